@@ -0,0 +1,34 @@
+#include "cobs.h"
+
+size_t cobs_encode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t  w    = 1;      // next output byte
+    size_t  code = 0;      // where the current block's length byte goes
+    uint8_t run  = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] != 0) {
+            out[w++] = in[i];
+            if (++run != 0xFF) continue;
+        }
+        // Zero in the input, or a full 254-byte block: close the block
+        out[code] = run;
+        code      = w++;
+        run       = 1;
+    }
+    out[code] = run;
+    return w;
+}
+
+size_t cobs_decode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t r = 0, w = 0;
+    while (r < len) {
+        uint8_t code = in[r++];
+        if (code == 0 || r + code - 1 > len) return 0;
+        for (uint8_t i = 1; i < code; i++) {
+            if (in[r] == 0) return 0;
+            out[w++] = in[r++];
+        }
+        // A block shorter than 254 stood for a zero, except at the very end
+        if (code != 0xFF && r < len) out[w++] = 0;
+    }
+    return w;
+}
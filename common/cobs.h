@@ -0,0 +1,31 @@
+#ifndef COBS_H
+#define COBS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Consistent Overhead Byte Stuffing — 0x00-free framing for byte streams
+//
+// Every zero in the payload is replaced by the distance to the next one, so
+// a frame never contains 0x00 and a single 0x00 can delimit frames on a
+// serial line. A receiver that starts mid-stream, or sees a corrupted frame,
+// is back in sync at the next delimiter.
+//
+//   payload   11 22 00 33        →   03 11 22 02 33
+//   overhead  1 byte + 1 per 254 non-zero bytes (COBS_MAX_ENCODED)
+//
+// Neither call writes the 0x00 delimiter; the stream writer adds it.
+// ---------------------------------------------------------------------------
+
+#define COBS_MAX_ENCODED(n) ((n) + (n) / 254 + 1)
+
+// Encode len bytes into out (≥ COBS_MAX_ENCODED(len)); returns bytes written
+size_t cobs_encode(const uint8_t* in, size_t len, uint8_t* out);
+
+// Decode one frame (delimiter excluded) into out (≥ len bytes); returns the
+// payload length, or 0 if the frame is empty or malformed (a 0x00 inside, or
+// a code running past the end)
+size_t cobs_decode(const uint8_t* in, size_t len, uint8_t* out);
+
+#endif // COBS_H
@@ -7,6 +7,20 @@
 #define LORA_IRQ_PIN    21
 #define LORA_FREQ       915.0
 
+// LoRa modem — single source for the radio setup and lora_airtime.h / lora_budget.h
+#define LORA_SF             7
+#define LORA_BW_HZ          125000
+#define LORA_CR_DENOM       5       // coding rate 4/5
+#define LORA_PREAMBLE       8       // RadioHead default
+#define LORA_TX_POWER_DBM   23      // RFM95W PA_BOOST maximum
+#define LORA_ANT_GAIN_DBI   2       // 1/4-wave whip, each end
+
+// Channel budget — checked at compile time in lora_budget.h
+#define LORA_MAX_DWELL_MS          400    // FCC 15.247 (902–928 MHz): ≤ 400 ms per transmission
+#define LORA_DUTY_CYCLE_MAX_PCT    100    // per node; 1 or 10 for EU868 sub-bands
+#define LORA_CHANNEL_LOAD_MAX_PCT  98     // scheduled airtime / superframe
+#define TELEMETRY_RATE_MIN_MHZ     2000   // each slave's STATUS rate the TDMA schedule must sustain (2 Hz)
+
 // SPI bus (shared with LoRa)
 #define SPI_MOSI_PIN    11
 #define SPI_MISO_PIN    13
@@ -16,11 +30,13 @@
 #define GPS_RX_PIN      18
 #define GPS_TX_PIN      17
 #define GPS_BAUD        115200
+#define GPS_UBX_RATE_HZ 10       // UBX NAV-PVT rate (1–25); 0 keeps the module on NMEA
 
-// OLED display (I2C) — ESP32-S3 defaults
+// I2C bus (OLED display + compass) — ESP32-S3 defaults
 #define OLED_SDA_PIN    8
 #define OLED_SCL_PIN    9
 #define OLED_ADDRESS    0x3C
+#define COMPASS_ADDR    0x0D   // QMC5883L
 
 // Thruster ESCs (PWM via LEDC, 100 Hz)
 #define MOTOR_LEFT_PWM  47
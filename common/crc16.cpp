@@ -0,0 +1,128 @@
+#include "crc16.h"
+
+#if defined(ESP_PLATFORM)
+#include "esp_rom_crc.h"
+#endif
+
+// ---------------------------------------------------------------------------
+// Lookup tables — generated at compile time, placed in .rodata (flash).
+//   t[0][b] : CRC of byte b fed into a zero register
+//   t[k][b] : t[0][b] followed by k zero bytes, so that slice-by-N can fold
+//             N input bytes into the register with N independent lookups.
+// Unused tables are discarded by --gc-sections when only TABLE is linked.
+// ---------------------------------------------------------------------------
+struct Crc16Tables {
+    uint16_t t[8][256];
+};
+
+static constexpr Crc16Tables makeCrc16Tables() {
+    Crc16Tables tbl{};
+    for (int b = 0; b < 256; b++) {
+        uint16_t crc = (uint16_t)(b << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ CRC16_POLY) : (uint16_t)(crc << 1);
+        }
+        tbl.t[0][b] = crc;
+    }
+    for (int k = 1; k < 8; k++) {
+        for (int b = 0; b < 256; b++) {
+            uint16_t prev = tbl.t[k - 1][b];
+            tbl.t[k][b] = (uint16_t)((prev << 8) ^ tbl.t[0][prev >> 8]);
+        }
+    }
+    return tbl;
+}
+
+static constexpr Crc16Tables CRC16_TABLES = makeCrc16Tables();
+
+// Spot-check against the bitwise definition: CRC of the single byte 0x01.
+static_assert(CRC16_TABLES.t[0][1] == CRC16_POLY, "CRC16 table generation broken");
+
+// ---------------------------------------------------------------------------
+// Reference implementation — the original 8-iteration loop.
+// ---------------------------------------------------------------------------
+uint16_t crc16_bitwise(uint16_t crc, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            if (crc & 0x8000) {
+                crc = (crc << 1) ^ CRC16_POLY;
+            } else {
+                crc <<= 1;
+            }
+        }
+    }
+    return crc;
+}
+
+// ---------------------------------------------------------------------------
+uint16_t crc16_table(uint16_t crc, const uint8_t* data, size_t len) {
+    const uint16_t* t0 = CRC16_TABLES.t[0];
+    while (len--) {
+        crc = (uint16_t)((crc << 8) ^ t0[(crc >> 8) ^ *data++]);
+    }
+    return crc;
+}
+
+// ---------------------------------------------------------------------------
+// Slice-by-N: the 16-bit register only overlaps the first two bytes of each
+// block; the remaining bytes are looked up directly in the deeper tables.
+// ---------------------------------------------------------------------------
+uint16_t crc16_slice4(uint16_t crc, const uint8_t* data, size_t len) {
+    const uint16_t (*t)[256] = CRC16_TABLES.t;
+    while (len >= 4) {
+        crc = t[3][data[0] ^ (crc >> 8)]
+            ^ t[2][data[1] ^ (crc & 0xFF)]
+            ^ t[1][data[2]]
+            ^ t[0][data[3]];
+        data += 4;
+        len  -= 4;
+    }
+    return crc16_table(crc, data, len);
+}
+
+uint16_t crc16_slice8(uint16_t crc, const uint8_t* data, size_t len) {
+    const uint16_t (*t)[256] = CRC16_TABLES.t;
+    while (len >= 8) {
+        crc = t[7][data[0] ^ (crc >> 8)]
+            ^ t[6][data[1] ^ (crc & 0xFF)]
+            ^ t[5][data[2]]
+            ^ t[4][data[3]]
+            ^ t[3][data[4]]
+            ^ t[2][data[5]]
+            ^ t[1][data[6]]
+            ^ t[0][data[7]];
+        data += 8;
+        len  -= 8;
+    }
+    return crc16_slice4(crc, data, len);
+}
+
+// ---------------------------------------------------------------------------
+// ESP32-S3 ROM routine. The ROM inverts the register on entry and exit
+// (CRC-16/GENIBUS convention), so invert around the call to get plain CCITT.
+// ---------------------------------------------------------------------------
+uint16_t crc16_rom(uint16_t crc, const uint8_t* data, size_t len) {
+#if defined(ESP_PLATFORM)
+    return (uint16_t)~esp_rom_crc16_be((uint16_t)~crc, data, (uint32_t)len);
+#else
+    return crc16_table(crc, data, len);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+uint16_t crc16_ccitt(const uint8_t* data, size_t len) {
+#if   CRC16_BACKEND == CRC16_BACKEND_BITWISE
+    return crc16_bitwise(CRC16_INIT, data, len);
+#elif CRC16_BACKEND == CRC16_BACKEND_TABLE
+    return crc16_table(CRC16_INIT, data, len);
+#elif CRC16_BACKEND == CRC16_BACKEND_SLICE4
+    return crc16_slice4(CRC16_INIT, data, len);
+#elif CRC16_BACKEND == CRC16_BACKEND_SLICE8
+    return crc16_slice8(CRC16_INIT, data, len);
+#elif CRC16_BACKEND == CRC16_BACKEND_ROM
+    return crc16_rom(CRC16_INIT, data, len);
+#else
+#error "Unknown CRC16_BACKEND"
+#endif
+}
@@ -0,0 +1,43 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC16-CCITT engines (polynomial 0x1021, initial value 0xFFFF, MSB-first, no final XOR).
+// Every backend produces byte-for-byte identical output to the original bitwise loop;
+// they differ only in speed and flash/RAM cost.
+//
+//   BITWISE  8 shift/XOR steps per byte          — no table
+//   TABLE    1 lookup per byte                   — 512 B table
+//   SLICE4   4 bytes per step, 4 lookups         — 2 KB tables
+//   SLICE8   8 bytes per step, 8 lookups         — 4 KB tables
+//   ROM      ESP32-S3 ROM crc16_be               — no table, runs from ROM (falls back to TABLE off-target)
+//
+// Select the backend used by calculate_checksum() with a build flag, e.g.
+//   build_flags = ${env.build_flags} -DCRC16_BACKEND=CRC16_BACKEND_SLICE4
+#define CRC16_BACKEND_BITWISE  0
+#define CRC16_BACKEND_TABLE    1
+#define CRC16_BACKEND_SLICE4   2
+#define CRC16_BACKEND_SLICE8   3
+#define CRC16_BACKEND_ROM      4
+
+#ifndef CRC16_BACKEND
+#define CRC16_BACKEND CRC16_BACKEND_TABLE
+#endif
+
+#define CRC16_INIT  0xFFFF
+#define CRC16_POLY  0x1021
+
+// Each backend continues from `crc`, so a packet may be checksummed in pieces:
+//   crc = crc16_table(CRC16_INIT, hdr, 2); crc = crc16_table(crc, body, n);
+uint16_t crc16_bitwise(uint16_t crc, const uint8_t* data, size_t len);
+uint16_t crc16_table  (uint16_t crc, const uint8_t* data, size_t len);
+uint16_t crc16_slice4 (uint16_t crc, const uint8_t* data, size_t len);
+uint16_t crc16_slice8 (uint16_t crc, const uint8_t* data, size_t len);
+uint16_t crc16_rom    (uint16_t crc, const uint8_t* data, size_t len);
+
+// CRC16-CCITT over `len` bytes using the backend chosen by CRC16_BACKEND.
+uint16_t crc16_ccitt(const uint8_t* data, size_t len);
+
+#endif // CRC16_H
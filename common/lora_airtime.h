@@ -0,0 +1,64 @@
+#ifndef LORA_AIRTIME_H
+#define LORA_AIRTIME_H
+
+#include <stdint.h>
+#include "config.h"
+
+// ---------------------------------------------------------------------------
+// LoRa time-on-air (Semtech SX1276 datasheet §4.1.1.7 / AN1200.13)
+//
+//   T_sym      = 2^SF / BW
+//   T_preamble = (n_preamble + 4.25) · T_sym
+//   n_payload  = 8 + max(ceil((8·PL − 4·SF + 28 + 16·CRC − 20·IH) / (4·(SF − 2·DE))) · (CR + 4), 0)
+//
+// PL includes RadioHead's 4-byte header (TO, FROM, ID, FLAGS) that RH_RF95
+// prepends to every frame, so pass the protocol struct size as payload_len.
+// All arithmetic is integer and constexpr; results are in microseconds.
+// ---------------------------------------------------------------------------
+
+#define RH_RF95_HEADER_BYTES  4
+
+struct LoRaModem {
+    uint8_t  sf;              // spreading factor 6–12
+    uint32_t bw_hz;           // 125000, 250000, 500000, ...
+    uint8_t  cr_denom;        // coding rate 4/5 … 4/8 → 5 … 8
+    uint16_t preamble;        // programmed preamble symbols (RadioHead default 8)
+    bool     explicit_header;
+    bool     crc;
+    bool     low_dr_optimize; // mandated for T_sym ≥ 16 ms (SF11/SF12 at 125 kHz)
+};
+
+constexpr uint32_t lora_symbol_us(const LoRaModem& m) {
+    return (uint32_t)(((uint64_t)1 << m.sf) * 1000000ULL / m.bw_hz);
+}
+
+// Explicit header + CRC, low-data-rate optimisation switched on where the
+// SX1276 requires it (symbol time ≥ 16 ms) — what RH_RF95 configures.
+constexpr LoRaModem lora_modem(uint8_t sf, uint32_t bw_hz, uint8_t cr_denom, uint16_t preamble) {
+    return { sf, bw_hz, cr_denom, preamble, true, true,
+             ((uint64_t)1 << sf) * 1000000ULL / bw_hz >= 16000 };
+}
+
+// Settings from config.h, used by lora_test_tx / lora_test_rx and the TDMA schedule
+constexpr LoRaModem LORA_MODEM_DEFAULT = lora_modem(LORA_SF, LORA_BW_HZ, LORA_CR_DENOM, LORA_PREAMBLE);
+
+constexpr uint32_t lora_payload_symbols(const LoRaModem& m, uint16_t payload_len) {
+    int32_t num = 8 * (int32_t)(payload_len + RH_RF95_HEADER_BYTES) - 4 * m.sf + 28
+                + (m.crc ? 16 : 0) - (m.explicit_header ? 0 : 20);
+    int32_t den = 4 * (m.sf - (m.low_dr_optimize ? 2 : 0));
+    int32_t blocks = num > 0 ? (num + den - 1) / den : 0;
+    return 8 + (uint32_t)blocks * m.cr_denom;
+}
+
+// Preamble + header + payload, in µs (quarter-symbol resolution for the 4.25)
+constexpr uint32_t lora_time_on_air_us(const LoRaModem& m, uint16_t payload_len) {
+    uint64_t quarterSymbols = 4ULL * m.preamble + 17 + 4ULL * lora_payload_symbols(m, payload_len);
+    return (uint32_t)(quarterSymbols * ((uint64_t)1 << m.sf) * 1000000ULL / (4ULL * m.bw_hz));
+}
+
+// Sanity anchors: SF7/125 kHz, 15-byte StatusPacket (+4 RH header) → 12.25 + 38 symbols;
+// SF12/125 kHz (low-DR on) → 12.25 + 28 symbols of 32.768 ms
+static_assert(lora_time_on_air_us(lora_modem(7, 125000, 5, 8), 15) == 51456, "LoRa airtime formula broken");
+static_assert(lora_time_on_air_us(lora_modem(12, 125000, 5, 8), 15) == 1318912, "LoRa low-DR airtime broken");
+
+#endif // LORA_AIRTIME_H
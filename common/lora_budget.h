@@ -0,0 +1,150 @@
+#ifndef LORA_BUDGET_H
+#define LORA_BUDGET_H
+
+#include <math.h>
+#include <stdint.h>
+#include "config.h"
+#include "protocol.h"
+#include "lora_airtime.h"
+#include "tdma.h"
+
+// ---------------------------------------------------------------------------
+// LoRa airtime and link budget, evaluated at compile time for the modem in
+// config.h (LORA_MODEM_DEFAULT) and the TDMA layout (TDMA_CONFIG_DEFAULT).
+//
+//   - per-packet-type time-on-air and the channel-saturated message rate
+//   - TDMA superframe, per-slave telemetry rate, per-node duty cycle
+//   - receiver sensitivity and link budget (SX1276 datasheet §2.5.5:
+//     −174 + 10·log10(BW) + NF 6 dB + SNR demodulation limit)
+//
+// The static_asserts at the bottom fail the build when the configured modem
+// and schedule exceed the channel budget set in config.h. Full tables for
+// other modem settings: pio run -e lora_budget -t exec
+// ---------------------------------------------------------------------------
+
+#define LORA_NOISE_FIGURE_CDB   600   // SX1276 receiver noise figure, centi-dB
+
+struct PacketAirtime {
+    const char* name;
+    uint8_t     type;
+    uint8_t     size;           // protocol bytes (RadioHead header added by the formula)
+    uint32_t    toa_us;
+    uint32_t    max_rate_mhz;   // messages per 1000 s on an otherwise idle channel
+};
+
+constexpr PacketAirtime packet_airtime(const LoRaModem& m, const char* name, uint8_t type, uint8_t size) {
+    return { name, type, size, lora_time_on_air_us(m, size),
+             (uint32_t)(1000000000ULL / lora_time_on_air_us(m, size)) };
+}
+
+#define LORA_PACKET_TYPE_COUNT 16
+
+struct PacketAirtimeTable {
+    PacketAirtime entry[LORA_PACKET_TYPE_COUNT];
+};
+
+// Every frame the protocol sends; FLEET_SUMMARY at its largest.
+constexpr PacketAirtimeTable lora_packet_airtimes(const LoRaModem& m) {
+    return { {
+        packet_airtime(m, "ASSIGN",        PKT_ASSIGN,        sizeof(AssignPacket)),
+        packet_airtime(m, "ACK_ASSIGN",    PKT_ACK_ASSIGN,    sizeof(AckAssignPacket)),
+        packet_airtime(m, "STATUS",        PKT_STATUS,        sizeof(StatusPacket)),
+        packet_airtime(m, "PING_STATUS",   PKT_PING_STATUS,   sizeof(PingStatusPacket)),
+        packet_airtime(m, "RC_*",          PKT_RC_START,      sizeof(RcCommandPacket)),
+        packet_airtime(m, "MASTER_STATUS", PKT_MASTER_STATUS, sizeof(MasterStatusPacket)),
+        packet_airtime(m, "FLEET_SUMMARY", PKT_FLEET_SUMMARY, (uint8_t)fleet_summary_size(FLEET_SUMMARY_MAX_ENTRIES)),
+        packet_airtime(m, "COURSE_ORIGIN", PKT_COURSE_ORIGIN, sizeof(CourseOriginPacket)),
+        packet_airtime(m, "ASSIGN_V2",     PKT_ASSIGN_V2,     sizeof(AssignV2Packet)),
+        packet_airtime(m, "ACK_ASSIGN_V2", PKT_ACK_ASSIGN_V2, sizeof(AckAssignV2Packet)),
+        packet_airtime(m, "STATUS_V2",     PKT_STATUS_V2,     sizeof(StatusV2Packet)),
+        packet_airtime(m, "BEACON",        PKT_BEACON,        sizeof(BeaconPacket)),
+        packet_airtime(m, "CONFIG_SET",    PKT_CONFIG_SET,    sizeof(ConfigSetPacket)),
+        packet_airtime(m, "CONFIG_ACK",    PKT_CONFIG_ACK,    sizeof(ConfigAckPacket)),
+        packet_airtime(m, "JOIN_REQUEST",  PKT_JOIN_REQUEST,  sizeof(JoinRequestPacket)),
+        packet_airtime(m, "JOIN_ACCEPT",   PKT_JOIN_ACCEPT,   sizeof(JoinAcceptPacket)),
+    } };
+}
+
+constexpr uint32_t lora_max_airtime_us(const PacketAirtimeTable& t) {
+    uint32_t worst = 0;
+    for (int i = 0; i < LORA_PACKET_TYPE_COUNT; i++) {
+        if (t.entry[i].toa_us > worst) worst = t.entry[i].toa_us;
+    }
+    return worst;
+}
+
+// ---------------------------------------------------------------------------
+// Schedule figures (TDMA layout)
+// ---------------------------------------------------------------------------
+
+// Per-slave telemetry rate, millihertz
+constexpr uint32_t tdma_slot_rate_mhz(const LoRaModem& m, const TdmaConfig& c) {
+    return (uint32_t)(1000000000ULL / tdma_superframe_us(m, c));
+}
+
+// Fraction of the superframe each node transmits, tenths of a percent
+constexpr uint32_t tdma_master_duty_permille(const LoRaModem& m, const TdmaConfig& c) {
+    return (uint32_t)(1000ULL * (lora_time_on_air_us(m, sizeof(BeaconPacket))
+                                 + (c.downlink_len ? lora_time_on_air_us(m, c.downlink_len) : 0))
+                      / tdma_superframe_us(m, c));
+}
+
+constexpr uint32_t tdma_slave_duty_permille(const LoRaModem& m, const TdmaConfig& c) {
+    return (uint32_t)(1000ULL * lora_time_on_air_us(m, c.uplink_len) / tdma_superframe_us(m, c));
+}
+
+constexpr uint32_t tdma_channel_load_permille(const LoRaModem& m, const TdmaConfig& c) {
+    return (uint32_t)(1000ULL * tdma_airtime_us(m, c) / tdma_superframe_us(m, c));
+}
+
+// ---------------------------------------------------------------------------
+// Link budget (centi-dB / centi-dBm integers so it stays constexpr)
+// ---------------------------------------------------------------------------
+
+// SX1276 SNR demodulation limit per spreading factor
+constexpr int32_t lora_snr_limit_cdb(uint8_t sf) {
+    return sf <= 6 ? -500 : -750 - 250 * (sf - 7);
+}
+
+// 10·log10(BW) for the SX1276 bandwidth steps; 0 for anything else
+constexpr int32_t lora_bw_log_cdb(uint32_t bw_hz) {
+    return bw_hz == 7800   ? 3892 : bw_hz == 10400  ? 4017 : bw_hz == 15600  ? 4193 :
+           bw_hz == 20800  ? 4318 : bw_hz == 31250  ? 4495 : bw_hz == 41700  ? 4620 :
+           bw_hz == 62500  ? 4796 : bw_hz == 125000 ? 5097 : bw_hz == 250000 ? 5398 :
+           bw_hz == 500000 ? 5699 : 0;
+}
+
+constexpr int32_t lora_sensitivity_cdbm(const LoRaModem& m) {
+    return -17400 + lora_bw_log_cdb(m.bw_hz) + LORA_NOISE_FIGURE_CDB + lora_snr_limit_cdb(m.sf);
+}
+
+// Maximum tolerable path loss: TX power + both antenna gains − sensitivity
+constexpr int32_t lora_link_budget_cdb(const LoRaModem& m, int32_t tx_dbm, int32_t ant_gain_dbi) {
+    return 100 * (tx_dbm + 2 * ant_gain_dbi) - lora_sensitivity_cdbm(m);
+}
+
+// Free-space range for a path loss budget — an upper bound; antennas a metre
+// above the water lose far more to the Fresnel zone and sea state.
+inline float lora_free_space_range_m(int32_t budget_cdb, float freq_mhz) {
+    return 1000.0f * powf(10.0f, (budget_cdb / 100.0f - 32.44f - 20.0f * log10f(freq_mhz)) / 20.0f);
+}
+
+// ---------------------------------------------------------------------------
+// Channel budget — build fails when config.h's modem/schedule does not fit
+// ---------------------------------------------------------------------------
+constexpr PacketAirtimeTable LORA_PACKET_AIRTIMES = lora_packet_airtimes(LORA_MODEM_DEFAULT);
+
+static_assert(lora_bw_log_cdb(LORA_BW_HZ) != 0, "LORA_BW_HZ is not an SX1276 bandwidth step");
+static_assert(LORA_SF >= 6 && LORA_SF <= 12, "LORA_SF must be 6..12");
+static_assert(lora_max_airtime_us(LORA_PACKET_AIRTIMES) <= LORA_MAX_DWELL_MS * 1000UL,
+              "a protocol frame exceeds LORA_MAX_DWELL_MS at this modem setting");
+static_assert(tdma_slot_rate_mhz(LORA_MODEM_DEFAULT, TDMA_CONFIG_DEFAULT) >= TELEMETRY_RATE_MIN_MHZ,
+              "TDMA superframe too long for TELEMETRY_RATE_MIN_MHZ");
+static_assert(tdma_master_duty_permille(LORA_MODEM_DEFAULT, TDMA_CONFIG_DEFAULT) <= 10 * LORA_DUTY_CYCLE_MAX_PCT,
+              "master duty cycle exceeds LORA_DUTY_CYCLE_MAX_PCT");
+static_assert(tdma_slave_duty_permille(LORA_MODEM_DEFAULT, TDMA_CONFIG_DEFAULT) <= 10 * LORA_DUTY_CYCLE_MAX_PCT,
+              "slave duty cycle exceeds LORA_DUTY_CYCLE_MAX_PCT");
+static_assert(tdma_channel_load_permille(LORA_MODEM_DEFAULT, TDMA_CONFIG_DEFAULT) <= 10 * LORA_CHANNEL_LOAD_MAX_PCT,
+              "TDMA schedule exceeds LORA_CHANNEL_LOAD_MAX_PCT");
+
+#endif // LORA_BUDGET_H
@@ -0,0 +1,229 @@
+#ifndef PACKET_CODEC_H
+#define PACKET_CODEC_H
+
+// ---------------------------------------------------------------------------
+// Typed packet codec for the structs in protocol.h
+//
+// Encode: fill a struct, then packet_seal(pkt) writes the CRC in place and
+//         returns the on-air length — no intermediate byte buffer.
+//
+//   StatusPacket pkt = { PKT_STATUS, BUOY_WINDWARD, lat, lon, dist, batt, 0 };
+//   radio.send((const uint8_t*)&pkt, packet_seal(pkt));
+//
+// Decode: packet_view<T>(buf, len) validates length, type and CRC, then
+//         returns a typed pointer into the caller's receive buffer (the
+//         structs are packed, alignment 1) — no memcpy into a local struct.
+//
+//   if (const StatusPacket* s = packet_view<StatusPacket>(buf, len)) { ... }
+//
+// Dispatch: PacketDispatcher<Handler> routes a raw frame to
+//         Handler::onAssign / onAckAssign / onStatus / onPing / onRcCommand /
+//         onMasterStatus / onFleetSummary / onCourseOrigin / onAssignV2 /
+//         onAckAssignV2 / onStatusV2 / onBeacon / onConfigSet / onConfigAck /
+//         onJoinRequest / onJoinAccept through a constexpr 256-entry table
+//         indexed by the packet_type byte — one load, one length compare, one
+//         CRC, one indirect call. Derive from PacketHandlerBase to get no-op
+//         defaults.
+//
+// RadioHead note: RH_RF95::recv() still copies the frame out of the driver's
+// private buffer once; everything after that works in place on that buffer.
+// ---------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+#include "protocol.h"
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "packet_seal() stores the CRC natively; verify_checksum() expects little-endian");
+
+// Per-struct wire facts. `type` is the packet_type a valid frame carries;
+// RcCommandPacket accepts the PKT_RC_* range instead of a single value.
+template <typename T> struct PacketTraits;
+
+template <> struct PacketTraits<AssignPacket>       { static constexpr uint8_t type = PKT_ASSIGN; };
+template <> struct PacketTraits<AckAssignPacket>    { static constexpr uint8_t type = PKT_ACK_ASSIGN; };
+template <> struct PacketTraits<StatusPacket>       { static constexpr uint8_t type = PKT_STATUS; };
+template <> struct PacketTraits<PingStatusPacket>   { static constexpr uint8_t type = PKT_PING_STATUS; };
+template <> struct PacketTraits<RcCommandPacket>    { static constexpr uint8_t type = PKT_RC_START; };
+template <> struct PacketTraits<MasterStatusPacket> { static constexpr uint8_t type = PKT_MASTER_STATUS; };
+template <> struct PacketTraits<CourseOriginPacket> { static constexpr uint8_t type = PKT_COURSE_ORIGIN; };
+template <> struct PacketTraits<AssignV2Packet>     { static constexpr uint8_t type = PKT_ASSIGN_V2; };
+template <> struct PacketTraits<AckAssignV2Packet>  { static constexpr uint8_t type = PKT_ACK_ASSIGN_V2; };
+template <> struct PacketTraits<StatusV2Packet>     { static constexpr uint8_t type = PKT_STATUS_V2; };
+template <> struct PacketTraits<BeaconPacket>       { static constexpr uint8_t type = PKT_BEACON; };
+template <> struct PacketTraits<ConfigSetPacket>    { static constexpr uint8_t type = PKT_CONFIG_SET; };
+template <> struct PacketTraits<ConfigAckPacket>    { static constexpr uint8_t type = PKT_CONFIG_ACK; };
+template <> struct PacketTraits<JoinRequestPacket>  { static constexpr uint8_t type = PKT_JOIN_REQUEST; };
+template <> struct PacketTraits<JoinAcceptPacket>   { static constexpr uint8_t type = PKT_JOIN_ACCEPT; };
+
+template <typename T>
+constexpr bool packet_type_matches(uint8_t type) {
+    return type == PacketTraits<T>::type;
+}
+
+template <>
+constexpr bool packet_type_matches<RcCommandPacket>(uint8_t type) {
+    return type == PKT_RC_START || type == PKT_RC_STOP || type == PKT_RC_RTH;
+}
+
+// ---------------------------------------------------------------------------
+// Encode
+// ---------------------------------------------------------------------------
+template <typename T>
+inline uint8_t packet_seal(T& pkt) {
+    static_assert(sizeof(T) <= LORA_MAX_PAYLOAD, "packet exceeds LoRa payload");
+    static_assert(sizeof(pkt.checksum) == 2, "checksum must be the uint16_t CRC field");
+    pkt.checksum = calculate_checksum((const uint8_t*)&pkt, sizeof(T) - 2);
+    return (uint8_t)sizeof(T);
+}
+
+// ---------------------------------------------------------------------------
+// Decode — nullptr on wrong length, wrong type or bad CRC
+// ---------------------------------------------------------------------------
+template <typename T>
+inline const T* packet_view(const uint8_t* buf, size_t len) {
+    if (len != sizeof(T) || !packet_type_matches<T>(buf[0])) return nullptr;
+    if (!verify_checksum(buf, len)) return nullptr;
+    return reinterpret_cast<const T*>(buf);
+}
+
+// Variable-length fleet summary: header and entries point into the buffer.
+struct FleetSummaryView {
+    const FleetSummaryHeader* header;
+    const FleetEntry*         entries;   // header->count records
+};
+
+inline bool fleet_summary_view(const uint8_t* buf, size_t len, FleetSummaryView* out) {
+    if (len < fleet_summary_size(0) || buf[0] != PKT_FLEET_SUMMARY) return false;
+    if (len != fleet_summary_size(buf[FLEET_SUMMARY_OFFSET_COUNT])) return false;
+    if (!verify_checksum(buf, len)) return false;
+    out->header  = reinterpret_cast<const FleetSummaryHeader*>(buf);
+    out->entries = reinterpret_cast<const FleetEntry*>(buf + sizeof(FleetSummaryHeader));
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+enum PacketResult {
+    PACKET_OK = 0,
+    PACKET_UNKNOWN_TYPE,
+    PACKET_BAD_LENGTH,
+    PACKET_BAD_CHECKSUM
+};
+
+// No-op defaults; a handler overrides (hides) only the packets it cares about.
+struct PacketHandlerBase {
+    void onAssign(const AssignPacket&) {}
+    void onAckAssign(const AckAssignPacket&) {}
+    void onStatus(const StatusPacket&) {}
+    void onPing(const PingStatusPacket&) {}
+    void onRcCommand(const RcCommandPacket&) {}
+    void onMasterStatus(const MasterStatusPacket&) {}
+    void onFleetSummary(const FleetSummaryView&) {}
+    void onCourseOrigin(const CourseOriginPacket&) {}
+    void onAssignV2(const AssignV2Packet&) {}
+    void onAckAssignV2(const AckAssignV2Packet&) {}
+    void onStatusV2(const StatusV2Packet&) {}
+    void onBeacon(const BeaconPacket&) {}
+    void onConfigSet(const ConfigSetPacket&) {}
+    void onConfigAck(const ConfigAckPacket&) {}
+    void onJoinRequest(const JoinRequestPacket&) {}
+    void onJoinAccept(const JoinAcceptPacket&) {}
+};
+
+// Routing table: one entry per packet_type byte; fn == nullptr means unknown.
+// Fixed-size packets have entry_size 0. Variable-length packets are valid at
+// size + entry_size × buf[count_index] bytes.
+template <typename Handler>
+struct PacketRoutes {
+    typedef void (*RouteFn)(Handler&, const uint8_t*);
+
+    struct Route {
+        uint8_t size;
+        uint8_t entry_size;
+        uint8_t count_index;
+        RouteFn fn;
+    };
+
+    Route route[256];
+};
+
+template <typename Handler>
+struct PacketThunks {
+    template <typename T>
+    static const T& as(const uint8_t* b) { return *reinterpret_cast<const T*>(b); }
+
+    static void toAssign(Handler& h, const uint8_t* b)       { h.onAssign(as<AssignPacket>(b)); }
+    static void toAckAssign(Handler& h, const uint8_t* b)    { h.onAckAssign(as<AckAssignPacket>(b)); }
+    static void toStatus(Handler& h, const uint8_t* b)       { h.onStatus(as<StatusPacket>(b)); }
+    static void toPing(Handler& h, const uint8_t* b)         { h.onPing(as<PingStatusPacket>(b)); }
+    static void toRcCommand(Handler& h, const uint8_t* b)    { h.onRcCommand(as<RcCommandPacket>(b)); }
+    static void toMasterStatus(Handler& h, const uint8_t* b) { h.onMasterStatus(as<MasterStatusPacket>(b)); }
+
+    static void toCourseOrigin(Handler& h, const uint8_t* b) { h.onCourseOrigin(as<CourseOriginPacket>(b)); }
+    static void toAssignV2(Handler& h, const uint8_t* b)     { h.onAssignV2(as<AssignV2Packet>(b)); }
+    static void toAckAssignV2(Handler& h, const uint8_t* b)  { h.onAckAssignV2(as<AckAssignV2Packet>(b)); }
+    static void toStatusV2(Handler& h, const uint8_t* b)     { h.onStatusV2(as<StatusV2Packet>(b)); }
+    static void toBeacon(Handler& h, const uint8_t* b)       { h.onBeacon(as<BeaconPacket>(b)); }
+    static void toConfigSet(Handler& h, const uint8_t* b)    { h.onConfigSet(as<ConfigSetPacket>(b)); }
+    static void toConfigAck(Handler& h, const uint8_t* b)    { h.onConfigAck(as<ConfigAckPacket>(b)); }
+    static void toJoinRequest(Handler& h, const uint8_t* b)  { h.onJoinRequest(as<JoinRequestPacket>(b)); }
+    static void toJoinAccept(Handler& h, const uint8_t* b)   { h.onJoinAccept(as<JoinAcceptPacket>(b)); }
+
+    static void toFleetSummary(Handler& h, const uint8_t* b) {
+        FleetSummaryView v = { &as<FleetSummaryHeader>(b),
+                               reinterpret_cast<const FleetEntry*>(b + sizeof(FleetSummaryHeader)) };
+        h.onFleetSummary(v);
+    }
+};
+
+template <typename Handler>
+constexpr PacketRoutes<Handler> make_packet_routes() {
+    typedef PacketThunks<Handler> T;
+    PacketRoutes<Handler> r{};
+    r.route[PKT_ASSIGN]        = { sizeof(AssignPacket),       0, 0, &T::toAssign };
+    r.route[PKT_ACK_ASSIGN]    = { sizeof(AckAssignPacket),    0, 0, &T::toAckAssign };
+    r.route[PKT_STATUS]        = { sizeof(StatusPacket),       0, 0, &T::toStatus };
+    r.route[PKT_PING_STATUS]   = { sizeof(PingStatusPacket),   0, 0, &T::toPing };
+    r.route[PKT_RC_START]      = { sizeof(RcCommandPacket),    0, 0, &T::toRcCommand };
+    r.route[PKT_RC_STOP]       = { sizeof(RcCommandPacket),    0, 0, &T::toRcCommand };
+    r.route[PKT_RC_RTH]        = { sizeof(RcCommandPacket),    0, 0, &T::toRcCommand };
+    r.route[PKT_MASTER_STATUS] = { sizeof(MasterStatusPacket), 0, 0, &T::toMasterStatus };
+    r.route[PKT_COURSE_ORIGIN] = { sizeof(CourseOriginPacket), 0, 0, &T::toCourseOrigin };
+    r.route[PKT_ASSIGN_V2]     = { sizeof(AssignV2Packet),     0, 0, &T::toAssignV2 };
+    r.route[PKT_ACK_ASSIGN_V2] = { sizeof(AckAssignV2Packet),  0, 0, &T::toAckAssignV2 };
+    r.route[PKT_STATUS_V2]     = { sizeof(StatusV2Packet),     0, 0, &T::toStatusV2 };
+    r.route[PKT_BEACON]        = { sizeof(BeaconPacket),       0, 0, &T::toBeacon };
+    r.route[PKT_CONFIG_SET]    = { sizeof(ConfigSetPacket),    0, 0, &T::toConfigSet };
+    r.route[PKT_CONFIG_ACK]    = { sizeof(ConfigAckPacket),    0, 0, &T::toConfigAck };
+    r.route[PKT_JOIN_REQUEST]  = { sizeof(JoinRequestPacket),  0, 0, &T::toJoinRequest };
+    r.route[PKT_JOIN_ACCEPT]   = { sizeof(JoinAcceptPacket),   0, 0, &T::toJoinAccept };
+    r.route[PKT_FLEET_SUMMARY] = { (uint8_t)fleet_summary_size(0), sizeof(FleetEntry),
+                                   FLEET_SUMMARY_OFFSET_COUNT, &T::toFleetSummary };
+    return r;
+}
+
+template <typename Handler>
+class PacketDispatcher {
+public:
+    explicit PacketDispatcher(Handler& handler) : handler(handler) {}
+
+    PacketResult dispatch(const uint8_t* buf, size_t len) {
+        if (len == 0) return PACKET_BAD_LENGTH;
+        const typename PacketRoutes<Handler>::Route& r = ROUTES.route[buf[0]];
+        if (r.fn == nullptr)             return PACKET_UNKNOWN_TYPE;
+        if (len < r.size)                return PACKET_BAD_LENGTH;
+        if (len != r.size + (size_t)r.entry_size * buf[r.count_index]) return PACKET_BAD_LENGTH;
+        if (!verify_checksum(buf, len))  return PACKET_BAD_CHECKSUM;
+        r.fn(handler, buf);
+        return PACKET_OK;
+    }
+
+private:
+    static constexpr PacketRoutes<Handler> ROUTES = make_packet_routes<Handler>();
+
+    Handler& handler;
+};
+
+#endif // PACKET_CODEC_H
@@ -0,0 +1,75 @@
+#include "position.h"
+#include <math.h>
+
+// WGS-84
+#define WGS84_A    6378137.0
+#define WGS84_E2   0.00669437999014
+
+#define E7_PER_DEG 10000000.0
+#define E7_FULL_TURN 3600000000LL
+
+// ---------------------------------------------------------------------------
+int32_t deg_to_e7(double deg) {
+    return (int32_t)lround(deg * E7_PER_DEG);
+}
+
+double e7_to_deg(int32_t e7) {
+    return e7 / E7_PER_DEG;
+}
+
+// ---------------------------------------------------------------------------
+// Local radii of curvature at the origin latitude; run once per origin.
+// ---------------------------------------------------------------------------
+void course_origin_set(CourseOrigin* origin, int32_t lat_e7, int32_t lon_e7, uint8_t seq) {
+    double phi  = e7_to_deg(lat_e7) * M_PI / 180.0;
+    double s    = sin(phi);
+    double w    = 1.0 - WGS84_E2 * s * s;
+    double m    = WGS84_A * (1.0 - WGS84_E2) / (w * sqrt(w));   // meridional radius
+    double n    = WGS84_A / sqrt(w);                            // prime-vertical radius
+    double cmPerE7Rad = (M_PI / 180.0) / E7_PER_DEG * 100.0;
+
+    origin->lat_e7        = lat_e7;
+    origin->lon_e7        = lon_e7;
+    origin->seq           = seq;
+    origin->cos_lat       = (float)cos(phi);
+    origin->cm_per_e7_lat = (float)(m * cmPerE7Rad);
+    origin->cm_per_e7_lon = (float)(n * cos(phi) * cmPerE7Rad);
+    origin->cm_per_e7_lat_q24 = (uint32_t)llround(m * cmPerE7Rad * (1 << POS_SCALE_SHIFT));
+    origin->cm_per_e7_lon_q24 = (uint32_t)llround(n * cos(phi) * cmPerE7Rad * (1 << POS_SCALE_SHIFT));
+}
+
+// Round-half-away-from-zero integer division
+static int64_t divRound(int64_t num, int64_t den) {
+    return (num >= 0) ? (num + den / 2) / den : (num - den / 2) / den;
+}
+
+// Longitude difference wrapped into ±180° so courses spanning the antimeridian work.
+static int64_t lonDeltaE7(int32_t lon_e7, int32_t origin_e7) {
+    int64_t d = (int64_t)lon_e7 - origin_e7;
+    if (d >  E7_FULL_TURN / 2) d -= E7_FULL_TURN;
+    if (d < -E7_FULL_TURN / 2) d += E7_FULL_TURN;
+    return d;
+}
+
+static int32_t wrapLonE7(int64_t lon) {
+    if (lon >  E7_FULL_TURN / 2) lon -= E7_FULL_TURN;
+    if (lon < -E7_FULL_TURN / 2) lon += E7_FULL_TURN;
+    return (int32_t)lon;
+}
+
+// ---------------------------------------------------------------------------
+bool position_encode(const CourseOrigin& origin, int32_t lat_e7, int32_t lon_e7, PositionCm* out) {
+    const int64_t one = (int64_t)1 << POS_SCALE_SHIFT;
+    int64_t north = divRound(((int64_t)lat_e7 - origin.lat_e7) * origin.cm_per_e7_lat_q24, one);
+    int64_t east  = divRound(lonDeltaE7(lon_e7, origin.lon_e7) * origin.cm_per_e7_lon_q24, one);
+    if (north > POS24_MAX || north < POS24_MIN || east > POS24_MAX || east < POS24_MIN) return false;
+    out->north_cm = (int32_t)north;
+    out->east_cm  = (int32_t)east;
+    return true;
+}
+
+void position_decode(const CourseOrigin& origin, const PositionCm& pos, int32_t* lat_e7, int32_t* lon_e7) {
+    const int64_t one = (int64_t)1 << POS_SCALE_SHIFT;   // multiply: offsets are signed, << of a negative is UB
+    *lat_e7 = origin.lat_e7 + (int32_t)divRound(pos.north_cm * one, origin.cm_per_e7_lat_q24);
+    *lon_e7 = wrapLonE7((int64_t)origin.lon_e7 + divRound(pos.east_cm * one, origin.cm_per_e7_lon_q24));
+}
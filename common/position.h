@@ -0,0 +1,70 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Protocol v2 position encoding — signed centimetre offsets from a course origin
+//
+// The master broadcasts the course origin once (PKT_COURSE_ORIGIN, absolute
+// lat/lon in 1e-7 degree integers). Every position-bearing v2 packet then
+// carries north/east offsets from that origin as 24-bit signed centimetres:
+//
+//   range      ±8 388 607 cm = ±83.9 km per axis
+//   resolution 1 cm (float32 lat/lon: ~1–2 m at typical longitudes)
+//   size       6 bytes per position instead of 8
+//
+// Offsets use the WGS-84 meridional / prime-vertical radii at the origin
+// latitude (computed once per origin), so they are metric to well under 1 cm
+// per km across a race course. Encode/decode is pure integer (Q8.24 scale,
+// 64-bit intermediate), so the round trip is within 1 cm over the full range.
+// Each packet carries the origin sequence number it was encoded against;
+// receivers drop packets whose origin_seq differs.
+// ---------------------------------------------------------------------------
+
+#define POS24_MAX   8388607
+#define POS24_MIN  (-8388608)
+
+#define POS_SCALE_SHIFT 24   // Q8.24 fixed-point scale factors
+
+struct CourseOrigin {
+    int32_t  lat_e7;            // origin latitude,  1e-7 degrees
+    int32_t  lon_e7;            // origin longitude, 1e-7 degrees
+    uint8_t  seq;               // bumped by the master whenever the origin moves
+    uint32_t cm_per_e7_lat_q24; // north centimetres per 1e-7 degree latitude, Q8.24
+    uint32_t cm_per_e7_lon_q24; // east centimetres per 1e-7 degree longitude (includes cos(lat)), Q8.24
+    float    cm_per_e7_lat;     // same scales as float, for callers doing float geometry
+    float    cm_per_e7_lon;
+    float    cos_lat;           // cached cos(origin latitude)
+};
+
+struct PositionCm {
+    int32_t north_cm;
+    int32_t east_cm;
+};
+
+// Degrees ↔ 1e-7 degree integers (the GPS-native fixed-point format)
+int32_t deg_to_e7(double deg);
+double  e7_to_deg(int32_t e7);
+
+void course_origin_set(CourseOrigin* origin, int32_t lat_e7, int32_t lon_e7, uint8_t seq);
+
+// Absolute position → offsets. Returns false if either axis exceeds the int24 range.
+bool position_encode(const CourseOrigin& origin, int32_t lat_e7, int32_t lon_e7, PositionCm* out);
+
+// Offsets → absolute position
+void position_decode(const CourseOrigin& origin, const PositionCm& pos, int32_t* lat_e7, int32_t* lon_e7);
+
+// 24-bit little-endian signed field in a packed packet struct
+static inline void pos24_put(uint8_t* p, int32_t v) {
+    p[0] = (uint8_t)(v);
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+}
+
+static inline int32_t pos24_get(const uint8_t* p) {
+    int32_t v = (int32_t)p[0] | ((int32_t)p[1] << 8) | ((int32_t)p[2] << 16);
+    return (v ^ 0x800000) - 0x800000;   // sign-extend bit 23
+}
+
+#endif // POSITION_H
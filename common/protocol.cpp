@@ -1,27 +1,42 @@
 #include "protocol.h"
+#include "crc16.h"
+#include <string.h>
 
 // CRC16-CCITT (polynomial 0x1021, initial value 0xFFFF)
 // Covers all bytes except the final 2-byte checksum field.
-uint16_t calculate_checksum(uint8_t* data, size_t len) {
-    uint16_t crc = 0xFFFF;
-    for (size_t i = 0; i < len; i++) {
-        crc ^= (uint16_t)data[i] << 8;
-        for (int bit = 0; bit < 8; bit++) {
-            if (crc & 0x8000) {
-                crc = (crc << 1) ^ 0x1021;
-            } else {
-                crc <<= 1;
-            }
-        }
-    }
-    return crc;
+// Backend (bitwise / table / slice-by-N / ROM) is selected by CRC16_BACKEND in crc16.h.
+uint16_t calculate_checksum(const uint8_t* data, size_t len) {
+    return crc16_ccitt(data, len);
 }
 
 // Verify checksum: compute CRC over all bytes except last 2, compare to stored value.
 // Assumes the stored uint16_t checksum is the last 2 bytes of the packet (little-endian).
-bool verify_checksum(uint8_t* data, size_t len) {
+bool verify_checksum(const uint8_t* data, size_t len) {
     if (len < 3) return false;
     uint16_t computed = calculate_checksum(data, len - 2);
     uint16_t stored   = (uint16_t)data[len - 2] | ((uint16_t)data[len - 1] << 8);
     return computed == stored;
 }
+
+// Fleet summary: header, entries, then the CRC over everything before it.
+size_t build_fleet_summary(uint8_t* buf, uint8_t fleet_state, uint8_t origin_seq,
+                           const FleetEntry* entries, uint8_t count, int fault_flags) {
+    if (count > FLEET_SUMMARY_MAX_ENTRIES) return 0;
+
+    FleetSummaryHeader* hdr = (FleetSummaryHeader*)buf;
+    hdr->packet_type = PKT_FLEET_SUMMARY;
+    hdr->buoy_id     = BUOY_MASTER;
+    hdr->fleet_state = fleet_state;
+    hdr->fault_flags = (uint8_t)(fault_flags < 0 ? 0 : fault_flags);
+    hdr->count       = count;
+    hdr->origin_seq  = origin_seq;
+    for (uint8_t i = 0; fault_flags < 0 && i < count; i++) hdr->fault_flags |= entries[i].error_flags;
+
+    memcpy(buf + sizeof(FleetSummaryHeader), entries, (size_t)count * sizeof(FleetEntry));
+
+    size_t   len = fleet_summary_size(count);
+    uint16_t crc = calculate_checksum(buf, len - 2);
+    buf[len - 2] = (uint8_t)(crc & 0xFF);
+    buf[len - 1] = (uint8_t)(crc >> 8);
+    return len;
+}
@@ -1,11 +1,16 @@
 #ifndef PROTOCOL_H
 #define PROTOCOL_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define MAX_BUOYS 6
 #define LORA_MAX_PAYLOAD 251
 
+// Protocol v2 adds origin-relative centimetre positions (see position.h).
+// v1 float lat/lon packets remain valid and keep their packet types.
+#define PROTOCOL_VERSION 2
+
 enum BuoyState {
     STATE_INIT = 0,
     STATE_DEPLOY,
@@ -23,7 +28,17 @@ enum PacketType {
     PKT_RC_START    = 0xB1,  // Remote control → master: start race
     PKT_RC_STOP     = 0xB2,  // Remote control → master: stop/abort race
     PKT_RC_RTH      = 0xB3,  // Remote control → master: recall entire fleet to home coords
-    PKT_MASTER_STATUS = 0xC1 // Master → remote: aggregate fleet state
+    PKT_MASTER_STATUS = 0xC1, // Master → remote: aggregate fleet state
+    PKT_FLEET_SUMMARY = 0xC2, // Master → remote/logger: every slave's telemetry in one frame
+    PKT_COURSE_ORIGIN = 0xC3, // Master → all: v2 course origin for centimetre offsets
+    PKT_ASSIGN_V2     = 0xA6, // Master → slave: target as origin offset
+    PKT_ACK_ASSIGN_V2 = 0xAB, // Slave → master: acknowledged, current position as origin offset
+    PKT_STATUS_V2     = 0x5B, // Slave → master: telemetry, position as origin offset
+    PKT_BEACON        = 0xC4, // Master → all: TDMA superframe start + slot layout (tdma.h)
+    PKT_CONFIG_SET    = 0xC5, // Master / remote → buoy: change one stored config value
+    PKT_CONFIG_ACK    = 0x5C, // Buoy → master: config value now in effect
+    PKT_JOIN_REQUEST  = 0x5D, // Node → master: unaddressed node asks to join (registry.h)
+    PKT_JOIN_ACCEPT   = 0xC6  // Master → node: address and role for a hardware UID
 };
 
 enum BuoyID {
@@ -34,6 +49,8 @@ enum BuoyID {
     BUOY_LEEWARD  = 4,
     BUOY_REMOTE   = 5   // Handheld remote control unit (two identical units, same ID)
 };
+// Fixed IDs and MAX_BUOYS are the original six-unit layout. Larger fleets
+// join through the master's registry (registry.h) and get a NodeAddress.
 
 struct GPSPosition {
     float   latitude;
@@ -51,6 +68,7 @@ struct __attribute__((packed)) AssignPacket {
     uint8_t  hold_radius;   // metres
     uint16_t checksum;      // CRC16-CCITT
 };
+static_assert(sizeof(AssignPacket) == 13, "AssignPacket must be 13 bytes on air");
 
 // Slave → master: confirm receipt of assignment (13 bytes)
 struct __attribute__((packed)) AckAssignPacket {
@@ -61,6 +79,7 @@ struct __attribute__((packed)) AckAssignPacket {
     float    current_lon;
     uint16_t checksum;      // CRC16-CCITT
 };
+static_assert(sizeof(AckAssignPacket) == 13, "AckAssignPacket must be 13 bytes on air");
 
 // Slave → master: position and battery telemetry (15 bytes)
 struct __attribute__((packed)) StatusPacket {
@@ -72,6 +91,7 @@ struct __attribute__((packed)) StatusPacket {
     uint8_t  battery_tenths_v;  // Battery voltage in 0.1V units (e.g. 148 = 14.8V)
     uint16_t checksum;          // CRC16-CCITT
 };
+static_assert(sizeof(StatusPacket) == 15, "StatusPacket must be 15 bytes on air");
 
 // Heartbeat (8 bytes)
 struct __attribute__((packed)) PingStatusPacket {
@@ -80,6 +100,7 @@ struct __attribute__((packed)) PingStatusPacket {
     uint32_t timestamp;     // millis()
     uint16_t checksum;      // CRC16-CCITT
 };
+static_assert(sizeof(PingStatusPacket) == 8, "PingStatusPacket must be 8 bytes on air");
 
 // Remote control → master: start, stop, or RTH command (4 bytes)
 // Handles PKT_RC_START (0xB1), PKT_RC_STOP (0xB2), PKT_RC_RTH (0xB3)
@@ -88,6 +109,7 @@ struct __attribute__((packed)) RcCommandPacket {
     uint8_t  buoy_id;       // BUOY_REMOTE
     uint16_t checksum;      // CRC16-CCITT
 };
+static_assert(sizeof(RcCommandPacket) == 4, "RcCommandPacket must be 4 bytes on air");
 
 // Fleet state values for MasterStatusPacket.fleet_state
 #define FLEET_STATE_REPOSITIONING  1  // Buoys navigating to targets
@@ -105,6 +127,210 @@ struct __attribute__((packed)) MasterStatusPacket {
     uint8_t  fault_flags;   // ERROR_FLAG_* bitmask (ORed across all reporting slaves)
     uint16_t checksum;      // CRC16-CCITT
 };
+static_assert(sizeof(MasterStatusPacket) == 6, "MasterStatusPacket must be 6 bytes on air");
+
+// Master → remote/logger: whole-fleet telemetry in a single frame (variable length)
+//   FleetSummaryHeader | FleetEntry × count | uint16_t checksum
+// Replaces relaying one StatusPacket per slave plus a MasterStatusPacket: one
+// preamble + header instead of N+1. Build with build_fleet_summary().
+struct __attribute__((packed)) FleetSummaryHeader {
+    uint8_t  packet_type;   // PKT_FLEET_SUMMARY (0xC2)
+    uint8_t  buoy_id;       // BUOY_MASTER
+    uint8_t  fleet_state;   // FLEET_STATE_* value above
+    uint8_t  fault_flags;   // ERROR_FLAG_* bitmask (ORed across all entries)
+    uint8_t  count;         // Number of FleetEntry records that follow
+    uint8_t  origin_seq;    // CourseOrigin.seq the entry positions are relative to
+};
+static_assert(sizeof(FleetSummaryHeader) == 6, "FleetSummaryHeader must be 6 bytes on air");
+
+// One slave's last reported state (11 bytes)
+struct __attribute__((packed)) FleetEntry {
+    uint8_t  buoy_id;
+    uint8_t  north_cm[3];       // int24 offset from course origin (pos24_get)
+    uint8_t  east_cm[3];        // int24 offset from course origin
+    uint16_t dist_to_target_cm;
+    uint8_t  battery_tenths_v;
+    uint8_t  error_flags;       // ERROR_FLAG_* bitmask for this buoy
+};
+static_assert(sizeof(FleetEntry) == 11, "FleetEntry must be 11 bytes on air");
+
+#define FLEET_SUMMARY_OFFSET_COUNT  4   // byte index of FleetSummaryHeader.count
+#define FLEET_SUMMARY_MAX_ENTRIES \
+    ((LORA_MAX_PAYLOAD - sizeof(FleetSummaryHeader) - 2) / sizeof(FleetEntry))   // 22
+
+constexpr size_t fleet_summary_size(uint8_t count) {
+    return sizeof(FleetSummaryHeader) + (size_t)count * sizeof(FleetEntry) + 2;
+}
+
+// ---------------------------------------------------------------------------
+// Protocol v2 — positions as int24 centimetre offsets from the course origin
+// (position.h). Every v2 packet names the origin_seq it was encoded against.
+// ---------------------------------------------------------------------------
+
+// Master → all: course origin (13 bytes). Sent at setup and whenever the origin moves.
+struct __attribute__((packed)) CourseOriginPacket {
+    uint8_t  packet_type;   // PKT_COURSE_ORIGIN (0xC3)
+    uint8_t  buoy_id;       // BUOY_MASTER
+    uint8_t  origin_seq;    // Incremented on every origin change
+    int32_t  lat_e7;        // Origin latitude,  1e-7 degrees
+    int32_t  lon_e7;        // Origin longitude, 1e-7 degrees
+    uint16_t checksum;      // CRC16-CCITT
+};
+static_assert(sizeof(CourseOriginPacket) == 13, "CourseOriginPacket must be 13 bytes on air");
+
+// Master → slave: assign target position (12 bytes; v1 AssignPacket is 13)
+struct __attribute__((packed)) AssignV2Packet {
+    uint8_t  packet_type;   // PKT_ASSIGN_V2 (0xA6)
+    uint8_t  buoy_id;
+    uint8_t  origin_seq;
+    uint8_t  target_north_cm[3];
+    uint8_t  target_east_cm[3];
+    uint8_t  hold_radius;   // metres
+    uint16_t checksum;      // CRC16-CCITT
+};
+static_assert(sizeof(AssignV2Packet) == 12, "AssignV2Packet must be 12 bytes on air");
+
+// Slave → master: confirm receipt of assignment (12 bytes; v1 is 13)
+struct __attribute__((packed)) AckAssignV2Packet {
+    uint8_t  packet_type;   // PKT_ACK_ASSIGN_V2 (0xAB)
+    uint8_t  buoy_id;
+    uint8_t  accepted;      // 1 = accepted, 0 = rejected (e.g. origin_seq mismatch)
+    uint8_t  origin_seq;
+    uint8_t  current_north_cm[3];
+    uint8_t  current_east_cm[3];
+    uint16_t checksum;      // CRC16-CCITT
+};
+static_assert(sizeof(AckAssignV2Packet) == 12, "AckAssignV2Packet must be 12 bytes on air");
+
+// Slave → master: position and battery telemetry (14 bytes; v1 is 15)
+struct __attribute__((packed)) StatusV2Packet {
+    uint8_t  packet_type;       // PKT_STATUS_V2 (0x5B)
+    uint8_t  buoy_id;
+    uint8_t  origin_seq;
+    uint8_t  current_north_cm[3];
+    uint8_t  current_east_cm[3];
+    uint16_t dist_to_target_cm; // Distance to assigned target in centimetres
+    uint8_t  battery_tenths_v;  // Battery voltage in 0.1V units
+    uint16_t checksum;          // CRC16-CCITT
+};
+static_assert(sizeof(StatusV2Packet) == 14, "StatusV2Packet must be 14 bytes on air");
+
+// Master → all: TDMA superframe beacon (10 bytes). Transmitted at the start of
+// every superframe; carries the slot layout so every node derives the same
+// schedule with tdma_build_schedule() and re-synchronises on reception.
+struct __attribute__((packed)) BeaconPacket {
+    uint8_t  packet_type;       // PKT_BEACON (0xC4)
+    uint8_t  buoy_id;           // BUOY_MASTER
+    uint8_t  fleet_state;       // FLEET_STATE_* value
+    uint8_t  frame_seq;         // Superframe counter (wraps)
+    uint8_t  uplink_slots;      // Slave slots, owned by buoy IDs 1..uplink_slots
+    uint8_t  downlink_len;      // Master downlink slot payload bytes (0 = no slot)
+    uint8_t  uplink_len;        // Slave slot payload bytes
+    uint8_t  contention_slots;  // RC sub-slots at the end of the superframe
+    uint16_t checksum;          // CRC16-CCITT
+};
+static_assert(sizeof(BeaconPacket) == 10, "BeaconPacket must be 10 bytes on air");
+
+// ---------------------------------------------------------------------------
+// Field configuration — one value of the buoy's NVS config blob
+// (firmware/common/config/config_store.h). value is in the key's wire units
+// (CONFIG_KEYS[key].scale per unit, e.g. tenths of a degree).
+// ---------------------------------------------------------------------------
+
+#define CONFIG_FLAG_SAVE      0x01   // also write the blob to NVS
+#define CONFIG_FLAG_QUERY     0x02   // change nothing, reply with the current value
+
+#define CONFIG_STATUS_OK      0
+#define CONFIG_STATUS_KEY     1      // unknown key
+#define CONFIG_STATUS_RANGE   2      // value outside the key's limits
+#define CONFIG_STATUS_NVS     3      // applied, but the NVS write failed
+
+// Master / remote → buoy: set (or query) one config value (11 bytes)
+struct __attribute__((packed)) ConfigSetPacket {
+    uint8_t  packet_type;   // PKT_CONFIG_SET (0xC5)
+    uint8_t  buoy_id;       // target buoy
+    uint8_t  seq;           // echoed in the ACK
+    uint8_t  key;           // ConfigKey
+    uint8_t  flags;         // CONFIG_FLAG_*
+    int32_t  value;         // wire units
+    uint16_t checksum;      // CRC16-CCITT
+};
+static_assert(sizeof(ConfigSetPacket) == 11, "ConfigSetPacket must be 11 bytes on air");
+
+// Buoy → master: result of a PKT_CONFIG_SET (11 bytes)
+struct __attribute__((packed)) ConfigAckPacket {
+    uint8_t  packet_type;   // PKT_CONFIG_ACK (0x5C)
+    uint8_t  buoy_id;       // replying buoy
+    uint8_t  seq;
+    uint8_t  key;
+    uint8_t  status;        // CONFIG_STATUS_*
+    int32_t  value;         // value in effect after the request, wire units
+    uint16_t checksum;      // CRC16-CCITT
+};
+static_assert(sizeof(ConfigAckPacket) == 11, "ConfigAckPacket must be 11 bytes on air");
+
+// ---------------------------------------------------------------------------
+// Dynamic fleet — join-time addresses and roles (master side: registry.h)
+//
+// A node that boots without an address sends PKT_JOIN_REQUEST with its
+// 32-bit hardware UID in a contention sub-slot; the master answers in its
+// downlink slot with PKT_JOIN_ACCEPT. The one-byte address then goes in
+// every buoy_id field: a buoy's address is also its uplink slot, and each
+// remote has its own, so RC commands say which handset sent them.
+// ---------------------------------------------------------------------------
+
+enum NodeAddress : uint8_t {
+    NODE_ADDR_MASTER       = 0,
+    NODE_ADDR_BUOY_FIRST   = 1,      // 1 … TDMA_MAX_UPLINK_SLOTS: buoys, address = uplink slot
+    NODE_ADDR_REMOTE_FIRST = 0xE0,   // 0xE0 … 0xFE: remotes, loggers
+    NODE_ADDR_REMOTE_LAST  = 0xFE,
+    NODE_ADDR_UNASSIGNED   = 0xFF
+};
+
+// Role a joined node plays. 1–4 equal the fixed BuoyIDs, so a registry
+// fleet's first four buoys line up with the six-unit layout. Append only.
+enum NodeRole : uint8_t {
+    NODE_ROLE_MASTER      = 0,
+    NODE_ROLE_START_A     = 1,
+    NODE_ROLE_START_B     = 2,
+    NODE_ROLE_WINDWARD    = 3,
+    NODE_ROLE_LEEWARD     = 4,
+    NODE_ROLE_GATE_PORT   = 5,
+    NODE_ROLE_GATE_STBD   = 6,
+    NODE_ROLE_OFFSET      = 7,
+    NODE_ROLE_FINISH_PIN  = 8,
+    NODE_ROLE_FINISH_BOAT = 9,
+    NODE_ROLE_SPARE       = 10,      // on the water, no mark to hold yet
+    NODE_ROLE_REMOTE      = 11,
+    NODE_ROLE_ANY         = 0xFF     // JoinRequest: the master picks
+};
+
+#define JOIN_STATUS_OK    0
+#define JOIN_STATUS_FULL  1          // no address left for this kind of node
+
+// Node → master: join (9 bytes). Sent in a contention sub-slot; repeated
+// after a random back-off until a JoinAccept for this uid arrives.
+struct __attribute__((packed)) JoinRequestPacket {
+    uint8_t  packet_type;   // PKT_JOIN_REQUEST (0x5D)
+    uint8_t  buoy_id;       // NODE_ADDR_UNASSIGNED
+    uint32_t uid;           // hardware UID (ESP32 eFuse MAC, low 32 bits)
+    uint8_t  role;          // NodeRole wanted: a mark, NODE_ROLE_REMOTE, or NODE_ROLE_ANY
+    uint16_t checksum;      // CRC16-CCITT
+};
+static_assert(sizeof(JoinRequestPacket) == 9, "JoinRequestPacket must be 9 bytes on air");
+
+// Master → node: address and role (11 bytes). A repeated request from the
+// same uid gets the same answer.
+struct __attribute__((packed)) JoinAcceptPacket {
+    uint8_t  packet_type;   // PKT_JOIN_ACCEPT (0xC6)
+    uint8_t  buoy_id;       // BUOY_MASTER
+    uint32_t uid;           // echoed from the request
+    uint8_t  address;       // NodeAddress; NODE_ADDR_UNASSIGNED when refused
+    uint8_t  role;          // NodeRole assigned
+    uint8_t  status;        // JOIN_STATUS_*
+    uint16_t checksum;      // CRC16-CCITT
+};
+static_assert(sizeof(JoinAcceptPacket) == 11, "JoinAcceptPacket must be 11 bytes on air");
 
 // Error flags (StatusPacket.error_flags if extended packet added in future)
 #define ERROR_FLAG_GPS_LOST     0x01
@@ -115,7 +341,7 @@ struct __attribute__((packed)) MasterStatusPacket {
 #define ERROR_FLAG_WIND_FAIL    0x20
 #define ERROR_FLAG_OBSTACLE     0x40   // Collision avoidance stop triggered
 
-// Operational constants
+// Operational constants — defaults for the NVS config (config_store.h)
 #define HOLD_RADIUS_DEFAULT         3       // metres (default slave hold radius)
 #define COMMS_TIMEOUT_MS            60000   // 60s without ASSIGN → slave enters failsafe
 #define GPS_FIX_REQUIRED            3       // Minimum fix quality (3D fix)
@@ -125,11 +351,17 @@ struct __attribute__((packed)) MasterStatusPacket {
 #define WIND_CHANGE_THRESHOLD_DEG   15.0f   // Max wind shift before Repositioning
 #define WIND_CHANGE_DURATION_S      60      // Rolling window for stability check
 
-// LoRa reply timing (deterministic stagger to avoid collisions)
-#define REPLY_DELAY_BASE_MS         100
-#define REPLY_DELAY_PER_ID_MS       50
+// LoRa channel access: TDMA superframe started by PKT_BEACON — see tdma.h
+
+uint16_t calculate_checksum(const uint8_t* data, size_t len);
+bool     verify_checksum(const uint8_t* data, size_t len);
 
-uint16_t calculate_checksum(uint8_t* data, size_t len);
-bool     verify_checksum(uint8_t* data, size_t len);
+// Pack `count` entries into `buf` (≥ fleet_summary_size(count) bytes), set the
+// header's fault_flags and seal the CRC. fault_flags −1 ORs the entries'
+// error_flags; a master sending a window of a larger fleet passes the whole
+// fleet's. Returns the frame length, or 0 if count exceeds
+// FLEET_SUMMARY_MAX_ENTRIES.
+size_t   build_fleet_summary(uint8_t* buf, uint8_t fleet_state, uint8_t origin_seq,
+                             const FleetEntry* entries, uint8_t count, int fault_flags = -1);
 
 #endif // PROTOCOL_H
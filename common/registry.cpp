@@ -0,0 +1,222 @@
+#include "registry.h"
+#include <string.h>
+#include "packet_codec.h"
+#include "position.h"
+
+static const uint8_t DEFAULT_PLAN[] = {
+    NODE_ROLE_START_A, NODE_ROLE_START_B, NODE_ROLE_WINDWARD, NODE_ROLE_LEEWARD,
+    NODE_ROLE_GATE_PORT, NODE_ROLE_GATE_STBD, NODE_ROLE_OFFSET, NODE_ROLE_FINISH_PIN, NODE_ROLE_FINISH_BOAT,
+};
+
+NodeRegistry::NodeRegistry() {
+    clear();
+    setPlan(DEFAULT_PLAN, sizeof(DEFAULT_PLAN));
+}
+
+void NodeRegistry::clear() {
+    count  = 0;
+    cursor = NODE_ADDR_BUOY_FIRST;
+    memset(index, REGISTRY_INDEX_NONE, sizeof(index));
+}
+
+void NodeRegistry::setPlan(const uint8_t* roles, uint8_t n) {
+    planCount = n < REGISTRY_PLAN_MAX ? n : REGISTRY_PLAN_MAX;
+    memcpy(plan, roles, planCount);
+}
+
+// ---------------------------------------------------------------------------
+// Join / leave
+// ---------------------------------------------------------------------------
+int NodeRegistry::findUid(uint32_t id) const {
+    for (int i = 0; i < count; i++) {
+        if (uid[i] == id) return i;
+    }
+    return -1;
+}
+
+uint8_t NodeRegistry::freeAddress(uint8_t first, uint8_t last) const {
+    for (int a = first; a <= last; a++) {
+        if (index[a] == REGISTRY_INDEX_NONE) return (uint8_t)a;
+    }
+    return NODE_ADDR_UNASSIGNED;
+}
+
+// A mark nobody holds, else the first plan entry not yet filled (a role
+// listed twice needs two holders), else spare
+uint8_t NodeRegistry::pickRole(uint8_t wanted) const {
+    uint8_t held[256] = {};
+    for (int i = 0; i < count; i++) held[role[i]]++;
+    if (wanted >= NODE_ROLE_START_A && wanted <= NODE_ROLE_FINISH_BOAT && held[wanted] == 0) return wanted;
+
+    uint8_t needed[256] = {};
+    for (int p = 0; p < planCount; p++) {
+        if (++needed[plan[p]] > held[plan[p]]) return plan[p];
+    }
+    return NODE_ROLE_SPARE;
+}
+
+bool NodeRegistry::join(const JoinRequestPacket& req, uint32_t now_ms, JoinAcceptPacket* out) {
+    out->packet_type = PKT_JOIN_ACCEPT;
+    out->buoy_id     = BUOY_MASTER;
+    out->uid         = req.uid;
+
+    int i = findUid(req.uid);
+    if (i < 0) {
+        bool    remote = req.role == NODE_ROLE_REMOTE;
+        uint8_t a      = count >= REGISTRY_CAPACITY ? (uint8_t)NODE_ADDR_UNASSIGNED
+                       : remote ? freeAddress(NODE_ADDR_REMOTE_FIRST, NODE_ADDR_REMOTE_LAST)
+                                : freeAddress(NODE_ADDR_BUOY_FIRST, REGISTRY_MAX_BUOYS);
+        if (a == NODE_ADDR_UNASSIGNED) {
+            out->address = NODE_ADDR_UNASSIGNED;
+            out->role    = req.role;
+            out->status  = JOIN_STATUS_FULL;
+            packet_seal(*out);
+            return false;
+        }
+        uint8_t r   = remote ? (uint8_t)NODE_ROLE_REMOTE : pickRole(req.role);
+        i           = count++;
+        uid[i]      = req.uid;
+        addr[i]     = a;
+        role[i]     = r;
+        north_cm[i] = 0;
+        east_cm[i]  = 0;
+        dist_cm[i]  = 0;
+        battery[i]  = 0;
+        flags[i]    = 0;
+        reported[i] = false;
+        index[a]    = (uint8_t)i;
+    }
+    last_ms[i] = now_ms;
+
+    out->address = addr[i];
+    out->role    = role[i];
+    out->status  = JOIN_STATUS_OK;
+    packet_seal(*out);
+    return true;
+}
+
+// Swap-remove: the last column entry fills the hole so scans stay dense
+void NodeRegistry::removeAt(int i) {
+    index[addr[i]] = REGISTRY_INDEX_NONE;
+    int last = --count;
+    if (i != last) {
+        uid[i]      = uid[last];
+        addr[i]     = addr[last];
+        role[i]     = role[last];
+        last_ms[i]  = last_ms[last];
+        north_cm[i] = north_cm[last];
+        east_cm[i]  = east_cm[last];
+        dist_cm[i]  = dist_cm[last];
+        battery[i]  = battery[last];
+        flags[i]    = flags[last];
+        reported[i] = reported[last];
+        index[addr[i]] = (uint8_t)i;
+    }
+}
+
+bool NodeRegistry::leave(uint8_t a) {
+    int i = indexOf(a);
+    if (i < 0) return false;
+    removeAt(i);
+    return true;
+}
+
+uint8_t NodeRegistry::expire(uint32_t now_ms, uint32_t silence_ms) {
+    uint8_t n = 0;
+    for (int i = count - 1; i >= 0; i--) {   // downwards: the entry swapped in was already checked
+        if ((uint32_t)(now_ms - last_ms[i]) > silence_ms) {
+            removeAt(i);
+            n++;
+        }
+    }
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Telemetry
+// ---------------------------------------------------------------------------
+bool NodeRegistry::onStatus(const StatusV2Packet& p, uint8_t origin_seq, uint32_t now_ms) {
+    int i = indexOf(p.buoy_id);
+    if (i < 0 || p.buoy_id > REGISTRY_MAX_BUOYS || p.origin_seq != origin_seq) return false;
+    north_cm[i] = pos24_get(p.current_north_cm);
+    east_cm[i]  = pos24_get(p.current_east_cm);
+    dist_cm[i]  = p.dist_to_target_cm;
+    battery[i]  = p.battery_tenths_v;
+    last_ms[i]  = now_ms;
+    reported[i] = true;
+    return true;
+}
+
+bool NodeRegistry::heard(uint8_t a, uint32_t now_ms) {
+    int i = indexOf(a);
+    if (i < 0) return false;
+    last_ms[i] = now_ms;
+    return true;
+}
+
+bool NodeRegistry::setFlags(uint8_t a, uint8_t error_flags) {
+    int i = indexOf(a);
+    if (i < 0) return false;
+    flags[i] = error_flags;
+    return true;
+}
+
+FleetAggregate NodeRegistry::aggregate(uint32_t now_ms, uint32_t timeout_ms, uint16_t hold_cm) const {
+    FleetAggregate a = {};
+    uint8_t minBattery = 0xFF;
+    for (int i = 0; i < count; i++) {
+        if (addr[i] > REGISTRY_MAX_BUOYS) {
+            a.remotes++;
+            continue;
+        }
+        bool fresh = reported[i] && (uint32_t)(now_ms - last_ms[i]) <= timeout_ms;
+        a.buoys++;
+        a.fault_flags |= flags[i] | (fresh ? 0 : ERROR_FLAG_COMMS_LOST);
+        if (!fresh) continue;
+        a.reporting++;
+        a.on_station += dist_cm[i] <= hold_cm;
+        if (battery[i] < minBattery) minBattery = battery[i];
+        if (dist_cm[i] > a.max_dist_cm) a.max_dist_cm = dist_cm[i];
+    }
+    a.min_battery_tenths_v = a.reporting ? minBattery : 0;
+    return a;
+}
+
+// Buoys in address order from the cursor; the header's fault_flags is the
+// whole fleet's even when the frame holds only a window of it
+size_t NodeRegistry::buildSummary(uint8_t* buf, uint8_t fleet_state, uint8_t origin_seq, uint32_t now_ms,
+                                  uint32_t timeout_ms) {
+    FleetEntry list[FLEET_SUMMARY_MAX_ENTRIES];
+    uint8_t    n = 0;
+    int        scanned;
+    for (scanned = 0; scanned < REGISTRY_MAX_BUOYS && n < FLEET_SUMMARY_MAX_ENTRIES; scanned++) {
+        uint8_t a = (uint8_t)(NODE_ADDR_BUOY_FIRST + (cursor - NODE_ADDR_BUOY_FIRST + scanned) % REGISTRY_MAX_BUOYS);
+        int     i = indexOf(a);
+        if (i < 0 || !reported[i]) continue;
+        bool        fresh = (uint32_t)(now_ms - last_ms[i]) <= timeout_ms;
+        FleetEntry& e     = list[n++];
+        e.buoy_id = a;
+        pos24_put(e.north_cm, north_cm[i]);
+        pos24_put(e.east_cm, east_cm[i]);
+        e.dist_to_target_cm = dist_cm[i];
+        e.battery_tenths_v  = battery[i];
+        e.error_flags       = (uint8_t)(flags[i] | (fresh ? 0 : ERROR_FLAG_COMMS_LOST));
+    }
+    cursor = (uint8_t)(NODE_ADDR_BUOY_FIRST + (cursor - NODE_ADDR_BUOY_FIRST + scanned) % REGISTRY_MAX_BUOYS);
+
+    return build_fleet_summary(buf, fleet_state, origin_seq, list, n, aggregate(now_ms, timeout_ms, 0).fault_flags);
+}
+
+TdmaConfig NodeRegistry::tdmaConfig() const {
+    uint8_t highest = 0, buoys = 0;
+    for (int i = 0; i < count; i++) {
+        if (addr[i] > REGISTRY_MAX_BUOYS) continue;
+        buoys++;
+        if (addr[i] > highest) highest = addr[i];
+    }
+    uint8_t entries  = buoys < FLEET_SUMMARY_MAX_ENTRIES ? buoys : (uint8_t)FLEET_SUMMARY_MAX_ENTRIES;
+    size_t  downlink = fleet_summary_size(entries);
+    if (downlink < sizeof(JoinAcceptPacket)) downlink = sizeof(JoinAcceptPacket);
+    TdmaConfig c = { highest, (uint8_t)downlink, sizeof(StatusV2Packet), (uint8_t)(buoys > 16 ? 4 : 2) };
+    return c;
+}
@@ -0,0 +1,127 @@
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "protocol.h"
+#include "tdma.h"
+
+// ---------------------------------------------------------------------------
+// Fleet registry — the master's table of joined nodes
+//
+// Nodes join with their hardware UID (PKT_JOIN_REQUEST) and are handed a
+// one-byte address and a role (PKT_JOIN_ACCEPT):
+//
+//   buoy     lowest free address 1 … TDMA_MAX_UPLINK_SLOTS (= its uplink slot)
+//            role: the one asked for if nobody holds it, else the next open
+//            role of the course plan, else NODE_ROLE_SPARE
+//   remote   lowest free address NODE_ADDR_REMOTE_FIRST …, NODE_ROLE_REMOTE
+//
+// The same UID always gets its old address back, so a rebooted buoy keeps its
+// slot and mark. The default plan starts START_A, START_B, WINDWARD, LEEWARD,
+// so the first four buoys take the addresses and roles of the fixed BuoyIDs.
+//
+// Per-node state is kept as a structure of arrays, packed at the front (a
+// leaving node is replaced by the last one), with a 256-entry address →
+// index map:
+//
+//   uid[]  addr[]  role[]  last_ms[]  north_cm[]  east_cm[]  dist_cm[]  battery[]  flags[]
+//   ──────────────────── count used ────────────────────┬───── free ─────
+//
+// aggregate() walks the status columns once for every fleet-wide figure the
+// master reports (fault_flags with COMMS_LOST for silent buoys, counts,
+// lowest battery, furthest off station); buildSummary() packs a
+// FLEET_SUMMARY and rotates through buoys beyond FLEET_SUMMARY_MAX_ENTRIES
+// while its header carries the whole fleet's fault_flags. tdmaConfig() is
+// the beacon layout for the current fleet.
+//
+//   NodeRegistry reg;
+//   reg.join(req, hal_millis(), &accept);          // onJoinRequest → downlink
+//   reg.onStatus(status, origin.seq, hal_millis());
+//   FleetAggregate a = reg.aggregate(hal_millis(), COMMS_TIMEOUT_MS, hold_cm);
+//   len = reg.buildSummary(buf, fleet_state, origin.seq, hal_millis(), COMMS_TIMEOUT_MS);
+// ---------------------------------------------------------------------------
+
+#define REGISTRY_CAPACITY       64    // buoys + remotes
+#define REGISTRY_MAX_BUOYS      TDMA_MAX_UPLINK_SLOTS
+#define REGISTRY_PLAN_MAX       16
+#define REGISTRY_INDEX_NONE     0xFF
+
+struct FleetAggregate {
+    uint8_t  fault_flags;            // ERROR_FLAG_* over all buoys, COMMS_LOST for silent ones
+    uint8_t  buoys;
+    uint8_t  remotes;
+    uint8_t  reporting;              // buoys heard within the timeout
+    uint8_t  on_station;             // reporting buoys within the hold distance
+    uint8_t  min_battery_tenths_v;   // over reporting buoys; 0 when none
+    uint16_t max_dist_cm;            // furthest reporting buoy from its target
+};
+
+class NodeRegistry {
+public:
+    NodeRegistry();
+
+    void clear();
+    // Roles handed to buoys asking for NODE_ROLE_ANY, in order; a role may repeat
+    void setPlan(const uint8_t* roles, uint8_t count);
+
+    // Find or add req.uid and fill the reply. False (and JOIN_STATUS_FULL)
+    // when no address of that kind is left.
+    bool join(const JoinRequestPacket& req, uint32_t now_ms, JoinAcceptPacket* out);
+    bool leave(uint8_t addr);
+    // Drop nodes silent for longer than silence_ms; returns how many
+    uint8_t expire(uint32_t now_ms, uint32_t silence_ms);
+
+    // STATUS_V2 from a joined buoy; false for an unknown address or another origin
+    bool onStatus(const StatusV2Packet& p, uint8_t origin_seq, uint32_t now_ms);
+    // Any other frame from a joined node (RC, ACK) — refreshes last heard
+    bool heard(uint8_t addr, uint32_t now_ms);
+    // ERROR_FLAG_* the master holds against a buoy (STATUS_V2 carries none)
+    bool setFlags(uint8_t addr, uint8_t error_flags);
+
+    FleetAggregate aggregate(uint32_t now_ms, uint32_t timeout_ms, uint16_t hold_cm) const;
+    size_t         buildSummary(uint8_t* buf, uint8_t fleet_state, uint8_t origin_seq, uint32_t now_ms,
+                                uint32_t timeout_ms);
+
+    // Beacon layout: uplink slots up to the highest buoy address, downlink
+    // sized for the summary (or a JoinAccept), contention 2 or 4 sub-slots
+    TdmaConfig tdmaConfig() const;
+
+    uint8_t size() const { return count; }
+    int     indexOf(uint8_t addr) const { return index[addr] == REGISTRY_INDEX_NONE ? -1 : index[addr]; }
+    bool    isRemote(uint8_t addr) const { return addr >= NODE_ADDR_REMOTE_FIRST && indexOf(addr) >= 0; }
+
+    // Columns, valid for index < size()
+    uint32_t uidAt(int i) const     { return uid[i]; }
+    uint8_t  addrAt(int i) const    { return addr[i]; }
+    uint8_t  roleAt(int i) const    { return role[i]; }
+    uint32_t lastAt(int i) const    { return last_ms[i]; }
+    uint8_t  flagsAt(int i) const   { return flags[i]; }
+    int32_t  northAt(int i) const   { return north_cm[i]; }
+    int32_t  eastAt(int i) const    { return east_cm[i]; }
+
+private:
+    uint8_t  count;
+    uint8_t  index[256];              // address → column, REGISTRY_INDEX_NONE if free
+    uint8_t  plan[REGISTRY_PLAN_MAX];
+    uint8_t  planCount;
+    uint8_t  cursor;                  // next buoy address for a rotating summary
+
+    uint32_t uid[REGISTRY_CAPACITY];
+    uint8_t  addr[REGISTRY_CAPACITY];
+    uint8_t  role[REGISTRY_CAPACITY];
+    uint32_t last_ms[REGISTRY_CAPACITY];
+    int32_t  north_cm[REGISTRY_CAPACITY];
+    int32_t  east_cm[REGISTRY_CAPACITY];
+    uint16_t dist_cm[REGISTRY_CAPACITY];
+    uint8_t  battery[REGISTRY_CAPACITY];
+    uint8_t  flags[REGISTRY_CAPACITY];
+    bool     reported[REGISTRY_CAPACITY];   // a STATUS since joining
+
+    int     findUid(uint32_t id) const;
+    uint8_t freeAddress(uint8_t first, uint8_t last) const;
+    uint8_t pickRole(uint8_t wanted) const;
+    void    removeAt(int i);
+};
+
+#endif // REGISTRY_H
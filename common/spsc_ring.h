@@ -0,0 +1,71 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Lock-free single-producer / single-consumer ring
+//
+// One side only pushes, the other only pops — an ISR and a task, or two tasks
+// on different cores. head is written by the producer only, tail by the
+// consumer only; acquire/release ordering publishes the slot contents.
+// Capacity N must be a power of two; counters run free and wrap.
+//
+// Large elements can be filled in place to avoid a second copy:
+//
+//   if (T* slot = ring.claim()) { fill(*slot); ring.publish(); }
+//   if (const T* f = ring.peek()) { use(*f); ring.release(); }
+// ---------------------------------------------------------------------------
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    // Producer side
+    T* claim() {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) return nullptr;
+        return &buf[h & (N - 1)];
+    }
+    void publish() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    bool push(const T& v) {
+        T* slot = claim();
+        if (!slot) return false;
+        *slot = v;
+        publish();
+        return true;
+    }
+
+    // Consumer side
+    const T* peek() const {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) return nullptr;
+        return &buf[t & (N - 1)];
+    }
+    void release() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    bool pop(T* out) {
+        const T* slot = peek();
+        if (!slot) return false;
+        *out = *slot;
+        release();
+        return true;
+    }
+
+    // Either side — a snapshot, exact only when the other side is idle
+    size_t size() const  { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    bool   empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    T buf[N];
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,101 @@
+#include "tdma.h"
+#include "lora_budget.h"   // compile-time channel budget checks for the configured schedule
+
+static void addSlot(TdmaSchedule* s, uint8_t kind, uint8_t owner, uint32_t airtime_us) {
+    TdmaSlot& slot = s->slot[s->count++];
+    slot.kind      = kind;
+    slot.owner     = owner;
+    slot.start_us  = s->superframe_us;
+    slot.length_us = airtime_us + TDMA_GUARD_US;
+    s->superframe_us += slot.length_us;
+    s->airtime_us    += airtime_us;
+}
+
+bool tdma_build_schedule(const LoRaModem& m, const TdmaConfig& c, TdmaSchedule* out) {
+    if (c.uplink_slots > TDMA_MAX_UPLINK_SLOTS) return false;
+    if (2u + c.uplink_slots + c.contention_slots > TDMA_MAX_SLOTS) return false;
+
+    out->count         = 0;
+    out->superframe_us = 0;
+    out->airtime_us    = 0;
+    out->beacon_us     = lora_time_on_air_us(m, sizeof(BeaconPacket));
+
+    addSlot(out, TDMA_SLOT_BEACON, BUOY_MASTER, out->beacon_us);
+    if (c.downlink_len) addSlot(out, TDMA_SLOT_DOWNLINK, BUOY_MASTER, lora_time_on_air_us(m, c.downlink_len));
+
+    uint32_t uplink_us = lora_time_on_air_us(m, c.uplink_len);
+    for (uint8_t i = 0; i < c.uplink_slots; i++) addSlot(out, TDMA_SLOT_UPLINK, (uint8_t)(BUOY_START_A + i), uplink_us);
+
+    uint32_t rc_us = lora_time_on_air_us(m, TDMA_CONTENTION_LEN);
+    for (uint8_t i = 0; i < c.contention_slots; i++) addSlot(out, TDMA_SLOT_CONTENTION, BUOY_REMOTE, rc_us);
+    return true;
+}
+
+TdmaConfig tdma_config_from_beacon(const BeaconPacket& b) {
+    TdmaConfig c = { b.uplink_slots, b.downlink_len, b.uplink_len, b.contention_slots };
+    return c;
+}
+
+void tdma_fill_beacon(BeaconPacket* b, const TdmaConfig& c, uint8_t fleet_state, uint8_t frame_seq) {
+    b->packet_type      = PKT_BEACON;
+    b->buoy_id          = BUOY_MASTER;
+    b->fleet_state      = fleet_state;
+    b->frame_seq        = frame_seq;
+    b->uplink_slots     = c.uplink_slots;
+    b->downlink_len     = c.downlink_len;
+    b->uplink_len       = c.uplink_len;
+    b->contention_slots = c.contention_slots;
+}
+
+int tdma_uplink_slot(const TdmaSchedule& s, uint8_t buoy_id) {
+    for (uint8_t i = 0; i < s.count; i++) {
+        if (s.slot[i].kind == TDMA_SLOT_UPLINK && s.slot[i].owner == buoy_id) return i;
+    }
+    return -1;
+}
+
+int tdma_contention_slot(const TdmaSchedule& s, uint8_t n) {
+    for (uint8_t i = 0; i < s.count; i++) {
+        if (s.slot[i].kind == TDMA_SLOT_CONTENTION && n-- == 0) return i;
+    }
+    return -1;
+}
+
+// ---------------------------------------------------------------------------
+// Synchronisation — all time comparisons are wrap-safe (signed differences)
+// ---------------------------------------------------------------------------
+void tdma_master_start(TdmaSync* sync, uint32_t now_us, uint8_t frame_seq) {
+    sync->locked         = true;
+    sync->frame_seq      = frame_seq;
+    sync->missed         = 0;
+    sync->frame_start_us = now_us;
+}
+
+void tdma_on_beacon(TdmaSync* sync, const TdmaSchedule& s, const BeaconPacket& b, uint32_t rx_done_us) {
+    sync->locked         = true;
+    sync->frame_seq      = b.frame_seq;
+    sync->missed         = 0;
+    sync->frame_start_us = rx_done_us - s.beacon_us - TDMA_GUARD_US / 2;   // beacon starts at its tx time
+}
+
+void tdma_advance(TdmaSync* sync, const TdmaSchedule& s, uint32_t now_us) {
+    if (!sync->locked || s.superframe_us == 0) return;
+    while ((int32_t)(now_us - sync->frame_start_us) >= (int32_t)s.superframe_us) {
+        sync->frame_start_us += s.superframe_us;
+        sync->frame_seq++;
+        if (++sync->missed > TDMA_MAX_MISSED_BEACONS) {
+            sync->locked = false;
+            return;
+        }
+    }
+}
+
+uint32_t tdma_tx_time_us(const TdmaSync& sync, const TdmaSchedule& s, uint8_t slot) {
+    return sync.frame_start_us + s.slot[slot].start_us + TDMA_GUARD_US / 2;
+}
+
+bool tdma_may_transmit(const TdmaSync& sync, const TdmaSchedule& s, uint8_t slot, uint32_t now_us) {
+    if (!sync.locked || slot >= s.count) return false;
+    int32_t late = (int32_t)(now_us - tdma_tx_time_us(sync, s, slot));
+    return late >= 0 && late <= TDMA_GUARD_US / 2;
+}
@@ -0,0 +1,123 @@
+#ifndef TDMA_H
+#define TDMA_H
+
+#include <stdint.h>
+#include "protocol.h"
+#include "lora_airtime.h"
+
+// ---------------------------------------------------------------------------
+// TDMA superframe scheduler
+//
+// The master opens every superframe with a PKT_BEACON. Everything after it is
+// a fixed slot table derived from the beacon fields and time-on-air:
+//
+//   | BEACON | DOWNLINK (master) | UPLINK id 1 | … | UPLINK id N | RC × k |
+//
+// Each slot is lora_time_on_air_us(payload) + TDMA_GUARD_US long; the owner
+// starts transmitting TDMA_GUARD_US / 2 into it, so half a guard protects each
+// edge against beacon timestamp jitter, crystal drift and TX ramp-up. Only
+// the slot owner transmits — scheduled traffic has no designed-in collisions.
+// The trailing RC sub-slots are the contention slot: remotes pick one at
+// random for PKT_RC_*, and nodes without an address for PKT_JOIN_REQUEST
+// (registry.h) — only these unscheduled frames can collide. Each sub-slot
+// fits the larger of the two, TDMA_CONTENTION_LEN.
+//
+// Slaves timestamp the beacon at RX-done and back off its airtime to recover
+// the superframe start (tdma_on_beacon). Between beacons they free-run; after
+// TDMA_MAX_MISSED_BEACONS missed beacons they stop transmitting until the next one.
+// ---------------------------------------------------------------------------
+
+#define TDMA_GUARD_US             2000   // turnaround + RX timestamp jitter + ±40 ppm drift
+#define TDMA_MAX_UPLINK_SLOTS     32
+#define TDMA_MAX_SLOTS            (2 + TDMA_MAX_UPLINK_SLOTS + 4)
+#define TDMA_MAX_MISSED_BEACONS   3
+#define TDMA_CONTENTION_LEN       sizeof(JoinRequestPacket)   // PKT_RC_* is 4 B
+
+enum TdmaSlotKind {
+    TDMA_SLOT_BEACON = 0,
+    TDMA_SLOT_DOWNLINK,
+    TDMA_SLOT_UPLINK,
+    TDMA_SLOT_CONTENTION
+};
+
+// Layout parameters — exactly what PKT_BEACON carries.
+struct TdmaConfig {
+    uint8_t uplink_slots;       // slaves, owned by buoy IDs 1..uplink_slots
+    uint8_t downlink_len;       // master frame bytes per superframe (0 = none)
+    uint8_t uplink_len;         // largest slave frame bytes
+    uint8_t contention_slots;   // RC / join sub-slots (each fits TDMA_CONTENTION_LEN)
+};
+
+struct TdmaSlot {
+    uint8_t  kind;              // TdmaSlotKind
+    uint8_t  owner;             // buoy ID (BUOY_REMOTE for contention)
+    uint32_t start_us;          // offset from superframe start
+    uint32_t length_us;         // airtime + guard
+};
+
+struct TdmaSchedule {
+    TdmaSlot slot[TDMA_MAX_SLOTS];
+    uint8_t  count;
+    uint32_t superframe_us;
+    uint32_t airtime_us;        // sum of slot airtimes (excludes guards)
+    uint32_t beacon_us;         // beacon time-on-air, for RX-done → superframe start
+};
+
+// Slave / remote view of the superframe timing (local clock).
+struct TdmaSync {
+    bool     locked;
+    uint8_t  frame_seq;
+    uint8_t  missed;            // superframes elapsed since the last beacon
+    uint32_t frame_start_us;    // local time of the current superframe start
+};
+
+constexpr uint32_t tdma_slot_us(const LoRaModem& m, uint16_t payload_len) {
+    return lora_time_on_air_us(m, payload_len) + TDMA_GUARD_US;
+}
+
+// Superframe length for a layout — usable in static_assert budget checks.
+constexpr uint32_t tdma_superframe_us(const LoRaModem& m, const TdmaConfig& c) {
+    return tdma_slot_us(m, sizeof(BeaconPacket))
+         + (c.downlink_len ? tdma_slot_us(m, c.downlink_len) : 0)
+         + (uint32_t)c.uplink_slots * tdma_slot_us(m, c.uplink_len)
+         + (uint32_t)c.contention_slots * tdma_slot_us(m, TDMA_CONTENTION_LEN);
+}
+
+// Sum of slot airtimes (no guards) — the channel actually occupied per superframe.
+constexpr uint32_t tdma_airtime_us(const LoRaModem& m, const TdmaConfig& c) {
+    return tdma_superframe_us(m, c)
+         - TDMA_GUARD_US * (1u + (c.downlink_len ? 1u : 0u) + c.uplink_slots + c.contention_slots);
+}
+
+// Default fleet layout: four slaves sending STATUS (largest slave frame),
+// master downlink sized for a fleet summary, two RC sub-slots.
+constexpr TdmaConfig TDMA_CONFIG_DEFAULT = {
+    MAX_BUOYS - 2, (uint8_t)fleet_summary_size(MAX_BUOYS - 2), sizeof(StatusPacket), 2
+};
+
+// Fill `out` from a layout. Returns false if the layout does not fit TDMA_MAX_SLOTS.
+bool tdma_build_schedule(const LoRaModem& m, const TdmaConfig& c, TdmaSchedule* out);
+
+TdmaConfig tdma_config_from_beacon(const BeaconPacket& b);
+void       tdma_fill_beacon(BeaconPacket* b, const TdmaConfig& c, uint8_t fleet_state, uint8_t frame_seq);
+
+// Index of the uplink slot owned by `buoy_id`, or -1.
+int        tdma_uplink_slot(const TdmaSchedule& s, uint8_t buoy_id);
+// Index of contention sub-slot `n` (0-based), or -1.
+int        tdma_contention_slot(const TdmaSchedule& s, uint8_t n);
+
+// Master: the superframe starts when it begins transmitting the beacon.
+void       tdma_master_start(TdmaSync* sync, uint32_t now_us, uint8_t frame_seq);
+// Slave/remote: beacon received, `rx_done_us` taken at the RX-done interrupt.
+void       tdma_on_beacon(TdmaSync* sync, const TdmaSchedule& s, const BeaconPacket& b, uint32_t rx_done_us);
+// Roll frame_start_us forward over elapsed superframes; drops lock after
+// TDMA_MAX_MISSED_BEACONS superframes without a beacon.
+void       tdma_advance(TdmaSync* sync, const TdmaSchedule& s, uint32_t now_us);
+
+// Local time at which the owner of `slot` starts transmitting in the current
+// superframe (slot start + TDMA_GUARD_US / 2).
+uint32_t   tdma_tx_time_us(const TdmaSync& sync, const TdmaSchedule& s, uint8_t slot);
+// True while a transmission started at now_us still ends inside `slot`.
+bool       tdma_may_transmit(const TdmaSync& sync, const TdmaSchedule& s, uint8_t slot, uint32_t now_us);
+
+#endif // TDMA_H
@@ -0,0 +1,63 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Lock-free latest-value mailbox (triple buffer), one writer / one reader
+//
+// For samples where only the newest matters — a position fix, a heading,
+// three ranges — and the reader should neither wait nor see a half-written
+// value. Three slots: the writer owns one (back), the reader owns one
+// (front), the third sits in the middle holding the newest published
+// sample. publish() swaps back ↔ middle, read() swaps middle ↔ front when
+// something new is there; both are a single atomic exchange, nothing is
+// copied and nobody blocks:
+//
+//   if (GpsSample* s = gps.write()) { fill(*s); gps.publish(); }     // writer
+//   if (const GpsSample* s = gps.read()) use(*s);                     // reader
+//
+// Samples the reader never picked up are overwritten (SpscRing is the
+// queue for messages that must all arrive). The pointer from read() stays
+// valid until the reader's next read(); write() returns the same back slot
+// until publish().
+// ---------------------------------------------------------------------------
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : buf(), middle(1), back(0), front(2), seen(0), published(0) {}
+
+    // Writer side
+    T* write() { return &buf[back]; }
+    void publish() {
+        published.fetch_add(1, std::memory_order_relaxed);
+        back = (uint8_t)(middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX);
+    }
+
+    // Reader side: newest sample, nullptr until the first publish()
+    const T* read() {
+        if (middle.load(std::memory_order_relaxed) & FRESH) {
+            front = (uint8_t)(middle.exchange(front, std::memory_order_acq_rel) & INDEX);
+            seen  = true;
+        }
+        return seen ? &buf[front] : nullptr;
+    }
+    bool fresh() const { return middle.load(std::memory_order_acquire) & FRESH; }
+
+    // Either side: samples published so far (reader: compare to count skips)
+    uint32_t count() const { return published.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint8_t INDEX = 0x03;
+    static constexpr uint8_t FRESH = 0x04;   // middle holds a sample the reader has not taken
+
+    T                     buf[3];
+    std::atomic<uint8_t>  middle;
+    uint8_t               back;    // writer only
+    uint8_t               front;   // reader only
+    bool                  seen;    // reader only
+    std::atomic<uint32_t> published;
+};
+
+#endif // TRIPLE_BUFFER_H
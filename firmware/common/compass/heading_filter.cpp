@@ -0,0 +1,170 @@
+#include "heading_filter.h"
+#include <math.h>
+
+static const float R2D = 57.2957795f;
+
+static float wrap180(float a) {
+    while (a > 180.0f) a -= 360.0f;
+    while (a <= -180.0f) a += 360.0f;
+    return a;
+}
+
+static float wrap360(float a) {
+    while (a >= 360.0f) a -= 360.0f;
+    while (a < 0.0f) a += 360.0f;
+    return a;
+}
+
+void HeadingFilter::reset() {
+    for (int i = 0; i < 3; i++) {
+        x[i] = 0.0f;
+        for (int j = 0; j < 3; j++) P[i][j] = 0.0f;
+    }
+    tUs       = 0;
+    lastFixMs = 0;
+    init      = false;
+    haveFix   = false;
+    gpsInRun  = false;
+    rejecting = false;
+    rejectUs  = 0;
+    rejectS   = 0.0f;
+    lastS     = 0.0f;
+    lastNu    = 0.0f;
+    st        = HeadingStats();
+}
+
+// ---------------------------------------------------------------------------
+// Kalman steps
+// ---------------------------------------------------------------------------
+void HeadingFilter::predict(uint32_t t_us) {
+    int32_t ahead = (int32_t)(t_us - tUs);
+    if (ahead <= 0) return;   // measurement older than the state: update in place
+    tUs = t_us;
+    float left = ahead * 1e-6f;
+    while (left > 0.0f) {
+        float dt = left < HEADING_DT_MAX_S ? left : HEADING_DT_MAX_S;
+        left    -= dt;
+
+        // F = [1 dt 0; 0 1 0; 0 0 1], white yaw acceleration and offset drift
+        x[0] = wrap360(x[0] + x[1] * dt);
+        if (rejecting) x[1] *= 1.0f - dt / (HEADING_COAST_TAU_S + dt);   // coasting: the turn ends
+        float q = HEADING_Q_ACCEL;
+        P[0][0] += dt * (2.0f * P[0][1] + dt * P[1][1]) + q * dt * dt * dt / 3.0f;
+        P[0][1] += dt * P[1][1] + q * dt * dt / 2.0f;
+        P[0][2] += dt * P[1][2];
+        P[1][1] += q * dt;
+        P[2][2] += HEADING_Q_OFFSET * dt;
+        P[1][0]  = P[0][1];
+        P[2][0]  = P[0][2];
+    }
+}
+
+// Scalar update, z = ψ (+ d when withOffset). gateS > 0 gates the innovation
+// at HEADING_MAG_GATE σ of at most that variance; false if gated out.
+bool HeadingFilter::update(float z, bool withOffset, float sigma, float gateS) {
+    float Ph[3], nu = wrap180(z - x[0] - (withOffset ? x[2] : 0.0f));
+    for (int i = 0; i < 3; i++) Ph[i] = P[i][0] + (withOffset ? P[i][2] : 0.0f);
+    float S = Ph[0] + (withOffset ? Ph[2] : 0.0f) + sigma * sigma;
+    lastS   = S;
+    lastNu  = nu;
+    if (gateS > 0.0f && nu * nu > HEADING_MAG_GATE * HEADING_MAG_GATE * (S < gateS ? S : gateS)) return false;
+
+    float K[3];
+    for (int i = 0; i < 3; i++) K[i] = Ph[i] / S;
+    for (int i = 0; i < 3; i++) x[i] += K[i] * nu;
+    for (int i = 0; i < 3; i++)
+        for (int j = i; j < 3; j++) P[j][i] = P[i][j] -= K[i] * Ph[j];
+    x[0] = wrap360(x[0]);
+    x[2] = wrap180(x[2]);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Measurements
+// ---------------------------------------------------------------------------
+bool HeadingFilter::mag(float heading_deg, uint32_t t_us) {
+    if (!init) {
+        reset();
+        x[0]    = wrap360(heading_deg);
+        P[0][0] = HEADING_MAG_SIGMA_DEG * HEADING_MAG_SIGMA_DEG;
+        P[1][1] = HEADING_INIT_RATE_DPS * HEADING_INIT_RATE_DPS;
+        P[2][2] = HEADING_INIT_OFFSET_DEG * HEADING_INIT_OFFSET_DEG;
+        tUs     = t_us;
+        init    = true;
+        st.mag++;
+        return true;
+    }
+    predict(t_us);
+    // While rejecting, the gate stays as wide as when the run began: the
+    // heading variance grows without compass updates, and a disturbance
+    // must not be let in just because the filter has been coasting
+    if (update(heading_deg, false, HEADING_MAG_SIGMA_DEG, rejecting ? rejectS : 1e30f)) {
+        rejecting = false;
+        gpsInRun  = false;
+        st.mag++;
+        return true;
+    }
+    st.mag_rejected++;
+
+    // A long run of rejections with no GPS vouching for the estimate: the
+    // filter is the one that is off (missed a fast turn), so start again
+    // from the compass
+    if (!rejecting) {
+        rejecting = true;
+        rejectUs  = t_us;
+        rejectS   = lastS;
+    }
+    if ((uint32_t)(t_us - rejectUs) < HEADING_REACQUIRE_MS * 1000UL) return false;
+    rejecting = false;
+    if (gpsInRun) {   // GPS agrees with the estimate: keep rejecting
+        gpsInRun = false;
+        return false;
+    }
+    float open = HEADING_REACQUIRE_DEG * HEADING_REACQUIRE_DEG;
+    if (P[0][0] < open) P[0][0] = open;
+    update(heading_deg, false, HEADING_MAG_SIGMA_DEG, 0.0f);
+    st.reacquired++;
+    return true;
+}
+
+bool HeadingFilter::gps(const GpsFix& fix, uint32_t t_us) {
+    if (!fix.valid || (haveFix && fix.rx_ms == lastFixMs)) return false;
+    lastFixMs = fix.rx_ms;
+    haveFix   = true;
+    if (!init || fix.sog_cms < HEADING_GPS_MIN_SOG_CMS) {
+        st.gps_skipped++;
+        return false;
+    }
+    float sigma = fix.head_acc_cdeg ? fix.head_acc_cdeg * 0.01f
+                                    : atan2f(HEADING_GPS_SPEED_SIGMA_CMS, (float)fix.sog_cms) * R2D;
+    return cog(fix.cog_cdeg * 0.01f, sigma, t_us);
+}
+
+bool HeadingFilter::cog(float cog_deg, float sigma_deg, uint32_t t_us) {
+    if (!init || fabsf(x[1]) > HEADING_GPS_MAX_RATE_DPS) {
+        st.gps_skipped++;
+        return false;
+    }
+    predict(t_us);
+    if (sigma_deg < HEADING_GPS_SIGMA_MIN_DEG) sigma_deg = HEADING_GPS_SIGMA_MIN_DEG;
+    if (!update(cog_deg, true, sigma_deg, 1e30f)) {
+        st.gps_skipped++;
+        return false;
+    }
+    // A tight COG that agrees with the estimate vouches for it against the compass
+    if (rejecting && sigma_deg <= HEADING_GPS_VOUCH_DEG && fabsf(lastNu) <= HEADING_GPS_VOUCH_DEG) gpsInRun = true;
+    st.gps++;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------
+float HeadingFilter::heading(uint32_t t_us) const {
+    int32_t ahead = (int32_t)(t_us - tUs);
+    float   dt    = ahead <= 0 ? 0.0f : ahead * 1e-6f;
+    if (dt > HEADING_DT_MAX_S) dt = HEADING_DT_MAX_S;
+    return wrap360(x[0] + x[1] * dt);
+}
+
+float HeadingFilter::sigma() const { return sqrtf(P[0][0]); }
@@ -0,0 +1,104 @@
+#ifndef HEADING_FILTER_H
+#define HEADING_FILTER_H
+
+#include <stdint.h>
+#include "firmware/common/gps/gps_fix.h"
+
+// ---------------------------------------------------------------------------
+// Heading fusion — magnetometer + GPS course over ground + yaw rate
+//
+// Three-state Kalman filter, all float (the S3 has a single-precision FPU):
+//
+//   ψ  heading, magnetic, degrees       mag():  z = ψ        σ HEADING_MAG_SIGMA_DEG
+//   r  yaw rate, °/s                    gps():  z = ψ + d    σ from head_acc / speed
+//   d  course offset: COG − heading (declination, leeway, current) — slow
+//
+//   predict: ψ += r·dt; r and d random walks (HEADING_Q_ACCEL, HEADING_Q_OFFSET)
+//
+// There is no gyro — r is estimated from the measurements themselves, and
+// heading(t) extrapolates ψ + r·(t − t_last) to the control step, so output
+// lag is one filter response (~0.1 s), not the 5-reading moving average the
+// QMC library smoothing adds. All angle differences are wrapped to ±180°.
+//
+// Magnetic disturbance (thrusters, a passing hull): a reading whose
+// innovation exceeds HEADING_MAG_GATE σ is rejected and the heading coasts
+// on r and GPS; the gate keeps the width it had when the run began. After
+// HEADING_REACQUIRE_MS of nothing but rejections the compass is believed
+// again (the filter, not the compass, was wrong) and the heading uncertainty
+// reopened — unless a tight GPS course agreed with the estimate during the
+// run, in which case the compass is the one that is off.
+//
+// GPS: COG is used only while moving (sog ≥ HEADING_GPS_MIN_SOG_CMS) and not
+// turning hard (|r| ≤ HEADING_GPS_MAX_RATE_DPS — COG lags the bow in a turn);
+// UBX head_acc gives the measurement σ, NMEA falls back to speed noise / sog.
+// One update per new fix (GpsFix::rx_ms), gated like the compass.
+//
+//   HeadingFilter hf;
+//   hf.mag(cal.heading(x, y, z), hal_micros());      // each compass reading
+//   hf.gps(gps.fix(), hal_micros());                 // each loop; new fixes only
+//   float h = hf.heading(hal_micros());              // any time, control rate
+// ---------------------------------------------------------------------------
+
+#define HEADING_MAG_SIGMA_DEG      3.0f    // compass noise incl. untilted wave roll
+#define HEADING_Q_ACCEL            300.0f  // yaw acceleration PSD, (°/s²)²/Hz
+#define HEADING_Q_OFFSET           0.01f   // course offset drift, °²/s
+#define HEADING_MAG_GATE           3.0f    // innovation gate, σ
+#define HEADING_REACQUIRE_MS       2000    // rejecting this long → re-acquire from the compass
+#define HEADING_GPS_VOUCH_DEG      5.0f    // COG this tight and close keeps the compass out
+#define HEADING_COAST_TAU_S        1.0f    // yaw rate decay while the compass is gated out
+#define HEADING_GPS_MIN_SOG_CMS    50      // ~1 kt
+#define HEADING_GPS_MAX_RATE_DPS   10.0f
+#define HEADING_GPS_SPEED_SIGMA_CMS 10.0f  // NMEA: velocity noise → COG σ = atan(σv / sog)
+#define HEADING_GPS_SIGMA_MIN_DEG  1.0f
+#define HEADING_DT_MAX_S           1.0f    // longer gaps are predicted in steps of this
+#define HEADING_INIT_RATE_DPS      20.0f   // initial σ: yaw rate
+#define HEADING_INIT_OFFSET_DEG    45.0f   //            course offset
+#define HEADING_REACQUIRE_DEG      30.0f   //            heading, when re-acquiring
+
+struct HeadingStats {
+    uint32_t mag;             // readings used
+    uint32_t mag_rejected;    // outside the gate
+    uint32_t reacquired;      // gate overridden after HEADING_REACQUIRE_MS
+    uint32_t gps;             // COG updates used
+    uint32_t gps_skipped;     // new fixes too slow / turning / outside the gate
+};
+
+class HeadingFilter {
+public:
+    HeadingFilter() { reset(); }
+
+    void reset();
+
+    // Measurements, each with hal_micros() when it was taken. Return true if used.
+    bool mag(float heading_deg, uint32_t t_us);
+    bool gps(const GpsFix& fix, uint32_t t_us);
+    bool cog(float cog_deg, float sigma_deg, uint32_t t_us);
+
+    // Estimate extrapolated to t_us, 0…360
+    float heading(uint32_t t_us) const;
+    float rate() const          { return x[1]; }          // °/s
+    float offset() const        { return x[2]; }          // COG − heading, °
+    float sigma() const;                                  // heading 1σ, °
+    bool  valid() const         { return init; }
+    HeadingStats stats() const  { return st; }
+
+private:
+    void predict(uint32_t t_us);
+    bool update(float z, bool withOffset, float sigma, float gateS);
+
+    float    x[3];            // ψ, r, d
+    float    P[3][3];
+    uint32_t tUs;
+    uint32_t lastFixMs;
+    bool     init;
+    bool     haveFix;
+    bool     rejecting;       // compass readings gated out since rejectUs
+    bool     gpsInRun;        // COG used since then
+    uint32_t rejectUs;
+    float    rejectS;         // innovation variance when the run began (gate width)
+    float    lastS;           // innovation variance / innovation of the last update
+    float    lastNu;
+    HeadingStats st;
+};
+
+#endif // HEADING_FILTER_H
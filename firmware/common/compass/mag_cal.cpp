@@ -0,0 +1,432 @@
+#include "mag_cal.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include "common/crc16.h"
+#include "firmware/common/gps/geodesy.h"
+#include "firmware/common/hal/hal.h"
+
+// ---------------------------------------------------------------------------
+// Small dense linear algebra (double, fixed sizes)
+// ---------------------------------------------------------------------------
+
+// Index of (i, j), i ≤ j, in a packed 9×9 upper triangle
+static int tri(int i, int j) { return i * 9 - i * (i - 1) / 2 + (j - i); }
+
+// Solve A·x = b for symmetric positive definite A (9×9) by Cholesky
+static bool cholSolve9(double A[9][9], const double b[9], double x[9]) {
+    double L[9][9] = {};
+    for (int i = 0; i < 9; i++) {
+        for (int j = 0; j <= i; j++) {
+            double s = A[i][j];
+            for (int k = 0; k < j; k++) s -= L[i][k] * L[j][k];
+            if (i == j) {
+                if (s <= 0.0) return false;
+                L[i][i] = sqrt(s);
+            } else {
+                L[i][j] = s / L[j][j];
+            }
+        }
+    }
+    double y[9];
+    for (int i = 0; i < 9; i++) {
+        double s = b[i];
+        for (int k = 0; k < i; k++) s -= L[i][k] * y[k];
+        y[i] = s / L[i][i];
+    }
+    for (int i = 8; i >= 0; i--) {
+        double s = y[i];
+        for (int k = i + 1; k < 9; k++) s -= L[k][i] * x[k];
+        x[i] = s / L[i][i];
+    }
+    return true;
+}
+
+static bool inverse3(const double m[3][3], double out[3][3]) {
+    double c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+    double c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+    double c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+    double det = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+    if (fabs(det) < 1e-300) return false;
+    double id = 1.0 / det;
+    out[0][0] = c00 * id;
+    out[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * id;
+    out[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * id;
+    out[1][0] = c01 * id;
+    out[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * id;
+    out[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * id;
+    out[2][0] = c02 * id;
+    out[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * id;
+    out[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * id;
+    return true;
+}
+
+// Cyclic Jacobi: a = V·diag(w)·Vᵀ for symmetric a
+static void eigen3(const double a[3][3], double w[3], double V[3][3]) {
+    double m[3][3];
+    memcpy(m, a, sizeof(m));
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++) V[i][j] = i == j;
+    for (int sweep = 0; sweep < 16; sweep++) {
+        double off = fabs(m[0][1]) + fabs(m[0][2]) + fabs(m[1][2]);
+        if (off < 1e-15 * (fabs(m[0][0]) + fabs(m[1][1]) + fabs(m[2][2]))) break;
+        for (int p = 0; p < 2; p++) {
+            for (int q = p + 1; q < 3; q++) {
+                if (m[p][q] == 0.0) continue;
+                double theta = (m[q][q] - m[p][p]) / (2.0 * m[p][q]);
+                double t     = (theta >= 0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+                double cs    = 1.0 / sqrt(t * t + 1.0), sn = t * cs;
+                for (int k = 0; k < 3; k++) {   // m = Jᵀ·m·J
+                    double mkp = m[k][p], mkq = m[k][q];
+                    m[k][p] = cs * mkp - sn * mkq;
+                    m[k][q] = sn * mkp + cs * mkq;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double mpk = m[p][k], mqk = m[q][k];
+                    m[p][k] = cs * mpk - sn * mqk;
+                    m[q][k] = sn * mpk + cs * mqk;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double vkp = V[k][p], vkq = V[k][q];
+                    V[k][p] = cs * vkp - sn * vkq;
+                    V[k][q] = sn * vkp + cs * vkq;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < 3; i++) w[i] = m[i][i];
+}
+
+static const double DECAY = exp(-(double)MAG_CAL_DECAY_BLOCK / MAG_CAL_MEMORY);
+
+static void identityCal(MagCal* c) {
+    memset(c, 0, sizeof(*c));
+    c->magic   = MAG_CAL_MAGIC;
+    c->version = MAG_CAL_VERSION;
+    c->soft[0] = c->soft[4] = c->soft[8] = 1.0f;
+    c->field   = MAG_CAL_FIELD_INIT;
+}
+
+static uint16_t calCrc(const MagCal& c) {
+    return crc16_ccitt((const uint8_t*)&c, offsetof(MagCal, crc));
+}
+
+// ---------------------------------------------------------------------------
+MagCalibrator::MagCalibrator() { reset(); }
+
+void MagCalibrator::reset() {
+    identityCal(&c);
+    saved      = c;
+    st         = MagCalStats();
+    lastSaveMs = 0;
+    dirty      = false;
+    restart();
+}
+
+void MagCalibrator::setCal(const MagCal& cal) {
+    c = cal;
+    restart();
+}
+
+void MagCalibrator::restart() {
+    memset(S, 0, sizeof(S));
+    memset(r, 0, sizeof(r));
+    n     = 0;
+    scale = c.field;
+    for (int i = 0; i < 3; i++) ref[i] = c.offset[i];
+    haveLast   = false;
+    sinceDecay = 0;
+    sinceSolve = 0;
+}
+
+void MagCalibrator::decay() {
+    for (double& v : S) v *= DECAY;
+    for (double& v : r) v *= DECAY;
+    n *= DECAY;
+    sinceDecay = 0;
+}
+
+// Re-express the moments around another reference / scale. u' = a·u + s is
+// affine, so the basis [d, 1] maps linearly, e' = T·e, and the augmented
+// moment matrix exactly: E' = T·E·Tᵀ. No samples are needed.
+void MagCalibrator::shift(const double to[3], double toScale) {
+    static const int QI[6] = { 0, 1, 2, 0, 0, 1 }, QJ[6] = { 0, 1, 2, 1, 2, 2 };
+    double a = scale / toScale, sh[3];
+    for (int i = 0; i < 3; i++) sh[i] = (ref[i] - to[i]) / toScale;
+
+    double T[10][10] = {};
+    for (int q = 0; q < 6; q++) {
+        int    i = QI[q], j = QJ[q];
+        double f = q < 3 ? 1.0 : 2.0;
+        T[q][q]      = a * a;
+        T[q][6 + j] += f * a * sh[i] / 2;
+        T[q][6 + i] += f * a * sh[j] / 2;
+        T[q][9]      = f * sh[i] * sh[j];
+    }
+    for (int i = 0; i < 3; i++) {
+        T[6 + i][6 + i] = a;
+        T[6 + i][9]     = 2 * sh[i];
+    }
+    T[9][9] = 1.0;
+
+    double E[10][10], TE[10][10];
+    for (int i = 0; i < 9; i++) {
+        for (int j = i; j < 9; j++) E[i][j] = E[j][i] = S[tri(i, j)];
+        E[i][9] = E[9][i] = r[i];
+    }
+    E[9][9] = n;
+    for (int i = 0; i < 10; i++)
+        for (int j = 0; j < 10; j++) {
+            double v = 0;
+            for (int k = 0; k < 10; k++) v += T[i][k] * E[k][j];
+            TE[i][j] = v;
+        }
+    for (int i = 0; i < 9; i++) {
+        for (int j = i; j < 10; j++) {
+            double v = 0;
+            for (int k = 0; k < 10; k++) v += TE[i][k] * T[j][k];
+            if (j < 9) S[tri(i, j)] = v;
+            else       r[i] = v;
+        }
+    }
+    for (int i = 0; i < 3; i++) ref[i] = to[i];
+    scale = toScale;
+}
+
+// ---------------------------------------------------------------------------
+// Hot path
+// ---------------------------------------------------------------------------
+void MagCalibrator::apply(int16_t x, int16_t y, int16_t z, float out[3]) const {
+    float dx = x - c.offset[0], dy = y - c.offset[1], dz = z - c.offset[2];
+    out[0] = c.soft[0] * dx + c.soft[1] * dy + c.soft[2] * dz;
+    out[1] = c.soft[3] * dx + c.soft[4] * dy + c.soft[5] * dz;
+    out[2] = c.soft[6] * dx + c.soft[7] * dy + c.soft[8] * dz;
+}
+
+float MagCalibrator::heading(int16_t x, int16_t y, int16_t z) const {
+    float v[3];
+    apply(x, y, z, v);
+    float h = geo_atan2_deg(v[1], v[0]);
+    return h < 0.0f ? h + 360.0f : h;
+}
+
+// ---------------------------------------------------------------------------
+// Learning
+// ---------------------------------------------------------------------------
+bool MagCalibrator::add(int16_t x, int16_t y, int16_t z) {
+    st.seen++;
+    if (haveLast) {
+        float dx = (float)(x - last[0]), dy = (float)(y - last[1]), dz = (float)(z - last[2]);
+        float step = MAG_CAL_MIN_STEP * c.field;
+        if (dx * dx + dy * dy + dz * dz < step * step) return false;
+    }
+    last[0]  = x;
+    last[1]  = y;
+    last[2]  = z;
+    haveLast = true;
+    st.kept++;
+
+    double u0 = (x - ref[0]) / scale, u1 = (y - ref[1]) / scale, u2 = (z - ref[2]) / scale;
+    double d[9] = { u0 * u0, u1 * u1, u2 * u2, 2 * u0 * u1, 2 * u0 * u2, 2 * u1 * u2, 2 * u0, 2 * u1, 2 * u2 };
+    int k = 0;
+    for (int i = 0; i < 9; i++) {
+        r[i] += d[i];
+        for (int j = i; j < 9; j++) S[k++] += d[i] * d[j];
+    }
+    n += 1.0;
+
+    if (++sinceDecay >= MAG_CAL_DECAY_BLOCK) decay();
+    sinceSolve++;
+    return true;
+}
+
+// Sample covariance (fit units) from the moments; false while empty
+bool MagCalibrator::covariance(double cov[3][3], double mean[3]) const {
+    if (n < 1.0) return false;
+    static const int CROSS[3][3] = { { 0, 3, 4 }, { 3, 1, 5 }, { 4, 5, 2 } };
+    for (int i = 0; i < 3; i++) mean[i] = r[6 + i] / (2 * n);
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            cov[i][j] = r[CROSS[i][j]] / (i == j ? n : 2 * n) - mean[i] * mean[j];
+    return true;
+}
+
+MagCalStats MagCalibrator::stats() const {
+    MagCalStats s = st;
+    s.weight = (float)n;
+    return s;
+}
+
+bool MagCalibrator::solve() {
+    st.solves++;
+    sinceSolve = 0;
+    double cov[3][3], mean[3];
+    if (n < MAG_CAL_MIN_SAMPLES || !covariance(cov, mean)) {
+        st.rejected++;
+        return false;
+    }
+
+    // Fit around the centroid of the data: directions the buoy never moves
+    // through then have basis terms ≈ 0, so the prior alone holds them
+    double to[3];
+    for (int i = 0; i < 3; i++) to[i] = ref[i] + mean[i] * scale;
+    shift(to, c.field);
+
+    // Prior: the current calibration as an ellipsoid in fit units,
+    // (u − o)ᵀ·Q0·(u − o) = 1 with Q0 = WᵀW·scale²/R², rewritten as dᵀp0 = 1.
+    // Before there is one (or if the data left it) the same shape is centred
+    // under the ring of readings: horizontally on it, vertically where a unit
+    // sphere through a ring of that radius puts it.
+    double Q0[3][3], o0[3];
+    for (int i = 0; i < 3; i++) {
+        o0[i] = (c.offset[i] - ref[i]) / scale;
+        for (int j = 0; j < 3; j++) {
+            double s = 0;
+            for (int k = 0; k < 3; k++) s += (double)c.soft[k * 3 + i] * c.soft[k * 3 + j];
+            Q0[i][j] = s * scale * scale / ((double)c.field * c.field);
+        }
+    }
+    double oQo = 0, Qo[3];
+    for (int i = 0; i < 3; i++) {
+        Qo[i] = Q0[i][0] * o0[0] + Q0[i][1] * o0[1] + Q0[i][2] * o0[2];
+        oQo  += o0[i] * Qo[i];
+    }
+    if (!c.samples || 1.0 - oQo < MAG_CAL_PRIOR_INSIDE) {
+        double ring = cov[0][0] + cov[1][1];
+        o0[0] = o0[1] = 0.0;
+        o0[2] = (ref[2] >= c.offset[2] ? -1.0 : 1.0) * sqrt(ring < 1.0 ? 1.0 - ring : 0.0);
+        oQo   = 0;
+        for (int i = 0; i < 3; i++) {
+            Qo[i] = Q0[i][0] * o0[0] + Q0[i][1] * o0[1] + Q0[i][2] * o0[2];
+            oQo  += o0[i] * Qo[i];
+        }
+    }
+    double t     = 1.0 - oQo;
+    double p0[9] = { Q0[0][0] / t, Q0[1][1] / t, Q0[2][2] / t, Q0[0][1] / t, Q0[0][2] / t, Q0[1][2] / t,
+                     -Qo[0] / t, -Qo[1] / t, -Qo[2] / t };
+
+    double A[9][9], b[9], trace = 0;
+    for (int i = 0; i < 9; i++) {
+        for (int j = i; j < 9; j++) A[i][j] = A[j][i] = S[tri(i, j)];
+        trace += A[i][i];
+    }
+    double lambda = MAG_CAL_PRIOR * trace / 9;
+    for (int i = 0; i < 9; i++) {
+        A[i][i] += lambda;
+        b[i]     = r[i] + lambda * p0[i];
+    }
+    double p[9];
+    if (!cholSolve9(A, b, p)) {
+        st.rejected++;
+        return false;
+    }
+
+    // Centre o = −M⁻¹·nv; (u − o)ᵀ·M·(u − o) = 1 + oᵀ·M·o = k
+    double M[3][3] = { { p[0], p[3], p[4] }, { p[3], p[1], p[5] }, { p[4], p[5], p[2] } };
+    double Mi[3][3], o[3];
+    if (!inverse3(M, Mi)) {
+        st.rejected++;
+        return false;
+    }
+    for (int i = 0; i < 3; i++) o[i] = -(Mi[i][0] * p[6] + Mi[i][1] * p[7] + Mi[i][2] * p[8]);
+    double k = 1.0;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++) k += o[i] * M[i][j] * o[j];
+    if (fabs(k) < 1e-9) {
+        st.rejected++;
+        return false;
+    }
+
+    double Q[3][3], w[3], V[3][3];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++) Q[i][j] = M[i][j] / k;
+    eigen3(Q, w, V);
+    if (w[0] <= 0 || w[1] <= 0 || w[2] <= 0) {
+        st.rejected++;
+        return false;
+    }
+    double aMin = 1e300, aMax = 0, aProd = 1;
+    for (int i = 0; i < 3; i++) {
+        double a = 1.0 / sqrt(w[i]);
+        aMin   = a < aMin ? a : aMin;
+        aMax   = a > aMax ? a : aMax;
+        aProd *= a;
+    }
+    double R = cbrt(aProd);
+
+    // Radial residual from the moments: eᵢ = dᵢᵀp − 1 = k(ρᵢ² − 1) ≈ 2k(ρᵢ − 1)
+    double e2 = n;
+    for (int i = 0; i < 9; i++) {
+        e2 -= 2 * p[i] * r[i];
+        for (int j = 0; j < 9; j++) e2 += p[i] * S[tri(i < j ? i : j, i < j ? j : i)] * p[j];
+    }
+    double rms = sqrt(e2 > 0 ? e2 / n : 0) / (2 * fabs(k));
+
+    // Heading coverage: the fit is centred on the data centroid, so o is how
+    // far the readings lean to one side of the ring (0 all round, → 1 one way)
+    double oh2 = o[0] * o[0] + o[1] * o[1];
+    double lean = sqrt(oh2 / (cov[0][0] + cov[1][1] + oh2));
+    st.lean = (float)lean;
+    if (aMax / aMin > MAG_CAL_MAX_AXIS_RATIO || rms > MAG_CAL_MAX_RMS || lean > MAG_CAL_MAX_LEAN) {
+        st.rejected++;
+        return false;
+    }
+
+    MagCal next = c;
+    for (int i = 0; i < 3; i++) {
+        next.offset[i] = (float)(ref[i] + o[i] * scale);
+        for (int j = 0; j < 3; j++) {   // W = R·V·√w·Vᵀ
+            double s = 0;
+            for (int m = 0; m < 3; m++) s += V[i][m] * sqrt(w[m]) * V[j][m];
+            next.soft[i * 3 + j] = (float)(R * s);
+        }
+    }
+    next.field   = (float)(R * scale);
+    next.rms     = (float)rms;
+    next.samples = (uint32_t)n;
+
+    float moved = 0;
+    for (int i = 0; i < 3; i++) moved = fmaxf(moved, fabsf(next.offset[i] - saved.offset[i]) / next.field);
+    for (int i = 0; i < 9; i++) moved = fmaxf(moved, fabsf(next.soft[i] - saved.soft[i]));
+    if (moved >= MAG_CAL_SAVE_MOVE || !saved.samples) dirty = true;
+
+    c = next;
+    st.accepted++;
+    return true;
+}
+
+bool MagCalibrator::service(uint32_t now_ms) {
+    bool accepted = sinceSolve >= MAG_CAL_SOLVE_EVERY && solve();
+    if (dirty && (!saved.samples || now_ms - lastSaveMs >= MAG_CAL_SAVE_MS)) {
+        save();
+        lastSaveMs = now_ms;
+    }
+    return accepted;
+}
+
+// ---------------------------------------------------------------------------
+// Persistence
+// ---------------------------------------------------------------------------
+bool MagCalibrator::save() {
+    c.magic   = MAG_CAL_MAGIC;
+    c.version = MAG_CAL_VERSION;
+    c.crc     = calCrc(c);
+    if (!hal_nvs_write(MAG_CAL_NVS_KEY, &c, sizeof(c))) return false;
+    saved = c;
+    dirty = false;
+    st.saves++;
+    return true;
+}
+
+bool MagCalibrator::load() {
+    MagCal in;
+    if (!hal_nvs_read(MAG_CAL_NVS_KEY, &in, sizeof(in))) return false;
+    if (in.magic != MAG_CAL_MAGIC || in.version != MAG_CAL_VERSION || in.crc != calCrc(in)) return false;
+    if (!(in.field > 0.0f) || !isfinite(in.field)) return false;
+    for (float v : in.offset) if (!isfinite(v)) return false;
+    for (float v : in.soft)   if (!isfinite(v)) return false;
+    setCal(in);
+    saved = in;
+    dirty = false;
+    return true;
+}
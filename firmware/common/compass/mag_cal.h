@@ -0,0 +1,137 @@
+#ifndef MAG_CAL_H
+#define MAG_CAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Online magnetometer calibration — hard + soft iron from normal readings
+//
+//   compass.read() raw x, y, z
+//        │
+//        ├─ add(): gate (must differ from the last kept sample by
+//        │         MAG_CAL_MIN_STEP of the field), then fold into running
+//        │         moments of the ellipsoid basis
+//        │           d = [x², y², z², 2xy, 2xz, 2yz, 2x, 2y, 2z]
+//        │         Σ d·dᵀ (45 terms), Σ d, n — O(1) memory, exponentially
+//        │         forgotten over ~MAG_CAL_MEMORY samples so a payload
+//        │         change is tracked
+//        │
+//        ├─ service(): every MAG_CAL_SOLVE_EVERY kept samples re-centre the
+//        │         moments on the data (exact affine shift, no samples kept)
+//        │         and solve dᵀp = 1 (9×9 Cholesky, ridge towards the current
+//        │         calibration so axes the buoy never tilts through stay
+//        │         put), → centre, ellipsoid matrix → offset + symmetric
+//        │         soft-iron matrix W = R·√Q. Accepted only if the readings
+//        │         go round the fitted centre (lean ≤ MAG_CAL_MAX_LEAN), the
+//        │         residual is ≤ MAG_CAL_MAX_RMS and the axis ratio ≤
+//        │         MAG_CAL_MAX_AXIS_RATIO; persisted to NVS when it moved, at
+//        │         most every MAG_CAL_SAVE_MS
+//        │
+//        └─ heading(): W·(raw − offset), geo_atan2_deg(y, x) — 9 multiply-
+//                  adds and a polynomial atan2 per reading, all float
+//
+// A buoy rolls a few degrees at most, so the vertical is poorly observed:
+// fitting around the centroid leaves the z terms of d near zero and the
+// prior keeps them, while the horizontal ring — all heading depends on —
+// is fitted freely. Level-only data still gives a correct heading, but the
+// field (and z offset) stay uncertain until the hull tilts.
+// Moments and the solve are double (a few µs per sample on the S3's soft
+// double — only add() and the occasional solve touch them).
+//
+// Boot: load() restores the last calibration from NVS (magic, version, CRC
+// checked), so no calibration run is needed; without one the identity is
+// used until the first accepted solve.
+// ---------------------------------------------------------------------------
+
+#define MAG_CAL_FIELD_INIT      1500.0f  // counts: QMC5883L at ±8 G, ~0.5 G field
+#define MAG_CAL_MIN_STEP        0.04f    // of the field, between kept samples
+#define MAG_CAL_MEMORY          3000     // kept samples of memory (forgetting time constant)
+#define MAG_CAL_DECAY_BLOCK     64       // kept samples per forgetting step
+#define MAG_CAL_SOLVE_EVERY     100      // kept samples between solves
+#define MAG_CAL_MIN_SAMPLES     300      // effective samples before the first solve
+#define MAG_CAL_MAX_LEAN        0.35f    // centroid offset from the fitted centre, of the ring radius
+#define MAG_CAL_MAX_RMS         0.03f    // radial fit residual, of the field
+#define MAG_CAL_MAX_AXIS_RATIO  1.6f
+#define MAG_CAL_PRIOR           1e-3     // ridge weight, of the mean moment diagonal
+#define MAG_CAL_PRIOR_INSIDE    0.1      // centroid this far inside the calibration to trust its centre
+#define MAG_CAL_SAVE_MOVE       0.01f    // offset / matrix change worth a flash write
+#define MAG_CAL_SAVE_MS         600000UL // at most one write per 10 min
+
+#define MAG_CAL_NVS_KEY         "magcal"
+#define MAG_CAL_MAGIC           0x4D43   // "MC"
+#define MAG_CAL_VERSION         1
+
+// Persisted calibration: corrected = soft · (raw − offset), |corrected| ≈ field
+struct MagCal {
+    uint16_t magic;
+    uint16_t version;
+    float    offset[3];     // hard iron, counts
+    float    soft[9];       // soft iron, row-major, dimensionless
+    float    field;         // corrected magnitude, counts
+    float    rms;           // radial residual of the fit, of the field
+    uint32_t samples;       // effective samples behind it (0: identity default)
+    uint16_t reserved;
+    uint16_t crc;           // CRC16-CCITT of everything above
+};
+
+struct MagCalStats {
+    uint32_t seen;          // add() calls
+    uint32_t kept;          // passed the step gate
+    uint32_t solves;
+    uint32_t accepted;
+    uint32_t rejected;      // coverage, residual, shape or numerics
+    uint32_t saves;
+    float    lean;          // last solve: readings' lean to one side (0 all headings, ~1 one heading)
+    float    weight;        // effective samples in the moments
+};
+
+class MagCalibrator {
+public:
+    MagCalibrator();
+
+    // Hot path: corrected vector (counts) / heading 0…360°, atan2(y, x) like the QMC library
+    void  apply(int16_t x, int16_t y, int16_t z, float out[3]) const;
+    float heading(int16_t x, int16_t y, int16_t z) const;
+
+    // Learning: add() every reading (true if kept); service() refits and persists when due.
+    // Returns true when a new calibration was accepted.
+    bool add(int16_t x, int16_t y, int16_t z);
+    bool service(uint32_t now_ms);
+    bool solve();
+
+    void reset();                       // identity calibration, empty moments
+    void setCal(const MagCal& c);       // also restarts the moments around it
+    const MagCal& cal() const { return c; }
+    MagCalStats   stats() const;
+
+    bool load();                        // from NVS; false (identity kept) if missing or bad
+    bool save();
+
+private:
+    void restart();
+    void decay();
+    void shift(const double to[3], double toScale);
+    bool covariance(double cov[3][3], double mean[3]) const;
+
+    MagCal   c;
+
+    // Moments in fit units u = (raw − ref) / scale
+    double   S[45];         // upper triangle of Σ d·dᵀ
+    double   r[9];          // Σ d
+    double   n;
+    double   ref[3];
+    double   scale;
+
+    int16_t  last[3];
+    bool     haveLast;
+    uint16_t sinceDecay;
+    uint16_t sinceSolve;
+    uint32_t lastSaveMs;
+    bool     dirty;         // accepted since the last save
+    MagCal   saved;         // what NVS holds
+
+    MagCalStats st;
+};
+
+#endif // MAG_CAL_H
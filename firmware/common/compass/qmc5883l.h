@@ -0,0 +1,48 @@
+#ifndef QMC5883L_H
+#define QMC5883L_H
+
+#include <stdint.h>
+#include "firmware/common/i2c/i2c_bus.h"
+
+// ---------------------------------------------------------------------------
+// QMC5883L through the shared I2cBus — no library access to Wire
+//
+// A reading is one write-then-read transaction: register 0x00, then 6 bytes
+// of X, Y, Z (int16, little-endian). These are the raw counts that
+// QMC5883LCompass::getX/Y/Z() return without setCalibration/setSmoothing.
+// Register the compass as an I2C_PRIO_HIGH device (addDevice) so a read
+// goes ahead of the OLED's next run rather than waiting out the frame.
+//
+// qmc5883l_init() writes the library's init() setup: set/reset period 1,
+// continuous mode, 200 Hz, ±8 G, 512× oversampling.
+// ---------------------------------------------------------------------------
+
+#define QMC5883L_REG_DATA     0x00
+#define QMC5883L_REG_CONTROL  0x09
+#define QMC5883L_REG_PERIOD   0x0B
+#define QMC5883L_CONTROL      0x1D   // OSR 512 | ±8 G | 200 Hz | continuous
+#define QMC5883L_DATA_BYTES   6
+
+// setup(): blocking, from the task that will read the compass
+static inline bool qmc5883l_init(I2cBus& bus, int dev) {
+    const uint8_t period[]  = { QMC5883L_REG_PERIOD, 0x01 };
+    const uint8_t control[] = { QMC5883L_REG_CONTROL, QMC5883L_CONTROL };
+    return bus.transfer(dev, period, sizeof(period)) && bus.transfer(dev, control, sizeof(control));
+}
+
+static inline void qmc5883l_decode(const uint8_t* raw, int16_t* x, int16_t* y, int16_t* z) {
+    *x = (int16_t)(raw[0] | raw[1] << 8);
+    *y = (int16_t)(raw[2] | raw[3] << 8);
+    *z = (int16_t)(raw[4] | raw[5] << 8);
+}
+
+// Blocking read; false (outputs untouched) on a bus error or full queue
+static inline bool qmc5883l_read(I2cBus& bus, int dev, int16_t* x, int16_t* y, int16_t* z) {
+    static const uint8_t reg = QMC5883L_REG_DATA;
+    uint8_t raw[QMC5883L_DATA_BYTES];
+    if (!bus.transfer(dev, &reg, 1, raw, sizeof(raw))) return false;
+    qmc5883l_decode(raw, x, y, z);
+    return true;
+}
+
+#endif // QMC5883L_H
@@ -0,0 +1,265 @@
+#include "config_store.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "common/crc16.h"
+#include "common/packet_codec.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/ultrasonic/ultrasonic.h"
+
+#define FIELD(member) (uint8_t)offsetof(BuoyConfig, member)
+
+// Defaults are the compile-time values these replace
+const ConfigField CONFIG_KEYS[CFG_KEY_COUNT] = {
+    //  name             unit    type     offset                     scale  min     max     default
+    { "vane_offset",    "deg",  CFG_F32, FIELD(vane_offset_deg),    10,    0.0f,   360.0f, 0.0f },
+    { "wind_shift",     "deg",  CFG_F32, FIELD(wind_shift_deg),     10,    1.0f,   90.0f,  WIND_CHANGE_THRESHOLD_DEG },
+    { "comms_timeout",  "s",    CFG_U16, FIELD(comms_timeout_s),    1,     5.0f,   3600.0f, COMMS_TIMEOUT_MS / 1000 },
+    { "dist_emergency", "cm",   CFG_U16, FIELD(dist_emergency_cm),  1,     20.0f,  450.0f, DIST_EMERGENCY_CM },
+    { "dist_avoidance", "cm",   CFG_U16, FIELD(dist_avoidance_cm),  1,     20.0f,  450.0f, DIST_AVOIDANCE_CM },
+    { "hold_radius",    "m",    CFG_U8,  FIELD(hold_radius_m),      1,     1.0f,   50.0f,  HOLD_RADIUS_DEFAULT },
+    { "hold_time",      "s",    CFG_U8,  FIELD(hold_time_s),        1,     1.0f,   120.0f, HOLD_TIME_REQUIRED_S },
+    { "telemetry",      "(0 text, 1 binary)", CFG_U8, FIELD(telemetry_mode), 1, 0.0f, 1.0f, 0.0f },
+    { "dist_side_emergency", "cm", CFG_U16, FIELD(dist_side_emergency_cm), 1, 20.0f, 450.0f, DIST_SIDE_EMERGENCY_CM },
+};
+
+static size_t typeSize(uint8_t type) {
+    return type == CFG_F32 ? 4 : type == CFG_U16 ? 2 : 1;
+}
+
+static float readField(const BuoyConfig& c, const ConfigField& f) {
+    const uint8_t* p = (const uint8_t*)&c + f.offset;
+    if (f.type == CFG_F32) { float v;    memcpy(&v, p, 4); return v; }
+    if (f.type == CFG_U16) { uint16_t v; memcpy(&v, p, 2); return v; }
+    return *p;
+}
+
+static void writeField(BuoyConfig* c, const ConfigField& f, float v) {
+    uint8_t* p = (uint8_t*)c + f.offset;
+    if (f.type == CFG_F32)      memcpy(p, &v, 4);
+    else if (f.type == CFG_U16) { uint16_t u = (uint16_t)lroundf(v); memcpy(p, &u, 2); }
+    else                        *p = (uint8_t)lroundf(v);
+}
+
+static bool inRange(const ConfigField& f, float v) {
+    return v >= f.min && v <= f.max;   // false for NaN
+}
+
+static uint16_t bodyCrc(const uint8_t* blob, size_t size) {
+    return crc16_ccitt(blob + CONFIG_HEADER_SIZE, size - CONFIG_HEADER_SIZE);
+}
+
+// Convert a blob written before CONFIG_VERSION, one step per version, oldest
+// first. An appended field needs a step only when its default would change
+// what the older firmware did; otherwise the short blob defaults it.
+static void migrate(BuoyConfig* c, uint16_t from) {
+    // v2 split the side sensors' stop distance from the forward one; v1
+    // stopped on any sensor below dist_emergency_cm, so keep that
+    if (from < 2) c->dist_side_emergency_cm = c->dist_emergency_cm;
+}
+
+// ---------------------------------------------------------------------------
+ConfigStore::ConfigStore() {
+    defaults();
+    tailLen     = 0;
+    tailVersion = CONFIG_VERSION;
+    lineLen     = 0;
+    st          = ConfigStats();
+}
+
+void ConfigStore::defaults() {
+    memset(&c, 0, sizeof(c));
+    c.magic   = CONFIG_MAGIC;
+    c.version = CONFIG_VERSION;
+    c.size    = sizeof(BuoyConfig);
+    for (const ConfigField& f : CONFIG_KEYS) writeField(&c, f, f.def);
+    changed = true;
+}
+
+float ConfigStore::get(ConfigKey key) const {
+    return (unsigned)key < CFG_KEY_COUNT ? readField(c, CONFIG_KEYS[key]) : 0.0f;
+}
+
+bool ConfigStore::set(ConfigKey key, float value) {
+    if ((unsigned)key >= CFG_KEY_COUNT) return false;
+    const ConfigField& f = CONFIG_KEYS[key];
+    if (!inRange(f, value)) return false;
+    float before = readField(c, f);
+    writeField(&c, f, value);
+    if (readField(c, f) != before) {
+        changed = true;
+        st.sets++;
+    }
+    return true;
+}
+
+int32_t ConfigStore::wire(ConfigKey key) const {
+    if ((unsigned)key >= CFG_KEY_COUNT) return 0;
+    return (int32_t)lroundf(get(key) * CONFIG_KEYS[key].scale);
+}
+
+bool ConfigStore::setWire(ConfigKey key, int32_t value) {
+    if ((unsigned)key >= CFG_KEY_COUNT) return false;
+    return set(key, (float)value / CONFIG_KEYS[key].scale);
+}
+
+int ConfigStore::find(const char* name) {
+    for (int i = 0; i < CFG_KEY_COUNT; i++) {
+        if (strcmp(CONFIG_KEYS[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// ---------------------------------------------------------------------------
+// Persistence
+// ---------------------------------------------------------------------------
+bool ConfigStore::load() {
+    uint8_t blob[CONFIG_BLOB_MAX];
+    size_t  len = hal_nvs_size(CONFIG_NVS_KEY);
+    defaults();
+    tailLen           = 0;
+    st.source         = CONFIG_FROM_DEFAULTS;
+    st.stored_version = 0;
+    st.defaulted      = 0;
+    if (len == 0) return false;
+
+    BuoyConfig hdr;
+    if (len < CONFIG_HEADER_SIZE || len > CONFIG_BLOB_MAX || !hal_nvs_read(CONFIG_NVS_KEY, blob, len)) {
+        st.rejected++;
+        return false;
+    }
+    memcpy(&hdr, blob, CONFIG_HEADER_SIZE);
+    if (hdr.magic != CONFIG_MAGIC || hdr.size != len || hdr.version == 0 || hdr.crc != bodyCrc(blob, len)) {
+        st.rejected++;
+        return false;
+    }
+
+    // Known prefix over the defaults; fields the writer did not have keep them
+    memcpy((uint8_t*)&c + CONFIG_HEADER_SIZE, blob + CONFIG_HEADER_SIZE,
+           (len < sizeof(c) ? len : sizeof(c)) - CONFIG_HEADER_SIZE);
+    for (const ConfigField& f : CONFIG_KEYS) {
+        if (f.offset + typeSize(f.type) > len) {
+            writeField(&c, f, f.def);
+            st.defaulted++;
+        }
+    }
+    if (hdr.version < CONFIG_VERSION) migrate(&c, hdr.version);
+    for (const ConfigField& f : CONFIG_KEYS) {
+        if (!inRange(f, readField(c, f))) {
+            writeField(&c, f, f.def);
+            st.defaulted++;
+        }
+    }
+    if (len > sizeof(c)) {   // a newer firmware's fields: keep them for save()
+        tailLen     = (uint16_t)(len - sizeof(c));
+        tailVersion = hdr.version;
+        memcpy(tail, blob + sizeof(c), tailLen);
+    }
+
+    bool current      = hdr.version == CONFIG_VERSION && len == sizeof(c);
+    st.source         = current ? CONFIG_FROM_NVS : CONFIG_MIGRATED;
+    st.stored_version = hdr.version;
+    changed           = st.defaulted > 0;
+    return true;
+}
+
+bool ConfigStore::save() {
+    uint8_t blob[CONFIG_BLOB_MAX];
+    size_t  len = sizeof(c) + tailLen;
+    c.magic   = CONFIG_MAGIC;
+    c.version = tailLen ? tailVersion : CONFIG_VERSION;
+    c.size    = (uint16_t)len;
+    memcpy(blob, &c, sizeof(c));
+    memcpy(blob + sizeof(c), tail, tailLen);
+    c.crc = bodyCrc(blob, len);
+    memcpy(blob, &c, CONFIG_HEADER_SIZE);
+    if (!hal_nvs_write(CONFIG_NVS_KEY, blob, len)) return false;
+    changed = false;
+    st.saves++;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Updates
+// ---------------------------------------------------------------------------
+static size_t printField(const ConfigStore& s, int key, char* out, size_t cap) {
+    const ConfigField& f = CONFIG_KEYS[key];
+    int decimals = f.scale >= 100 ? 2 : f.scale >= 10 ? 1 : 0;
+    int n = snprintf(out, cap, "%s = %.*f %s\n", f.name, decimals, s.get((ConfigKey)key), f.unit);
+    return n < 0 ? 0 : (size_t)n < cap ? (size_t)n : cap - 1;
+}
+
+bool ConfigStore::command(const char* line, char* reply, size_t cap) {
+    char  verb[12] = "", name[24] = "";
+    float value;
+    int   got = sscanf(line, "%11s %23s %f", verb, name, &value);
+    if (cap) reply[0] = 0;
+    if (got < 1 || cap == 0) return false;
+
+    if (strcmp(verb, "get") == 0) {
+        if (got >= 2) {
+            int key = find(name);
+            if (key < 0) snprintf(reply, cap, "unknown key %s\n", name);
+            else         printField(*this, key, reply, cap);
+            return true;
+        }
+        size_t used = 0;
+        for (int i = 0; i < CFG_KEY_COUNT; i++) used += printField(*this, i, reply + used, cap - used);
+        if (changed && used < cap) snprintf(reply + used, cap - used, "(unsaved)\n");
+        return true;
+    }
+    if (strcmp(verb, "set") == 0 && got == 3) {
+        int key = find(name);
+        if (key < 0) {
+            snprintf(reply, cap, "unknown key %s\n", name);
+        } else if (!set((ConfigKey)key, value)) {
+            const ConfigField& f = CONFIG_KEYS[key];
+            snprintf(reply, cap, "%s: %g to %g %s\n", f.name, f.min, f.max, f.unit);
+        } else {
+            printField(*this, key, reply, cap);
+        }
+        return true;
+    }
+    if (strcmp(verb, "save") == 0) {
+        snprintf(reply, cap, save() ? "saved\n" : "save failed\n");
+        return true;
+    }
+    if (strcmp(verb, "defaults") == 0) {
+        defaults();
+        snprintf(reply, cap, "defaults (not saved)\n");
+        return true;
+    }
+    return false;
+}
+
+bool ConfigStore::feed(char ch, char* reply, size_t cap) {
+    if (ch != '\r' && ch != '\n') {
+        if (lineLen < CONFIG_LINE_MAX - 1) line[lineLen++] = ch;
+        return false;
+    }
+    if (lineLen == 0) return false;
+    line[lineLen] = 0;
+    lineLen       = 0;
+    if (command(line, reply, cap)) return true;
+    snprintf(reply, cap, "config: get [name] | set <name> <value> | save | defaults\n");
+    return true;
+}
+
+bool ConfigStore::apply(const ConfigSetPacket& in, uint8_t self_id, ConfigAckPacket* ack) {
+    if (in.buoy_id != self_id) return false;
+    bool    query  = in.flags & CONFIG_FLAG_QUERY;
+    uint8_t status = CONFIG_STATUS_OK;
+    if (in.key >= CFG_KEY_COUNT)                              status = CONFIG_STATUS_KEY;
+    else if (!query && !setWire((ConfigKey)in.key, in.value)) status = CONFIG_STATUS_RANGE;
+    else if ((in.flags & CONFIG_FLAG_SAVE) && changed && !save()) status = CONFIG_STATUS_NVS;
+
+    ack->packet_type = PKT_CONFIG_ACK;
+    ack->buoy_id     = self_id;
+    ack->seq         = in.seq;
+    ack->key         = in.key;
+    ack->status      = status;
+    ack->value       = wire((ConfigKey)in.key);
+    packet_seal(*ack);
+    return true;
+}
@@ -0,0 +1,170 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "common/protocol.h"
+
+// ---------------------------------------------------------------------------
+// Field configuration — one versioned, CRC-protected blob in NVS
+//
+// Values that used to be compile-time (#define VANE_OFFSET, HOLD_RADIUS_DEFAULT,
+// the ultrasonic zone thresholds, ...) live in a BuoyConfig loaded into RAM
+// once at boot. Code reads the struct directly — cfg.get().hold_radius_m is
+// a plain load — and changes go through the key table, which knows each
+// value's name, type, wire scale and limits:
+//
+//   serial   "set vane_offset 12.5" / "get" / "save" / "defaults"  → command()
+//   LoRa     ConfigSetPacket → apply() → ConfigAckPacket (protocol.h)
+//
+//   ┌──────────── header ────────────┐┌──────── body (append-only) ────────┐
+//   magic  version  size  crc(body)    vane_offset  wind_shift  ...  hold_time
+//
+// Layout rules, so that any firmware reads any other firmware's blob:
+//   - fields are only ever appended; the key numbers are wire-stable
+//   - a version's fields start after the previous version's whole struct:
+//     its tail padding is declared as reserved bytes and never reused, so
+//     every newer blob is longer than every older firmware's struct
+//   - a field whose meaning changes is retired (left as is) and a new one
+//     appended, with a migrate step in config_store.cpp converting the old
+//     value when a blob older than that CONFIG_VERSION is loaded
+//   - size is what the writer knew: an older, shorter blob keeps its prefix
+//     and the new fields take their defaults; a newer, longer one keeps the
+//     fields this firmware knows and save() writes the rest back untouched,
+//     stamped with the newer version (a rollback does not lose the newer
+//     firmware's settings, and they are not migrated again on the way back)
+//   - every value is range-checked on load; an out-of-range one reverts to
+//     its default on its own, the rest of the blob is kept
+//
+// A missing or corrupt blob gives the defaults (the old #defines) and is not
+// written back until something is changed and saved. The learnt compass
+// calibration keeps its own record (mag_cal.h): it is rewritten by the
+// calibrator, not by the operator.
+//
+//   ConfigStore cfg;
+//   cfg.load();                                   // setup(), once
+//   float off = cfg.get().vane_offset_deg;        // anywhere, RAM read
+//   while (Serial.available())                    // loop(): serial console
+//       if (cfg.feed(Serial.read(), reply, sizeof(reply))) Serial.print(reply);
+//   cfg.apply(setPkt, BUOY_WINDWARD, &ackPkt);    // PKT_CONFIG_SET
+// ---------------------------------------------------------------------------
+
+#define CONFIG_NVS_KEY      "config"
+#define CONFIG_MAGIC        0x4342   // "BC"
+#define CONFIG_VERSION      2
+#define CONFIG_HEADER_SIZE  8
+#define CONFIG_BLOB_MAX     256      // largest blob load() accepts (a far newer firmware's)
+#define CONFIG_LINE_MAX     48       // serial command line
+
+struct BuoyConfig {
+    uint16_t magic;
+    uint16_t version;
+    uint16_t size;               // bytes, header included
+    uint16_t crc;                // CRC16-CCITT of bytes [CONFIG_HEADER_SIZE, size)
+
+    // v1
+    float    vane_offset_deg;    // vane_raw with the bow into the wind
+    float    wind_shift_deg;     // 60 s wind range before repositioning
+    uint16_t comms_timeout_s;    // without ASSIGN → failsafe
+    uint16_t dist_emergency_cm;  // ultrasonic: forward below → stop (v1: any sensor)
+    uint16_t dist_avoidance_cm;  // ultrasonic: forward below → avoid
+    uint8_t  hold_radius_m;
+    uint8_t  hold_time_s;        // on station before HOLD is confirmed
+    uint8_t  telemetry_mode;     // serial output: TelemMode, 0 text / 1 binary (telemetry.h)
+    uint8_t  reserved_v1[3];     // v1's tail padding (28 B blob)
+
+    // v2
+    uint16_t dist_side_emergency_cm;   // ultrasonic: port / starboard below → stop
+    uint8_t  reserved_v2[2];
+};
+static_assert(offsetof(BuoyConfig, dist_side_emergency_cm) == 28, "v2 fields follow the whole v1 blob");
+static_assert(sizeof(BuoyConfig) == 32, "BuoyConfig layout is stored in NVS");
+
+// Wire-stable key numbers (ConfigSetPacket.key) — append only
+enum ConfigKey {
+    CFG_VANE_OFFSET = 0,
+    CFG_WIND_SHIFT,
+    CFG_COMMS_TIMEOUT,
+    CFG_DIST_EMERGENCY,
+    CFG_DIST_AVOIDANCE,
+    CFG_HOLD_RADIUS,
+    CFG_HOLD_TIME,
+    CFG_TELEMETRY,
+    CFG_DIST_SIDE_EMERGENCY,
+    CFG_KEY_COUNT
+};
+
+enum ConfigType { CFG_F32, CFG_U16, CFG_U8 };
+
+struct ConfigField {
+    const char* name;            // serial name
+    const char* unit;
+    uint8_t     type;            // ConfigType
+    uint8_t     offset;          // in BuoyConfig
+    uint8_t     scale;           // wire units per unit (10: tenths)
+    float       min;
+    float       max;
+    float       def;
+};
+
+extern const ConfigField CONFIG_KEYS[CFG_KEY_COUNT];
+
+// Where the RAM copy came from at load()
+enum ConfigSource {
+    CONFIG_FROM_DEFAULTS = 0,    // nothing stored, or not readable
+    CONFIG_FROM_NVS,             // current version
+    CONFIG_MIGRATED              // older / newer layout, converted
+};
+
+struct ConfigStats {
+    uint8_t  source;             // ConfigSource
+    uint16_t stored_version;     // of the blob load() read (0: none)
+    uint8_t  defaulted;          // fields not in the blob, out of range or migrated away
+    uint8_t  rejected;           // blob refused: magic, size or CRC
+    uint32_t sets;               // values changed through set()
+    uint32_t saves;
+};
+
+class ConfigStore {
+public:
+    ConfigStore();
+
+    const BuoyConfig& get() const { return c; }
+
+    // Typed access by key; set() range-checks (false: unknown key or out of range)
+    float get(ConfigKey key) const;
+    bool  set(ConfigKey key, float value);
+    int32_t wire(ConfigKey key) const;               // value in wire units
+    bool    setWire(ConfigKey key, int32_t value);
+    static int find(const char* name);               // key for a serial name, −1 if none
+
+    void defaults();                    // RAM only; save() to make it stick
+    bool load();                        // false: defaults in use (stats().source)
+    bool save();
+    bool dirty() const { return changed; }
+
+    // Serial: "get", "get <name>", "set <name> <value>", "save", "defaults".
+    // Writes one line (or one per key for "get") to reply; false if not understood.
+    bool command(const char* line, char* reply, size_t cap);
+    // Byte at a time from the serial port: true when a line produced a reply
+    bool feed(char ch, char* reply, size_t cap);
+
+    // PKT_CONFIG_SET: if addressed to self_id, apply (save if asked) and seal
+    // the ACK to send back; false if it was for another buoy
+    bool apply(const ConfigSetPacket& in, uint8_t self_id, ConfigAckPacket* ack);
+
+    ConfigStats stats() const { return st; }
+
+private:
+    BuoyConfig  c;
+    bool        changed;        // differs from NVS
+    // A newer firmware's fields past ours, written back untouched by save()
+    uint8_t     tail[CONFIG_BLOB_MAX - sizeof(BuoyConfig)];
+    uint16_t    tailLen;
+    uint16_t    tailVersion;
+    char        line[CONFIG_LINE_MAX];
+    uint8_t     lineLen;
+    ConfigStats st;
+};
+
+#endif // CONFIG_STORE_H
@@ -0,0 +1,108 @@
+#include "course_geometry.h"
+#include <math.h>
+#include "common/packet_codec.h"
+
+#define DEG_TO_RAD_F  0.0174532925f
+
+CourseGeometry::CourseGeometry(const CourseConfig& config, EnuPoint center)
+    : cfg(config), centre(center), windDeg(0.0f), upE(0.0f), upN(1.0f), haveWind(false),
+      dirty(COURSE_MARKS_ALL), due(0), marks(), counters() {
+    for (uint8_t id = 0; id < MAX_BUOYS; id++) marks[id].hold_m = HOLD_RADIUS_DEFAULT;
+}
+
+// ---------------------------------------------------------------------------
+void CourseGeometry::setWind(float from_deg) {
+    float d = fmodf(from_deg - windDeg + 540.0f, 360.0f) - 180.0f;
+    if (haveWind && fabsf(d) < COURSE_WIND_EPS_DEG) return;
+    windDeg  = fmodf(from_deg + 360.0f, 360.0f);
+    upE      = sinf(windDeg * DEG_TO_RAD_F);
+    upN      = cosf(windDeg * DEG_TO_RAD_F);
+    haveWind = true;
+    dirty   |= COURSE_MARKS_ALL;
+}
+
+void CourseGeometry::setConfig(const CourseConfig& config) {
+    if (config.line_m != cfg.line_m) dirty |= COURSE_MARK_BIT(BUOY_START_A) | COURSE_MARK_BIT(BUOY_START_B);
+    if (config.windward_m != cfg.windward_m) dirty |= COURSE_MARK_BIT(BUOY_WINDWARD);
+    if (config.leeward_m != cfg.leeward_m) dirty |= COURSE_MARK_BIT(BUOY_LEEWARD);
+    cfg = config;
+}
+
+void CourseGeometry::setCenter(EnuPoint center) {
+    if (center.east_m == centre.east_m && center.north_m == centre.north_m) return;
+    centre = center;
+    dirty |= COURSE_MARKS_ALL;
+}
+
+// A new radius is judged against the existing assignment on the next update()
+void CourseGeometry::setHoldRadius(uint8_t buoy, uint8_t metres) {
+    if (!isMark(buoy) || marks[buoy].hold_m == metres) return;
+    marks[buoy].hold_m = metres;
+    dirty |= COURSE_MARK_BIT(buoy);
+}
+
+void CourseGeometry::invalidate() {
+    for (uint8_t id = BUOY_START_A; id <= BUOY_LEEWARD; id++) marks[id].everAssigned = false;
+    dirty |= COURSE_MARKS_ALL;
+}
+
+// ---------------------------------------------------------------------------
+uint8_t CourseGeometry::update() {
+    counters.updates++;
+    if (!haveWind || !dirty) return due;
+
+    // Start line runs port → starboard looking upwind: A on the left
+    float half = cfg.line_m * 0.5f;
+    for (uint8_t id = BUOY_START_A; id <= BUOY_LEEWARD; id++) {
+        if (!(dirty & COURSE_MARK_BIT(id))) continue;
+        Mark& m = marks[id];
+        float along = 0.0f, across = 0.0f;   // upwind, and to the left of upwind
+        switch (id) {
+            case BUOY_START_A:  across =  half;           break;
+            case BUOY_START_B:  across = -half;           break;
+            case BUOY_WINDWARD: along  =  cfg.windward_m; break;
+            case BUOY_LEEWARD:  along  = -cfg.leeward_m;  break;
+        }
+        m.target.east_m  = centre.east_m  + along * upE - across * upN;
+        m.target.north_m = centre.north_m + along * upN + across * upE;
+        counters.recomputed++;
+
+        float de = m.target.east_m - m.assigned.east_m;
+        float dn = m.target.north_m - m.assigned.north_m;
+        float r  = m.hold_m;
+        if (!m.everAssigned || de * de + dn * dn > r * r) due |= COURSE_MARK_BIT(id);
+        else due &= (uint8_t)~COURSE_MARK_BIT(id);
+    }
+    dirty = 0;
+    return due;
+}
+
+bool CourseGeometry::assign(uint8_t buoy, uint8_t origin_seq, AssignV2Packet* out) {
+    if (!isMark(buoy) || !haveWind) return false;
+    Mark& m     = marks[buoy];
+    long  north = lrintf(m.target.north_m * 100.0f);
+    long  east  = lrintf(m.target.east_m * 100.0f);
+    if (north > POS24_MAX || north < POS24_MIN || east > POS24_MAX || east < POS24_MIN) return false;
+
+    out->packet_type = PKT_ASSIGN_V2;
+    out->buoy_id     = buoy;
+    out->origin_seq  = origin_seq;
+    pos24_put(out->target_north_cm, (int32_t)north);
+    pos24_put(out->target_east_cm, (int32_t)east);
+    out->hold_radius = m.hold_m;
+    packet_seal(*out);
+
+    m.assigned     = m.target;
+    m.everAssigned = true;
+    due &= (uint8_t)~COURSE_MARK_BIT(buoy);
+    counters.assigned++;
+    return true;
+}
+
+float CourseGeometry::drift(uint8_t buoy) const {
+    const Mark& m = marks[buoy];
+    if (!m.everAssigned) return 0.0f;
+    float de = m.target.east_m - m.assigned.east_m;
+    float dn = m.target.north_m - m.assigned.north_m;
+    return sqrtf(de * de + dn * dn);
+}
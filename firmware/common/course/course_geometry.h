@@ -0,0 +1,109 @@
+#ifndef COURSE_GEOMETRY_H
+#define COURSE_GEOMETRY_H
+
+#include <stdint.h>
+#include "common/protocol.h"
+#include "firmware/common/gps/geodesy.h"
+
+// ---------------------------------------------------------------------------
+// Race-course geometry — cached mark solution, assignments only when it matters
+//
+//                 WINDWARD                 wind from ↓ (setWind)
+//                    │ windward_m
+//      START_A ──────┼────── START_B       line_m, perpendicular to the wind,
+//                    │ leeward_m           centred on the course centre
+//                 LEEWARD
+//
+// Marks live in the course ENU frame (geodesy.h), so a solution is the
+// centre plus multiples of one upwind unit vector — one sinf/cosf per wind
+// change, two multiply-adds per mark. Each input dirties only the marks it
+// moves (wind / centre: all four; line length: A and B; windward / leeward
+// distance: that mark), and update() recomputes just those.
+//
+// Assignment is separate from the solution. For every mark the engine keeps
+// the target last handed to the radio; update() flags a buoy only when its
+// fresh target is more than that buoy's hold_radius from it (or it was never
+// assigned). A buoy still inside its hold circle around the new mark needs
+// neither a packet nor thrust. Small shifts accumulate against the last
+// assignment, so a slow veer is never lost to creep.
+//
+//   CourseGeometry course;
+//   course.setWind(window.mean_deg());
+//   uint8_t due = course.update();                // COURSE_MARK_BIT(id) per buoy
+//   for (uint8_t id = BUOY_START_A; id <= BUOY_LEEWARD; id++) {
+//       if (due & COURSE_MARK_BIT(id) && course.assign(id, origin.seq, &pkt)) radio.send(...);
+//   }
+//
+// invalidate() forces every mark out again (new course origin, slave reboot).
+// ---------------------------------------------------------------------------
+
+#define COURSE_LINE_DEFAULT_M       60.0f
+#define COURSE_WINDWARD_DEFAULT_M   400.0f
+#define COURSE_LEEWARD_DEFAULT_M    60.0f
+#define COURSE_WIND_EPS_DEG         0.01f    // smaller wind changes leave the solution untouched
+
+#define COURSE_MARK_BIT(id)   ((uint8_t)(1u << (id)))
+#define COURSE_MARKS_ALL      (COURSE_MARK_BIT(BUOY_START_A) | COURSE_MARK_BIT(BUOY_START_B) | \
+                               COURSE_MARK_BIT(BUOY_WINDWARD) | COURSE_MARK_BIT(BUOY_LEEWARD))
+
+struct CourseConfig {
+    float line_m;       // START_A ↔ START_B
+    float windward_m;   // line centre → WINDWARD, upwind
+    float leeward_m;    // line centre → LEEWARD, downwind
+};
+
+struct CourseStats {
+    uint32_t updates;       // update() calls
+    uint32_t recomputed;    // marks recomputed
+    uint32_t assigned;      // assignments handed out
+};
+
+class CourseGeometry {
+public:
+    explicit CourseGeometry(const CourseConfig& config = { COURSE_LINE_DEFAULT_M, COURSE_WINDWARD_DEFAULT_M,
+                                                           COURSE_LEEWARD_DEFAULT_M },
+                            EnuPoint center = { 0.0f, 0.0f });
+
+    void setWind(float from_deg);                 // direction the wind blows from, 0–360° true
+    void setConfig(const CourseConfig& config);
+    void setCenter(EnuPoint center);
+    void setHoldRadius(uint8_t buoy, uint8_t metres);
+    void invalidate();
+
+    // Recompute dirty marks; returns buoys due a new assignment (pending until assign())
+    uint8_t update();
+
+    // Fill and seal an ASSIGN_V2 for `buoy` and record its target as assigned.
+    // False if the buoy is not a mark, has no solution yet, or is off the int24 range.
+    bool assign(uint8_t buoy, uint8_t origin_seq, AssignV2Packet* out);
+
+    bool               solved() const { return haveWind; }
+    const EnuPoint&    target(uint8_t buoy) const   { return marks[buoy].target; }
+    const EnuPoint&    assigned(uint8_t buoy) const { return marks[buoy].assigned; }
+    float              drift(uint8_t buoy) const;  // target − assigned, metres
+    uint8_t            holdRadius(uint8_t buoy) const { return marks[buoy].hold_m; }
+    uint8_t            pending() const { return due; }
+    const CourseStats& stats() const   { return counters; }
+
+private:
+    struct Mark {
+        EnuPoint target;     // current solution
+        EnuPoint assigned;   // last target handed to the radio
+        uint8_t  hold_m;
+        bool     everAssigned;
+    };
+
+    static bool isMark(uint8_t buoy) { return buoy >= BUOY_START_A && buoy <= BUOY_LEEWARD; }
+
+    CourseConfig cfg;
+    EnuPoint     centre;
+    float        windDeg;
+    float        upE, upN;        // upwind unit vector, east/north
+    bool         haveWind;
+    uint8_t      dirty;           // marks whose target must be recomputed
+    uint8_t      due;             // marks whose target must be (re)assigned
+    Mark         marks[MAX_BUOYS];
+    CourseStats  counters;
+};
+
+#endif // COURSE_GEOMETRY_H
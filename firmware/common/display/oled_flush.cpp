@@ -0,0 +1,215 @@
+#include "oled_flush.h"
+#include <string.h>
+
+// SSD1306 I2C control bytes and window commands (horizontal addressing mode,
+// as left by Adafruit_SSD1306::begin())
+#define SSD1306_CTRL_CMD     0x00
+#define SSD1306_CTRL_DATA    0x40
+#define SSD1306_COLUMN_ADDR  0x21
+#define SSD1306_PAGE_ADDR    0x22
+
+OledFlush::OledFlush(uint8_t addr)
+    : addr(addr), incoming(), seq(0), submitted(0), invalidated(false), taken(0), work(), shadow(),
+      busy(false), cursor(0), frameStartUs(0), frameBytes(0), frameWrites(0),
+      flushed(0), coalesced(0), lastBytes(0), lastWrites(0), lastFlushUs(0), maxFlushUs(0), totalBytes(0),
+      bus(nullptr), busDev(-1), runCmd(), runData(), runStart(0), runLen(0), runFailed(false), inFlight(false)
+#if defined(ARDUINO)
+      , task(nullptr)
+#endif
+{
+    memset(unknown, 0xFF, sizeof(unknown));   // panel RAM is garbage at power-up
+}
+
+// ---------------------------------------------------------------------------
+// Loop side
+// ---------------------------------------------------------------------------
+void OledFlush::submit(const uint8_t* frame) {
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(incoming, frame, OLED_FRAME_BYTES);
+    submitted.fetch_add(1, std::memory_order_relaxed);
+    seq.store(s + 2, std::memory_order_release);
+#if defined(ARDUINO)
+    if (task) xTaskNotifyGive((TaskHandle_t)task);
+#endif
+}
+
+void OledFlush::invalidate() {
+    invalidated.store(true, std::memory_order_release);
+#if defined(ARDUINO)
+    if (task) xTaskNotifyGive((TaskHandle_t)task);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Flusher side
+// ---------------------------------------------------------------------------
+bool OledFlush::takeFrame() {
+    if (submitted.load(std::memory_order_acquire) == taken) return false;
+    uint32_t s, n;
+    do {
+        s = seq.load(std::memory_order_acquire);
+        memcpy(work, incoming, OLED_FRAME_BYTES);
+        n = submitted.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((s & 1) || seq.load(std::memory_order_relaxed) != s);
+    taken = n;
+    return true;
+}
+
+// Next run of dirty bytes from the cursor: one page, ≤ OLED_CHUNK_BYTES,
+// clean gaps up to OLED_MERGE_GAP folded in
+bool OledFlush::nextRun(uint16_t* start, uint8_t* len) {
+    uint16_t i = cursor;
+    while (i < OLED_FRAME_BYTES && !dirtyAt(i)) i++;
+    if (i == OLED_FRAME_BYTES) {
+        cursor = i;
+        return false;
+    }
+    uint16_t pageEnd = (uint16_t)((i / OLED_WIDTH + 1) * OLED_WIDTH);
+    uint16_t last    = i;
+    for (uint16_t k = i + 1; k < pageEnd && k - i < OLED_CHUNK_BYTES; k++) {
+        if (dirtyAt(k))                    last = k;
+        else if (k - last > OLED_MERGE_GAP) break;
+    }
+    *start = i;
+    *len   = (uint8_t)(last - i + 1);
+    cursor = last + 1;
+    return true;
+}
+
+bool OledFlush::sendRun(uint16_t start, uint8_t len) {
+    uint8_t page = (uint8_t)(start / OLED_WIDTH);
+    uint8_t col  = (uint8_t)(start % OLED_WIDTH);
+    uint8_t cmd[] = { SSD1306_CTRL_CMD, SSD1306_COLUMN_ADDR, col, (uint8_t)(col + len - 1),
+                      SSD1306_PAGE_ADDR, page, page };
+    memcpy(runCmd, cmd, sizeof(cmd));
+    runData[0] = SSD1306_CTRL_DATA;
+    memcpy(runData + 1, work + start, len);
+    runStart = start;
+    runLen   = len;
+
+    // Bytes on the wire: address + payload per transaction
+    frameBytes  += (1 + sizeof(cmd)) + (2 + len);
+    frameWrites += 2;
+
+    if (bus) {
+        // Window and data queue back to back on our ring; runDone() lands the run
+        I2cTxn c = { runCmd, sizeof(cmd), nullptr, 0, cmdDone, this, 0 };
+        I2cTxn d = { runData, (uint16_t)(1 + len), nullptr, 0, dataDone, this, 0 };
+        runFailed = false;
+        inFlight.store(true, std::memory_order_relaxed);
+        if (!bus->submit(busDev, c) || !bus->submit(busDev, d)) {
+            inFlight.store(false, std::memory_order_relaxed);
+            runDone(false);   // a half-queued window is harmless: the next run sets its own
+            return false;
+        }
+        return true;
+    }
+    bool ok = hal_i2c_write(addr, runCmd, sizeof(cmd)) && hal_i2c_write(addr, runData, 1 + len);
+    runDone(ok);
+    return ok;
+}
+
+void OledFlush::runDone(bool ok) {
+    if (!ok) {
+        for (uint16_t i = runStart; i < runStart + runLen; i++) unknown[i >> 3] |= (uint8_t)(1u << (i & 7));
+        return;   // left dirty: retried with the next frame
+    }
+    memcpy(shadow + runStart, runData + 1, runLen);
+    for (uint16_t i = runStart; i < runStart + runLen; i++) unknown[i >> 3] &= (uint8_t)~(1u << (i & 7));
+}
+
+// Bus callbacks (bus side). The window write always completes before its data.
+void OledFlush::cmdDone(void* ctx, bool ok) {
+    if (!ok) static_cast<OledFlush*>(ctx)->runFailed = true;
+}
+
+void OledFlush::dataDone(void* ctx, bool ok) {
+    OledFlush* o = static_cast<OledFlush*>(ctx);
+    o->runDone(ok && !o->runFailed);
+    o->inFlight.store(false, std::memory_order_release);   // publishes shadow / unknown to the flusher
+#if defined(ARDUINO)
+    if (o->task) xTaskNotifyGive((TaskHandle_t)o->task);
+#endif
+}
+
+void OledFlush::attachBus(I2cBus& b, I2cPriority priority) {
+    int id = b.addDevice("oled", addr, priority);
+    if (id < 0) return;   // bus full: keep the direct path
+    bus    = &b;
+    busDev = id;
+}
+
+bool OledFlush::service() {
+    if (inFlight.load(std::memory_order_acquire)) return false;   // dataDone() wakes us
+
+    bool restart = takeFrame();
+    if (invalidated.exchange(false, std::memory_order_acq_rel)) {
+        memset(unknown, 0xFF, sizeof(unknown));
+        restart = true;
+    }
+    if (restart) {
+        if (busy) {
+            coalesced.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            busy         = true;
+            frameStartUs = hal_micros();
+            frameBytes   = frameWrites = 0;
+        }
+        cursor = 0;   // runs already sent may differ in the new frame
+    }
+    if (!busy) return false;
+
+    uint16_t start;
+    uint8_t  len;
+    if (nextRun(&start, &len)) {
+        sendRun(start, len);
+        return true;
+    }
+
+    // Full scan with nothing left: the panel shows the latest frame
+    uint32_t us = hal_micros() - frameStartUs;
+    busy = false;
+    lastBytes.store(frameBytes, std::memory_order_relaxed);
+    lastWrites.store(frameWrites, std::memory_order_relaxed);
+    lastFlushUs.store(us, std::memory_order_relaxed);
+    if (us > maxFlushUs.load(std::memory_order_relaxed)) maxFlushUs.store(us, std::memory_order_relaxed);
+    totalBytes.fetch_add(frameBytes, std::memory_order_relaxed);
+    flushed.fetch_add(1, std::memory_order_release);
+    return false;
+}
+
+OledStats OledFlush::stats() const {
+    OledStats s;
+    s.frames_flushed   = flushed.load(std::memory_order_acquire);
+    s.frames_submitted = submitted.load(std::memory_order_relaxed);
+    s.frames_coalesced = coalesced.load(std::memory_order_relaxed);
+    s.last_bytes       = lastBytes.load(std::memory_order_relaxed);
+    s.last_writes      = lastWrites.load(std::memory_order_relaxed);
+    s.last_flush_us    = lastFlushUs.load(std::memory_order_relaxed);
+    s.max_flush_us     = maxFlushUs.load(std::memory_order_relaxed);
+    s.total_bytes      = totalBytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+#if defined(ARDUINO)
+static void oledTask(void* arg) {
+    OledFlush* o = static_cast<OledFlush*>(arg);
+    for (;;) {
+        while (o->service()) {}
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);   // until submit() / invalidate() / run landed
+    }
+}
+
+bool OledFlush::startTask(uint8_t core) {
+    TaskHandle_t h = nullptr;
+    if (xTaskCreatePinnedToCore(oledTask, "oled", OLED_TASK_STACK, this, OLED_TASK_PRIORITY, &h, core) != pdPASS) {
+        return false;
+    }
+    task = h;
+    return true;
+}
+#endif
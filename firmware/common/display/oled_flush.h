@@ -0,0 +1,132 @@
+#ifndef OLED_FLUSH_H
+#define OLED_FLUSH_H
+
+#include <atomic>
+#include <stdint.h>
+#include "common/config.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/i2c/i2c_bus.h"
+
+// ---------------------------------------------------------------------------
+// SSD1306 dirty-region flush — only changed columns go over I2C, off the loop
+//
+//   loop()                                  flush task (or service() calls)
+//   draw into the Adafruit buffer           take the newest frame
+//   submit(display.getBuffer()) ──1 KB──►   diff it against the panel shadow
+//   (memcpy under a seqlock, returns)       send each changed run: set column/page
+//                                           window, then the bytes; shadow follows
+//
+// The panel's RAM is mirrored in a shadow, so a frame costs what changed on
+// screen: a few digits are tens of bytes instead of the 1 KB + framing that
+// Adafruit_SSD1306::display() pushes (~25 ms blocking at 400 kHz).
+//
+// Runs are found per 8-pixel page by column: unchanged gaps shorter than
+// OLED_MERGE_GAP are sent anyway (cheaper than a new window), and a run
+// stops at OLED_CHUNK_BYTES. service() sends one run per call, so a newer
+// frame submitted mid-flush is picked up at the next run boundary — the
+// panel converges on the latest frame and intermediate ones are skipped
+// (counted in frames_coalesced). Nothing allocates.
+//
+// On target, startTask() runs service() in a FreeRTOS task; Wire blocks
+// that task, never loop(). With attachBus() the runs go through the shared
+// I2cBus instead, as its lowest-priority device: service() queues one run
+// and returns, the bus lands it and wakes the flusher, and a compass read
+// queued meanwhile goes ahead of the next run. On host, call service()
+// (and the bus's) directly — hal_i2c_write() advances the virtual clock by
+// the 400 kHz transfer time.
+// ---------------------------------------------------------------------------
+
+#define OLED_WIDTH           128
+#define OLED_PAGES           8                         // 64 rows / 8
+#define OLED_FRAME_BYTES     (OLED_WIDTH * OLED_PAGES)  // Adafruit_SSD1306 buffer layout
+#define OLED_CHUNK_BYTES     64                         // data bytes per run: bounds one bus hold (Wire buffer 128)
+#define OLED_MERGE_GAP       10                         // a new run costs a window write + data header: 10 bytes
+#define OLED_TASK_STACK      3072
+#define OLED_TASK_PRIORITY   1
+#define OLED_TASK_CORE       0                          // loop() runs on core 1
+
+struct OledStats {
+    uint32_t frames_submitted;
+    uint32_t frames_flushed;      // panel matched a submitted frame
+    uint32_t frames_coalesced;    // replaced by a newer frame before finishing
+    uint32_t last_bytes;          // I2C bytes for the last flushed frame (address + control included)
+    uint32_t last_writes;         // I2C transactions for it
+    uint32_t last_flush_us;       // first run → panel matched
+    uint32_t max_flush_us;
+    uint64_t total_bytes;
+};
+
+class OledFlush {
+public:
+    explicit OledFlush(uint8_t addr = OLED_ADDRESS);
+
+    // Loop side: copy a finished frame (OLED_FRAME_BYTES, page-major) for the flusher
+    void submit(const uint8_t* frame);
+
+    // Panel RAM unknown (power-up, after a blocking display()): next frame is sent whole
+    void invalidate();
+
+    // setup(), before startTask(): send runs through the shared bus as one of its devices
+    void attachBus(I2cBus& b, I2cPriority priority = I2C_PRIO_LOW);
+
+    // Flusher side: send (or queue) at most one run; true if it did. idle(): flusher side too.
+    bool service();
+    bool idle() const {
+        return !busy && !inFlight.load(std::memory_order_acquire) && submitted.load(std::memory_order_acquire) == taken;
+    }
+
+#if defined(ARDUINO)
+    bool startTask(uint8_t core = OLED_TASK_CORE);
+#endif
+
+    OledStats stats() const;
+
+private:
+    bool takeFrame();
+    bool dirtyAt(uint16_t i) const {
+        return work[i] != shadow[i] || (unknown[i >> 3] & (1u << (i & 7)));
+    }
+    bool nextRun(uint16_t* start, uint8_t* len);
+    bool sendRun(uint16_t start, uint8_t len);
+    void runDone(bool ok);
+    static void cmdDone(void* ctx, bool ok);
+    static void dataDone(void* ctx, bool ok);
+
+    uint8_t addr;
+
+    // Latest submitted frame — seqlock: odd while submit() is copying
+    uint8_t               incoming[OLED_FRAME_BYTES];
+    std::atomic<uint32_t> seq;
+    std::atomic<uint32_t> submitted;   // frames submitted
+    std::atomic<bool>     invalidated;
+    uint32_t              taken;       // submitted count at the last takeFrame()
+
+    // Flusher state
+    uint8_t  work[OLED_FRAME_BYTES];   // frame being flushed
+    uint8_t  shadow[OLED_FRAME_BYTES]; // what the panel shows
+    uint8_t  unknown[OLED_FRAME_BYTES / 8];  // 1 bit per byte: panel content unknown
+    bool     busy;
+    uint16_t cursor;                   // next byte index to scan
+    uint32_t frameStartUs;
+    uint32_t frameBytes, frameWrites;
+
+    // Written by the flusher, read anywhere
+    std::atomic<uint32_t> flushed, coalesced, lastBytes, lastWrites, lastFlushUs, maxFlushUs;
+    std::atomic<uint64_t> totalBytes;
+
+    // Run on the wire: buffers outlive the queued bus transactions
+    I2cBus*           bus;
+    int               busDev;
+    uint8_t           runCmd[7];
+    uint8_t           runData[1 + OLED_CHUNK_BYTES];
+    uint16_t          runStart;
+    uint8_t           runLen;
+    bool              runFailed;
+    std::atomic<bool> inFlight;   // set by service(), cleared by dataDone()
+
+#if defined(ARDUINO)
+    void* task;   // TaskHandle_t, notified by submit()
+#endif
+};
+
+#endif // OLED_FLUSH_H
@@ -0,0 +1,48 @@
+#include "geodesy.h"
+#include <math.h>
+
+#define E7_FULL_TURN  3600000000LL
+#define RAD_TO_DEG_F  57.2957795f
+#define HALF_PI_F     1.57079633f
+#define PI_F          3.14159265f
+
+// ---------------------------------------------------------------------------
+// atan(z) on [0, 1]: Abramowitz & Stegun 4.4.49, |error| ≤ 1e-5 rad.
+// Octant reduction maps every (y, x) onto it with min/max, so one divide.
+// ---------------------------------------------------------------------------
+float geo_atan2_deg(float y, float x) {
+    float ax = fabsf(x), ay = fabsf(y);
+    float hi = ax > ay ? ax : ay;
+    float lo = ax > ay ? ay : ax;
+    if (hi == 0.0f) return 0.0f;
+
+    float z  = lo / hi;
+    float z2 = z * z;
+    float a  = z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+    if (ay > ax)   a = HALF_PI_F - a;
+    if (x < 0.0f)  a = PI_F - a;
+    if (y < 0.0f)  a = -a;
+    return a * RAD_TO_DEG_F;
+}
+
+// ---------------------------------------------------------------------------
+EnuPoint geo_to_enu(const CourseOrigin& origin, int32_t lat_e7, int32_t lon_e7) {
+    int64_t dLon = (int64_t)lon_e7 - origin.lon_e7;
+    if (dLon >  E7_FULL_TURN / 2) dLon -= E7_FULL_TURN;
+    if (dLon < -E7_FULL_TURN / 2) dLon += E7_FULL_TURN;
+    int32_t dLat = lat_e7 - origin.lat_e7;
+    // Deltas stay exact in float below 2^24 e7 (~180 km); scales are cm per e7
+    return { (float)dLon * origin.cm_per_e7_lon * 0.01f, (float)dLat * origin.cm_per_e7_lat * 0.01f };
+}
+
+// ---------------------------------------------------------------------------
+GeoVector geo_vector(const EnuPoint& from, const EnuPoint& to) {
+    float de = to.east_m - from.east_m;
+    float dn = to.north_m - from.north_m;
+    float b  = geo_atan2_deg(de, dn);
+    return { sqrtf(de * de + dn * dn), b < 0.0f ? b + 360.0f : b };
+}
+
+void geo_vectors(const EnuPoint* from, const EnuPoint* to, GeoVector* out, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = geo_vector(from[i], to[i]);
+}
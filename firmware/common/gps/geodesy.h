@@ -0,0 +1,74 @@
+#ifndef GEODESY_H
+#define GEODESY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "common/protocol.h"
+#include "common/position.h"
+#include "firmware/common/gps/gps_fix.h"
+
+// ---------------------------------------------------------------------------
+// Local-tangent-plane geodesy — distance and bearing without trig per tick
+//
+//   fix (lat/lon) ──geo_to_enu()──► EnuPoint (east/north metres from the course origin)
+//                                      │
+//   target (ASSIGN_V2 cm offsets) ──geo_from_cm()──┤
+//                                      ▼
+//                      geo_vector() / geo_vectors() → distance m, bearing °
+//
+// The course origin (CourseOrigin, course_origin_set()) already holds the
+// WGS-84 metres-per-1e-7° scales at its latitude, cos(lat) included; they are
+// computed once per origin. Projecting a fix is then one integer subtract and
+// one float multiply per axis, and a distance/bearing is a float sqrt plus
+// geo_atan2_deg() — a 9th-order odd polynomial, no libm trig, no double.
+// Targets sent as v2 centimetre offsets are already in this frame.
+//
+// Error spec (vs the WGS-84 geodesic, checked by the geodesy_bench host env):
+//   both points within GEO_SPEC_RADIUS_M of the origin, |lat| ≤ GEO_SPEC_LAT_DEG
+//     distance  ≤ GEO_SPEC_DIST_REL of the distance + 1 cm
+//     bearing   ≤ GEO_SPEC_BEARING_DEG for legs ≥ 10 m
+//   geo_atan2_deg() alone: ≤ 0.001° (1e-5 rad polynomial + float rounding)
+// The equirectangular frame's only approximation is holding the east scale
+// at the origin latitude: ≤ 0.054% at 60°, centimetres over a few hundred
+// metres. Spherical Haversine is worse everywhere — its single 6371 km
+// radius is off by up to 0.5% (22 m over 4 km at the equator).
+// ---------------------------------------------------------------------------
+
+#define GEO_SPEC_RADIUS_M      2000.0f
+#define GEO_SPEC_LAT_DEG       60.0f
+#define GEO_SPEC_DIST_REL      6e-4f
+#define GEO_SPEC_BEARING_DEG   0.05f
+
+struct EnuPoint {
+    float east_m;
+    float north_m;
+};
+
+struct GeoVector {
+    float dist_m;
+    float bearing_deg;   // 0–360, clockwise from true north
+};
+
+// atan2(y, x) in degrees, −180…180; (0, 0) → 0
+float geo_atan2_deg(float y, float x);
+
+// Absolute position → metres from the origin (longitude wrapped across ±180°)
+EnuPoint geo_to_enu(const CourseOrigin& origin, int32_t lat_e7, int32_t lon_e7);
+
+// A receiver fix: its 1e-7° integers go straight in (no float degrees, no double)
+static inline EnuPoint geo_to_enu(const CourseOrigin& origin, const GpsFix& fix) {
+    return geo_to_enu(origin, fix.lat_e7, fix.lon_e7);
+}
+
+// Protocol v2 centimetre offsets → metres (same frame, no math beyond a scale)
+static inline EnuPoint geo_from_cm(const PositionCm& pos) {
+    return { pos.east_cm * 0.01f, pos.north_cm * 0.01f };
+}
+
+// Distance and bearing from → to
+GeoVector geo_vector(const EnuPoint& from, const EnuPoint& to);
+
+// Master batch: out[i] = geo_vector(from[i], to[i]) for every buoy, one pass
+void geo_vectors(const EnuPoint* from, const EnuPoint* to, GeoVector* out, size_t n = MAX_BUOYS);
+
+#endif // GEODESY_H
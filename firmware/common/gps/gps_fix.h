@@ -0,0 +1,54 @@
+#ifndef GPS_FIX_H
+#define GPS_FIX_H
+
+#include <stdint.h>
+#include "common/protocol.h"
+
+// ---------------------------------------------------------------------------
+// GpsFix — the receiver state both GPS front ends fill
+//
+// NmeaReader (nmea.h) and UbxReader (ubx.h) decode into the same struct, so
+// navigation code does not care which protocol the BE-880 is speaking.
+// Fields a source does not provide keep their last value (NED velocity and
+// accuracies are UBX-only; NMEA leaves them 0).
+// ---------------------------------------------------------------------------
+
+#define GPS_SRC_NMEA    0
+#define GPS_SRC_UBX     1
+
+struct GpsFix {
+    uint32_t rx_ms;         // hal_millis() when the last sentence / frame was decoded
+    uint32_t time_ms;       // UTC time of day
+    uint32_t date;          // ddmmyy, 0 until seen
+    int32_t  lat_e7;
+    int32_t  lon_e7;
+    int32_t  alt_cm;        // above mean sea level
+    uint16_t sog_cms;       // speed over ground
+    uint16_t cog_cdeg;      // course (heading of motion), true
+    int16_t  vel_n_cms;     // NED velocity (UBX)
+    int16_t  vel_e_cms;
+    int16_t  vel_d_cms;
+    uint16_t head_acc_cdeg; // heading-of-motion accuracy (UBX)
+    uint32_t h_acc_mm;      // horizontal position accuracy (UBX)
+    uint16_t hdop_x100;
+    uint16_t pdop_x100;
+    uint16_t vdop_x100;
+    uint8_t  quality;       // GGA scale: 0 none, 1 GPS, 2 DGPS, 4 RTK fixed, 5 RTK float, 6 DR
+    uint8_t  sats;          // satellites used
+    uint8_t  mode;          // 1 no fix, 2 2D, 3 3D
+    bool     valid;         // usable position: last GGA (quality > 0) or RMC (status A) said so
+    uint8_t  source;        // GPS_SRC_NMEA / GPS_SRC_UBX
+    uint8_t  updated;       // message bits decoded since the caller last cleared it
+};
+
+// Protocol-level position (float degrees) for packets
+static inline GPSPosition gps_fix_position(const GpsFix& f) {
+    GPSPosition p;
+    p.latitude    = (float)(f.lat_e7 / 1e7);
+    p.longitude   = (float)(f.lon_e7 / 1e7);
+    p.fix_quality = f.valid ? f.quality : 0;
+    p.hdop        = f.hdop_x100 / 100.0f;
+    return p;
+}
+
+#endif // GPS_FIX_H
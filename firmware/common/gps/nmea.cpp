@@ -0,0 +1,326 @@
+#include "nmea.h"
+#include <string.h>
+
+// ---------------------------------------------------------------------------
+// Field access — fields are (pointer, length) slices of the sentence
+// ---------------------------------------------------------------------------
+struct NmeaField {
+    const char* p;
+    size_t      n;
+};
+
+struct NmeaCursor {
+    const char* p;     // start of the next field
+    const char* end;   // the '*'
+    bool        more;
+
+    // Next comma-separated field; empty once the sentence runs out
+    NmeaField next() {
+        NmeaField f = { p, 0 };
+        if (!more) return f;
+        const char* c = (const char*)memchr(p, ',', (size_t)(end - p));
+        if (!c) {
+            c    = end;
+            more = false;
+        }
+        f.n = (size_t)(c - p);
+        p   = c + 1;
+        return f;
+    }
+    void skip(int n) { while (n-- > 0) next(); }
+};
+
+static bool parseUint(NmeaField f, uint32_t* out) {
+    if (f.n == 0) return false;
+    uint32_t v = 0;
+    for (size_t i = 0; i < f.n; i++) {
+        uint8_t d = (uint8_t)(f.p[i] - '0');
+        if (d > 9) return false;
+        v = v * 10 + d;
+    }
+    *out = v;
+    return true;
+}
+
+// "[-]int[.frac]" → value × 10^decimals (extra digits truncated). false if
+// empty or malformed; *ok distinguishes the two.
+static bool parseFixed(NmeaField f, uint8_t decimals, int64_t* out, bool* ok) {
+    *ok = true;
+    if (f.n == 0) return false;
+    size_t  i   = 0;
+    bool    neg = f.p[0] == '-';
+    if (neg) i++;
+    int64_t v      = 0;
+    int     frac   = -1;   // digits seen after '.', -1 before it
+    bool    digits = false;
+    for (; i < f.n; i++) {
+        char c = f.p[i];
+        if (c == '.' && frac < 0) { frac = 0; continue; }
+        uint8_t d = (uint8_t)(c - '0');
+        if (d > 9) { *ok = false; return false; }
+        digits = true;
+        if (frac >= decimals) continue;
+        v = v * 10 + d;
+        if (frac >= 0) frac++;
+    }
+    if (!digits) { *ok = false; return false; }
+    for (int k = frac < 0 ? 0 : frac; k < decimals; k++) v *= 10;
+    *out = neg ? -v : v;
+    return true;
+}
+
+// "ddmm.mmmmmmm" / "dddmm.mmmmmmm" + hemisphere → 1e-7 degrees, exact to the input
+static bool parseCoord(NmeaField f, NmeaField hemi, int32_t maxDeg, int32_t* e7, bool* ok) {
+    int64_t v;   // ddmm × 1e7
+    if (!parseFixed(f, 7, &v, ok)) return false;
+    if (v < 0) { *ok = false; return false; }
+    int64_t deg = v / 1000000000LL;
+    int64_t min = v % 1000000000LL;                  // minutes × 1e7
+    if (deg > maxDeg || min >= 600000000LL || hemi.n != 1) { *ok = false; return false; }
+    int64_t r = deg * 10000000LL + (min + 30) / 60;
+    if (hemi.p[0] == 'S' || hemi.p[0] == 'W') r = -r;
+    else if (hemi.p[0] != 'N' && hemi.p[0] != 'E') { *ok = false; return false; }
+    *e7 = (int32_t)r;
+    return true;
+}
+
+// "hhmmss[.sss]" → ms of day
+static bool parseTime(NmeaField f, uint32_t* ms, bool* ok) {
+    int64_t v;
+    if (!parseFixed(f, 3, &v, ok)) return false;
+    uint32_t hh = (uint32_t)(v / 10000000), mm = (uint32_t)(v / 100000 % 100), ss = (uint32_t)(v / 1000 % 100);
+    if (hh > 23 || mm > 59 || ss > 60) { *ok = false; return false; }
+    *ms = ((hh * 60 + mm) * 60 + ss) * 1000 + (uint32_t)(v % 1000);
+    return true;
+}
+
+static uint16_t knotsE3ToCms(int64_t kn_e3) {
+    int64_t cms = (kn_e3 * 514444 + 5000000) / 10000000;   // 1 kn = 51.4444 cm/s
+    return (uint16_t)(cms > 65535 ? 65535 : cms);
+}
+
+static uint8_t hexVal(char c) {
+    if (c >= '0' && c <= '9') return (uint8_t)(c - '0');
+    if (c >= 'A' && c <= 'F') return (uint8_t)(c - 'A' + 10);
+    if (c >= 'a' && c <= 'f') return (uint8_t)(c - 'a' + 10);
+    return 0xFF;
+}
+
+// ---------------------------------------------------------------------------
+// Sentence decoders — parse into locals, commit only when the whole sentence is sound
+// ---------------------------------------------------------------------------
+static uint8_t decodeGga(NmeaCursor& c, GpsFix* fix) {
+    bool ok = true, t;
+    uint32_t time_ms = 0, quality = 0, sats = 0;
+    int32_t  lat = 0, lon = 0;
+    int64_t  hdop = 0, alt = 0;
+
+    bool hasTime = parseTime(c.next(), &time_ms, &t);           ok &= t;
+    NmeaField la = c.next(), ns = c.next(), lo = c.next(), ew = c.next();
+    bool hasLat  = parseCoord(la, ns, 90, &lat, &t);             ok &= t || la.n == 0;
+    bool hasLon  = parseCoord(lo, ew, 180, &lon, &t);            ok &= t || lo.n == 0;
+    bool hasQ    = parseUint(c.next(), &quality);
+    bool hasSats = parseUint(c.next(), &sats);
+    bool hasHdop = parseFixed(c.next(), 2, &hdop, &t);          ok &= t;
+    bool hasAlt  = parseFixed(c.next(), 2, &alt, &t);           ok &= t;
+    if (!ok || !hasQ) return NMEA_BAD;
+
+    if (hasTime) fix->time_ms = time_ms;
+    fix->quality = (uint8_t)quality;
+    if (hasSats) fix->sats = (uint8_t)sats;
+    if (hasHdop) fix->hdop_x100 = (uint16_t)hdop;
+    if (quality == 0) {
+        fix->valid = false;
+        return NMEA_GGA;
+    }
+    if (hasLat && hasLon) {
+        fix->lat_e7 = lat;
+        fix->lon_e7 = lon;
+        fix->valid  = true;
+    }
+    if (hasAlt) fix->alt_cm = (int32_t)alt;
+    return NMEA_GGA;
+}
+
+static uint8_t decodeRmc(NmeaCursor& c, GpsFix* fix) {
+    bool ok = true, t;
+    uint32_t time_ms = 0, date = 0;
+    int32_t  lat = 0, lon = 0;
+    int64_t  sog = 0, cog = 0;
+
+    bool hasTime = parseTime(c.next(), &time_ms, &t);           ok &= t;
+    NmeaField status = c.next();
+    NmeaField la = c.next(), ns = c.next(), lo = c.next(), ew = c.next();
+    bool hasLat  = parseCoord(la, ns, 90, &lat, &t);             ok &= t || la.n == 0;
+    bool hasLon  = parseCoord(lo, ew, 180, &lon, &t);            ok &= t || lo.n == 0;
+    bool hasSog  = parseFixed(c.next(), 3, &sog, &t);           ok &= t;
+    bool hasCog  = parseFixed(c.next(), 2, &cog, &t);           ok &= t;
+    bool hasDate = parseUint(c.next(), &date);
+    if (!ok || status.n != 1) return NMEA_BAD;
+
+    if (hasTime) fix->time_ms = time_ms;
+    if (hasDate) fix->date = date;
+    fix->valid = status.p[0] == 'A';
+    if (!fix->valid) return NMEA_RMC;
+    if (hasLat && hasLon) {
+        fix->lat_e7 = lat;
+        fix->lon_e7 = lon;
+    }
+    if (hasSog) fix->sog_cms = knotsE3ToCms(sog);
+    if (hasCog) fix->cog_cdeg = (uint16_t)(cog % 36000);
+    return NMEA_RMC;
+}
+
+static uint8_t decodeVtg(NmeaCursor& c, GpsFix* fix) {
+    bool ok = true, t;
+    int64_t cog = 0, sog = 0;
+    bool hasCog = parseFixed(c.next(), 2, &cog, &t);   ok &= t;
+    c.skip(3);                                          // T, magnetic course, M
+    bool hasSog = parseFixed(c.next(), 3, &sog, &t);   ok &= t;
+    if (!ok) return NMEA_BAD;
+    if (hasCog) fix->cog_cdeg = (uint16_t)(cog % 36000);
+    if (hasSog) fix->sog_cms = knotsE3ToCms(sog);
+    return NMEA_VTG;
+}
+
+static uint8_t decodeGsa(NmeaCursor& c, GpsFix* fix) {
+    bool ok = true, t;
+    uint32_t mode = 0;
+    int64_t  pdop = 0, hdop = 0, vdop = 0;
+    c.next();                                           // M / A selection
+    bool hasMode = parseUint(c.next(), &mode);
+    c.skip(12);                                         // satellite IDs
+    bool hasP = parseFixed(c.next(), 2, &pdop, &t);    ok &= t;
+    bool hasH = parseFixed(c.next(), 2, &hdop, &t);    ok &= t;
+    bool hasV = parseFixed(c.next(), 2, &vdop, &t);    ok &= t;
+    if (!ok || !hasMode || mode < 1 || mode > 3) return NMEA_BAD;
+    fix->mode = (uint8_t)mode;
+    if (hasP) fix->pdop_x100 = (uint16_t)pdop;
+    if (hasH) fix->hdop_x100 = (uint16_t)hdop;
+    if (hasV) fix->vdop_x100 = (uint16_t)vdop;
+    return NMEA_GSA;
+}
+
+uint8_t nmea_parse(const char* s, size_t len, uint8_t types, GpsFix* fix) {
+    // "$ttsss," … "*hh": at least talker + type + checksum
+    if (len < 10 || s[0] != '$' || s[len - 3] != '*') return NMEA_BAD;
+    if (s[1] == 'P' || s[6] != ',') return NMEA_IGNORED;   // proprietary
+
+    // Type first: unwanted sentences (GSV, GLL, ...) are most of the bytes and
+    // are dropped without summing them
+    const char* t = s + 3;
+    uint8_t type = NMEA_IGNORED;
+    if      (t[0] == 'G' && t[1] == 'G' && t[2] == 'A') type = NMEA_GGA;
+    else if (t[0] == 'R' && t[1] == 'M' && t[2] == 'C') type = NMEA_RMC;
+    else if (t[0] == 'V' && t[1] == 'T' && t[2] == 'G') type = NMEA_VTG;
+    else if (t[0] == 'G' && t[1] == 'S' && t[2] == 'A') type = NMEA_GSA;
+    if (!(type & types)) return NMEA_IGNORED;
+
+    uint8_t sum = 0;
+    for (size_t i = 1; i < len - 3; i++) sum ^= (uint8_t)s[i];
+    uint8_t hi = hexVal(s[len - 2]), lo = hexVal(s[len - 1]);
+    if (hi > 15 || lo > 15 || sum != (uint8_t)(hi << 4 | lo)) return NMEA_BAD;
+
+    NmeaCursor c = { s + 7, s + len - 3, true };
+    switch (type) {
+        case NMEA_GGA: return decodeGga(c, fix);
+        case NMEA_RMC: return decodeRmc(c, fix);
+        case NMEA_VTG: return decodeVtg(c, fix);
+        default:       return decodeGsa(c, fix);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// NmeaReader
+// ---------------------------------------------------------------------------
+NmeaReader::NmeaReader(uint8_t port, uint8_t types)
+    : port(port), wanted(types), gps(), st(), partial(), partialLen(0), skipping(false),
+      echoPort(0), echoPerS(0), echoTokens(0), echoRefillMs(0) {}
+
+void NmeaReader::setEcho(uint8_t p, uint16_t per_s) {
+    echoPort     = p;
+    echoPerS     = per_s;
+    echoTokens   = per_s;
+    echoRefillMs = hal_millis();
+}
+
+uint8_t NmeaReader::poll() {
+    uint8_t mask = 0;
+    uint8_t rx[NMEA_RX_CHUNK];
+    size_t  n;
+    while ((n = hal_uart_read_bytes(port, rx, sizeof(rx))) > 0) mask |= consume((const char*)rx, n);
+    return mask;
+}
+
+uint8_t NmeaReader::consume(const char* data, size_t len) {
+    st.bytes += (uint32_t)len;
+    uint8_t     mask = 0;
+    const char* p    = data;
+    const char* end  = data + len;
+    while (p < end) {
+        const char* nl = (const char*)memchr(p, '\n', (size_t)(end - p));
+        size_t      n  = (size_t)((nl ? nl : end) - p);
+
+        if (skipping || partialLen + n > NMEA_MAX_SENTENCE + 1) {   // + '\r'
+            if (!skipping) st.overflows++;
+            skipping   = nl == nullptr;
+            partialLen = 0;
+        } else if (!nl) {
+            memcpy(partial + partialLen, p, n);   // finished by the next chunk
+            partialLen = (uint8_t)(partialLen + n);
+        } else if (partialLen) {
+            memcpy(partial + partialLen, p, n);
+            mask |= sentence(partial, partialLen + n);
+            partialLen = 0;
+        } else {
+            mask |= sentence(p, n);               // in place
+        }
+        if (!nl) break;
+        p = nl + 1;
+    }
+    return mask;
+}
+
+uint8_t NmeaReader::sentence(const char* s, size_t len) {
+    if (len && s[len - 1] == '\r') len--;
+    const char* start = (const char*)memchr(s, '$', len);   // line noise before '$'
+    if (!start) return 0;
+    len -= (size_t)(start - s);
+
+    uint8_t r = nmea_parse(start, len, wanted, &gps);
+    if (echoPerS) echo(start, len);
+    if (r == NMEA_BAD) {
+        st.bad++;
+        return 0;
+    }
+    st.sentences++;
+    if (r == NMEA_IGNORED) {
+        st.ignored++;
+        return 0;
+    }
+    for (uint8_t i = 0; i < NMEA_TYPE_COUNT; i++) {
+        if (r == (1u << i)) st.decoded[i]++;
+    }
+    gps.updated |= r;
+    gps.rx_ms    = hal_millis();
+    gps.source   = GPS_SRC_NMEA;
+    return r;
+}
+
+void NmeaReader::echo(const char* s, size_t len) {
+    uint32_t now = hal_millis();
+    uint32_t add = (now - echoRefillMs) * echoPerS / 1000;
+    if (add) {
+        echoTokens    = (uint16_t)(echoTokens + add > echoPerS ? echoPerS : echoTokens + add);
+        echoRefillMs += add * 1000 / echoPerS;
+    }
+    if (!echoTokens) {
+        st.echo_dropped++;
+        return;
+    }
+    echoTokens--;
+    static const uint8_t CRLF[] = { '\r', '\n' };
+    hal_uart_write(echoPort, (const uint8_t*)s, len);
+    hal_uart_write(echoPort, CRLF, sizeof(CRLF));
+    st.echoed++;
+}
@@ -0,0 +1,100 @@
+#ifndef NMEA_H
+#define NMEA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/gps/gps_fix.h"
+
+// ---------------------------------------------------------------------------
+// GPS NMEA ingestion — bulk UART reads, sentences parsed in place
+//
+//   UART driver RX buffer ──hal_uart_read_bytes()──► rx chunk (one copy)
+//        │  (ESP32: filled by the UART ISR/FIFO; onReceive() fires at the
+//        │   end of each burst, so poll() runs once per GPS epoch)
+//        ▼
+//   consume(): find '\n' with memchr, hand each "$...*hh" slice to
+//   nmea_parse() where it lies — only a sentence split across two chunks is
+//   carried over (≤ NMEA_MAX_SENTENCE bytes)
+//        ▼
+//   nmea_parse(): the 3-letter type first — everything not wanted (GSV, GLL,
+//   TXT: most of the bytes) is dropped unread — then checksum, then the
+//   wanted types only (GGA, RMC; VTG, GSA on request) decoded field by field
+//   with integer fixed-point: no strtok, no atof, no per-byte state machine.
+//
+// Coordinates come out as 1e-7 degrees computed exactly from the NMEA
+// minutes (up to 7 decimals) — the units geodesy.h and position.h work in,
+// with no float rounding on the way. Optional echo of raw sentences (debug)
+// goes to another UART port straight from the slice, rate-limited by a
+// token bucket so a USB monitor never throttles ingestion.
+// ---------------------------------------------------------------------------
+
+#define NMEA_MAX_SENTENCE   96      // 82 per NMEA 0183, headroom for high-precision fields
+#define NMEA_RX_CHUNK       256     // bytes per hal_uart_read_bytes()
+
+// Sentence types (bit mask)
+#define NMEA_GGA            0x01
+#define NMEA_RMC            0x02
+#define NMEA_VTG            0x04
+#define NMEA_GSA            0x08
+#define NMEA_TYPES_DEFAULT  (NMEA_GGA | NMEA_RMC)
+#define NMEA_TYPE_COUNT     4
+
+// nmea_parse() results besides a type bit
+#define NMEA_IGNORED        0x00    // valid sentence, type not wanted
+#define NMEA_BAD            0x80    // framing, checksum or field error
+
+struct NmeaStats {
+    uint32_t bytes;
+    uint32_t sentences;        // framed and not bad
+    uint32_t decoded[NMEA_TYPE_COUNT];   // GGA, RMC, VTG, GSA
+    uint32_t ignored;          // other types (not checksummed)
+    uint32_t bad;              // checksum / field errors in wanted types
+    uint32_t overflows;        // line longer than NMEA_MAX_SENTENCE
+    uint32_t echoed;
+    uint32_t echo_dropped;     // over the echo rate
+};
+
+// Decode one sentence: s points at '$', len excludes CR/LF. Only types in
+// `types` touch fix. Returns the type bit decoded, NMEA_IGNORED or NMEA_BAD.
+uint8_t nmea_parse(const char* s, size_t len, uint8_t types, GpsFix* fix);
+
+class NmeaReader {
+public:
+    explicit NmeaReader(uint8_t port = HAL_GPS_UART, uint8_t types = NMEA_TYPES_DEFAULT);
+
+    void setTypes(uint8_t types) { wanted = types; }
+
+    // Copy raw sentences to another UART, at most per_s per second (0: off)
+    void setEcho(uint8_t port, uint16_t per_s);
+
+    // Drain the UART; returns the types decoded during this call
+    uint8_t poll();
+
+    // Parse bytes already in memory (recorded logs, another transport)
+    uint8_t consume(const char* data, size_t len);
+
+    const GpsFix& fix() const { return gps; }
+    GpsFix&       fix()       { return gps; }
+    NmeaStats     stats() const { return st; }
+
+private:
+    uint8_t sentence(const char* s, size_t len);
+    void    echo(const char* s, size_t len);
+
+    uint8_t   port;
+    uint8_t   wanted;
+    GpsFix    gps;
+    NmeaStats st;
+
+    char      partial[NMEA_MAX_SENTENCE + 2];   // sentence split across chunks, + CR
+    uint8_t   partialLen;
+    bool      skipping;                     // overflowed: drop to the next '\n'
+
+    uint8_t   echoPort;
+    uint16_t  echoPerS;
+    uint16_t  echoTokens;
+    uint32_t  echoRefillMs;
+};
+
+#endif // NMEA_H
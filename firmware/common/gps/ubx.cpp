@@ -0,0 +1,290 @@
+#include "ubx.h"
+#include <string.h>
+
+// ---------------------------------------------------------------------------
+// Frames
+// ---------------------------------------------------------------------------
+static uint16_t u2(const uint8_t* p) { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t u4(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+static int32_t  i4(const uint8_t* p) { return (int32_t)u4(p); }
+
+static int16_t clampI16(int32_t v) { return (int16_t)(v > 32767 ? 32767 : v < -32768 ? -32768 : v); }
+static uint16_t clampU16(uint32_t v) { return (uint16_t)(v > 65535 ? 65535 : v); }
+
+void ubx_checksum(const uint8_t* p, size_t len, uint8_t* ck_a, uint8_t* ck_b) {
+    uint8_t a = 0, b = 0;
+    for (size_t i = 0; i < len; i++) {
+        a = (uint8_t)(a + p[i]);
+        b = (uint8_t)(b + a);
+    }
+    *ck_a = a;
+    *ck_b = b;
+}
+
+size_t ubx_frame(uint8_t* out, size_t max, uint16_t msg, const uint8_t* payload, uint16_t len) {
+    size_t total = (size_t)len + UBX_OVERHEAD;
+    if (total > max) return 0;
+    out[0] = UBX_SYNC1;
+    out[1] = UBX_SYNC2;
+    out[2] = (uint8_t)(msg >> 8);
+    out[3] = (uint8_t)msg;
+    out[4] = (uint8_t)len;
+    out[5] = (uint8_t)(len >> 8);
+    if (len) memcpy(out + UBX_HEADER, payload, len);
+    ubx_checksum(out + 2, (size_t)len + 4, &out[total - 2], &out[total - 1]);
+    return total;
+}
+
+// CFG-VALSET key/value pairs (key size is in bits 28..30: 1 = bit, 2 = U1, 3 = U2)
+static uint8_t* putKey(uint8_t* p, uint32_t key, uint16_t value) {
+    for (int i = 0; i < 4; i++) *p++ = (uint8_t)(key >> (8 * i));
+    *p++ = (uint8_t)value;
+    if ((key >> 28 & 7) == 3) *p++ = (uint8_t)(value >> 8);
+    return p;
+}
+
+size_t ubx_config_frame(uint8_t* out, size_t max, uint8_t rate_hz) {
+    if (rate_hz < 1) rate_hz = 1;
+    if (rate_hz > UBX_RATE_MAX_HZ) rate_hz = UBX_RATE_MAX_HZ;
+    uint8_t  payload[UBX_CONFIG_FRAME - UBX_OVERHEAD];
+    uint8_t* p = payload;
+    *p++ = 0;      // version
+    *p++ = 0x01;   // layers: RAM only — a power cycle restores NMEA
+    *p++ = 0;
+    *p++ = 0;
+    p = putKey(p, 0x30210001, (uint16_t)(1000 / rate_hz));   // CFG-RATE-MEAS, ms
+    p = putKey(p, 0x30210002, 1);                            // CFG-RATE-NAV: every measurement
+    p = putKey(p, 0x10740001, 1);                            // CFG-UART1OUTPROT-UBX
+    p = putKey(p, 0x10740002, 0);                            // CFG-UART1OUTPROT-NMEA
+    p = putKey(p, 0x20910007, 1);                            // CFG-MSGOUT-UBX_NAV_PVT_UART1
+    p = putKey(p, 0x20910039, rate_hz);                      // CFG-MSGOUT-UBX_NAV_DOP_UART1: 1 Hz
+    return ubx_frame(out, max, UBX_CFG_VALSET, payload, (uint16_t)(p - payload));
+}
+
+// ---------------------------------------------------------------------------
+// Payload decoders
+// ---------------------------------------------------------------------------
+static uint8_t decodePvt(const uint8_t* p, GpsFix* fix) {
+    uint8_t fixType = p[20], flags = p[21];
+    int32_t lon = i4(p + 24), lat = i4(p + 28);
+    if (fixType > 5 || lat < -900000000 || lat > 900000000 || lon < -1800000000 || lon > 1800000000) return UBX_BAD;
+
+    uint8_t validBits = p[11];
+    if (validBits & 0x02) {   // validTime
+        uint8_t hh = p[8], mm = p[9], ss = p[10];
+        if (hh > 23 || mm > 59 || ss > 60) return UBX_BAD;
+        int32_t nano = i4(p + 16);   // may be negative: true time is hh:mm:ss + nano
+        int32_t ms   = (int32_t)(((hh * 60u + mm) * 60u + ss) * 1000u) +
+                       (nano >= 0 ? nano / 1000000 : -((-nano + 999999) / 1000000));
+        fix->time_ms = (uint32_t)(ms < 0 ? ms + 86400000 : ms);
+    }
+    if (validBits & 0x01) fix->date = p[7] * 10000u + p[6] * 100u + u2(p + 4) % 100;   // ddmmyy
+
+    bool    fixOk = flags & 0x01;
+    uint8_t carr  = flags >> 6;
+    fix->sats      = p[23];
+    fix->mode      = fixType == 2 ? 2 : (fixType == 3 || fixType == 4) ? 3 : 1;
+    fix->pdop_x100 = u2(p + 76);
+    fix->valid     = fixOk && fixType >= 2 && fixType <= 4;
+    fix->quality   = !fixOk || fixType == 0 || fixType == 5 ? 0
+                   : fixType == 1                           ? 6
+                   : carr == 2                              ? 4
+                   : carr == 1                              ? 5
+                   : flags & 0x02                           ? 2 : 1;
+    if (!fix->valid) return UBX_PVT;
+
+    fix->lat_e7        = lat;
+    fix->lon_e7        = lon;
+    fix->alt_cm        = i4(p + 36) / 10;
+    fix->h_acc_mm      = u4(p + 40);
+    fix->vel_n_cms     = clampI16(i4(p + 48) / 10);
+    fix->vel_e_cms     = clampI16(i4(p + 52) / 10);
+    fix->vel_d_cms     = clampI16(i4(p + 56) / 10);
+    int32_t gSpeed     = i4(p + 60);
+    fix->sog_cms       = clampU16(gSpeed > 0 ? (uint32_t)gSpeed / 10 : 0);
+    int32_t head       = i4(p + 64) / 1000 % 36000;   // 1e-5° → 0.01°
+    fix->cog_cdeg      = (uint16_t)(head < 0 ? head + 36000 : head);
+    fix->head_acc_cdeg = clampU16(u4(p + 72) / 1000);
+    return UBX_PVT;
+}
+
+static uint8_t decodeDop(const uint8_t* p, GpsFix* fix) {
+    fix->pdop_x100 = u2(p + 6);
+    fix->vdop_x100 = u2(p + 10);
+    fix->hdop_x100 = u2(p + 12);
+    return UBX_DOP;
+}
+
+uint8_t ubx_decode(uint16_t msg, const uint8_t* payload, uint16_t len, GpsFix* fix) {
+    switch (msg) {
+        case UBX_NAV_PVT: return len == UBX_NAV_PVT_LEN ? decodePvt(payload, fix) : UBX_BAD;
+        case UBX_NAV_DOP: return len == UBX_NAV_DOP_LEN ? decodeDop(payload, fix) : UBX_BAD;
+        default:          return UBX_IGNORED;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// UbxReader
+// ---------------------------------------------------------------------------
+UbxReader::UbxReader(uint8_t port)
+    : port(port), rateHz(0), src(GPS_SRC_NMEA), refused(false), gps(), nmea(port), st(), partial(),
+      partialLen(0), frameLen(0), skip(0), lostMs(UBX_LOST_MIN_MS), lastPvtMs(0), lastConfigMs(0) {
+    gps.source = GPS_SRC_UBX;
+}
+
+void UbxReader::begin(uint8_t rate_hz) {
+    rateHz  = rate_hz > UBX_RATE_MAX_HZ ? UBX_RATE_MAX_HZ : rate_hz;
+    refused = false;
+    if (!rateHz) return;
+    uint32_t lost = UBX_LOST_EPOCHS * 1000u / rateHz;
+    lostMs = lost > UBX_LOST_MIN_MS ? lost : UBX_LOST_MIN_MS;
+    configure();
+}
+
+void UbxReader::configure() {
+    uint8_t f[UBX_CONFIG_FRAME];
+    size_t  n = ubx_config_frame(f, sizeof(f), rateHz);
+    hal_uart_write(port, f, n);
+    lastConfigMs = hal_millis();
+    st.configs++;
+}
+
+uint8_t UbxReader::poll() {
+    uint8_t mask = 0;
+    uint8_t rx[NMEA_RX_CHUNK];
+    size_t  n;
+    while ((n = hal_uart_read_bytes(port, rx, sizeof(rx))) > 0) mask |= consume(rx, n);
+    checkSource();
+    return mask;
+}
+
+uint8_t UbxReader::consume(const uint8_t* data, size_t len) {
+    st.bytes += (uint32_t)len;
+    uint8_t        mask = 0;
+    const uint8_t* p    = data;
+    const uint8_t* end  = data + len;
+    while (p < end) {
+        size_t avail = (size_t)(end - p);
+        if (skip) {                                   // unbuffered long frame
+            size_t k = avail < skip ? avail : skip;
+            skip = (uint16_t)(skip - k);
+            p += k;
+            continue;
+        }
+        if (partialLen) {                             // frame split across reads
+            size_t want = (frameLen ? frameLen : UBX_HEADER) - partialLen;
+            size_t k    = avail < want ? avail : want;
+            memcpy(partial + partialLen, p, k);
+            partialLen = (uint16_t)(partialLen + k);
+            p += k;
+            if (!frameLen && partialLen == UBX_HEADER) {
+                uint16_t n = u2(partial + 4);
+                if (partial[1] != UBX_SYNC2 || n > UBX_SANE_PAYLOAD) {
+                    st.bad += partial[1] == UBX_SYNC2;
+                    partialLen = 0;
+                } else if (n > UBX_MAX_PAYLOAD) {
+                    st.ignored++;
+                    skip       = (uint16_t)(n + 2);
+                    partialLen = 0;
+                } else {
+                    frameLen = (uint16_t)(n + UBX_OVERHEAD);
+                }
+            }
+            if (frameLen && partialLen == frameLen) {
+                mask |= frame(partial, frameLen);
+                partialLen = frameLen = 0;
+            }
+            continue;
+        }
+
+        const uint8_t* s = (const uint8_t*)memchr(p, UBX_SYNC1, avail);
+        if (!s) {
+            mask |= nmea.consume((const char*)p, avail);
+            break;
+        }
+        if (s > p) mask |= nmea.consume((const char*)p, (size_t)(s - p));
+        p     = s;
+        avail = (size_t)(end - p);
+        if (avail < UBX_HEADER) {                     // header split: finish it next read
+            memcpy(partial, p, avail);
+            partialLen = (uint16_t)avail;
+            break;
+        }
+        uint16_t n = u2(p + 4);
+        if (p[1] != UBX_SYNC2 || n > UBX_SANE_PAYLOAD) {   // line noise, not a frame
+            st.bad += p[1] == UBX_SYNC2;
+            p += p[1] == UBX_SYNC2 ? 2 : 1;
+            continue;
+        }
+        if (n > UBX_MAX_PAYLOAD) {
+            st.ignored++;
+            skip = (uint16_t)(n + UBX_OVERHEAD);
+            continue;
+        }
+        size_t total = (size_t)n + UBX_OVERHEAD;
+        if (avail >= total) {
+            mask |= frame(p, total);                  // in place
+            p += total;
+        } else {
+            memcpy(partial, p, avail);
+            partialLen = (uint16_t)avail;
+            frameLen   = (uint16_t)total;
+            break;
+        }
+    }
+    return mask;
+}
+
+uint8_t UbxReader::frame(const uint8_t* f, size_t len) {
+    uint8_t a, b;
+    ubx_checksum(f + 2, len - 4, &a, &b);
+    if (a != f[len - 2] || b != f[len - 1]) {
+        st.bad++;
+        return 0;
+    }
+    st.frames++;
+    uint16_t       msg = (uint16_t)(f[2] << 8 | f[3]);
+    uint16_t       n   = (uint16_t)(len - UBX_OVERHEAD);
+    const uint8_t* pl  = f + UBX_HEADER;
+
+    if (msg == UBX_ACK_ACK || msg == UBX_ACK_NAK) {
+        if (n == 2 && (uint16_t)(pl[0] << 8 | pl[1]) == UBX_CFG_VALSET) {
+            if (msg == UBX_ACK_ACK) {
+                st.acks++;
+            } else {
+                st.naks++;
+                refused = true;
+            }
+        }
+        return 0;
+    }
+
+    uint8_t r = ubx_decode(msg, pl, n, &gps);
+    if (r == UBX_BAD) {
+        st.bad++;
+        return 0;
+    }
+    if (r == UBX_IGNORED) {
+        st.ignored++;
+        return 0;
+    }
+    gps.updated |= r;
+    gps.rx_ms    = hal_millis();
+    if (r == UBX_PVT) {
+        st.pvt++;
+        lastPvtMs = gps.rx_ms;
+        src       = GPS_SRC_UBX;
+    } else {
+        st.dop++;
+    }
+    return r;
+}
+
+void UbxReader::checkSource() {
+    uint32_t now = hal_millis();
+    if (src == GPS_SRC_UBX && now - lastPvtMs > lostMs) {
+        src = GPS_SRC_NMEA;
+        st.fallbacks++;
+    }
+    if (src == GPS_SRC_NMEA && rateHz && !refused && now - lastConfigMs >= UBX_RETRY_MS) configure();
+}
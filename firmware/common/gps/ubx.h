@@ -0,0 +1,134 @@
+#ifndef UBX_H
+#define UBX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/gps/gps_fix.h"
+#include "firmware/common/gps/nmea.h"
+
+// ---------------------------------------------------------------------------
+// UBX binary GPS — NAV-PVT at up to 25 Hz, NMEA fallback on the same UART
+//
+//   begin(rate): CFG-VALSET (RAM layer only) → measurement rate, UBX out,
+//   NMEA out off, NAV-PVT every epoch, NAV-DOP once a second
+//
+//   UART bytes ──consume()──┬─ 0xB5 0x62 … ──► frame: Fletcher-8 check, then
+//                           │                  NAV-PVT / NAV-DOP decoded in place
+//                           │                  (a frame split across reads is
+//                           │                  carried over, ≤ UBX_MAX_PAYLOAD)
+//                           └─ anything else ─► NmeaReader (text between frames)
+//
+// 0xB5 never occurs in NMEA text, so one stream carries both. NAV-PVT is
+// all integers — lat/lon 1e-7°, NED velocity mm/s, heading of motion 1e-5° —
+// copied into GpsFix with no text parsing at all.
+//
+// Fallback: source() is GPS_SRC_UBX while NAV-PVT keeps arriving. After
+// UBX_LOST_EPOCHS missed epochs (at least UBX_LOST_MIN_MS) it drops back to
+// the NMEA fix; since the config lives in RAM, a module that browned out
+// comes back talking NMEA, so the config is re-sent every UBX_RETRY_MS until
+// NAV-PVT resumes. A NAK (firmware without CFG-VALSET) stops the retries and
+// the reader stays on NMEA.
+//
+// BE-880 (u-blox M10): 25 Hz needs a reduced constellation set (GPS +
+// Galileo); with all four the navigation rate tops out around 10 Hz and the
+// module simply outputs at its own rate.
+// ---------------------------------------------------------------------------
+
+#define UBX_SYNC1           0xB5
+#define UBX_SYNC2           0x62
+#define UBX_HEADER          6       // sync ×2, class, id, length (LE)
+#define UBX_OVERHEAD        8       // + CK_A, CK_B
+#define UBX_MAX_PAYLOAD     100     // frames buffered/decoded (NAV-PVT is 92)
+#define UBX_SANE_PAYLOAD    1024    // longer lengths are taken as a false sync
+
+#define UBX_RATE_MAX_HZ     25
+#define UBX_LOST_EPOCHS     5
+#define UBX_LOST_MIN_MS     300
+#define UBX_RETRY_MS        5000
+
+// Messages: class << 8 | id
+#define UBX_NAV_PVT         0x0107
+#define UBX_NAV_DOP         0x0104
+#define UBX_ACK_NAK         0x0500
+#define UBX_ACK_ACK         0x0501
+#define UBX_CFG_VALSET      0x068A
+
+#define UBX_NAV_PVT_LEN     92
+#define UBX_NAV_DOP_LEN     18
+#define UBX_CONFIG_FRAME    44      // ubx_config_frame() size
+
+// ubx_decode() results — GpsFix::updated bits above the NMEA_* ones
+#define UBX_PVT             0x10
+#define UBX_DOP             0x20
+#define UBX_IGNORED         0x00
+#define UBX_BAD             0x80
+
+struct UbxStats {
+    uint32_t bytes;
+    uint32_t frames;           // checksum passed
+    uint32_t pvt;
+    uint32_t dop;
+    uint32_t acks;
+    uint32_t naks;
+    uint32_t ignored;          // other messages, or longer than UBX_MAX_PAYLOAD
+    uint32_t bad;              // checksum / length / field errors
+    uint32_t configs;          // CFG-VALSET sent
+    uint32_t fallbacks;        // UBX → NMEA
+};
+
+// Fletcher-8 over class, id, length and payload (p points at the class byte)
+void ubx_checksum(const uint8_t* p, size_t len, uint8_t* ck_a, uint8_t* ck_b);
+
+// Build a complete frame; returns its size, 0 if it does not fit in max
+size_t ubx_frame(uint8_t* out, size_t max, uint16_t msg, const uint8_t* payload, uint16_t len);
+
+// CFG-VALSET for NAV-PVT at rate_hz (clamped to 1..UBX_RATE_MAX_HZ), UBX_CONFIG_FRAME bytes
+size_t ubx_config_frame(uint8_t* out, size_t max, uint8_t rate_hz);
+
+// Decode a checked payload. Returns UBX_PVT / UBX_DOP, UBX_IGNORED or UBX_BAD.
+uint8_t ubx_decode(uint16_t msg, const uint8_t* payload, uint16_t len, GpsFix* fix);
+
+class UbxReader {
+public:
+    explicit UbxReader(uint8_t port = HAL_GPS_UART);
+
+    // Configure the module for NAV-PVT at rate_hz; 0 leaves it on NMEA
+    void begin(uint8_t rate_hz);
+
+    // Drain the UART; returns the UBX_* / NMEA_* bits decoded during this call
+    uint8_t poll();
+
+    // Feed bytes already in memory (captures, another transport)
+    uint8_t consume(const uint8_t* data, size_t len);
+
+    uint8_t       source() const { return src; }
+    const GpsFix& fix() const    { return src == GPS_SRC_UBX ? gps : nmea.fix(); }
+    GpsFix&       fix()          { return src == GPS_SRC_UBX ? gps : nmea.fix(); }
+    NmeaReader&   text()         { return nmea; }   // fallback reader (types, echo)
+    UbxStats      stats() const  { return st; }
+
+private:
+    uint8_t frame(const uint8_t* f, size_t len);
+    void    configure();
+    void    checkSource();
+
+    uint8_t    port;
+    uint8_t    rateHz;
+    uint8_t    src;
+    bool       refused;           // NAK'd: stay on NMEA
+    GpsFix     gps;
+    NmeaReader nmea;
+    UbxStats   st;
+
+    uint8_t    partial[UBX_MAX_PAYLOAD + UBX_OVERHEAD];   // frame split across reads
+    uint16_t   partialLen;
+    uint16_t   frameLen;          // total of the partial frame once its header is in
+    uint16_t   skip;              // bytes left of a frame too long to buffer
+
+    uint32_t   lostMs;
+    uint32_t   lastPvtMs;
+    uint32_t   lastConfigMs;
+};
+
+#endif // UBX_H
@@ -0,0 +1,248 @@
+#ifndef HAL_H
+#define HAL_H
+
+// ---------------------------------------------------------------------------
+// Thin hardware abstraction layer
+//
+// Shared logic under firmware/common/ calls hal_*() instead of the Arduino API
+// so the same source builds as an ESP32-S3 sketch and as a Linux binary
+// ([env:native] in platformio.ini).
+//
+//   ARDUINO defined → inline wrappers over the Arduino core (no call overhead)
+//   otherwise       → deterministic stand-ins in hal_host.cpp, scripted through
+//                     hal_host.h (virtual clock, queued echo pulses, fake I2C
+//                     devices, UART byte feeds)
+//
+// Edge interrupts and one-shot µs timers (hal_attach_change_isr, HalTimer)
+// let drivers capture timing without blocking: on target they map to
+// attachInterruptArg and esp_timer; on host, scripted edges and timers fire
+// from the virtual clock as it advances.
+//
+// The SPI radio is a class interface (HalRadio in hal_radio.h) because
+// RadioHead itself is class-based.
+//
+// hal_nvs_read/write keep small blobs across reboots: Preferences (NVS flash)
+// under HAL_NVS_NAMESPACE on target, an in-memory store on host that
+// hal_host_reset() leaves alone, so a "reboot" in a host scenario keeps it.
+// Keys are at most HAL_NVS_KEY_MAX characters (the NVS limit). hal_nvs_size()
+// lets a reader size its buffer for a blob whose length changed between
+// firmware versions.
+//
+// hal_flash_* address a raw data partition (HAL_FLASH_PARTITION, see
+// partitions_recorder.csv) with NOR rules: erase sets a HAL_FLASH_SECTOR to
+// 0xFF, a write can only clear bits. On host the partition is an in-memory
+// image that, like NVS, survives hal_host_reset(); erase and program cost
+// virtual time at typical SPI NOR rates.
+// ---------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HAL_LOW          0
+#define HAL_HIGH         1
+#define HAL_UART_PORTS   3   // ESP32-S3: UART0 (USB CDC), UART1 (GPS), UART2
+#define HAL_GPS_UART     1
+#define HAL_NVS_NAMESPACE "buoy"
+#define HAL_NVS_KEY_MAX  15
+#define HAL_FLASH_PARTITION "rec"
+#define HAL_FLASH_SECTOR 4096
+#define HAL_FLASH_PAGE   256   // largest single program operation
+
+typedef void (*HalIsr)(void* arg);   // edge interrupt / timer callback
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <Wire.h>
+#include <esp_partition.h>
+#include <esp_timer.h>
+
+#define HAL_ISR_ATTR  IRAM_ATTR   // interrupt handlers and everything they call
+
+// UART ports are bound once in setup(), e.g. hal_uart_bind(HAL_GPS_UART, &GPSSerial)
+inline Stream* hal_uart_ports[HAL_UART_PORTS] = {};
+
+static inline void     hal_uart_bind(uint8_t port, Stream* s) { hal_uart_ports[port] = s; }
+
+static inline uint32_t hal_millis()                            { return millis(); }
+static inline uint32_t hal_micros()                            { return micros(); }
+static inline void     hal_delay_ms(uint32_t ms)               { delay(ms); }
+static inline void     hal_delay_us(uint32_t us)               { delayMicroseconds(us); }
+static inline void     hal_digital_write(uint8_t pin, uint8_t level) { digitalWrite(pin, level); }
+static inline int      hal_digital_read(uint8_t pin)           { return digitalRead(pin); }
+static inline uint16_t hal_analog_read(uint8_t pin)            { return (uint16_t)analogRead(pin); }
+
+static inline uint32_t hal_pulse_in(uint8_t pin, uint8_t level, uint32_t timeout_us) {
+    return pulseIn(pin, level, timeout_us);
+}
+
+// Interrupt on both edges (or the falling edge) of pin; isr runs in interrupt context
+static inline void hal_attach_change_isr(uint8_t pin, HalIsr isr, void* arg) {
+    attachInterruptArg(digitalPinToInterrupt(pin), isr, arg, CHANGE);
+}
+static inline void hal_attach_falling_isr(uint8_t pin, HalIsr isr, void* arg) {
+    attachInterruptArg(digitalPinToInterrupt(pin), isr, arg, FALLING);
+}
+static inline void hal_detach_isr(uint8_t pin) { detachInterrupt(digitalPinToInterrupt(pin)); }
+
+// One-shot timer. The callback runs in the esp_timer task (highest-priority
+// task, not an ISR); start/stop may be called from an ISR.
+struct HalTimer {
+    esp_timer_handle_t handle;
+};
+
+static inline bool hal_timer_init(HalTimer* t, HalIsr cb, void* arg) {
+    esp_timer_create_args_t args = {};
+    args.callback        = cb;
+    args.arg             = arg;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name            = "hal";
+    return esp_timer_create(&args, &t->handle) == ESP_OK;
+}
+
+static inline void hal_timer_start_once(HalTimer* t, uint32_t us) {   // re-arms if running
+    esp_timer_stop(t->handle);
+    esp_timer_start_once(t->handle, us);
+}
+
+static inline void hal_timer_stop(HalTimer* t) { esp_timer_stop(t->handle); }
+
+static inline bool hal_i2c_probe(uint8_t addr) {
+    Wire.beginTransmission(addr);
+    return Wire.endTransmission() == 0;
+}
+
+static inline bool hal_i2c_write(uint8_t addr, const uint8_t* data, size_t len) {
+    Wire.beginTransmission(addr);
+    Wire.write(data, len);
+    return Wire.endTransmission() == 0;
+}
+
+static inline bool hal_i2c_read(uint8_t addr, uint8_t* data, size_t len) {
+    if ((size_t)Wire.requestFrom((int)addr, (int)len) != len) return false;
+    for (size_t i = 0; i < len; i++) data[i] = (uint8_t)Wire.read();
+    return true;
+}
+
+static inline int hal_uart_available(uint8_t port) {
+    return hal_uart_ports[port] ? hal_uart_ports[port]->available() : 0;
+}
+
+static inline int hal_uart_read(uint8_t port) {
+    return hal_uart_ports[port] ? hal_uart_ports[port]->read() : -1;
+}
+
+// Up to max bytes already received, in one copy out of the driver's RX buffer; never waits
+static inline size_t hal_uart_read_bytes(uint8_t port, uint8_t* data, size_t max) {
+    Stream* s = hal_uart_ports[port];
+    int     n = s ? s->available() : 0;
+    if (n <= 0) return 0;
+    return s->readBytes(data, (size_t)n < max ? (size_t)n : max);
+}
+
+static inline size_t hal_uart_write(uint8_t port, const uint8_t* data, size_t len) {
+    return hal_uart_ports[port] ? hal_uart_ports[port]->write(data, len) : 0;
+}
+
+// Whole blob or nothing: a stored blob of another size reads as missing
+static inline bool hal_nvs_read(const char* key, void* data, size_t len) {
+    Preferences prefs;
+    if (!prefs.begin(HAL_NVS_NAMESPACE, true)) return false;
+    bool ok = prefs.getBytesLength(key) == len && prefs.getBytes(key, data, len) == len;
+    prefs.end();
+    return ok;
+}
+
+// Stored length of key, 0 if missing
+static inline size_t hal_nvs_size(const char* key) {
+    Preferences prefs;
+    if (!prefs.begin(HAL_NVS_NAMESPACE, true)) return 0;
+    size_t len = prefs.isKey(key) ? prefs.getBytesLength(key) : 0;
+    prefs.end();
+    return len;
+}
+
+static inline bool hal_nvs_write(const char* key, const void* data, size_t len) {
+    Preferences prefs;
+    if (!prefs.begin(HAL_NVS_NAMESPACE, false)) return false;
+    bool ok = prefs.putBytes(key, data, len) == len;
+    prefs.end();
+    return ok;
+}
+
+static inline const esp_partition_t* hal_flash_partition() {
+    static const esp_partition_t* part =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, HAL_FLASH_PARTITION);
+    return part;
+}
+
+// Partition size in bytes, 0 if the partition table has none
+static inline uint32_t hal_flash_size() {
+    return hal_flash_partition() ? hal_flash_partition()->size : 0;
+}
+
+static inline bool hal_flash_read(uint32_t addr, void* data, size_t len) {
+    return hal_flash_partition() && esp_partition_read(hal_flash_partition(), addr, data, len) == ESP_OK;
+}
+
+// addr and len multiples of HAL_FLASH_SECTOR
+static inline bool hal_flash_erase(uint32_t addr, uint32_t len) {
+    return hal_flash_partition() && esp_partition_erase_range(hal_flash_partition(), addr, len) == ESP_OK;
+}
+
+static inline bool hal_flash_write(uint32_t addr, const void* data, size_t len) {
+    return hal_flash_partition() && esp_partition_write(hal_flash_partition(), addr, data, len) == ESP_OK;
+}
+
+#else  // host
+
+#define HAL_ISR_ATTR
+
+uint32_t hal_millis();
+uint32_t hal_micros();
+void     hal_delay_ms(uint32_t ms);
+void     hal_delay_us(uint32_t us);
+void     hal_digital_write(uint8_t pin, uint8_t level);
+int      hal_digital_read(uint8_t pin);
+uint16_t hal_analog_read(uint8_t pin);
+uint32_t hal_pulse_in(uint8_t pin, uint8_t level, uint32_t timeout_us);
+
+void     hal_attach_change_isr(uint8_t pin, HalIsr isr, void* arg);
+void     hal_attach_falling_isr(uint8_t pin, HalIsr isr, void* arg);
+void     hal_detach_isr(uint8_t pin);
+
+struct HalTimer {
+    HalIsr   cb;
+    void*    arg;
+    uint64_t due_us;
+    bool     armed;
+};
+
+bool     hal_timer_init(HalTimer* t, HalIsr cb, void* arg);
+void     hal_timer_start_once(HalTimer* t, uint32_t us);
+void     hal_timer_stop(HalTimer* t);
+
+bool     hal_i2c_probe(uint8_t addr);
+bool     hal_i2c_write(uint8_t addr, const uint8_t* data, size_t len);
+bool     hal_i2c_read(uint8_t addr, uint8_t* data, size_t len);
+
+int      hal_uart_available(uint8_t port);
+int      hal_uart_read(uint8_t port);
+size_t   hal_uart_read_bytes(uint8_t port, uint8_t* data, size_t max);
+size_t   hal_uart_write(uint8_t port, const uint8_t* data, size_t len);
+
+bool     hal_nvs_read(const char* key, void* data, size_t len);
+size_t   hal_nvs_size(const char* key);
+bool     hal_nvs_write(const char* key, const void* data, size_t len);
+
+uint32_t hal_flash_size();
+bool     hal_flash_read(uint32_t addr, void* data, size_t len);
+bool     hal_flash_erase(uint32_t addr, uint32_t len);
+bool     hal_flash_write(uint32_t addr, const void* data, size_t len);
+
+#include "hal_host.h"
+
+#endif
+
+#endif // HAL_H
@@ -0,0 +1,423 @@
+#if !defined(ARDUINO)
+
+#include "hal.h"
+#include <string.h>
+#include "common/lora_airtime.h"
+
+// ---------------------------------------------------------------------------
+// Host stand-ins for the HAL — see hal_host.h
+// ---------------------------------------------------------------------------
+
+struct PulseQueue {
+    uint32_t width_us[HAL_HOST_PULSE_QUEUE];
+    uint8_t  head;
+    uint8_t  count;
+};
+
+struct PinIsr {
+    HalIsr isr;
+    void*  arg;
+    bool   fallingOnly;
+};
+
+struct PinEdge {
+    uint64_t due_us;
+    uint8_t  pin;
+    uint8_t  level;
+};
+
+struct NvsBlob {
+    char    key[HAL_NVS_KEY_MAX + 1];
+    uint8_t data[HAL_HOST_NVS_BLOB];
+    size_t  len;
+};
+
+struct UartPort {
+    uint8_t rx[HAL_HOST_UART_BUF];
+    size_t  rxHead, rxCount;
+    uint8_t tx[HAL_HOST_UART_BUF];
+    size_t  txCount;
+};
+
+static uint64_t       nowUs;
+static uint16_t       analogLevel[HAL_HOST_PINS];
+static uint8_t        digitalLevel[HAL_HOST_PINS];
+static PulseQueue     pulses[HAL_HOST_PINS];
+static PinIsr         pinIsrs[HAL_HOST_PINS];
+static uint8_t        echoOf[HAL_HOST_PINS];     // trig pin → linked echo pin + 1 (0 = none)
+static PinEdge        edges[HAL_HOST_EDGE_QUEUE];
+static uint8_t        edgeCount;
+static HalTimer*      timers[HAL_HOST_TIMERS];
+static uint8_t        timerCount;
+static bool           dispatching;
+static UartPort       uarts[HAL_UART_PORTS];
+static HostI2cDevice* i2cDevices[128];
+static NvsBlob        nvs[HAL_HOST_NVS_KEYS];   // not touched by hal_host_reset()
+static uint8_t        flash[HAL_HOST_FLASH_SIZE]; // neither
+
+// ---------------------------------------------------------------------------
+void hal_host_reset() {
+    nowUs = 0;
+    memset(analogLevel,  0, sizeof(analogLevel));
+    memset(digitalLevel, 0, sizeof(digitalLevel));
+    memset(pulses,       0, sizeof(pulses));
+    memset(pinIsrs,      0, sizeof(pinIsrs));
+    memset(echoOf,       0, sizeof(echoOf));
+    memset(uarts,        0, sizeof(uarts));
+    memset(i2cDevices,   0, sizeof(i2cDevices));
+    edgeCount   = 0;
+    timerCount  = 0;
+    dispatching = false;
+}
+
+// Drive a pin level; fires its interrupt if the level moved (falling-only: on HIGH → LOW)
+static void setLevel(uint8_t pin, uint8_t level) {
+    if (pin >= HAL_HOST_PINS || digitalLevel[pin] == level) return;
+    digitalLevel[pin] = level;
+    const PinIsr& h = pinIsrs[pin];
+    if (h.isr && (!h.fallingOnly || level == HAL_LOW)) h.isr(h.arg);
+}
+
+// Move the clock to t, firing timers and scheduled edges on the way in time
+// order. Callbacks that delay (e.g. a TRIG pulse) just move the clock; the
+// outer loop picks up whatever became due.
+static void runUntil(uint64_t t) {
+    if (dispatching) {
+        if (t > nowUs) nowUs = t;
+        return;
+    }
+    dispatching = true;
+    for (;;) {
+        uint64_t  due   = UINT64_MAX;
+        int       edge  = -1;
+        HalTimer* timer = nullptr;
+        for (uint8_t i = 0; i < edgeCount; i++) {
+            if (edges[i].due_us < due) { due = edges[i].due_us; edge = i; }
+        }
+        for (uint8_t i = 0; i < timerCount; i++) {
+            if (timers[i]->armed && timers[i]->due_us < due) { due = timers[i]->due_us; timer = timers[i]; edge = -1; }
+        }
+        if (due > t) break;
+        if (due > nowUs) nowUs = due;
+        if (timer) {
+            timer->armed = false;
+            timer->cb(timer->arg);
+        } else {
+            PinEdge e = edges[edge];
+            edges[edge] = edges[--edgeCount];
+            setLevel(e.pin, e.level);
+        }
+    }
+    if (t > nowUs) nowUs = t;
+    dispatching = false;
+}
+
+void     hal_host_advance_us(uint32_t us) { runUntil(nowUs + us); }
+uint64_t hal_host_time_us()               { return nowUs; }
+
+void hal_host_set_analog(uint8_t pin, uint16_t value) {
+    if (pin < HAL_HOST_PINS) analogLevel[pin] = value;
+}
+
+void hal_host_set_digital(uint8_t pin, uint8_t level) {
+    setLevel(pin, level);
+}
+
+void hal_host_schedule_edge(uint8_t pin, uint8_t level, uint32_t delay_us) {
+    if (pin >= HAL_HOST_PINS || edgeCount >= HAL_HOST_EDGE_QUEUE) return;
+    edges[edgeCount++] = { nowUs + delay_us, pin, level };
+}
+
+void hal_host_link_echo(uint8_t trigPin, uint8_t echoPin) {
+    if (trigPin < HAL_HOST_PINS && echoPin < HAL_HOST_PINS) echoOf[trigPin] = echoPin + 1;
+}
+
+void hal_host_queue_pulse(uint8_t pin, uint32_t width_us) {
+    if (pin >= HAL_HOST_PINS) return;
+    PulseQueue& q = pulses[pin];
+    if (q.count >= HAL_HOST_PULSE_QUEUE) return;
+    q.width_us[(q.head + q.count) % HAL_HOST_PULSE_QUEUE] = width_us;
+    q.count++;
+}
+
+void hal_host_uart_feed(uint8_t port, const uint8_t* data, size_t len) {
+    if (port >= HAL_UART_PORTS) return;
+    UartPort& u = uarts[port];
+    for (size_t i = 0; i < len && u.rxCount < HAL_HOST_UART_BUF; i++) {
+        u.rx[(u.rxHead + u.rxCount) % HAL_HOST_UART_BUF] = data[i];
+        u.rxCount++;
+    }
+}
+
+size_t hal_host_uart_drain(uint8_t port, uint8_t* out, size_t max) {
+    if (port >= HAL_UART_PORTS) return 0;
+    UartPort& u = uarts[port];
+    size_t n = u.txCount < max ? u.txCount : max;
+    memcpy(out, u.tx, n);
+    memmove(u.tx, u.tx + n, u.txCount - n);
+    u.txCount -= n;
+    return n;
+}
+
+void hal_host_i2c_attach(uint8_t addr, HostI2cDevice* dev) {
+    if (addr < 128) i2cDevices[addr] = dev;
+}
+
+void hal_host_nvs_erase() { memset(nvs, 0, sizeof(nvs)); }
+
+void     hal_host_flash_fill(uint8_t value) { memset(flash, value, sizeof(flash)); }
+uint8_t* hal_host_flash_image()             { return flash; }
+
+static NvsBlob* nvsFind(const char* key) {
+    for (NvsBlob& b : nvs) {
+        if (b.key[0] && strcmp(b.key, key) == 0) return &b;
+    }
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// hal_*() — same contract as the Arduino wrappers in hal.h
+// ---------------------------------------------------------------------------
+uint32_t hal_millis()              { return (uint32_t)(nowUs / 1000); }
+uint32_t hal_micros()              { return (uint32_t)nowUs; }
+void     hal_delay_ms(uint32_t ms) { runUntil(nowUs + (uint64_t)ms * 1000); }
+void     hal_delay_us(uint32_t us) { runUntil(nowUs + us); }
+
+void hal_digital_write(uint8_t pin, uint8_t level) {
+    if (pin >= HAL_HOST_PINS) return;
+    bool falling = digitalLevel[pin] == HAL_HIGH && level == HAL_LOW;
+    digitalLevel[pin] = level;
+    if (!falling || !echoOf[pin]) return;
+
+    // Linked TRIG released: play back the next queued echo width as edges
+    uint8_t     echo = echoOf[pin] - 1;
+    PulseQueue& q    = pulses[echo];
+    if (q.count == 0) return;
+    uint32_t width = q.width_us[q.head];
+    q.head = (q.head + 1) % HAL_HOST_PULSE_QUEUE;
+    q.count--;
+    if (width == 0) return;
+    hal_host_schedule_edge(echo, HAL_HIGH, HAL_HOST_ECHO_DELAY_US);
+    hal_host_schedule_edge(echo, HAL_LOW,  HAL_HOST_ECHO_DELAY_US + width);
+}
+
+int hal_digital_read(uint8_t pin) {
+    return pin < HAL_HOST_PINS ? digitalLevel[pin] : HAL_LOW;
+}
+
+uint16_t hal_analog_read(uint8_t pin) {
+    return pin < HAL_HOST_PINS ? analogLevel[pin] : 0;
+}
+
+// Returns the next queued width and advances the clock by the time pulseIn()
+// would have spent waiting. An empty queue or a 0/over-length width is a timeout.
+uint32_t hal_pulse_in(uint8_t pin, uint8_t level, uint32_t timeout_us) {
+    (void)level;
+    if (pin >= HAL_HOST_PINS || pulses[pin].count == 0) {
+        nowUs += timeout_us;
+        return 0;
+    }
+    PulseQueue& q = pulses[pin];
+    uint32_t width = q.width_us[q.head];
+    q.head = (q.head + 1) % HAL_HOST_PULSE_QUEUE;
+    q.count--;
+    if (width == 0 || width > timeout_us) {
+        nowUs += timeout_us;
+        return 0;
+    }
+    nowUs += width;
+    return width;
+}
+
+void hal_attach_change_isr(uint8_t pin, HalIsr isr, void* arg) {
+    if (pin < HAL_HOST_PINS) pinIsrs[pin] = { isr, arg, false };
+}
+
+void hal_attach_falling_isr(uint8_t pin, HalIsr isr, void* arg) {
+    if (pin < HAL_HOST_PINS) pinIsrs[pin] = { isr, arg, true };
+}
+
+void hal_detach_isr(uint8_t pin) {
+    if (pin < HAL_HOST_PINS) pinIsrs[pin] = { nullptr, nullptr, false };
+}
+
+bool hal_timer_init(HalTimer* t, HalIsr cb, void* arg) {
+    *t = { cb, arg, 0, false };
+    for (uint8_t i = 0; i < timerCount; i++) {
+        if (timers[i] == t) return true;
+    }
+    if (timerCount >= HAL_HOST_TIMERS) return false;
+    timers[timerCount++] = t;
+    return true;
+}
+
+void hal_timer_start_once(HalTimer* t, uint32_t us) {
+    t->due_us = nowUs + us;
+    t->armed  = true;
+}
+
+void hal_timer_stop(HalTimer* t) { t->armed = false; }
+
+bool hal_i2c_probe(uint8_t addr) {
+    return addr < 128 && i2cDevices[addr] != nullptr;
+}
+
+bool hal_i2c_write(uint8_t addr, const uint8_t* data, size_t len) {
+    if (!hal_i2c_probe(addr)) return false;
+    nowUs += (len + 1) * 9 * 1000000ULL / 400000;   // 9 clocks per byte at 400 kHz
+    return i2cDevices[addr]->onWrite(data, len);
+}
+
+bool hal_i2c_read(uint8_t addr, uint8_t* data, size_t len) {
+    if (!hal_i2c_probe(addr)) return false;
+    nowUs += (len + 1) * 9 * 1000000ULL / 400000;
+    return i2cDevices[addr]->onRead(data, len);
+}
+
+int hal_uart_available(uint8_t port) {
+    return port < HAL_UART_PORTS ? (int)uarts[port].rxCount : 0;
+}
+
+int hal_uart_read(uint8_t port) {
+    if (port >= HAL_UART_PORTS || uarts[port].rxCount == 0) return -1;
+    UartPort& u = uarts[port];
+    uint8_t c = u.rx[u.rxHead];
+    u.rxHead = (u.rxHead + 1) % HAL_HOST_UART_BUF;
+    u.rxCount--;
+    return c;
+}
+
+size_t hal_uart_read_bytes(uint8_t port, uint8_t* data, size_t max) {
+    if (port >= HAL_UART_PORTS) return 0;
+    UartPort& u = uarts[port];
+    size_t n = u.rxCount < max ? u.rxCount : max;
+    for (size_t i = 0; i < n; i++) data[i] = u.rx[(u.rxHead + i) % HAL_HOST_UART_BUF];
+    u.rxHead   = (u.rxHead + n) % HAL_HOST_UART_BUF;
+    u.rxCount -= n;
+    return n;
+}
+
+size_t hal_uart_write(uint8_t port, const uint8_t* data, size_t len) {
+    if (port >= HAL_UART_PORTS) return 0;
+    UartPort& u = uarts[port];
+    size_t n = 0;
+    while (n < len && u.txCount < HAL_HOST_UART_BUF) u.tx[u.txCount++] = data[n++];
+    return n;
+}
+
+bool hal_nvs_read(const char* key, void* data, size_t len) {
+    NvsBlob* b = nvsFind(key);
+    if (!b || b->len != len) return false;
+    memcpy(data, b->data, len);
+    return true;
+}
+
+size_t hal_nvs_size(const char* key) {
+    NvsBlob* b = nvsFind(key);
+    return b ? b->len : 0;
+}
+
+bool hal_nvs_write(const char* key, const void* data, size_t len) {
+    if (strlen(key) > HAL_NVS_KEY_MAX || len > HAL_HOST_NVS_BLOB) return false;
+    NvsBlob* b = nvsFind(key);
+    for (size_t i = 0; !b && i < HAL_HOST_NVS_KEYS; i++) {
+        if (!nvs[i].key[0]) b = &nvs[i];
+    }
+    if (!b) return false;
+    strcpy(b->key, key);
+    memcpy(b->data, data, len);
+    b->len = len;
+    return true;
+}
+
+uint32_t hal_flash_size() { return HAL_HOST_FLASH_SIZE; }
+
+bool hal_flash_read(uint32_t addr, void* data, size_t len) {
+    if (addr > HAL_HOST_FLASH_SIZE || len > HAL_HOST_FLASH_SIZE - addr) return false;
+    memcpy(data, flash + addr, len);
+    return true;
+}
+
+bool hal_flash_erase(uint32_t addr, uint32_t len) {
+    if (addr % HAL_FLASH_SECTOR || len % HAL_FLASH_SECTOR) return false;
+    if (addr > HAL_HOST_FLASH_SIZE || len > HAL_HOST_FLASH_SIZE - addr) return false;
+    memset(flash + addr, 0xFF, len);
+    nowUs += (uint64_t)(len / HAL_FLASH_SECTOR) * HAL_HOST_FLASH_ERASE_US;
+    return true;
+}
+
+// NOR: programming only clears bits
+bool hal_flash_write(uint32_t addr, const void* data, size_t len) {
+    if (addr > HAL_HOST_FLASH_SIZE || len > HAL_HOST_FLASH_SIZE - addr) return false;
+    const uint8_t* src = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i++) flash[addr + i] &= src[i];
+    nowUs += (len + HAL_FLASH_PAGE - 1) / HAL_FLASH_PAGE * HAL_HOST_FLASH_PAGE_US;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// HostRadio
+// ---------------------------------------------------------------------------
+bool HostRadio::inject(const uint8_t* data, uint8_t len, int16_t frameRssi, int8_t frameSnr) {
+    if (singleFrame) rxCount = 0;   // overwrite the unread frame
+    if (rxCount >= HAL_HOST_RADIO_QUEUE) return false;
+    Frame& f = rx[(rxHead + rxCount) % HAL_HOST_RADIO_QUEUE];
+    memcpy(f.data, data, len);
+    f.len  = len;
+    f.rssi = frameRssi;
+    f.snr  = frameSnr;
+    rxCount++;
+    if (hook) hook(hookCtx, HAL_RADIO_IRQ_RX_DONE, (uint32_t)nowUs);
+    return true;
+}
+
+bool HostRadio::popSent(Frame* out) {
+    if (txCount == 0) return false;
+    *out   = tx[txHead];
+    txHead = (txHead + 1) % HAL_HOST_RADIO_QUEUE;
+    txCount--;
+    return true;
+}
+
+bool HostRadio::send(const uint8_t* data, uint8_t len) {
+    txPending = true;
+    txUntilUs = nowUs + lora_time_on_air_us(LORA_MODEM_DEFAULT, len);
+    if (peer) return peer->inject(data, len);
+    if (txCount >= HAL_HOST_RADIO_QUEUE) return false;
+    Frame& f = tx[(txHead + txCount) % HAL_HOST_RADIO_QUEUE];
+    memcpy(f.data, data, len);
+    f.len  = len;
+    f.rssi = 0;
+    f.snr  = 0;
+    txCount++;
+    return true;
+}
+
+bool HostRadio::txBusy() {
+    if (!txPending) return false;
+    if (nowUs < txUntilUs) return true;
+    txPending = false;
+    if (hook) hook(hookCtx, HAL_RADIO_IRQ_TX_DONE, (uint32_t)txUntilUs);
+    return false;
+}
+
+bool HostRadio::waitPacketSent() {
+    if (txPending && nowUs < txUntilUs) nowUs = txUntilUs;
+    txBusy();
+    return true;
+}
+
+bool HostRadio::recv(uint8_t* buf, uint8_t* len) {
+    if (rxCount == 0) return false;
+    Frame& f = rx[rxHead];
+    uint8_t n = f.len < *len ? f.len : *len;
+    memcpy(buf, f.data, n);
+    *len   = n;
+    rssi   = f.rssi;
+    snr    = f.snr;
+    rxHead = (rxHead + 1) % HAL_HOST_RADIO_QUEUE;
+    rxCount--;
+    return true;
+}
+
+#endif // !ARDUINO
@@ -0,0 +1,126 @@
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+// ---------------------------------------------------------------------------
+// Host-side controls for the HAL stand-ins (only built when ARDUINO is not
+// defined). Everything is deterministic: time only moves when a delay, a
+// pulse_in() or hal_host_advance_us() moves it, so two runs of the same
+// scenario produce identical output.
+//
+// Armed HalTimers and scheduled pin edges are events on the virtual clock:
+// a delay or advance fires every event it passes, in time order, with the
+// clock set to the event time (so hal_micros() inside a callback reads the
+// edge timestamp). Pin interrupts fire on any level change of an input
+// (falling-edge ones on HIGH → LOW only), scripted or scheduled.
+// ---------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hal_radio.h"
+
+#define HAL_HOST_PINS          49    // GPIO 0–48 on the ESP32-S3
+#define HAL_HOST_PULSE_QUEUE   16    // queued echo widths per pin
+#define HAL_HOST_UART_BUF      1024  // per-port RX and TX capacity
+#define HAL_HOST_TIMERS        8     // HalTimers registered by hal_timer_init()
+#define HAL_HOST_EDGE_QUEUE    16    // scheduled pin edges in flight
+#define HAL_HOST_ECHO_DELAY_US 450   // TRIG falling → ECHO rising on a linked pair
+#define HAL_HOST_RADIO_QUEUE   8     // frames per HostRadio RX/TX queue
+#define HAL_HOST_RADIO_MTU     255
+#define HAL_HOST_NVS_KEYS      8     // blobs in the in-memory NVS
+#define HAL_HOST_NVS_BLOB      512   // bytes per blob
+#define HAL_HOST_FLASH_SIZE    (256 * 1024)   // "rec" partition image
+#define HAL_HOST_FLASH_ERASE_US 45000         // per 4 KB sector (W25Q typical)
+#define HAL_HOST_FLASH_PAGE_US  700           // per 256 B page program
+
+// Virtual clock
+void     hal_host_reset();                          // clock, pins, queues and devices back to power-on
+void     hal_host_advance_us(uint32_t us);
+uint64_t hal_host_time_us();
+
+// Pins
+void     hal_host_set_analog(uint8_t pin, uint16_t value);     // next hal_analog_read(pin) result
+void     hal_host_set_digital(uint8_t pin, uint8_t level);     // drive an input pin
+void     hal_host_queue_pulse(uint8_t pin, uint32_t width_us); // next hal_pulse_in(pin); 0 = no echo
+void     hal_host_schedule_edge(uint8_t pin, uint8_t level, uint32_t delay_us);
+
+// Ultrasonic stand-in: each TRIG falling edge pops the next queued width for
+// echoPin and plays it back as edges (HIGH after HAL_HOST_ECHO_DELAY_US, LOW
+// width_us later). 0 = no echo. hal_pulse_in() on echoPin is unaffected.
+void     hal_host_link_echo(uint8_t trigPin, uint8_t echoPin);
+
+// UART
+void     hal_host_uart_feed(uint8_t port, const uint8_t* data, size_t len);  // bytes "received" by firmware
+size_t   hal_host_uart_drain(uint8_t port, uint8_t* out, size_t max);        // bytes written by firmware
+
+// I2C — attach a register-level model to an address
+class HostI2cDevice {
+public:
+    virtual ~HostI2cDevice() {}
+    virtual bool onWrite(const uint8_t* data, size_t len) = 0;
+    virtual bool onRead(uint8_t* data, size_t len) = 0;
+};
+
+void     hal_host_i2c_attach(uint8_t addr, HostI2cDevice* dev);
+
+// NVS — survives hal_host_reset() like flash survives a reboot
+void     hal_host_nvs_erase();                      // factory-fresh: every key gone
+
+// Raw flash partition — survives hal_host_reset() too
+void     hal_host_flash_fill(uint8_t value);        // whole image, e.g. 0xFF fresh or 0x00 worn
+uint8_t* hal_host_flash_image();                    // HAL_HOST_FLASH_SIZE bytes, for dumps and fault injection
+
+// ---------------------------------------------------------------------------
+// In-memory radio: frames sent by the firmware land in the TX queue; frames
+// injected by the scenario are returned by recv(). Two HostRadios can be
+// linked so one's send() is the other's RX (loopback for protocol tests).
+//
+// A send() keeps the radio busy for the frame's time-on-air at
+// LORA_MODEM_DEFAULT on the virtual clock: txBusy() reports it and
+// waitPacketSent() advances the clock to the end, as the real call blocks.
+// inject() fires the RX-done IRQ hook at the current virtual time; TX done
+// fires from the first txBusy()/waitPacketSent() after the airtime elapses.
+// setSingleFrame(true) holds one RX frame like RH_RF95: a frame arriving
+// before the previous one is read overwrites it (its IRQ still fires).
+// ---------------------------------------------------------------------------
+class HostRadio : public HalRadio {
+public:
+    struct Frame {
+        uint8_t  data[HAL_HOST_RADIO_MTU];
+        uint8_t  len;
+        int16_t  rssi;
+        int8_t   snr;
+    };
+
+    HostRadio() : peer(nullptr), rxHead(0), rxCount(0), txHead(0), txCount(0), rssi(0), snr(0),
+                  txPending(false), txUntilUs(0), singleFrame(false), hook(nullptr), hookCtx(nullptr) {}
+
+    void link(HostRadio* other) { peer = other; other->peer = this; }
+    void setSingleFrame(bool on) { singleFrame = on; }
+    bool inject(const uint8_t* data, uint8_t len, int16_t rssi = -60, int8_t snr = 9);
+    bool popSent(Frame* out);
+
+    bool    send(const uint8_t* data, uint8_t len) override;
+    bool    waitPacketSent() override;
+    bool    available() override      { return rxCount > 0; }
+    bool    recv(uint8_t* buf, uint8_t* len) override;
+    int16_t lastRssi() override       { return rssi; }
+    int8_t  lastSnr() override        { return snr; }
+    bool    txBusy() override;
+    void    setIrqHook(HalRadioIrqHook h, void* ctx) override { hook = h; hookCtx = ctx; }
+
+private:
+    HostRadio* peer;
+    Frame      rx[HAL_HOST_RADIO_QUEUE];
+    uint8_t    rxHead, rxCount;
+    Frame      tx[HAL_HOST_RADIO_QUEUE];
+    uint8_t    txHead, txCount;
+    int16_t    rssi;
+    int8_t     snr;
+    bool       txPending;
+    uint64_t   txUntilUs;
+    bool       singleFrame;
+    HalRadioIrqHook hook;
+    void*      hookCtx;
+};
+
+#endif // HAL_HOST_H
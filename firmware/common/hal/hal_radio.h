@@ -0,0 +1,36 @@
+#ifndef HAL_RADIO_H
+#define HAL_RADIO_H
+
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// SPI LoRa radio interface — the subset of RH_RF95 the protocol layer uses.
+//   On target: Rf95Radio (rf95_radio.h) forwards to a RadioHead RH_RF95.
+//   On host:   HostRadio (hal_host.h) queues frames in memory.
+//
+// setIrqHook() reports DIO0 completions (RX done / TX done) with the µs
+// timestamp taken at the interrupt — LoraAsync (firmware/common/lora/) uses
+// it to timestamp received frames and to start the next queued TX.
+// ---------------------------------------------------------------------------
+
+#define HAL_RADIO_IRQ_RX_DONE  1
+#define HAL_RADIO_IRQ_TX_DONE  2
+
+// Runs in interrupt context on target: record and return, no radio calls.
+typedef void (*HalRadioIrqHook)(void* ctx, uint8_t event, uint32_t t_us);
+
+class HalRadio {
+public:
+    virtual ~HalRadio() {}
+
+    virtual bool    send(const uint8_t* data, uint8_t len) = 0;   // queue for TX, returns immediately
+    virtual bool    waitPacketSent() = 0;                          // block until TX complete
+    virtual bool    available() = 0;                               // RX frame waiting
+    virtual bool    recv(uint8_t* buf, uint8_t* len) = 0;          // copy out RX frame; *len = capacity in, size out
+    virtual int16_t lastRssi() = 0;                                // dBm of last RX frame
+    virtual int8_t  lastSnr() = 0;                                 // dB of last RX frame
+    virtual bool    txBusy() = 0;                                  // a frame is on air
+    virtual void    setIrqHook(HalRadioIrqHook hook, void* ctx) = 0;
+};
+
+#endif // HAL_RADIO_H
@@ -0,0 +1,61 @@
+#ifndef RF95_RADIO_H
+#define RF95_RADIO_H
+
+// HalRadio adapter for RadioHead RH_RF95 — on-target only (needs lib_deps mikem/RadioHead).
+//
+//   Rf95Driver rf95(LORA_CS_PIN, LORA_IRQ_PIN);
+//   Rf95Radio  radio(rf95);
+
+#include <RH_RF95.h>
+#include "hal_radio.h"
+
+// RH_RF95 with a timestamping DIO0 handler. RadioHead services the chip from
+// its own ISR; attachIrqHook() replaces that ISR on the pin with one that
+// reads micros() first, lets RadioHead service the chip (handleInterrupt is
+// protected, hence the subclass), then reports which completion fired.
+class Rf95Driver : public RH_RF95 {
+public:
+    Rf95Driver(uint8_t cs, uint8_t irq) : RH_RF95(cs, irq), irqPin(irq), hook(nullptr), hookCtx(nullptr) {}
+
+    // Call after init(); init() attaches RadioHead's own handler.
+    void attachIrqHook(HalRadioIrqHook h, void* ctx) {
+        hook    = h;
+        hookCtx = ctx;
+        attachInterruptArg(digitalPinToInterrupt(irqPin), isr, this, RISING);
+    }
+
+private:
+    static void IRAM_ATTR isr(void* arg) {
+        Rf95Driver* d  = static_cast<Rf95Driver*>(arg);
+        uint32_t    t  = micros();
+        uint16_t    rx = d->rxGood();
+        uint16_t    tx = d->txGood();
+        d->handleInterrupt();
+        if (!d->hook) return;
+        if (d->rxGood() != rx) d->hook(d->hookCtx, HAL_RADIO_IRQ_RX_DONE, t);
+        if (d->txGood() != tx) d->hook(d->hookCtx, HAL_RADIO_IRQ_TX_DONE, t);
+    }
+
+    uint8_t         irqPin;
+    HalRadioIrqHook hook;
+    void*           hookCtx;
+};
+
+class Rf95Radio : public HalRadio {
+public:
+    explicit Rf95Radio(Rf95Driver& rf95) : rf95(rf95) {}
+
+    bool    send(const uint8_t* data, uint8_t len) override { return rf95.send(data, len); }
+    bool    waitPacketSent() override                        { return rf95.waitPacketSent(); }
+    bool    available() override                             { return rf95.available(); }
+    bool    recv(uint8_t* buf, uint8_t* len) override        { return rf95.recv(buf, len); }
+    int16_t lastRssi() override                              { return rf95.lastRssi(); }
+    int8_t  lastSnr() override                               { return (int8_t)rf95.lastSNR(); }
+    bool    txBusy() override                                { return rf95.mode() == RHGenericDriver::RHModeTx; }
+    void    setIrqHook(HalRadioIrqHook h, void* ctx) override { rf95.attachIrqHook(h, ctx); }
+
+private:
+    Rf95Driver& rf95;
+};
+
+#endif // RF95_RADIO_H
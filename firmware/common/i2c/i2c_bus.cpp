@@ -0,0 +1,185 @@
+#include "i2c_bus.h"
+
+I2cBus::I2cBus()
+    : dev(), count(0), rr(0), windowStartUs(0)
+#if defined(ARDUINO)
+      , task(nullptr)
+#endif
+{
+}
+
+int I2cBus::addDevice(const char* name, uint8_t addr, I2cPriority priority) {
+    if (count >= I2C_BUS_MAX_DEVICES) return -1;
+    Device& d  = dev[count];
+    d.name     = name;
+    d.addr     = addr;
+    d.priority = priority;
+    return count++;
+}
+
+// ---------------------------------------------------------------------------
+// Producer side
+// ---------------------------------------------------------------------------
+bool I2cBus::submit(int id, const I2cTxn& t) {
+    if (id < 0 || id >= count) return false;
+    Device& d = dev[id];
+    I2cTxn* slot = d.queue.claim();
+    if (!slot) {
+        d.rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    *slot = t;
+    slot->queued_us = hal_micros();
+    d.queue.publish();
+#if defined(ARDUINO)
+    if (task) xTaskNotifyGive((TaskHandle_t)task);
+#endif
+    return true;
+}
+
+// transfer() caller parked until its transaction completes
+struct I2cWaiter {
+    std::atomic<bool> done;
+    bool              ok;
+#if defined(ARDUINO)
+    TaskHandle_t      caller;
+#endif
+};
+
+static void wakeWaiter(void* ctx, bool ok) {
+    I2cWaiter* w = static_cast<I2cWaiter*>(ctx);
+    w->ok = ok;
+    w->done.store(true, std::memory_order_release);
+#if defined(ARDUINO)
+    xTaskNotifyGive(w->caller);
+#endif
+}
+
+bool I2cBus::transfer(int id, const uint8_t* tx, uint16_t tx_len, uint8_t* rx, uint16_t rx_len) {
+    I2cWaiter w;
+    w.done.store(false, std::memory_order_relaxed);
+    w.ok = false;
+#if defined(ARDUINO)
+    w.caller = xTaskGetCurrentTaskHandle();
+#endif
+    I2cTxn t = { tx, tx_len, rx, rx_len, wakeWaiter, &w, 0 };
+    if (!submit(id, t)) return false;
+
+    while (!w.done.load(std::memory_order_acquire)) {
+#if defined(ARDUINO)
+        if (task) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+#endif
+        service();   // no bus task: run the queue from here
+    }
+    return w.ok;
+}
+
+// ---------------------------------------------------------------------------
+// Bus side
+// ---------------------------------------------------------------------------
+bool I2cBus::pending() const {
+    for (uint8_t i = 0; i < count; i++) {
+        if (!dev[i].queue.empty()) return true;
+    }
+    return false;
+}
+
+bool I2cBus::service() {
+    // Highest priority with work; scan from rr so equal priorities alternate
+    int pick = -1;
+    for (uint8_t k = 0; k < count; k++) {
+        uint8_t i = (uint8_t)((rr + k) % count);
+        if (dev[i].queue.empty()) continue;
+        if (pick < 0 || dev[i].priority > dev[pick].priority) pick = i;
+    }
+    if (pick < 0) return false;
+    rr = (uint8_t)((pick + 1) % count);
+
+    Device&       d = dev[pick];
+    const I2cTxn* t = d.queue.peek();
+    uint32_t start  = hal_micros();
+    uint32_t wait   = start - t->queued_us;
+
+    bool     ok    = true;
+    uint32_t bytes = 0;
+    if (t->tx_len) {
+        ok     = hal_i2c_write(d.addr, t->tx, t->tx_len);
+        bytes += 1 + t->tx_len;
+    }
+    if (ok && t->rx_len) {
+        ok     = hal_i2c_read(d.addr, t->rx, t->rx_len);
+        bytes += 1 + t->rx_len;
+    }
+    uint32_t busy = hal_micros() - start;
+
+    d.txns.fetch_add(1, std::memory_order_relaxed);
+    if (!ok) d.errors.fetch_add(1, std::memory_order_relaxed);
+    d.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    d.busUs.fetch_add(busy, std::memory_order_relaxed);
+    d.waitTotalUs.fetch_add(wait, std::memory_order_relaxed);
+    if (wait > d.waitMaxUs.load(std::memory_order_relaxed)) d.waitMaxUs.store(wait, std::memory_order_relaxed);
+
+    // Free the slot before the callback so it can queue the next transaction
+    I2cDone done = t->done;
+    void*   ctx  = t->ctx;
+    d.queue.release();
+    if (done) done(ctx, ok);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Accounting
+// ---------------------------------------------------------------------------
+I2cDeviceStats I2cBus::deviceStats(int id) const {
+    I2cDeviceStats s = {};
+    if (id < 0 || id >= count) return s;
+    const Device& d = dev[id];
+    s.name          = d.name;
+    s.addr          = d.addr;
+    s.priority      = d.priority;
+    s.txns          = d.txns.load(std::memory_order_relaxed);
+    s.errors        = d.errors.load(std::memory_order_relaxed);
+    s.rejected      = d.rejected.load(std::memory_order_relaxed);
+    s.bytes         = d.bytes.load(std::memory_order_relaxed);
+    s.bus_us        = d.busUs.load(std::memory_order_relaxed);
+    s.wait_max_us   = d.waitMaxUs.load(std::memory_order_relaxed);
+    s.wait_total_us = d.waitTotalUs.load(std::memory_order_relaxed);
+    return s;
+}
+
+void I2cBus::resetStats() {
+    for (uint8_t i = 0; i < count; i++) {
+        Device& d = dev[i];
+        d.txns.store(0, std::memory_order_relaxed);
+        d.errors.store(0, std::memory_order_relaxed);
+        d.rejected.store(0, std::memory_order_relaxed);
+        d.bytes.store(0, std::memory_order_relaxed);
+        d.busUs.store(0, std::memory_order_relaxed);
+        d.waitMaxUs.store(0, std::memory_order_relaxed);
+        d.waitTotalUs.store(0, std::memory_order_relaxed);
+    }
+    windowStartUs = hal_micros();
+}
+
+// ---------------------------------------------------------------------------
+#if defined(ARDUINO)
+static void busTask(void* arg) {
+    I2cBus* b = static_cast<I2cBus*>(arg);
+    for (;;) {
+        while (b->service()) {}
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);   // until submit()
+    }
+}
+
+bool I2cBus::startTask(uint8_t core) {
+    TaskHandle_t h = nullptr;
+    if (xTaskCreatePinnedToCore(busTask, "i2c", I2C_BUS_TASK_STACK, this, I2C_BUS_TASK_PRIORITY, &h, core) != pdPASS) {
+        return false;
+    }
+    task = h;
+    return true;
+}
+#endif
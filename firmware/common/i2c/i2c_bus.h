@@ -0,0 +1,120 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <atomic>
+#include <stdint.h>
+#include "common/spsc_ring.h"
+#include "firmware/common/hal/hal.h"
+
+// ---------------------------------------------------------------------------
+// Shared I2C bus manager — one owner, prioritised transactions, bus-time accounting
+//
+//   loop():      compass.submit ─► [HIGH   ring] ─┐
+//   OLED task:   run cmd / data ─► [LOW    ring] ─┼─► service(): highest-priority
+//   ...          (one ring per device)           ─┘   pending transaction, then
+//                                                     its completion callback
+//
+// Every device on the bus registers once (addDevice) with a priority and
+// gets its own lock-free SpscRing, so each producer — one task per device —
+// queues without locks. service() runs one whole transaction at a time
+// (write, then read) and always picks the highest-priority device with work,
+// round-robin among equals. A compass read queued while the OLED is
+// flushing therefore waits for at most the one run already on the wire
+// (≤ ~1.7 ms at 400 kHz), never for the rest of the frame.
+//
+// Completion callbacks run on the bus side (the bus task on target) — keep
+// them short: copy the result, set a flag, notify a task. transfer() wraps
+// submit() + wait for callers that want a blocking read.
+//
+// Per-device accounting: transactions, errors, bytes on the wire (address
+// bytes included), bus time and queue wait (submit → start). Bus time over
+// the window since resetStats() is the utilisation breakdown.
+//
+// On target startTask() runs service() in a FreeRTOS task woken by submit();
+// on host call service() directly (hal_i2c_*() advance the virtual clock).
+// ---------------------------------------------------------------------------
+
+#define I2C_BUS_MAX_DEVICES   4
+#define I2C_BUS_QUEUE         8     // transactions per device, power of two
+#define I2C_BUS_TASK_STACK    3072
+#define I2C_BUS_TASK_PRIORITY 3     // above OLED_TASK_PRIORITY
+#define I2C_BUS_TASK_CORE     0
+
+enum I2cPriority : uint8_t {
+    I2C_PRIO_LOW    = 0,   // display
+    I2C_PRIO_NORMAL = 1,
+    I2C_PRIO_HIGH   = 2,   // heading sensors
+};
+
+typedef void (*I2cDone)(void* ctx, bool ok);
+
+// Buffers belong to the caller and must stay valid until done() runs
+struct I2cTxn {
+    const uint8_t* tx;          // written first (register address, commands, data); may be null
+    uint16_t       tx_len;
+    uint8_t*       rx;          // then read; may be null
+    uint16_t       rx_len;
+    I2cDone        done;        // may be null
+    void*          ctx;
+    uint32_t       queued_us;   // set by submit()
+};
+
+struct I2cDeviceStats {
+    const char* name;
+    uint8_t     addr;
+    uint8_t     priority;
+    uint32_t    txns;
+    uint32_t    errors;
+    uint32_t    rejected;       // submit() on a full queue
+    uint32_t    bytes;
+    uint32_t    bus_us;
+    uint32_t    wait_max_us;
+    uint32_t    wait_total_us;
+};
+
+class I2cBus {
+public:
+    I2cBus();
+
+    // setup() only, before any submit(). Returns the device handle, or -1.
+    int  addDevice(const char* name, uint8_t addr, I2cPriority priority);
+
+    // Producer side (one task per device): queue, false if the device queue is full
+    bool submit(int dev, const I2cTxn& t);
+
+    // Blocking convenience: submit and wait for completion. Not from the bus task.
+    bool transfer(int dev, const uint8_t* tx, uint16_t tx_len, uint8_t* rx = nullptr, uint16_t rx_len = 0);
+
+    // Bus side: run one transaction; true if one ran
+    bool service();
+    bool pending() const;
+
+#if defined(ARDUINO)
+    bool startTask(uint8_t core = I2C_BUS_TASK_CORE);
+#endif
+
+    uint8_t        devices() const { return count; }
+    I2cDeviceStats deviceStats(int dev) const;
+    uint32_t       windowUs() const { return hal_micros() - windowStartUs; }
+    void           resetStats();
+
+private:
+    struct Device {
+        const char*                      name;
+        uint8_t                          addr;
+        uint8_t                          priority;
+        SpscRing<I2cTxn, I2C_BUS_QUEUE>  queue;
+        std::atomic<uint32_t>            txns, errors, rejected, bytes, busUs, waitMaxUs, waitTotalUs;
+    };
+
+    Device   dev[I2C_BUS_MAX_DEVICES];
+    uint8_t  count;
+    uint8_t  rr;                // round-robin start among equal priorities
+    uint32_t windowStartUs;
+
+#if defined(ARDUINO)
+    void* task;   // TaskHandle_t, notified by submit()
+#endif
+};
+
+#endif // I2C_BUS_H
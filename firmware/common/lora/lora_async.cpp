@@ -0,0 +1,91 @@
+#include "lora_async.h"
+#include <string.h>
+#include "firmware/common/hal/hal.h"
+
+LoraAsync::LoraAsync(HalRadio& radio)
+    : radio(radio), txDoneIrq(false), txActive(false), st() {}
+
+void LoraAsync::begin() {
+    radio.setIrqHook(&LoraAsync::onIrq, this);
+}
+
+// Interrupt context: record and return.
+void HAL_ISR_ATTR LoraAsync::onIrq(void* ctx, uint8_t event, uint32_t t_us) {
+    LoraAsync* self = static_cast<LoraAsync*>(ctx);
+    if (event == HAL_RADIO_IRQ_RX_DONE) self->rxStamps.push(t_us);
+    if (event == HAL_RADIO_IRQ_TX_DONE) self->txDoneIrq.store(true, std::memory_order_release);
+}
+
+// ---------------------------------------------------------------------------
+bool LoraAsync::send(const uint8_t* data, uint8_t len) {
+    if (len > LORA_MAX_PAYLOAD) return false;
+    LoraTxFrame* f = txq.claim();
+    if (!f) {
+        st.tx_dropped++;
+        return false;
+    }
+    memcpy(f->data, data, len);
+    f->len       = len;
+    f->queued_us = hal_micros();
+    txq.publish();
+    return true;
+}
+
+bool LoraAsync::receive(LoraRxFrame* out) {
+    return rxq.pop(out);
+}
+
+// ---------------------------------------------------------------------------
+void LoraAsync::poll() {
+    // RX: one frame per call — the radio buffers at most one on target, so
+    // it is the newest RX-done; earlier stamps belong to overwritten frames
+    if (radio.available()) {
+        uint32_t stamp;
+        if (rxStamps.pop(&stamp)) {
+            uint32_t newer;
+            while (rxStamps.pop(&newer)) {
+                stamp = newer;
+                st.rx_overruns++;
+            }
+        } else {
+            stamp = hal_micros();   // no IRQ hook (or host without one)
+        }
+        LoraRxFrame* f = rxq.claim();
+        if (f) {
+            f->len = sizeof(f->data);
+            if (radio.recv(f->data, &f->len)) {
+                f->rssi  = radio.lastRssi();
+                f->snr   = radio.lastSnr();
+                f->rx_us = stamp;
+                rxq.publish();
+                st.rx_frames++;
+            }
+        } else {
+            uint8_t scratch[LORA_MAX_PAYLOAD];
+            uint8_t len = sizeof(scratch);
+            radio.recv(scratch, &len);   // free the radio buffer
+            st.rx_dropped++;
+        }
+    } else if (!rxStamps.empty()) {
+        // IRQs with no frame left to read: overwritten before we got to them
+        uint32_t stale;
+        while (rxStamps.pop(&stale)) st.rx_overruns++;
+    }
+
+    // TX: start the next queued frame once the previous one is off the air
+    if (txActive) {
+        bool done = txDoneIrq.exchange(false, std::memory_order_acq_rel);
+        if (done || !radio.txBusy()) txActive = false;
+    }
+    if (!txActive) {
+        const LoraTxFrame* f = txq.peek();
+        if (f) {
+            uint32_t wait = hal_micros() - f->queued_us;
+            if (wait > st.tx_wait_max_us) st.tx_wait_max_us = wait;
+            radio.send(f->data, f->len);
+            txq.release();
+            txActive = true;
+            st.tx_frames++;
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef LORA_ASYNC_H
+#define LORA_ASYNC_H
+
+#include <atomic>
+#include <stdint.h>
+#include "common/protocol.h"
+#include "common/spsc_ring.h"
+#include "firmware/common/hal/hal_radio.h"
+
+// ---------------------------------------------------------------------------
+// Non-blocking LoRa layer over HalRadio (RH_RF95 on target)
+//
+//   app / nav loop           poll() (loop or radio task)         DIO0 IRQ
+//   send()  ──► TX ring ──►  radio.send() when the radio is idle
+//   receive() ◄── RX ring ◄── radio.recv() + RSSI/SNR + stamp  ◄── RX-done µs
+//
+// send() and receive() only touch the lock-free rings, so the caller never
+// waits on the radio. poll() is the only code that talks SPI; it does a
+// bounded amount of work (at most one frame copy each way) and never waits
+// for TX completion or for a frame. Each received frame carries the
+// hal_micros() timestamp captured in the RX-done interrupt.
+//
+// RH_RF95 holds a single RX frame: if two arrive between polls, the first is
+// overwritten and counted in rx_overruns. Poll at ≥ 1 kHz from a radio task,
+// or at least every 30 ms (shortest frame at SF7/125 kHz is ~36 ms).
+// ---------------------------------------------------------------------------
+
+#define LORA_RX_QUEUE   8   // frames, power of two
+#define LORA_TX_QUEUE   8
+
+struct LoraRxFrame {
+    uint8_t  data[LORA_MAX_PAYLOAD];
+    uint8_t  len;
+    int16_t  rssi;      // dBm
+    int8_t   snr;       // dB
+    uint32_t rx_us;     // hal_micros() at the RX-done interrupt
+};
+
+struct LoraTxFrame {
+    uint8_t  data[LORA_MAX_PAYLOAD];
+    uint8_t  len;
+    uint32_t queued_us;
+};
+
+struct LoraAsyncStats {
+    uint32_t rx_frames;
+    uint32_t rx_dropped;      // RX ring full — receiver not draining
+    uint32_t rx_overruns;     // RX-done IRQs whose frame was overwritten in the radio
+    uint32_t tx_frames;
+    uint32_t tx_dropped;      // TX ring full at send()
+    uint32_t tx_wait_max_us;  // longest send() → on-air delay
+};
+
+class LoraAsync {
+public:
+    explicit LoraAsync(HalRadio& radio);
+
+    void begin();                                   // install the DIO0 hook
+
+    // App side — return immediately
+    bool send(const uint8_t* data, uint8_t len);    // false if the TX ring is full
+    bool receive(LoraRxFrame* out);                 // false if nothing waiting
+    const LoraRxFrame* peek() { return rxq.peek(); }   // in-place read, then release()
+    void release()            { rxq.release(); }
+
+    // Radio side
+    void poll();
+    bool txIdle() const { return !txActive && txq.empty(); }
+
+    const LoraAsyncStats& stats() const { return st; }
+
+private:
+    static void onIrq(void* ctx, uint8_t event, uint32_t t_us);
+
+    HalRadio&                             radio;
+    SpscRing<LoraRxFrame, LORA_RX_QUEUE>  rxq;
+    SpscRing<LoraTxFrame, LORA_TX_QUEUE>  txq;
+    SpscRing<uint32_t, LORA_RX_QUEUE>     rxStamps;   // IRQ → poll()
+    std::atomic<bool>                     txDoneIrq;
+    bool                                  txActive;
+    LoraAsyncStats                        st;
+};
+
+#endif // LORA_ASYNC_H
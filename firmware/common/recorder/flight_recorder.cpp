@@ -0,0 +1,354 @@
+#include "flight_recorder.h"
+#include <string.h>
+#include "common/crc16.h"
+#include "firmware/common/hal/hal.h"
+
+#define PAGES_PER_SECTOR (HAL_FLASH_SECTOR / REC_PAGE_SIZE)
+
+// Payload fields are little-endian at fixed offsets (ESP32 and hosts alike)
+static inline void put16(uint8_t* d, int off, uint16_t v) { memcpy(d + off, &v, 2); }
+static inline void put32(uint8_t* d, int off, uint32_t v) { memcpy(d + off, &v, 4); }
+static inline uint16_t get16(const uint8_t* d, int off) { uint16_t v; memcpy(&v, d + off, 2); return v; }
+static inline uint32_t get32(const uint8_t* d, int off) { uint32_t v; memcpy(&v, d + off, 4); return v; }
+
+static uint16_t pageCrc(const RecPage& p) {
+    return crc16_ccitt((const uint8_t*)&p + 4, REC_PAGE_SIZE - 4);
+}
+
+bool rec_page_valid(const RecPage& p) {
+    return p.h.magic == REC_PAGE_MAGIC && p.h.count <= REC_PAGE_RECORDS && p.h.crc == pageCrc(p);
+}
+
+// ---------------------------------------------------------------------------
+FlightRecorder::FlightRecorder()
+    : open(nullptr), seq(0), lastMs(0), openMs(0), gpsLat(0), gpsLon(0), gpsRef(false),
+      droppedSince(0), pages(0), writePage(0), st() {}
+
+bool FlightRecorder::begin() {
+    pages             = hal_flash_size() / HAL_FLASH_SECTOR * PAGES_PER_SECTOR;
+    st.capacity_pages = pages;
+    writePage         = 0;
+    seq               = 0;
+    if (pages == 0) return false;
+
+    // Newest valid page: headers first, the CRC only for a new candidate
+    bool     found = false;
+    uint32_t best  = 0, bestSeq = 0;
+    RecPage  p;
+    for (uint32_t i = 0; i < pages; i++) {
+        if (!hal_flash_read(i * REC_PAGE_SIZE, &p.h, sizeof(p.h))) return false;
+        if (p.h.magic != REC_PAGE_MAGIC || (found && p.h.seq <= bestSeq)) continue;
+        if (!hal_flash_read(i * REC_PAGE_SIZE, &p, sizeof(p)) || !rec_page_valid(p)) continue;
+        found   = true;
+        best    = i;
+        bestSeq = p.h.seq;
+    }
+    if (found) {
+        // The rest of that sector may hold a torn page: start on a fresh one
+        writePage = (best / PAGES_PER_SECTOR + 1) * PAGES_PER_SECTOR % pages;
+        seq       = bestSeq + 1;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Producer
+// ---------------------------------------------------------------------------
+bool FlightRecorder::room(uint32_t t_ms, int n) {
+    if (open && (t_ms - lastMs > 0xFFFF || open->h.count + n > REC_PAGE_RECORDS)) seal();
+    if (open) return true;
+
+    open = ring.claim();
+    if (!open) {
+        st.dropped++;
+        if (droppedSince < 0xFFFF) droppedSince++;
+        return false;
+    }
+    memset(open, 0xFF, sizeof(*open));
+    open->h.magic   = REC_PAGE_MAGIC;
+    open->h.seq     = seq;
+    open->h.t0_ms   = t_ms;
+    open->h.count   = 0;
+    open->h.version = REC_VERSION;
+    open->h.dropped = droppedSince;
+    droppedSince    = 0;
+    lastMs          = t_ms;
+    openMs          = t_ms;
+    gpsRef          = false;
+    return true;
+}
+
+RecRecord* FlightRecorder::put(uint8_t type, uint8_t aux, uint32_t t_ms) {
+    RecRecord* r = &open->r[open->h.count++];
+    r->type  = type;
+    r->aux   = aux;
+    r->dt_ms = (uint16_t)(t_ms - lastMs);
+    lastMs   = t_ms;
+    st.records++;
+    return r;
+}
+
+void FlightRecorder::seal() {
+    if (!open) return;
+    open->h.crc = pageCrc(*open);
+    ring.publish();
+    open = nullptr;
+    seq++;
+    uint32_t queued = ring.size();
+    if (queued > st.max_queue) st.max_queue = queued;
+}
+
+void FlightRecorder::gps(uint32_t t_ms, int32_t lat_e7, int32_t lon_e7, uint16_t sog_cms, uint16_t cog_cdeg, uint8_t sats) {
+    int32_t dlat = lat_e7 - gpsLat;
+    int32_t dlon = lon_e7 - gpsLon;
+    bool    fits = dlat >= INT16_MIN && dlat <= INT16_MAX && dlon >= INT16_MIN && dlon <= INT16_MAX;
+    if (!room(t_ms, gpsRef && fits ? 1 : 2)) return;
+    if (!gpsRef || !fits) {                       // room() may have opened a page
+        RecRecord* a = put(REC_GPS_ABS, sats, t_ms);
+        put32(a->data, 0, (uint32_t)lat_e7);
+        put32(a->data, 4, (uint32_t)lon_e7);
+        dlat = dlon = 0;
+    }
+    RecRecord* r = put(REC_GPS, sats, t_ms);
+    put16(r->data, 0, (uint16_t)(int16_t)dlat);
+    put16(r->data, 2, (uint16_t)(int16_t)dlon);
+    put16(r->data, 4, sog_cms);
+    put16(r->data, 6, cog_cdeg);
+    gpsLat = lat_e7;
+    gpsLon = lon_e7;
+    gpsRef = true;
+}
+
+void FlightRecorder::compass(uint32_t t_ms, uint16_t heading_cdeg, int16_t x, int16_t y, int16_t z) {
+    if (!room(t_ms, 1)) return;
+    RecRecord* r = put(REC_COMPASS, 0, t_ms);
+    put16(r->data, 0, heading_cdeg);
+    put16(r->data, 2, (uint16_t)x);
+    put16(r->data, 4, (uint16_t)y);
+    put16(r->data, 6, (uint16_t)z);
+}
+
+void FlightRecorder::vane(uint32_t t_ms, uint16_t vane_raw_cdeg, uint16_t abs_wind_cdeg, int16_t heading_error_cdeg) {
+    if (!room(t_ms, 1)) return;
+    RecRecord* r = put(REC_VANE, 0, t_ms);
+    put16(r->data, 0, vane_raw_cdeg);
+    put16(r->data, 2, abs_wind_cdeg);
+    put16(r->data, 4, (uint16_t)heading_error_cdeg);
+}
+
+void FlightRecorder::wind(uint32_t t_ms, uint16_t speed, uint16_t gust, uint16_t lull) {
+    if (!room(t_ms, 1)) return;
+    RecRecord* r = put(REC_WIND, 0, t_ms);
+    put16(r->data, 0, speed);
+    put16(r->data, 2, gust);
+    put16(r->data, 4, lull);
+}
+
+void FlightRecorder::range(uint32_t t_ms, const UltrasonicScan& scan, uint8_t zone) {
+    if (!room(t_ms, 1)) return;
+    RecRecord* r = put(REC_RANGE, zone, t_ms);
+    put16(r->data, 0, scan.fwd_cm);
+    put16(r->data, 2, scan.port_cm);
+    put16(r->data, 4, scan.stbd_cm);
+}
+
+void FlightRecorder::battery(uint32_t t_ms, uint16_t mv) {
+    if (!room(t_ms, 1)) return;
+    RecRecord* r = put(REC_BATTERY, 0, t_ms);
+    put16(r->data, 0, mv);
+}
+
+void FlightRecorder::radio(uint32_t t_ms, uint8_t event, uint8_t packet_type, uint8_t len, int16_t rssi, int8_t snr, uint8_t peer) {
+    if (!room(t_ms, 1)) return;
+    RecRecord* r = put(REC_RADIO, event, t_ms);
+    r->data[0] = packet_type;
+    r->data[1] = len;
+    put16(r->data, 2, (uint16_t)rssi);
+    r->data[4] = (uint8_t)snr;
+    r->data[5] = peer;
+}
+
+void FlightRecorder::sync(uint32_t t_ms) {
+    if (open && (open->h.count == REC_PAGE_RECORDS || t_ms - openMs >= REC_SYNC_MS)) seal();
+}
+
+void FlightRecorder::flush() {
+    seal();
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+int FlightRecorder::service() {
+    uint32_t t0 = hal_micros();
+    int      n  = 0;
+    while (const RecPage* p = ring.peek()) {
+        if (pages) {
+            uint32_t addr = writePage * REC_PAGE_SIZE;
+            if (writePage % PAGES_PER_SECTOR == 0) {
+                if (hal_flash_erase(addr, HAL_FLASH_SECTOR)) st.erases++;
+                else                                         st.flash_errors++;
+            }
+            if (hal_flash_write(addr, p, REC_PAGE_SIZE)) st.pages++;
+            else                                         st.flash_errors++;
+            writePage = (writePage + 1) % pages;
+            n++;
+        }
+        ring.release();
+    }
+    st.write_us += hal_micros() - t0;
+    return n;
+}
+
+RecStats FlightRecorder::stats() const {
+    return st;
+}
+
+#if defined(ARDUINO)
+static void recTask(void* arg) {
+    FlightRecorder* r = static_cast<FlightRecorder*>(arg);
+    for (;;) {
+        r->service();
+        vTaskDelay(pdMS_TO_TICKS(REC_TASK_PERIOD_MS));   // a page fills in ~0.5 s at the sized rate
+    }
+}
+
+bool FlightRecorder::startTask(uint8_t core) {
+    return xTaskCreatePinnedToCore(recTask, "rec", REC_TASK_STACK, this, REC_TASK_PRIORITY, nullptr, core) == pdPASS;
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Decoding
+// ---------------------------------------------------------------------------
+static const char* const TYPE_NAMES[REC_TYPE_COUNT] = {
+    "gps_abs", "gps", "compass", "vane", "wind", "range", "battery", "radio"
+};
+
+static const char* const F_GPS[]     = { "lat_e7", "lon_e7", "sog_cms", "cog_cdeg", "sats" };
+static const char* const F_COMPASS[] = { "heading_cdeg", "x", "y", "z" };
+static const char* const F_VANE[]    = { "vane_raw_cdeg", "abs_wind_cdeg", "heading_error_cdeg" };
+static const char* const F_WIND[]    = { "speed", "gust", "lull" };
+static const char* const F_RANGE[]   = { "fwd_cm", "port_cm", "stbd_cm", "zone" };
+static const char* const F_BATTERY[] = { "mv" };
+static const char* const F_RADIO[]   = { "event", "packet_type", "len", "rssi", "snr", "peer" };
+
+#define FIELDS(a) (*names = a, (int)(sizeof(a) / sizeof(a[0])))
+
+const char* rec_type_name(uint8_t type) {
+    return type < REC_TYPE_COUNT ? TYPE_NAMES[type] : "?";
+}
+
+int rec_field_names(uint8_t type, const char* const** names) {
+    switch (type) {
+        case REC_GPS:     return FIELDS(F_GPS);
+        case REC_COMPASS: return FIELDS(F_COMPASS);
+        case REC_VANE:    return FIELDS(F_VANE);
+        case REC_WIND:    return FIELDS(F_WIND);
+        case REC_RANGE:   return FIELDS(F_RANGE);
+        case REC_BATTERY: return FIELDS(F_BATTERY);
+        case REC_RADIO:   return FIELDS(F_RADIO);
+        default:          *names = nullptr; return 0;
+    }
+}
+
+static uint32_t decodePage(const RecPage& p, RecSink out, void* ctx) {
+    uint32_t n = 0, t = p.h.t0_ms;
+    int32_t  lat = 0, lon = 0;
+    bool     ref = false;
+    for (int i = 0; i < p.h.count; i++) {
+        const RecRecord& r = p.r[i];
+        const uint8_t*   d = r.data;
+        RecEntry e;
+        memset(&e, 0, sizeof(e));
+        t     += r.dt_ms;
+        e.seq  = p.h.seq;
+        e.t_ms = t;
+        e.type = r.type;
+        switch (r.type) {
+            case REC_GPS_ABS:
+                lat = (int32_t)get32(d, 0);
+                lon = (int32_t)get32(d, 4);
+                ref = true;
+                continue;
+            case REC_GPS:
+                if (!ref) continue;
+                lat += (int16_t)get16(d, 0);
+                lon += (int16_t)get16(d, 2);
+                e.v[0] = lat;
+                e.v[1] = lon;
+                e.v[2] = get16(d, 4);
+                e.v[3] = get16(d, 6);
+                e.v[4] = r.aux;
+                break;
+            case REC_COMPASS:
+                e.v[0] = get16(d, 0);
+                e.v[1] = (int16_t)get16(d, 2);
+                e.v[2] = (int16_t)get16(d, 4);
+                e.v[3] = (int16_t)get16(d, 6);
+                break;
+            case REC_VANE:
+                e.v[0] = get16(d, 0);
+                e.v[1] = get16(d, 2);
+                e.v[2] = (int16_t)get16(d, 4);
+                break;
+            case REC_WIND:
+                e.v[0] = get16(d, 0);
+                e.v[1] = get16(d, 2);
+                e.v[2] = get16(d, 4);
+                break;
+            case REC_RANGE:
+                e.v[0] = get16(d, 0);
+                e.v[1] = get16(d, 2);
+                e.v[2] = get16(d, 4);
+                e.v[3] = r.aux;
+                break;
+            case REC_BATTERY:
+                e.v[0] = get16(d, 0);
+                break;
+            case REC_RADIO:
+                e.v[0] = r.aux;
+                e.v[1] = d[0];
+                e.v[2] = d[1];
+                e.v[3] = (int16_t)get16(d, 2);
+                e.v[4] = (int8_t)d[4];
+                e.v[5] = d[5];
+                break;
+            default:
+                continue;          // a newer firmware's type
+        }
+        out(e, ctx);
+        n++;
+    }
+    return n;
+}
+
+uint32_t rec_decode_image(const uint8_t* image, size_t len, RecSink out, void* ctx,
+                          uint32_t* bad_pages, uint32_t* dropped) {
+    uint32_t count = (uint32_t)(len / REC_PAGE_SIZE);
+    uint32_t bad = 0, lost = 0, n = 0;
+    // The writer goes round the ring in order, so oldest-first is a walk from
+    // the lowest sequence number
+    bool     any   = false;
+    uint32_t start = 0, minSeq = 0;
+    RecPage  p;
+    for (uint32_t i = 0; i < count; i++) {
+        memcpy(&p, image + (size_t)i * REC_PAGE_SIZE, sizeof(p));
+        if (p.h.magic != REC_PAGE_MAGIC) continue;
+        if (!rec_page_valid(p)) { bad++; continue; }
+        if (!any || p.h.seq < minSeq) {
+            any    = true;
+            start  = i;
+            minSeq = p.h.seq;
+        }
+    }
+    for (uint32_t k = 0; any && k < count; k++) {
+        memcpy(&p, image + (size_t)((start + k) % count) * REC_PAGE_SIZE, sizeof(p));
+        if (!rec_page_valid(p)) continue;
+        lost += p.h.dropped;
+        n    += decodePage(p, out, ctx);
+    }
+    if (bad_pages) *bad_pages = bad;
+    if (dropped) *dropped = lost;
+    return n;
+}
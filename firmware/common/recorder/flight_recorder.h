@@ -0,0 +1,193 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "common/spsc_ring.h"
+#include "firmware/common/ultrasonic/ultrasonic.h"
+
+// ---------------------------------------------------------------------------
+// Flight-data recorder — fixed-size binary records in a raw flash ring
+//
+//   control task                       ui / log task (lowest priority)
+//   gps() compass() vane() ...         service()
+//     │ 12 B record into the page        │ erase the sector ahead,
+//     │ being filled (a claimed slot)    │ program one 256 B page each
+//     ▼                                  ▼
+//   SpscRing<RecPage, REC_RAM_PAGES> ───────► "rec" partition (hal_flash_*)
+//
+// A record is { type, aux, dt_ms, 8 payload bytes }: dt_ms is the time since
+// the previous record (a gap that does not fit starts a new page), and GPS
+// positions are int16 deltas in 1e-7° from the previous fix (±3.3 mm per LSB,
+// ±3.6 km per step) after a REC_GPS_ABS reference — once per page, or when
+// a step does not fit. Every value is an integer in the unit the producer
+// already has — no float formatting anywhere on the buoy.
+//
+// Pages (16 B header + 20 records) carry a sequence number, the absolute
+// time of their first record and a CRC16, so each decodes on its own: the
+// ring overwrites the oldest sector, a torn page after a power cut fails its
+// CRC, and begin() resumes after the newest valid page on the next boot.
+//
+// The producer never touches flash. A page is sealed when full, or after
+// REC_SYNC_MS so slow data reaches flash within ~1 s; if every RAM page is
+// waiting for the writer, records are dropped and counted (the next page
+// header carries the count). On target, a page program briefly pauses the
+// flash cache on both cores (~1 ms); the writer erases one 4 KB sector per
+// 16 pages (ESP-IDF yields during erase).
+//
+// Sizing: ~40 records/s (GPS 10 Hz, compass 10 Hz, vane / wind 5 Hz,
+// ranges 10 Hz) is 2 pages/s, so the 1.9 MB partition holds ~65 min.
+// Read it out with esptool (read_flash at the partition offset) and decode
+// with testing/flight_decode.
+//
+//   FlightRecorder rec;
+//   rec.begin();                                       // setup()
+//   rec.compass(hal_millis(), heading_cdeg, x, y, z);  // control step
+//   rec.service();                                     // log task, or
+//   rec.startTask();                                   // setup(): service() in its own task
+// ---------------------------------------------------------------------------
+
+#define REC_PAGE_SIZE      256
+#define REC_RECORD_SIZE    12
+#define REC_PAGE_RECORDS   20
+#define REC_PAGE_MAGIC     0x5246   // "FR"
+#define REC_VERSION        1
+#define REC_RAM_PAGES      8        // pages waiting for the writer, power of two (2 KB)
+#define REC_SYNC_MS        1000     // seal a partly filled page after this long
+#define REC_TASK_STACK     3072
+#define REC_TASK_PRIORITY  1          // lowest application priority: erase/program block only this task
+#define REC_TASK_CORE      0          // loop() runs on core 1
+#define REC_TASK_PERIOD_MS 100        // service() interval; REC_RAM_PAGES covers ~4 s of records
+
+enum RecType : uint8_t {
+    REC_EMPTY    = 0xFF,   // erased flash: end of a partly filled page
+    REC_GPS_ABS  = 0,      // i32 lat_e7, i32 lon_e7 — reference for the REC_GPS that follows
+    REC_GPS      = 1,      // i16 dlat_e7, i16 dlon_e7, u16 sog_cms, u16 cog_cdeg   aux: sats
+    REC_COMPASS  = 2,      // u16 heading_cdeg, i16 x, y, z (raw counts)
+    REC_VANE     = 3,      // u16 vane_raw_cdeg, u16 abs_wind_cdeg, i16 heading_error_cdeg
+    REC_WIND     = 4,      // u16 speed, gust, lull (0.01 km/h)
+    REC_RANGE    = 5,      // u16 fwd, port, stbd (cm)           aux: ObstacleZone
+    REC_BATTERY  = 6,      // u16 mV
+    REC_RADIO    = 7,      // u8 packet_type, u8 len, i16 rssi, i8 snr, u8 peer   aux: RecRadioEvent
+    REC_TYPE_COUNT
+};
+
+enum RecRadioEvent : uint8_t {
+    REC_RADIO_TX = 0,
+    REC_RADIO_RX,
+    REC_RADIO_BAD_CRC,
+    REC_RADIO_TIMEOUT
+};
+
+struct __attribute__((packed)) RecRecord {
+    uint8_t  type;             // RecType
+    uint8_t  aux;
+    uint16_t dt_ms;            // since the previous record in the page
+    uint8_t  data[8];
+};
+static_assert(sizeof(RecRecord) == REC_RECORD_SIZE, "RecRecord is the on-flash layout");
+
+struct __attribute__((packed)) RecPageHeader {
+    uint16_t magic;
+    uint16_t crc;              // CRC16-CCITT of bytes [4, REC_PAGE_SIZE)
+    uint32_t seq;              // page number since the partition was first used
+    uint32_t t0_ms;            // hal_millis() of the first record
+    uint8_t  count;            // records (the rest stay 0xFF)
+    uint8_t  version;
+    uint16_t dropped;          // records lost to a full RAM ring since the previous page
+};
+
+struct RecPage {
+    RecPageHeader h;
+    RecRecord     r[REC_PAGE_RECORDS];
+};
+static_assert(sizeof(RecPage) == REC_PAGE_SIZE, "RecPage is one flash page");
+
+bool rec_page_valid(const RecPage& p);
+
+struct RecStats {
+    uint32_t records;          // accepted by the producer
+    uint32_t dropped;          // RAM ring full
+    uint32_t pages;            // written to flash
+    uint32_t erases;
+    uint32_t flash_errors;
+    uint32_t write_us;         // time spent in service(), flash included
+    uint32_t max_queue;        // pages waiting, high-water mark
+    uint32_t capacity_pages;
+};
+
+class FlightRecorder {
+public:
+    FlightRecorder();
+
+    // Find the newest page in the partition and continue in the sector after
+    // it; false if there is no partition (pages are then discarded unwritten)
+    bool begin();
+
+    // Producer side — one task only, constant time, never waits
+    void gps(uint32_t t_ms, int32_t lat_e7, int32_t lon_e7, uint16_t sog_cms, uint16_t cog_cdeg, uint8_t sats);
+    void compass(uint32_t t_ms, uint16_t heading_cdeg, int16_t x, int16_t y, int16_t z);
+    void vane(uint32_t t_ms, uint16_t vane_raw_cdeg, uint16_t abs_wind_cdeg, int16_t heading_error_cdeg);
+    void wind(uint32_t t_ms, uint16_t speed, uint16_t gust, uint16_t lull);
+    void range(uint32_t t_ms, const UltrasonicScan& scan, uint8_t zone);
+    void battery(uint32_t t_ms, uint16_t mv);
+    void radio(uint32_t t_ms, uint8_t event, uint8_t packet_type, uint8_t len, int16_t rssi, int8_t snr, uint8_t peer);
+    void sync(uint32_t t_ms);                 // seal the open page if REC_SYNC_MS old
+    void flush();                             // seal the open page now (before a planned power-off)
+
+    // Writer side — lowest-priority task; returns pages written
+    int service();
+#if defined(ARDUINO)
+    // Run service() every REC_TASK_PERIOD_MS in a pinned low-priority task
+    bool startTask(uint8_t core = REC_TASK_CORE);
+#endif
+
+    uint32_t nextSeq() const { return seq; }
+    RecStats stats() const;
+
+private:
+    bool       room(uint32_t t_ms, int n);     // open page with n free records, false: dropped
+    RecRecord* put(uint8_t type, uint8_t aux, uint32_t t_ms);
+    void       seal();
+
+    SpscRing<RecPage, REC_RAM_PAGES> ring;
+    RecPage* open;             // claimed slot being filled, nullptr if none
+    uint32_t seq;              // producer: next page's sequence number
+    uint32_t lastMs;
+    uint32_t openMs;
+    int32_t  gpsLat, gpsLon;   // previous fix in the open page
+    bool     gpsRef;
+    uint16_t droppedSince;
+
+    uint32_t pages;            // writer: partition size in pages
+    uint32_t writePage;        // next page index to program
+    RecStats st;
+};
+
+// ---------------------------------------------------------------------------
+// Decoding — host tools and tests. Records come back in time order with
+// absolute time and position; aux is folded into the values.
+// ---------------------------------------------------------------------------
+#define REC_MAX_FIELDS 6
+
+struct RecEntry {
+    uint32_t seq;              // page
+    uint32_t t_ms;
+    uint8_t  type;             // RecType, never REC_GPS_ABS
+    int32_t  v[REC_MAX_FIELDS];
+};
+
+const char* rec_type_name(uint8_t type);
+// Names of the RecEntry::v values for a type, e.g. REC_GPS: lat_e7 lon_e7
+// sog_cms cog_cdeg sats; returns how many (0: unknown type)
+int         rec_field_names(uint8_t type, const char* const** names);
+
+// Decode every valid page of a partition image, oldest first, calling
+// out(entry, ctx) per record; returns records decoded. bad_pages counts pages
+// with the magic but a failed CRC (torn writes), dropped sums the records the
+// pages report as lost to a full RAM ring. Walks the ring in place — no heap.
+typedef void (*RecSink)(const RecEntry& e, void* ctx);
+uint32_t rec_decode_image(const uint8_t* image, size_t len, RecSink out, void* ctx,
+                          uint32_t* bad_pages = nullptr, uint32_t* dropped = nullptr);
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,126 @@
+#ifndef BUOY_TASKS_H
+#define BUOY_TASKS_H
+
+#include <stdint.h>
+#include "common/config.h"
+#include "common/spsc_ring.h"
+#include "common/triple_buffer.h"
+#include "firmware/common/tasks/task_set.h"
+#include "firmware/common/ultrasonic/ultrasonic.h"
+
+// ---------------------------------------------------------------------------
+// Buoy task table and inter-task channels
+//
+//   core 0                                      core 1
+//   ┌────────────┐  latest samples (TripleBuffer)  ┌─────────────┐
+//   │ sensor     │ ─ gps / heading / range / wind ─► control     │ LOOP_RATE_HZ
+//   │ 50 Hz      │                                 │             │
+//   └────────────┘                                 └──┬───────▲──┘
+//   ┌────────────┐   LoraAsync TX ring  ◄─────────────┘       │ ControlRecord
+//   │ radio      │   LoraAsync RX ring  ──► control           │ (SpscRing)
+//   │ DIO0 / 5 ms│                                 ┌──────────┴──┐
+//   └────────────┘                                 │ ui / log    │ 5 Hz, lowest
+//   (I2cBus, OledFlush tasks: core 0)              └─────────────┘
+//
+// Sensors → control carry only the newest value: each TripleBuffer has one
+// writer (sensor task) and one reader (control task); a sample the control
+// step does not need is simply overwritten. Everything the UI/log task
+// shows comes through ControlRecords, which must all arrive, so that hop is
+// an SpscRing (drops counted by the producer). Radio traffic uses
+// LoraAsync's own rings: control send()/receive(), radio task poll(),
+// woken by the DIO0 interrupt through TaskSet::notifyFromIsr().
+//
+// Core 1 keeps control deterministic (nothing else there but the lowest
+// priority UI); core 0 takes the I/O: radio above sensors above the bus and
+// display tasks.
+// ---------------------------------------------------------------------------
+
+#define TASK_SENSOR_PERIOD_US   20000                      // compass / ranges at 50 Hz
+#define TASK_CONTROL_PERIOD_US  (1000000 / LOOP_RATE_HZ)
+#define TASK_RADIO_PERIOD_US    5000                       // heartbeat; DIO0 wakes it sooner
+#define TASK_UI_PERIOD_US       200000                     // 5 Hz display / log
+#define TASK_LOG_QUEUE          16                         // ControlRecords, power of two
+
+enum BuoyTask : uint8_t {
+    TASK_SENSOR  = 0,
+    TASK_CONTROL = 1,
+    TASK_RADIO   = 2,
+    TASK_UI      = 3,
+    TASK_BUOY_COUNT
+};
+
+struct BuoyTaskConfig {
+    const char* name;
+    uint32_t    period_us;
+    uint8_t     priority;
+    uint8_t     core;
+    uint16_t    stack;
+    bool        notifiable;
+};
+
+static constexpr BuoyTaskConfig BUOY_TASKS[TASK_BUOY_COUNT] = {
+    { "sensor",  TASK_SENSOR_PERIOD_US,  4, 0, 4096, false },
+    { "control", TASK_CONTROL_PERIOD_US, 3, 1, 6144, false },
+    { "radio",   TASK_RADIO_PERIOD_US,   5, 0, 4096, true  },
+    { "ui",      TASK_UI_PERIOD_US,      1, 1, 4096, false },
+};
+
+// TaskSpec for one buoy task with its step function
+static inline TaskSpec buoy_task(BuoyTask which, TaskStep step, void* ctx) {
+    const BuoyTaskConfig& c = BUOY_TASKS[which];
+    TaskSpec s = { c.name, step, ctx, c.period_us, c.priority, c.core, c.stack, c.notifiable };
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// Messages — t_us is hal_micros() when the value was measured
+// ---------------------------------------------------------------------------
+struct GpsSample {
+    uint32_t t_us;
+    int32_t  lat_e7;
+    int32_t  lon_e7;
+    uint16_t hdop_x10;
+    uint8_t  fix_quality;
+    uint8_t  sats;
+};
+
+struct HeadingSample {
+    uint32_t t_us;
+    float    heading_deg;     // magnetic, 0–360
+    int16_t  raw_x, raw_y, raw_z;
+};
+
+struct RangeSample {
+    uint32_t       t_us;
+    UltrasonicScan scan;
+};
+
+struct WindSample {
+    uint32_t t_us;
+    float    vane_deg;
+    float    speed_kmh;
+    float    gust_kmh;
+    float    lull_kmh;
+};
+
+struct ControlRecord {
+    uint32_t t_us;
+    uint32_t seq;
+    uint8_t  state;
+    uint8_t  zone;            // ObstacleZone of the last scan
+    int16_t  heading_cmd_cdeg;
+    int16_t  thrust_left;     // −1000…+1000
+    int16_t  thrust_right;
+    uint16_t target_dist_dm;
+    uint16_t sample_age_ms;   // oldest input the step used
+};
+
+struct BuoyChannels {
+    TripleBuffer<GpsSample>                 gps;       // sensor → control
+    TripleBuffer<HeadingSample>             heading;
+    TripleBuffer<RangeSample>               range;
+    TripleBuffer<WindSample>                wind;      // master only
+    SpscRing<ControlRecord, TASK_LOG_QUEUE> log;       // control → ui / log
+};
+
+#endif // BUOY_TASKS_H
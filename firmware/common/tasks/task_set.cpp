@@ -0,0 +1,161 @@
+#include "task_set.h"
+
+TaskSet::TaskSet() : task(), count(0), windowStartUs(0) {}
+
+int TaskSet::add(const TaskSpec& spec) {
+    if (count >= TASK_SET_MAX || !spec.step || spec.core >= TASK_CORES || spec.period_us == 0) return -1;
+    Task& t = task[count];
+    t.spec  = spec;
+    t.owner = this;
+    t.dueUs = hal_micros();
+#if defined(ARDUINO)
+    t.handle = nullptr;
+#endif
+    return count++;
+}
+
+// Time one step and fold it into the task's counters
+void TaskSet::runStep(Task& t, uint32_t due) {
+    uint32_t start = hal_micros();
+    t.spec.step(t.spec.ctx);
+    uint32_t us = hal_micros() - start;
+
+    t.runs.fetch_add(1, std::memory_order_relaxed);
+    t.busyUs.fetch_add(us, std::memory_order_relaxed);
+    if (us > t.stepMaxUs.load(std::memory_order_relaxed)) t.stepMaxUs.store(us, std::memory_order_relaxed);
+    if (us > t.spec.period_us) t.overruns.fetch_add(1, std::memory_order_relaxed);
+    uint32_t late = (int32_t)(start - due) > 0 ? start - due : 0;
+    if (late > t.lateMaxUs.load(std::memory_order_relaxed)) t.lateMaxUs.store(late, std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Accounting
+// ---------------------------------------------------------------------------
+TaskStats TaskSet::stats(int id) const {
+    TaskStats s = {};
+    if (id < 0 || id >= count) return s;
+    const Task& t    = task[id];
+    s.name           = t.spec.name;
+    s.core           = t.spec.core;
+    s.priority       = t.spec.priority;
+    s.period_us      = t.spec.period_us;
+    s.runs           = t.runs.load(std::memory_order_relaxed);
+    s.overruns       = t.overruns.load(std::memory_order_relaxed);
+    s.busy_us        = t.busyUs.load(std::memory_order_relaxed);
+    s.step_max_us    = t.stepMaxUs.load(std::memory_order_relaxed);
+    s.late_max_us    = t.lateMaxUs.load(std::memory_order_relaxed);
+#if defined(ARDUINO)
+    if (t.handle) s.stack_free_min = uxTaskGetStackHighWaterMark((TaskHandle_t)t.handle);   // bytes on ESP32
+#endif
+    return s;
+}
+
+uint32_t TaskSet::coreBusyUs(uint8_t core) const {
+    uint32_t us = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (task[i].spec.core == core) us += task[i].busyUs.load(std::memory_order_relaxed);
+    }
+    return us;
+}
+
+void TaskSet::resetStats() {
+    for (uint8_t i = 0; i < count; i++) {
+        Task& t = task[i];
+        t.runs.store(0, std::memory_order_relaxed);
+        t.overruns.store(0, std::memory_order_relaxed);
+        t.busyUs.store(0, std::memory_order_relaxed);
+        t.stepMaxUs.store(0, std::memory_order_relaxed);
+        t.lateMaxUs.store(0, std::memory_order_relaxed);
+    }
+    windowStartUs = hal_micros();
+}
+
+// ---------------------------------------------------------------------------
+#if defined(ARDUINO)
+void TaskSet::entry(void* arg) {
+    Task&      t      = *static_cast<Task*>(arg);
+    TickType_t period = pdMS_TO_TICKS(t.spec.period_us / 1000);
+    if (period == 0) period = 1;
+    TickType_t last   = xTaskGetTickCount();
+    for (;;) {
+        if (t.spec.notifiable) {
+            ulTaskNotifyTake(pdTRUE, period);
+            t.owner->runStep(t, hal_micros());
+        } else {
+            vTaskDelayUntil(&last, period);
+            t.owner->runStep(t, t.dueUs);
+            t.dueUs += t.spec.period_us;
+        }
+    }
+}
+
+bool TaskSet::start() {
+    resetStats();
+    for (uint8_t i = 0; i < count; i++) {
+        Task&        t = task[i];
+        TaskHandle_t h = nullptr;
+        t.dueUs = hal_micros() + t.spec.period_us;
+        if (xTaskCreatePinnedToCore(entry, t.spec.name, t.spec.stack, &t, t.spec.priority, &h, t.spec.core) != pdPASS) {
+            return false;
+        }
+        t.handle = h;
+    }
+    return true;
+}
+
+void TaskSet::notify(int id) {
+    if (id >= 0 && id < count && task[id].handle) xTaskNotifyGive((TaskHandle_t)task[id].handle);
+}
+
+void HAL_ISR_ATTR TaskSet::notifyFromIsr(int id) {
+    if (id < 0 || id >= count || !task[id].handle) return;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)task[id].handle, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+#else
+bool TaskSet::start() {
+    resetStats();
+    for (uint8_t i = 0; i < count; i++) task[i].dueUs = hal_micros() + task[i].spec.period_us;
+    return true;
+}
+
+void TaskSet::notify(int id) {
+    if (id >= 0 && id < count) task[id].notified.store(true, std::memory_order_release);
+}
+
+void TaskSet::notifyFromIsr(int id) { notify(id); }
+
+void TaskSet::runFor(uint32_t us) {
+    uint32_t end = hal_micros() + us;
+    for (;;) {
+        uint32_t now  = hal_micros();
+        int      pick = -1;
+        for (uint8_t i = 0; i < count; i++) {
+            Task& t   = task[i];
+            bool  due = (int32_t)(now - t.dueUs) >= 0 ||
+                        (t.spec.notifiable && t.notified.load(std::memory_order_acquire));
+            if (due && (pick < 0 || t.spec.priority > task[pick].spec.priority)) pick = i;
+        }
+        if (pick >= 0) {
+            Task& t = task[pick];
+            if (t.spec.notifiable) {
+                t.notified.store(false, std::memory_order_relaxed);
+                runStep(t, now);
+                t.dueUs = hal_micros() + t.spec.period_us;   // timeout restarts after each wake
+            } else {
+                runStep(t, t.dueUs);
+                t.dueUs += t.spec.period_us;
+            }
+            continue;
+        }
+        if ((int32_t)(now - end) >= 0) return;
+        uint32_t next = end;
+        for (uint8_t i = 0; i < count; i++) {
+            if ((int32_t)(task[i].dueUs - next) < 0) next = task[i].dueUs;
+        }
+        hal_host_advance_us(next - now);
+    }
+}
+#endif
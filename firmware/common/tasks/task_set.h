@@ -0,0 +1,111 @@
+#ifndef TASK_SET_H
+#define TASK_SET_H
+
+#include <atomic>
+#include <stdint.h>
+#include "firmware/common/hal/hal.h"
+
+// ---------------------------------------------------------------------------
+// Pinned periodic tasks with CPU and stack accounting
+//
+// A buoy's work split into a few FreeRTOS tasks, each pinned to a core and
+// running one step() per period instead of one loop() paced by delay():
+//
+//   TaskSpec { "control", controlStep, &ctx, 100000, prio 3, core 1, 4096 B }
+//
+//   fixed rate    vTaskDelayUntil(): step() every period_us, late steps run
+//                 back to back to catch up (each overrun counted)
+//   notifiable    waits for notify() — an IRQ, a queue producer — or at most
+//                 period_us, then steps: event-driven with a heartbeat
+//
+// Tasks exchange data through lock-free structures only (TripleBuffer for
+// latest samples, SpscRing for messages), so no step() ever waits on another
+// task. See tasks/buoy_tasks.h for the buoy's task table and channels.
+//
+// Accounting per task: runs, overruns (step longer than its period),
+// busy time and worst step, worst start latency (due → start) and, on
+// target, the stack high-water mark (bytes never touched). Busy time is
+// hal_micros() around step(), so preemption by a higher-priority task on
+// the same core counts against the preempted one. Busy over windowUs()
+// gives CPU per task; coreBusyUs() sums it per core.
+//
+// On host, runFor() runs the set cooperatively on the virtual clock: the
+// highest-priority due task first, hal_host_advance_us() between due times.
+// Both cores share the one host thread.
+// ---------------------------------------------------------------------------
+
+#define TASK_SET_MAX   6
+#define TASK_CORES     2
+
+typedef void (*TaskStep)(void* ctx);
+
+struct TaskSpec {
+    const char* name;
+    TaskStep    step;
+    void*       ctx;
+    uint32_t    period_us;
+    uint8_t     priority;     // FreeRTOS priority, higher runs first
+    uint8_t     core;
+    uint16_t    stack;        // bytes
+    bool        notifiable;   // wake on notify() as well as every period_us
+};
+
+struct TaskStats {
+    const char* name;
+    uint8_t     core;
+    uint8_t     priority;
+    uint32_t    period_us;
+    uint32_t    runs;
+    uint32_t    overruns;
+    uint32_t    busy_us;
+    uint32_t    step_max_us;
+    uint32_t    late_max_us;      // due → start, fixed-rate tasks
+    uint32_t    stack_free_min;   // bytes; 0 on host (no separate stacks)
+};
+
+class TaskSet {
+public:
+    TaskSet();
+
+    // setup(): register before start(). Returns the task handle, or -1.
+    int  add(const TaskSpec& spec);
+    bool start();
+
+    // Wake a notifiable task now (from another task, or from an ISR)
+    void notify(int id);
+    void notifyFromIsr(int id);
+
+#if !defined(ARDUINO)
+    // Host: run due steps on the virtual clock for us microseconds
+    void runFor(uint32_t us);
+#endif
+
+    uint8_t   tasks() const { return count; }
+    TaskStats stats(int id) const;
+    uint32_t  coreBusyUs(uint8_t core) const;
+    uint32_t  windowUs() const { return hal_micros() - windowStartUs; }
+    void      resetStats();
+
+private:
+    struct Task {
+        TaskSpec              spec;
+        TaskSet*              owner;
+        uint32_t              dueUs;
+        std::atomic<bool>     notified;
+        std::atomic<uint32_t> runs, overruns, busyUs, stepMaxUs, lateMaxUs;
+#if defined(ARDUINO)
+        void*                 handle;   // TaskHandle_t
+#endif
+    };
+
+    void runStep(Task& t, uint32_t due);
+#if defined(ARDUINO)
+    static void entry(void* arg);
+#endif
+
+    Task     task[TASK_SET_MAX];
+    uint8_t  count;
+    uint32_t windowStartUs;
+};
+
+#endif // TASK_SET_H
@@ -0,0 +1,240 @@
+#include "telemetry.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "common/cobs.h"
+#include "common/protocol.h"
+
+static const char* const WIND_STATE[] = { "FILL", "STABLE", "SHIFT" };
+static const char* const ZONE_NAMES[] = { "CLEAR", "AVOID PORT", "AVOID STBD", "STOP" };   // ObstacleZone
+
+static const TelemField WIND_FIELDS[] = {
+    //  name           type     decimals  labels
+    { "vane_raw",     TF_U16,  1,        nullptr, 0 },
+    { "vane_rel",     TF_U16,  1,        nullptr, 0 },
+    { "compass",      TF_U16,  0,        nullptr, 0 },
+    { "abs_wind",     TF_U16,  1,        nullptr, 0 },
+    { "error",        TF_I16,  1,        nullptr, 0 },
+    { "speed_kmh",    TF_U16,  2,        nullptr, 0 },
+    { "gust",         TF_U16,  2,        nullptr, 0 },
+    { "lull",         TF_U16,  2,        nullptr, 0 },
+    { "mean_60s",     TF_U16,  1,        nullptr, 0 },
+    { "cvar",         TF_U16,  4,        nullptr, 0 },
+    { "shift",        TF_U16,  1,        nullptr, 0 },
+    { "stable",       TF_U8,   0,        WIND_STATE, 3 },
+};
+
+static const TelemField RANGE_FIELDS[] = {
+    { "fwd_cm",       TF_U16,  0,        nullptr, 0 },
+    { "port_cm",      TF_U16,  0,        nullptr, 0 },
+    { "stbd_cm",      TF_U16,  0,        nullptr, 0 },
+    { "status",       TF_U8,   0,        ZONE_NAMES, 4 },
+    { "sweep_ms",     TF_U16,  1,        nullptr, 0 },
+    { "oled_bytes",   TF_U16,  0,        nullptr, 0 },
+    { "oled_us",      TF_U32,  0,        nullptr, 0 },
+};
+
+#define SCHEMA(name, fields) { name, (uint8_t)(sizeof(fields) / sizeof(fields[0])), fields }
+
+const TelemSchema TELEM_SCHEMAS[TELEM_TYPE_COUNT] = {
+    { nullptr, 0, nullptr },
+    SCHEMA("wind", WIND_FIELDS),
+    SCHEMA("range", RANGE_FIELDS),
+};
+
+static const float POW10[] = { 1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f };
+
+static size_t fieldSize(uint8_t type) {
+    return type == TF_U32 ? 4 : type == TF_U8 ? 1 : 2;
+}
+
+static int32_t clampField(uint8_t type, float scaled) {
+    float lo = type == TF_I16 ? -32768.0f : 0.0f;
+    float hi = type == TF_U8 ? 255.0f : type == TF_I16 ? 32767.0f : type == TF_U16 ? 65535.0f : 4294967295.0f;
+    if (!(scaled >= lo)) scaled = lo;   // NaN → lo
+    if (scaled > hi) scaled = hi;
+    return type == TF_U32 ? (int32_t)(uint32_t)llroundf(scaled) : (int32_t)lroundf(scaled);
+}
+
+static bool knownType(uint8_t type) {
+    return type > 0 && type < TELEM_TYPE_COUNT;
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+Telemetry::Telemetry() : len(0), binary(false), seq(0), open(false), bad(false), cur(), st() {}
+
+void Telemetry::clear() {
+    len = 0;
+}
+
+void Telemetry::header(uint8_t type) {
+    if (binary || !knownType(type)) return;
+    const TelemSchema& s = TELEM_SCHEMAS[type];
+    int n = snprintf((char*)buf + len, TELEM_BUF - len, "# %s: t_ms", s.name);
+    for (int i = 0; n > 0 && i < s.count && len + n < TELEM_BUF; i++) {
+        n += snprintf((char*)buf + len + n, TELEM_BUF - len - n, "\t%s", s.fields[i].name);
+    }
+    if (n > 0 && len + n + 1 < TELEM_BUF) {
+        buf[len + n] = '\n';
+        len += n + 1;
+    }
+}
+
+void Telemetry::begin(uint8_t type, uint32_t t_ms) {
+    cur.type  = type;
+    cur.t_ms  = t_ms;
+    cur.count = 0;
+    open      = true;
+    bad       = !knownType(type);
+}
+
+void Telemetry::add(float value) {
+    if (!open || bad) return;
+    const TelemSchema& s = TELEM_SCHEMAS[cur.type];
+    if (cur.count >= s.count) {
+        bad = true;
+        return;
+    }
+    const TelemField& f = s.fields[cur.count];
+    cur.v[cur.count++]  = clampField(f.type, value * POW10[f.decimals]);
+}
+
+bool Telemetry::end() {
+    if (!open) return false;
+    open = false;
+    const TelemSchema* s = knownType(cur.type) ? &TELEM_SCHEMAS[cur.type] : nullptr;
+    if (bad || !s || cur.count != s->count) {
+        st.schema_errors++;
+        return false;
+    }
+    cur.seq = seq;
+
+    if (binary) {
+        uint8_t raw[TELEM_RECORD_MAX];
+        size_t  n = 0;
+        raw[n++]  = cur.type;
+        raw[n++]  = cur.seq;
+        memcpy(raw + n, &cur.t_ms, 4);
+        n += 4;
+        for (int i = 0; i < cur.count; i++) {
+            size_t sz = fieldSize(s->fields[i].type);
+            memcpy(raw + n, &cur.v[i], sz);        // little-endian: low bytes first
+            n += sz;
+        }
+        uint16_t crc = calculate_checksum(raw, n);
+        raw[n++]     = (uint8_t)(crc & 0xFF);
+        raw[n++]     = (uint8_t)(crc >> 8);
+
+        size_t lead = len == 0 ? 1 : 0;           // the batch's opening delimiter
+        if (len + lead + COBS_MAX_ENCODED(n) + 1 > TELEM_BUF) {
+            st.dropped++;
+            return false;
+        }
+        if (lead) buf[len++] = 0;
+        len += cobs_encode(raw, n, buf + len);
+        buf[len++] = 0;
+    } else {
+        char   line[TELEM_MAX_FIELDS * 12 + 16];
+        size_t n = (size_t)snprintf(line, sizeof(line), "%lu", (unsigned long)cur.t_ms);
+        for (int i = 0; i < cur.count; i++) {
+            line[n++] = '\t';
+            n += telem_format_value(s->fields[i], cur.v[i], line + n, sizeof(line) - n - 1);
+        }
+        line[n++] = '\n';
+        if (len + n > TELEM_BUF) {
+            st.dropped++;
+            return false;
+        }
+        memcpy(buf + len, line, n);
+        len += n;
+    }
+    seq++;
+    st.records++;
+    return true;
+}
+
+size_t telem_format_value(const TelemField& f, int32_t v, char* out, size_t cap) {
+    int n;
+    if (f.labels && v >= 0 && v < f.nlabels) {
+        n = snprintf(out, cap, "%s", f.labels[v]);
+    } else if (f.type == TF_U32) {
+        n = snprintf(out, cap, "%lu", (unsigned long)(uint32_t)v);
+    } else if (f.decimals == 0) {
+        n = snprintf(out, cap, "%ld", (long)v);
+    } else {
+        long div = (long)POW10[f.decimals];
+        long a   = v < 0 ? -(long)v : (long)v;
+        n = snprintf(out, cap, "%s%ld.%0*ld", v < 0 ? "-" : "", a / div, (int)f.decimals, a % div);
+    }
+    return n < 0 ? 0 : (size_t)n < cap ? (size_t)n : cap - 1;
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+// ---------------------------------------------------------------------------
+bool telem_decode(const uint8_t* frame, size_t len, TelemRecord* out) {
+    uint8_t raw[TELEM_RECORD_MAX];
+    if (len == 0 || len > COBS_MAX_ENCODED(TELEM_RECORD_MAX)) return false;
+    size_t n = cobs_decode(frame, len, raw);
+    if (n < TELEM_HEADER_SIZE + 2 || n > TELEM_RECORD_MAX || !verify_checksum(raw, n)) return false;
+    if (!knownType(raw[0])) return false;
+
+    const TelemSchema& s = TELEM_SCHEMAS[raw[0]];
+    size_t want = TELEM_HEADER_SIZE + 2;
+    for (int i = 0; i < s.count; i++) want += fieldSize(s.fields[i].type);
+    if (n != want) return false;
+
+    out->type  = raw[0];
+    out->seq   = raw[1];
+    memcpy(&out->t_ms, raw + 2, 4);
+    out->count = s.count;
+    size_t p   = TELEM_HEADER_SIZE;
+    for (int i = 0; i < s.count; i++) {
+        const uint8_t* b = raw + p;
+        switch (s.fields[i].type) {
+            case TF_U8:  out->v[i] = b[0]; p += 1; break;
+            case TF_I16: out->v[i] = (int16_t)(b[0] | b[1] << 8); p += 2; break;
+            case TF_U16: out->v[i] = (uint16_t)(b[0] | b[1] << 8); p += 2; break;
+            default:     memcpy(&out->v[i], b, 4); p += 4; break;
+        }
+    }
+    return true;
+}
+
+TelemReader::TelemReader() : len(0), overflow(false), lastSeq(-1), rec(), st() {}
+
+static bool printable(const uint8_t* p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (p[i] < 0x20 && p[i] != '\n' && p[i] != '\r' && p[i] != '\t') return false;
+    }
+    return n > 0;
+}
+
+int TelemReader::feed(uint8_t byte) {
+    if (byte != 0) {
+        if (len < TELEM_READER_BUF) chunk[len++] = byte;
+        else                        overflow = true;
+        return TELEM_NONE;
+    }
+    size_t n    = len;
+    bool   over = overflow;
+    len         = 0;
+    overflow    = false;
+    if (n == 0) return TELEM_NONE;               // back-to-back delimiters
+
+    if (!over && telem_decode(chunk, n, &rec)) {
+        if (lastSeq >= 0) st.lost += (uint8_t)(rec.seq - lastSeq - 1);
+        lastSeq = rec.seq;
+        st.records++;
+        return TELEM_GOT_RECORD;
+    }
+    if (printable(chunk, n)) {
+        chunk[n] = 0;
+        st.text_chunks++;
+        return TELEM_GOT_TEXT;
+    }
+    st.bad_frames++;
+    return TELEM_NONE;
+}
@@ -0,0 +1,156 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Serial telemetry — typed records, binary (COBS + CRC16) or text, one write
+// per loop
+//
+// A sketch describes each line it logs once, as a schema (name, integer
+// width and decimals per field, TELEM_SCHEMAS in telemetry.cpp), then fills
+// records field by field. Every value is scaled to an integer on add(), so
+// both modes carry exactly the same numbers:
+//
+//   binary   00 | COBS( type seq t_ms  fields…  crc16 ) 00 | COBS(…) 00 …
+//   text     t_ms <TAB> 12.5 <TAB> … <LF>          (the sketches' old lines)
+//
+// Records accumulate in one preallocated buffer; the sketch sends it with a
+// single Serial.write() at the end of the loop and clear()s it. In binary
+// mode the buffer starts with a 0x00, so console text printed between loops
+// (config replies, warnings) lands between delimiters and the decoder skips
+// it. The CRC is calculate_checksum() (protocol.h), as on the radio link.
+//
+// The mode is a runtime switch: the sketches keep it in the "telemetry"
+// config key (0 text, 1 binary — "set telemetry 1", config_store.h).
+// testing/telemetry_decode splits a captured binary stream into one CSV per
+// record type; TelemReader is the same decoder for other tools.
+//
+//   Telemetry tm;
+//   tm.setMode(cfg.get().telemetry_mode);
+//   tm.begin(TELEM_RANGE, millis());
+//   tm.add(fwd_cm); tm.add(port_cm); ...
+//   tm.end();
+//   Serial.write(tm.data(), tm.size()); tm.clear();
+// ---------------------------------------------------------------------------
+
+#define TELEM_BUF          512    // one loop's output
+#define TELEM_MAX_FIELDS   16
+#define TELEM_HEADER_SIZE  6      // type, seq, t_ms
+#define TELEM_RECORD_MAX   (TELEM_HEADER_SIZE + TELEM_MAX_FIELDS * 4 + 2)
+#define TELEM_READER_BUF   512    // TelemReader: longest frame or stray text chunk
+
+enum TelemMode : uint8_t {
+    TELEM_TEXT   = 0,
+    TELEM_BINARY = 1
+};
+
+// Record types — wire-stable, append only
+enum TelemType : uint8_t {
+    TELEM_WIND  = 1,   // wind_sensor_test
+    TELEM_RANGE = 2,   // ultrasonic_test
+    TELEM_TYPE_COUNT
+};
+
+enum TelemFieldType : uint8_t { TF_U8, TF_I16, TF_U16, TF_U32 };
+
+struct TelemField {
+    const char*        name;
+    uint8_t            type;      // TelemFieldType
+    uint8_t            decimals;  // value × 10^decimals on the wire
+    const char* const* labels;    // text for enum values (nullptr: a number)
+    uint8_t            nlabels;
+};
+
+struct TelemSchema {
+    const char*       name;       // CSV file name, text header
+    uint8_t           count;
+    const TelemField* fields;
+};
+
+extern const TelemSchema TELEM_SCHEMAS[TELEM_TYPE_COUNT];   // by TelemType, [0] unused
+
+struct TelemRecord {
+    uint8_t  type;
+    uint8_t  seq;                 // per stream, wraps: gaps show lost records
+    uint32_t t_ms;
+    uint8_t  count;
+    int32_t  v[TELEM_MAX_FIELDS]; // scaled integers
+};
+
+struct TelemStats {
+    uint32_t records;
+    uint32_t bytes;               // handed out through data()
+    uint32_t dropped;             // buffer full
+    uint32_t schema_errors;       // unknown type, or fields not matching the schema
+};
+
+class Telemetry {
+public:
+    Telemetry();
+
+    void    setMode(uint8_t mode) { binary = mode == TELEM_BINARY; }
+    uint8_t mode() const          { return binary ? TELEM_BINARY : TELEM_TEXT; }
+
+    // Text mode: "# <name>: t_ms <TAB> field …" column header; nothing in binary
+    void header(uint8_t type);
+
+    void begin(uint8_t type, uint32_t t_ms);
+    void add(float value);        // next field in schema order
+    bool end();                   // false: dropped (buffer full or schema mismatch)
+
+    const uint8_t* data() const { return buf; }
+    size_t         size() const { return len; }
+    void           clear();
+
+    TelemStats stats() const { return st; }
+
+private:
+    uint8_t     buf[TELEM_BUF];
+    size_t      len;
+    bool        binary;
+    uint8_t     seq;
+    bool        open;
+    bool        bad;
+    TelemRecord cur;
+    TelemStats  st;
+};
+
+// Scaled integer → text with the field's decimals or label; returns length
+size_t telem_format_value(const TelemField& f, int32_t v, char* out, size_t cap);
+
+// One COBS frame (delimiters excluded) → record; false if malformed, failed
+// CRC or not matching its schema
+bool telem_decode(const uint8_t* frame, size_t len, TelemRecord* out);
+
+// Byte-stream decoder: feed() returns TELEM_GOT_RECORD when record() holds a
+// new record, TELEM_GOT_TEXT when a chunk between delimiters was printable
+// text (console output) rather than a frame — text() has it
+enum TelemFeed { TELEM_NONE = 0, TELEM_GOT_RECORD, TELEM_GOT_TEXT };
+
+struct TelemReaderStats {
+    uint32_t records;
+    uint32_t bad_frames;          // malformed or failed CRC
+    uint32_t text_chunks;
+    uint32_t lost;                // seq gaps
+};
+
+class TelemReader {
+public:
+    TelemReader();
+    int feed(uint8_t byte);
+    const TelemRecord& record() const { return rec; }
+    const char*        text() const   { return (const char*)chunk; }
+    TelemReaderStats   stats() const  { return st; }
+
+private:
+    uint8_t          chunk[TELEM_READER_BUF + 1];
+    size_t           len;
+    bool             overflow;
+    int              lastSeq;     // −1: none yet
+    TelemRecord      rec;
+    TelemReaderStats st;
+};
+
+#endif // TELEMETRY_H
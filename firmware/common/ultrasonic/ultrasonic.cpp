@@ -0,0 +1,53 @@
+#include "ultrasonic.h"
+#include "common/config.h"
+#include "firmware/common/hal/hal.h"
+
+// ---------------------------------------------------------------------------
+uint16_t ultrasonic_echo_to_cm(uint32_t duration_us) {
+    if (duration_us == 0) return DIST_NONE_CM;
+    return (uint16_t)(duration_us * 0.034f / 2.0f);
+}
+
+// ---------------------------------------------------------------------------
+uint16_t ultrasonic_read(uint8_t trigPin, uint8_t echoPin) {
+    hal_digital_write(trigPin, HAL_LOW);
+    hal_delay_us(2);
+    hal_digital_write(trigPin, HAL_HIGH);
+    hal_delay_us(10);
+    hal_digital_write(trigPin, HAL_LOW);
+
+    return ultrasonic_echo_to_cm(hal_pulse_in(echoPin, HAL_HIGH, ECHO_TIMEOUT_US));
+}
+
+// ---------------------------------------------------------------------------
+UltrasonicScan ultrasonic_scan() {
+    UltrasonicScan scan;
+    scan.fwd_cm  = ultrasonic_read(ULTRASONIC_TRIG_FWD,  ULTRASONIC_ECHO_FWD);
+    scan.port_cm = ultrasonic_read(ULTRASONIC_TRIG_PORT, ULTRASONIC_ECHO_PORT);
+    scan.stbd_cm = ultrasonic_read(ULTRASONIC_TRIG_STBD, ULTRASONIC_ECHO_STBD);
+    return scan;
+}
+
+// ---------------------------------------------------------------------------
+ObstacleZone ultrasonic_classify(const UltrasonicScan& scan, uint16_t emergency_cm, uint16_t avoidance_cm,
+                                 uint16_t side_emergency_cm) {
+    if (scan.fwd_cm  < emergency_cm ||
+        scan.port_cm < side_emergency_cm ||
+        scan.stbd_cm < side_emergency_cm) {
+        return ZONE_STOP;
+    }
+    if (scan.fwd_cm < avoidance_cm) {
+        // Turn toward the side with more clearance
+        return (scan.port_cm > scan.stbd_cm) ? ZONE_AVOID_PORT : ZONE_AVOID_STBD;
+    }
+    return ZONE_CLEAR;
+}
+
+const char* ultrasonic_zone_name(ObstacleZone zone) {
+    switch (zone) {
+        case ZONE_STOP:       return "STOP";
+        case ZONE_AVOID_PORT: return "AVOID PORT";
+        case ZONE_AVOID_STBD: return "AVOID STBD";
+        default:              return "CLEAR";
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef ULTRASONIC_H
+#define ULTRASONIC_H
+
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// JSN-SR04T collision avoidance — ranging and zone classification
+//
+// Extracted from testing/ultrasonic_test so the slave firmware and the host
+// build share one implementation. Hardware access goes through hal.h.
+// ---------------------------------------------------------------------------
+
+// Zone thresholds — defaults; the field values come from the NVS config
+// (config_store.h) and are passed to ultrasonic_classify()
+#define DIST_EMERGENCY_CM   50    // forward sensor below → emergency stop
+#define DIST_SIDE_EMERGENCY_CM 50 // port / starboard sensor below → emergency stop
+#define DIST_AVOIDANCE_CM  200    // forward sensor below → avoidance zone
+#define DIST_NONE_CM       500    // pulseIn timeout — treat as no obstacle
+
+// pulseIn timeout: 30 ms → ~510 cm theoretical max (JSN-SR04T range ≤ 450 cm)
+#define ECHO_TIMEOUT_US  30000UL
+
+enum ObstacleZone {
+    ZONE_CLEAR = 0,     // all sensors ≥ DIST_AVOIDANCE_CM
+    ZONE_AVOID_PORT,    // fwd < DIST_AVOIDANCE_CM, port has more clearance
+    ZONE_AVOID_STBD,    // fwd < DIST_AVOIDANCE_CM, starboard has equal or more clearance
+    ZONE_STOP           // fwd < DIST_EMERGENCY_CM or a side < DIST_SIDE_EMERGENCY_CM
+};
+
+struct UltrasonicScan {
+    uint16_t fwd_cm;
+    uint16_t port_cm;
+    uint16_t stbd_cm;
+};
+
+// Echo high time (µs) → distance in cm; 0 (timeout) → DIST_NONE_CM
+uint16_t     ultrasonic_echo_to_cm(uint32_t duration_us);
+
+// Fire one sensor (10 µs TRIG pulse) and wait for its echo — blocks up to ECHO_TIMEOUT_US
+uint16_t     ultrasonic_read(uint8_t trigPin, uint8_t echoPin);
+
+// Fire FWD, PORT, STBD sequentially (no acoustic cross-talk) using config.h pins
+UltrasonicScan ultrasonic_scan();
+
+ObstacleZone ultrasonic_classify(const UltrasonicScan& scan,
+                                 uint16_t emergency_cm = DIST_EMERGENCY_CM,
+                                 uint16_t avoidance_cm = DIST_AVOIDANCE_CM,
+                                 uint16_t side_emergency_cm = DIST_SIDE_EMERGENCY_CM);
+const char*  ultrasonic_zone_name(ObstacleZone zone);
+
+#endif // ULTRASONIC_H
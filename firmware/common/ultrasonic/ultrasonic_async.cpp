@@ -0,0 +1,139 @@
+#include "ultrasonic_async.h"
+#include "common/config.h"
+
+UltrasonicAsync::UltrasonicAsync()
+    : timer(), phase(PHASE_IDLE), current(0), rising(false), riseUs(0), settleUntilUs(0),
+      widthUs(), sweep(), cycleStartUs(0), seq(0), cycles(0), timeouts(0), lastCycleUs(0),
+      busyUs(0), readCycles(0) {
+    static const uint8_t pins[ULTRASONIC_SENSORS][2] = {
+        { ULTRASONIC_TRIG_FWD,  ULTRASONIC_ECHO_FWD  },
+        { ULTRASONIC_TRIG_PORT, ULTRASONIC_ECHO_PORT },
+        { ULTRASONIC_TRIG_STBD, ULTRASONIC_ECHO_STBD },
+    };
+    for (uint8_t i = 0; i < ULTRASONIC_SENSORS; i++) {
+        ch[i] = { this, i, pins[i][0], pins[i][1] };
+        cm[i].store(DIST_NONE_CM, std::memory_order_relaxed);
+    }
+}
+
+bool UltrasonicAsync::begin() {
+    if (!hal_timer_init(&timer, &UltrasonicAsync::onTimer, this)) return false;
+    for (uint8_t i = 0; i < ULTRASONIC_SENSORS; i++) {
+        hal_digital_write(ch[i].trig, HAL_LOW);
+        hal_attach_change_isr(ch[i].echo, &UltrasonicAsync::onEdge, &ch[i]);
+    }
+    cycleStartUs = hal_micros();
+    fire(0);
+    return true;
+}
+
+void UltrasonicAsync::stop() {
+    phase.store(PHASE_IDLE, std::memory_order_release);
+    hal_timer_stop(&timer);
+    for (uint8_t i = 0; i < ULTRASONIC_SENSORS; i++) hal_detach_isr(ch[i].echo);
+}
+
+// ---------------------------------------------------------------------------
+// ECHO change interrupt: timestamp the rising edge; on the falling edge
+// record the width and hand over to the timer for the settle gap. Edges from
+// a sensor that is not the one in flight (late echo after a timeout) are
+// ignored.
+void HAL_ISR_ATTR UltrasonicAsync::onEdge(void* arg) {
+    const Channel*   c = static_cast<const Channel*>(arg);
+    UltrasonicAsync* u = c->owner;
+    uint32_t         t = hal_micros();
+
+    if (c->index != u->current || u->phase.load(std::memory_order_acquire) != PHASE_ECHO) return;
+    if (hal_digital_read(c->echo) == HAL_HIGH) {
+        u->riseUs = t;
+        u->rising = true;
+        return;
+    }
+    if (!u->rising) return;
+
+    u->widthUs[c->index] = t - u->riseUs;
+    u->settleUntilUs     = t + ULTRASONIC_SETTLE_US;
+    uint8_t expect = PHASE_ECHO;
+    if (u->phase.compare_exchange_strong(expect, PHASE_SETTLE, std::memory_order_acq_rel)) {
+        hal_timer_start_once(&u->timer, ULTRASONIC_SETTLE_US);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Timer: either the echo timed out (still PHASE_ECHO) or the settle gap after
+// an echo has passed. Close the current sensor, publish after STBD, fire next.
+void UltrasonicAsync::onTimer(void* arg) {
+    UltrasonicAsync* u = static_cast<UltrasonicAsync*>(arg);
+    uint8_t          i = u->current;
+
+    uint8_t expect = PHASE_ECHO;
+    if (u->phase.compare_exchange_strong(expect, PHASE_SETTLE, std::memory_order_acq_rel)) {
+        u->widthUs[i] = 0;   // no falling edge inside the timeout
+        u->timeouts.fetch_add(1, std::memory_order_relaxed);
+    } else if (expect != PHASE_SETTLE) {
+        return;   // stopped
+    } else if ((int32_t)(hal_micros() - u->settleUntilUs) < 0) {
+        return;   // echo ended just as the timeout fired; the ISR re-armed us for the settle gap
+    }
+
+    u->sweep[i] = ultrasonic_echo_to_cm(u->widthUs[i]);
+    if (i == ULTRASONIC_SENSORS - 1) u->publish();
+    u->fire((uint8_t)((i + 1) % ULTRASONIC_SENSORS));
+}
+
+void UltrasonicAsync::fire(uint8_t i) {
+    uint32_t start = hal_micros();
+    current = i;
+    rising  = false;
+    phase.store(PHASE_ECHO, std::memory_order_release);
+    hal_timer_start_once(&timer, ECHO_TIMEOUT_US + ULTRASONIC_ECHO_START_US);
+
+    hal_digital_write(ch[i].trig, HAL_LOW);
+    hal_delay_us(2);
+    hal_digital_write(ch[i].trig, HAL_HIGH);
+    hal_delay_us(10);
+    hal_digital_write(ch[i].trig, HAL_LOW);
+    busyUs.fetch_add(hal_micros() - start, std::memory_order_relaxed);
+}
+
+void UltrasonicAsync::publish() {
+    uint32_t now = hal_micros();
+    uint32_t s   = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (uint8_t i = 0; i < ULTRASONIC_SENSORS; i++) cm[i].store(sweep[i], std::memory_order_relaxed);
+    seq.store(s + 2, std::memory_order_release);
+
+    lastCycleUs.store(now - cycleStartUs, std::memory_order_relaxed);
+    cycles.fetch_add(1, std::memory_order_release);
+    cycleStartUs = now;
+}
+
+// ---------------------------------------------------------------------------
+bool UltrasonicAsync::latest(UltrasonicScan* out) {
+    uint16_t v[ULTRASONIC_SENSORS];
+    uint32_t s;
+    do {
+        s = seq.load(std::memory_order_acquire);
+        for (uint8_t i = 0; i < ULTRASONIC_SENSORS; i++) v[i] = cm[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((s & 1) || seq.load(std::memory_order_relaxed) != s);
+
+    out->fwd_cm  = v[0];
+    out->port_cm = v[1];
+    out->stbd_cm = v[2];
+
+    uint32_t n     = cycles.load(std::memory_order_acquire);
+    bool     fresh = n != readCycles;
+    readCycles     = n;
+    return fresh;
+}
+
+UltrasonicStats UltrasonicAsync::stats() const {
+    UltrasonicStats st;
+    st.cycles        = cycles.load(std::memory_order_relaxed);
+    st.timeouts      = timeouts.load(std::memory_order_relaxed);
+    st.last_cycle_us = lastCycleUs.load(std::memory_order_relaxed);
+    st.busy_us       = busyUs.load(std::memory_order_relaxed);
+    return st;
+}
@@ -0,0 +1,90 @@
+#ifndef ULTRASONIC_ASYNC_H
+#define ULTRASONIC_ASYNC_H
+
+#include <atomic>
+#include <stdint.h>
+#include "ultrasonic.h"
+#include "firmware/common/hal/hal.h"
+
+// ---------------------------------------------------------------------------
+// Non-blocking JSN-SR04T ranging — timer-triggered, edge-captured
+//
+//   timer ─► fire FWD ─► ECHO edges (IRQ) ─► settle ─► fire PORT ─► … STBD ─► scan
+//
+// Sensors still fire one at a time (no acoustic cross-talk), but nothing
+// waits: a one-shot timer pulses TRIG, a change interrupt on the ECHO pin
+// timestamps both edges, and the falling edge re-arms the timer for the
+// next sensor after ULTRASONIC_SETTLE_US. A sensor that never answers is
+// closed by the same timer at the echo timeout. The cycle is therefore as
+// short as the echoes allow: ~3 × (echo + settle), 90+ ms only when all
+// three see open water.
+//
+// CPU cost per sensor is the 12 µs TRIG pulse and two short ISRs. The
+// caller picks up finished scans with latest(); distances are published
+// once per full cycle so the three values always belong to the same sweep.
+//
+// Echo ISR does no float math (the ESP32 FPU is off-limits in interrupts);
+// widths are converted to cm in the timer callback.
+// ---------------------------------------------------------------------------
+
+#define ULTRASONIC_SENSORS          3
+#define ULTRASONIC_SETTLE_US     5000UL   // echo end → next burst: let reverberation decay
+#define ULTRASONIC_ECHO_START_US 2000UL   // TRIG → ECHO rising, worst case (burst + module latency)
+
+struct UltrasonicStats {
+    uint32_t cycles;          // full FWD/PORT/STBD sweeps published
+    uint32_t timeouts;        // sensors with no echo inside ECHO_TIMEOUT_US
+    uint32_t last_cycle_us;   // duration of the last sweep
+    uint32_t busy_us;         // total CPU time spent pulsing TRIG
+};
+
+class UltrasonicAsync {
+public:
+    UltrasonicAsync();                      // config.h pins: FWD, PORT, STBD
+
+    bool begin();                           // attach ECHO interrupts, create the timer, fire FWD
+    void stop();
+
+    // Latest complete sweep. Returns true if it is new since the last call.
+    bool latest(UltrasonicScan* out);
+
+    UltrasonicStats stats() const;
+
+private:
+    enum Phase : uint8_t { PHASE_IDLE, PHASE_ECHO, PHASE_SETTLE };
+
+    struct Channel {
+        UltrasonicAsync* owner;
+        uint8_t          index;
+        uint8_t          trig;
+        uint8_t          echo;
+    };
+
+    static void onEdge(void* arg);      // interrupt context
+    static void onTimer(void* arg);     // timer task
+    void fire(uint8_t i);
+    void publish();
+
+    Channel               ch[ULTRASONIC_SENSORS];
+    HalTimer              timer;
+    std::atomic<uint8_t>  phase;
+    volatile uint8_t      current;
+    volatile bool         rising;
+    volatile uint32_t     riseUs;
+    volatile uint32_t     settleUntilUs;
+    volatile uint32_t     widthUs[ULTRASONIC_SENSORS];   // 0 = no echo
+
+    uint16_t              sweep[ULTRASONIC_SENSORS];     // timer task only
+    uint32_t              cycleStartUs;
+
+    // Published sweep — seqlock: odd while the timer task is writing
+    std::atomic<uint32_t> seq;
+    std::atomic<uint16_t> cm[ULTRASONIC_SENSORS];
+    std::atomic<uint32_t> cycles;
+    std::atomic<uint32_t> timeouts;
+    std::atomic<uint32_t> lastCycleUs;
+    std::atomic<uint32_t> busyUs;
+    uint32_t              readCycles;
+};
+
+#endif // ULTRASONIC_ASYNC_H
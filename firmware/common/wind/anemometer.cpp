@@ -0,0 +1,84 @@
+#include "anemometer.h"
+
+// km/h × µs for one pulse: 1 pulse/s = WIND_KMH_PER_PPS km/h
+static const float KMH_US = WIND_KMH_PER_PPS * 1000000.0f;
+
+Anemometer::Anemometer(uint8_t pin, uint32_t gust_window_ms, uint32_t lull_window_ms)
+    : pin(pin), gustUs(gust_window_ms * 1000), lullUs(lull_window_ms * 1000), pulses(0), overrun(0),
+      isrLastUs(0), isrArmed(false), havePulse(false), lastUs(0), lastPeriodUs(0),
+      head(0), tail(0), maxHead(0), maxTail(0), minHead(0), minTail(0) {}
+
+void Anemometer::begin() {
+    hal_attach_falling_isr(pin, &Anemometer::onPulse, this);
+}
+
+// Interrupt context: timestamp, debounce, count, queue. No float math.
+void HAL_ISR_ATTR Anemometer::onPulse(void* arg) {
+    Anemometer* a = static_cast<Anemometer*>(arg);
+    uint32_t    t = hal_micros();
+    if (a->isrArmed && t - a->isrLastUs < ANEMO_DEBOUNCE_US) return;
+    a->isrArmed  = true;
+    a->isrLastUs = t;
+    a->pulses.fetch_add(1, std::memory_order_relaxed);
+    if (!a->stamps.push(t)) a->overrun.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+bool Anemometer::poll() {
+    bool     fresh = false;
+    uint32_t t;
+    while (stamps.pop(&t)) {
+        if (havePulse) {
+            lastPeriodUs = t - lastUs;
+            float    kmh = KMH_US / lastPeriodUs;
+            uint16_t cv  = kmh >= 655.0f ? 65500 : (uint16_t)(kmh * 100.0f + 0.5f);
+
+            if (head - tail >= ANEMO_HISTORY) {
+                if (maxHead != maxTail && maxQ[maxTail % ANEMO_HISTORY] == tail) maxTail++;
+                if (minHead != minTail && minQ[minTail % ANEMO_HISTORY] == tail) minTail++;
+                tail++;
+            }
+            hist[head % ANEMO_HISTORY] = { t, cv };
+            while (maxHead != maxTail && hist[maxQ[(maxHead - 1) % ANEMO_HISTORY] % ANEMO_HISTORY].kmh_x100 <= cv) maxHead--;
+            maxQ[maxHead++ % ANEMO_HISTORY] = head;
+            while (minHead != minTail && hist[minQ[(minHead - 1) % ANEMO_HISTORY] % ANEMO_HISTORY].kmh_x100 >= cv) minHead--;
+            minQ[minHead++ % ANEMO_HISTORY] = head;
+            head++;
+            fresh = true;
+        }
+        havePulse = true;
+        lastUs    = t;
+    }
+    expire(hal_micros());
+    return fresh;
+}
+
+// Drop deque fronts older than their window, then history older than both
+void Anemometer::expire(uint32_t now_us) {
+    while (maxHead != maxTail && now_us - hist[maxQ[maxTail % ANEMO_HISTORY] % ANEMO_HISTORY].t_us > gustUs) maxTail++;
+    while (minHead != minTail && now_us - hist[minQ[minTail % ANEMO_HISTORY] % ANEMO_HISTORY].t_us > lullUs) minTail++;
+    uint32_t keep = gustUs > lullUs ? gustUs : lullUs;
+    while (head != tail && now_us - hist[tail % ANEMO_HISTORY].t_us > keep) tail++;
+}
+
+// ---------------------------------------------------------------------------
+float Anemometer::speedKmh() const {
+    if (!havePulse || lastPeriodUs == 0) return 0.0f;
+    uint32_t open = hal_micros() - lastUs;
+    if (open >= ANEMO_CALM_US) return 0.0f;
+    // Less than one revolution since the last pulse: the wind is at most this
+    uint32_t period = open > lastPeriodUs ? open : lastPeriodUs;
+    return KMH_US / period;
+}
+
+float Anemometer::gustKmh() const {
+    if (maxHead == maxTail) return 0.0f;
+    return hist[maxQ[maxTail % ANEMO_HISTORY] % ANEMO_HISTORY].kmh_x100 / 100.0f;
+}
+
+float Anemometer::lullKmh() const {
+    float now = speedKmh();
+    if (minHead == minTail) return now;
+    float lull = hist[minQ[minTail % ANEMO_HISTORY] % ANEMO_HISTORY].kmh_x100 / 100.0f;
+    return now < lull ? now : lull;
+}
@@ -0,0 +1,88 @@
+#ifndef ANEMOMETER_H
+#define ANEMOMETER_H
+
+#include <atomic>
+#include <stdint.h>
+#include "common/config.h"
+#include "common/spsc_ring.h"
+#include "firmware/common/hal/hal.h"
+#include "wind.h"
+
+// ---------------------------------------------------------------------------
+// Davis anemometer — per-pulse period measurement with gust/lull windows
+//
+//   WIND_SPEED_PIN falling edge (IRQ)        poll() (loop)
+//   µs timestamp, debounce ─► stamp ring ─►  period → km/h per pulse
+//                                            ├─ speed: latest period, decays in a calm
+//                                            ├─ gust:  max over the gust window
+//                                            └─ lull:  min over the lull window
+//
+// One pulse per cup revolution, so every pulse yields a fresh speed from the
+// period since the previous one (1 pulse/s = 1 mph). No 1 s integration:
+// latency is one revolution, resolution is the µs clock at any wind speed.
+// When pulses stop, speed follows the bound set by the open period (the cups
+// have turned less than once since the last pulse) and reads 0 after
+// ANEMO_CALM_US.
+//
+// The ISR also counts pulses, so the 1 s count path (wind_speed_kmh) stays
+// available: takePulseCount() returns the pulses since the previous call.
+// Gust and lull come from monotonic deques over a fixed pulse history —
+// amortised O(1) per pulse, no allocation.
+// ---------------------------------------------------------------------------
+
+#define ANEMO_DEBOUNCE_US      1000      // reed bounce < 1 ms; real pulses are 5+ ms apart below 320 km/h
+#define ANEMO_STAMP_QUEUE      64        // ISR → poll(), power of two
+#define ANEMO_HISTORY          512       // pulses kept for gust/lull, power of two (3 s at 270 km/h)
+#define ANEMO_GUST_WINDOW_MS   3000      // WMO gust: 3 s
+#define ANEMO_LULL_WINDOW_MS   3000
+#define ANEMO_CALM_US          5000000UL // no pulse for 5 s (< 0.33 km/h) → calm
+
+class Anemometer {
+public:
+    explicit Anemometer(uint8_t pin = WIND_SPEED_PIN,
+                        uint32_t gust_window_ms = ANEMO_GUST_WINDOW_MS,
+                        uint32_t lull_window_ms = ANEMO_LULL_WINDOW_MS);
+
+    void begin();                // attach the falling-edge interrupt
+
+    // Drain timestamps from the ISR; true if at least one new period arrived
+    bool poll();
+
+    float    speedKmh() const;   // latest per-pulse speed, bounded by the open period
+    float    gustKmh() const;    // max per-pulse speed in the gust window (0 if none)
+    float    lullKmh() const;    // min per-pulse speed in the lull window, or speedKmh() if lower
+    uint32_t lastPulseUs() const { return lastUs; }
+
+    // Count-path fallback: pulses since the previous call (debounced in the ISR)
+    uint32_t takePulseCount()   { return pulses.exchange(0, std::memory_order_relaxed); }
+    uint32_t overruns() const   { return overrun.load(std::memory_order_relaxed); }
+
+private:
+    static void onPulse(void* arg);   // interrupt context
+
+    struct Entry {
+        uint32_t t_us;
+        uint16_t kmh_x100;
+    };
+
+    void expire(uint32_t now_us);
+
+    uint8_t                               pin;
+    uint32_t                              gustUs, lullUs;
+    SpscRing<uint32_t, ANEMO_STAMP_QUEUE> stamps;
+    std::atomic<uint32_t>                 pulses;
+    std::atomic<uint32_t>                 overrun;
+    volatile uint32_t                     isrLastUs;
+    volatile bool                         isrArmed;
+
+    bool     havePulse;
+    uint32_t lastUs;
+    uint32_t lastPeriodUs;
+
+    Entry    hist[ANEMO_HISTORY];
+    uint32_t head, tail;                          // entry sequence numbers
+    uint32_t maxQ[ANEMO_HISTORY], maxHead, maxTail;
+    uint32_t minQ[ANEMO_HISTORY], minHead, minTail;
+};
+
+#endif // ANEMOMETER_H
@@ -0,0 +1,30 @@
+#include "wind.h"
+#include <math.h>
+#include "common/config.h"
+#include "firmware/common/hal/hal.h"
+
+// ---------------------------------------------------------------------------
+float wind_vane_from_adc(uint16_t adc) {
+    return (adc / VANE_ADC_FULL_SCALE) * 360.0f;
+}
+
+float wind_vane_read() {
+    return wind_vane_from_adc(hal_analog_read(WIND_DIR_PIN));
+}
+
+// ---------------------------------------------------------------------------
+WindFusion wind_fuse(float vane_raw, float vane_offset, float compass_heading) {
+    WindFusion f;
+    f.vane_relative = fmodf(vane_raw - vane_offset + 360.0f, 360.0f);
+    f.abs_wind_dir  = fmodf(compass_heading + f.vane_relative, 360.0f);
+    f.heading_error = f.vane_relative;
+    if (f.heading_error > 180.0f) f.heading_error -= 360.0f;
+    return f;
+}
+
+// ---------------------------------------------------------------------------
+float wind_speed_kmh(uint32_t pulses, uint32_t elapsed_ms) {
+    if (elapsed_ms == 0) return 0.0f;
+    float pps = (float)pulses / (elapsed_ms / 1000.0f);
+    return pps * WIND_KMH_PER_PPS;
+}
@@ -0,0 +1,35 @@
+#ifndef WIND_H
+#define WIND_H
+
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Davis Vantage Pro vane + compass fusion, anemometer pulse → speed
+//
+// Extracted from testing/wind_sensor_test so master firmware and the host
+// build share one implementation.
+// ---------------------------------------------------------------------------
+
+#define VANE_ADC_FULL_SCALE   4095.0f    // 12-bit ADC, 0–3.3 V → 0–360°
+#define WIND_KMH_PER_PPS      1.609344f  // Davis: 1 pulse/s = 1 mph
+#define KMH_PER_KNOT          1.852f
+
+struct WindFusion {
+    float vane_relative;  // offset-corrected vane angle — 0° = wind from bow
+    float abs_wind_dir;   // absolute magnetic direction wind is coming FROM
+    float heading_error;  // −180…+180 — positive = wind from starboard (turn right)
+};
+
+// Raw ADC count → vane angle 0–360°
+float      wind_vane_from_adc(uint16_t adc);
+
+// Read WIND_DIR_PIN through the HAL
+float      wind_vane_read();
+
+// Combine raw vane angle, calibration offset and compass heading (all degrees)
+WindFusion wind_fuse(float vane_raw, float vane_offset, float compass_heading);
+
+// Anemometer pulses counted over elapsed_ms → km/h
+float      wind_speed_kmh(uint32_t pulses, uint32_t elapsed_ms);
+
+#endif // WIND_H
@@ -0,0 +1,160 @@
+#ifndef WIND_WINDOW_H
+#define WIND_WINDOW_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "common/protocol.h"
+
+// ---------------------------------------------------------------------------
+// Sliding-window circular statistics for wind stability — O(1) per sample
+//
+// Holds the last WIND_CHANGE_DURATION_S of abs_wind_dir samples in a fixed
+// ring and keeps, incrementally:
+//   - Σsin, Σcos in Q15 integers → mean direction, resultant length R and
+//     circular variance 1 − R (integer sums: no drift however long it runs)
+//   - the angle unwrapped across 0/360 (int32 centidegrees) with monotonic
+//     max/min deques → the largest shift inside the window, max − min
+//
+// add() pushes one sample, expires everything older than the window (or the
+// oldest sample when the ring is full) and updates the deques; each sample
+// enters and leaves every structure once, so cost is amortised O(1) whatever
+// the window length or sample rate. Nothing allocates.
+//
+//   WindWindow w;                          // 60 s at up to WIND_WINDOW_RATE_MAX_HZ
+//   w.add(fusion.abs_wind_dir, millis());
+//   if (w.full() && !w.stable()) { ... }   // shift > WIND_CHANGE_THRESHOLD_DEG
+//
+// Capacity N is a power of two (sequence numbers run free and wrap) and a
+// template parameter so host benchmarks can size it for 100 Hz; firmware
+// uses WindWindow — 1024 samples, 20 KB.
+// ---------------------------------------------------------------------------
+
+#define WIND_WINDOW_RATE_MAX_HZ  10
+#define WIND_WINDOW_CAPACITY     1024   // ≥ WIND_CHANGE_DURATION_S × WIND_WINDOW_RATE_MAX_HZ
+
+#define WIND_Q15                 32767.0f
+
+template <size_t N>
+class WindWindowT {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "WindWindowT capacity must be a power of two");
+
+public:
+    explicit WindWindowT(uint32_t duration_ms = WIND_CHANGE_DURATION_S * 1000UL)
+        : durationMs(duration_ms) { reset(); }
+
+    void reset() {
+        head = tail = 0;
+        maxHead = maxTail = minHead = minTail = 0;
+        sumSin = sumCos = 0;
+        lastCd = 0;
+    }
+
+    void add(float dir_deg, uint32_t t_ms) {
+        // Unwrap: step by the shortest signed turn from the previous sample
+        int32_t cd = (int32_t)lrintf(dir_deg * 100.0f) % 36000;
+        if (cd < 0) cd += 36000;
+        int32_t un = cd;
+        if (head != tail) {
+            int32_t step = (cd - lastCd % 36000 + 36000) % 36000;
+            if (step > 18000) step -= 36000;
+            un = lastCd + step;
+        }
+        lastCd = un;
+
+        // Expire by age, then make room
+        while (head != tail && (uint32_t)(t_ms - at(tail).t_ms) >= durationMs) evict();
+        if (head - tail >= N) evict();
+
+        float   r = cd * (float)(M_PI / 18000.0);
+        Sample& s = at(head);
+        s.t_ms    = t_ms;
+        s.sin_q15 = (int16_t)lrintf(sinf(r) * WIND_Q15);
+        s.cos_q15 = (int16_t)lrintf(cosf(r) * WIND_Q15);
+        s.un_cd   = un;
+        sumSin   += s.sin_q15;
+        sumCos   += s.cos_q15;
+
+        while (maxHead != maxTail && at(maxQ[(maxHead - 1) % N]).un_cd <= un) maxHead--;
+        maxQ[maxHead++ % N] = head;
+        while (minHead != minTail && at(minQ[(minHead - 1) % N]).un_cd >= un) minHead--;
+        minQ[minHead++ % N] = head;
+        head++;
+    }
+
+    size_t   count() const   { return head - tail; }
+    uint32_t span_ms() const { return count() < 2 ? 0 : at(head - 1).t_ms - at(tail).t_ms; }
+
+    // Window spans (nearly) the whole duration — stability can be judged
+    bool full(uint32_t tolerance_ms = 1000) const { return span_ms() + tolerance_ms >= durationMs; }
+
+    // Circular mean direction 0–360° (0 if empty)
+    float mean_deg() const {
+        if (count() == 0) return 0.0f;
+        float d = atan2f((float)sumSin, (float)sumCos) * (float)(180.0 / M_PI);
+        return d < 0.0f ? d + 360.0f : d;
+    }
+
+    // Mean resultant length R: 1 = steady direction, 0 = uniformly spread
+    float resultant() const {
+        if (count() == 0) return 0.0f;
+        return sqrtf((float)sumSin * sumSin + (float)sumCos * sumCos) / (count() * WIND_Q15);
+    }
+
+    float circular_variance() const { return 1.0f - resultant(); }
+
+    // Circular standard deviation √(−2 ln R), degrees
+    float circular_std_deg() const {
+        float R = resultant();
+        if (R <= 0.0f) return 180.0f;
+        if (R >= 1.0f) return 0.0f;
+        return sqrtf(-2.0f * logf(R)) * (float)(180.0 / M_PI);
+    }
+
+    // Largest shift inside the window: max − min of the unwrapped direction
+    float range_deg() const {
+        if (count() == 0) return 0.0f;
+        return (at(maxQ[maxTail % N]).un_cd - at(minQ[minTail % N]).un_cd) / 100.0f;
+    }
+
+    bool stable(float threshold_deg = WIND_CHANGE_THRESHOLD_DEG) const { return range_deg() <= threshold_deg; }
+
+    // Oldest-first access for rescans and tests; i < count()
+    float sample_deg(size_t i) const { return at(tail + (uint32_t)i).un_cd / 100.0f; }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    struct Sample {
+        uint32_t t_ms;
+        int32_t  un_cd;     // unwrapped centidegrees
+        int16_t  sin_q15;
+        int16_t  cos_q15;
+    };
+
+    Sample&       at(uint32_t seq)       { return ring[seq % N]; }
+    const Sample& at(uint32_t seq) const { return ring[seq % N]; }
+
+    void evict() {
+        const Sample& s = at(tail);
+        sumSin -= s.sin_q15;
+        sumCos -= s.cos_q15;
+        if (maxHead != maxTail && maxQ[maxTail % N] == tail) maxTail++;
+        if (minHead != minTail && minQ[minTail % N] == tail) minTail++;
+        tail++;
+    }
+
+    uint32_t durationMs;
+    Sample   ring[N];
+    uint32_t head, tail;                 // sample sequence numbers, free-running
+    uint32_t maxQ[N], maxHead, maxTail;  // sequence numbers, un_cd decreasing
+    uint32_t minQ[N], minHead, minTail;  // sequence numbers, un_cd increasing
+    int32_t  sumSin, sumCos;             // Q15 — |Σ| ≤ N × 32767
+    int32_t  lastCd;                     // unwrapped centidegrees of the newest sample
+};
+
+typedef WindWindowT<WIND_WINDOW_CAPACITY> WindWindow;
+static_assert(WIND_WINDOW_CAPACITY >= WIND_CHANGE_DURATION_S * WIND_WINDOW_RATE_MAX_HZ,
+              "WindWindow too small for WIND_CHANGE_DURATION_S at WIND_WINDOW_RATE_MAX_HZ");
+
+#endif // WIND_WINDOW_H
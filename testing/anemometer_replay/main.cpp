@@ -0,0 +1,228 @@
+// Anemometer Replay — per-pulse period vs 1 s pulse count — host (platform = native)
+//
+// Run:  pio run -e anemometer_replay -t exec
+//
+// Generates Davis reed-switch pulses (1 per cup revolution, ±2% period
+// jitter, a 300 µs contact bounce on every pulse) for a 70 s wind profile and
+// plays them on WIND_SPEED_PIN through the host HAL, so the same falling-edge
+// ISR runs as on target. A 20 Hz loop reads three estimators side by side:
+//
+//   legacy  — wind_sensor_test before: millis() 10 ms debounce, count / 1 s
+//   count   — Anemometer::takePulseCount() / 1 s (the fallback path)
+//   period  — Anemometer::speedKmh(), fresh on every pulse
+//
+// Profile: 2 km/h light air, 12 km/h, a 2 s gust to 30, back to 12, a lull
+// to 4, 5 s calm, 5 s at 160 km/h (pulse spacing ~10 ms), then 10 km/h.
+//
+// Reports per segment: mean |error| vs the true speed and the step response
+// (time to settle within 10% of the new speed), plus gust/lull and pulse
+// counts at 160 km/h.
+//
+// Pass criteria: period path settles within 0.6 s of each step and is more
+// accurate than the 1 s count in every windy segment; in the calm it drops
+// below 0.5 km/h within 3.5 s (it cannot know sooner that the cups stopped);
+// gust window catches the 30 km/h gust; lull catches 4 km/h; no pulses lost
+// or double-counted at 160 km/h or through the bounce.
+
+#include <stdio.h>
+#include <math.h>
+#include "common/config.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/wind/wind.h"
+#include "firmware/common/wind/anemometer.h"
+#include "testing/check.h"
+
+#define POLL_US         50000    // 20 Hz loop
+#define BOUNCE_US       300
+#define JITTER          0.02
+
+static uint32_t rngState = 3;
+static double uniform(double lo, double hi) {
+    rngState = rngState * 1664525u + 1013904223u;
+    return lo + (hi - lo) * ((rngState >> 8) / 16777216.0);
+}
+
+struct Segment {
+    const char* name;
+    double      end_s;
+    double      kmh;
+};
+
+static const Segment PROFILE[] = {
+    { "light 2",    10.0,   2.0 },
+    { "steady 12",  20.0,  12.0 },
+    { "gust 30",    22.0,  30.0 },
+    { "steady 12",  32.0,  12.0 },
+    { "lull 4",     42.0,   4.0 },
+    { "calm",       47.0,   0.0 },
+    { "storm 160",  52.0, 160.0 },
+    { "steady 10",  70.0,  10.0 },
+};
+static const size_t SEGMENTS = sizeof(PROFILE) / sizeof(PROFILE[0]);
+static const size_t CALM     = 5;
+static const size_t STORM    = 6;
+
+static size_t segmentAt(double t_s) {
+    for (size_t i = 0; i < SEGMENTS; i++) {
+        if (t_s < PROFILE[i].end_s) return i;
+    }
+    return SEGMENTS - 1;
+}
+
+// ---------------------------------------------------------------------------
+// Legacy path: the original windSpeedISR() with a millis() debounce
+static volatile uint32_t legacyCount = 0;
+static volatile uint32_t legacyLast  = 0;
+
+static void legacyIsr() {
+    uint32_t now = hal_millis();
+    if (now - legacyLast > 10) {
+        legacyCount++;
+        legacyLast = now;
+    }
+}
+
+struct Stat {
+    double errSum[SEGMENTS];
+    int    n[SEGMENTS];
+};
+
+struct Step {
+    double at_s;
+    double settle_s[3];   // legacy, count, period; -1 = never
+};
+
+int main() {
+    hal_host_reset();
+    Anemometer a(WIND_SPEED_PIN);
+    a.begin();
+
+    // Pulse train: one falling edge per revolution (+ bounce), pin idles HIGH
+    hal_host_set_digital(WIND_SPEED_PIN, HAL_HIGH);
+
+    const double END_S    = PROFILE[SEGMENTS - 1].end_s;
+    double   nextPulse    = 0.5;
+    double   nextPoll     = POLL_US / 1e6;
+    double   nextCount    = 1.0;
+    uint32_t truePulses[SEGMENTS]   = {};
+    uint32_t anemoPulses[SEGMENTS]  = {};   // by poll, so ±1 at segment edges
+    uint32_t legacyPulses[SEGMENTS] = {};
+    uint32_t trueTotal = 0, anemoTotal = 0;
+    uint32_t anemoSecond = 0, legacySecond = 0;
+
+    float legacyKmh = 0, countKmh = 0;
+    Stat  st[3] = {};
+    Step  steps[SEGMENTS] = {};
+    for (size_t i = 1; i < SEGMENTS; i++) {
+        steps[i].at_s = PROFILE[i - 1].end_s;
+        for (int k = 0; k < 3; k++) steps[i].settle_s[k] = -1;
+    }
+    float gustSeen = 0, lullSeen = 1e9f;
+
+    // Event loop over pulses and polls in time order. Each falling edge goes
+    // through the HAL to Anemometer's ISR; the legacy ISR is called at the
+    // same instant (the HAL holds one handler per pin).
+    while (nextPoll < END_S) {
+        if (nextPulse < nextPoll) {
+            hal_host_advance_us((uint32_t)(nextPulse * 1e6 - hal_host_time_us()));
+            size_t seg = segmentAt(nextPulse);
+            hal_host_set_digital(WIND_SPEED_PIN, HAL_LOW);
+            legacyIsr();
+            truePulses[seg]++;
+            trueTotal++;
+            hal_host_advance_us(BOUNCE_US / 3);
+            hal_host_set_digital(WIND_SPEED_PIN, HAL_HIGH);
+            hal_host_advance_us(BOUNCE_US / 3);
+            hal_host_set_digital(WIND_SPEED_PIN, HAL_LOW);   // bounce
+            legacyIsr();
+            hal_host_advance_us(BOUNCE_US / 3);
+            hal_host_set_digital(WIND_SPEED_PIN, HAL_HIGH);
+
+            double kmh = PROFILE[seg].kmh;
+            if (kmh <= 0) {
+                nextPulse = PROFILE[seg].end_s;   // calm: next pulse when the wind returns
+                continue;
+            }
+            double period = WIND_KMH_PER_PPS / kmh * uniform(1.0 - JITTER, 1.0 + JITTER);
+            nextPulse += period;
+            continue;
+        }
+
+        hal_host_advance_us((uint32_t)(nextPoll * 1e6 - hal_host_time_us()));
+        double t = nextPoll;
+        nextPoll += POLL_US / 1e6;
+
+        a.poll();
+        size_t   pollSeg = segmentAt(t - POLL_US / 2e6);
+        uint32_t pc      = a.takePulseCount();
+        uint32_t lc      = legacyCount;
+        legacyCount      = 0;
+        anemoPulses[pollSeg]  += pc;
+        legacyPulses[pollSeg] += lc;
+        anemoTotal  += pc;
+        anemoSecond += pc;
+        legacySecond += lc;
+        if (t >= nextCount) {
+            legacyKmh    = wind_speed_kmh(legacySecond, 1000);
+            countKmh     = wind_speed_kmh(anemoSecond, 1000);
+            legacySecond = 0;
+            anemoSecond  = 0;
+            nextCount   += 1.0;
+        }
+
+        size_t seg   = segmentAt(t);
+        double truth = PROFILE[seg].kmh;
+        float  est[3] = { legacyKmh, countKmh, a.speedKmh() };
+        for (int k = 0; k < 3; k++) {
+            st[k].errSum[seg] += fabs(est[k] - truth);
+            st[k].n[seg]++;
+            // settle: first time after the step from which the estimate stays within 10% (or 0.5 km/h)
+            Step& s = steps[seg];
+            double tol = truth * 0.1 > 0.5 ? truth * 0.1 : 0.5;
+            bool   in  = fabs(est[k] - truth) <= tol;
+            if (seg > 0) {
+                if (in && s.settle_s[k] < 0) s.settle_s[k] = t - s.at_s;
+                if (!in) s.settle_s[k] = -1;
+            }
+        }
+        if (seg == 2 && a.gustKmh() > gustSeen) gustSeen = a.gustKmh();
+        if (seg == 4 && t > PROFILE[3].end_s + 3.0 && a.lullKmh() < lullSeen) lullSeen = a.lullKmh();
+    }
+
+    printf("Anemometer replay — %.0f s profile, 20 Hz loop, %.0f%% period jitter, %d us contact bounce\n\n",
+           END_S, JITTER * 100, BOUNCE_US);
+    printf("%-10s %7s | %-24s | %-24s\n", "", "", "mean |error| km/h", "settle after step s");
+    printf("%-10s %7s | %7s %7s %8s | %7s %7s %8s\n",
+           "segment", "km/h", "legacy", "count", "period", "legacy", "count", "period");
+    bool periodBetter = true, periodFast = true;
+    for (size_t i = 0; i < SEGMENTS; i++) {
+        double e[3];
+        for (int k = 0; k < 3; k++) e[k] = st[k].n[i] ? st[k].errSum[i] / st[k].n[i] : 0;
+        printf("%-10s %7.1f | %7.2f %7.2f %8.2f |", PROFILE[i].name, PROFILE[i].kmh, e[0], e[1], e[2]);
+        for (int k = 0; k < 3; k++) {
+            if (i == 0)                         printf(" %7s", "-");
+            else if (steps[i].settle_s[k] < 0)  printf(" %7s", "never");
+            else                                printf(" %7.2f", steps[i].settle_s[k]);
+        }
+        printf("\n");
+        if (i == CALM) continue;   // judged separately: decay is bounded by the open period
+        if (e[2] > e[1] + 1e-9) periodBetter = false;
+        if (i > 0 && (steps[i].settle_s[2] < 0 || steps[i].settle_s[2] > 0.6)) periodFast = false;
+    }
+
+    printf("\n160 km/h: %lu true pulses, %lu counted (Anemometer), %lu counted (legacy 10 ms debounce)\n",
+           (unsigned long)truePulses[STORM], (unsigned long)anemoPulses[STORM], (unsigned long)legacyPulses[STORM]);
+    printf("gust (3 s) during the 30 km/h gust: %.1f km/h; lull (3 s) in the 4 km/h lull: %.1f km/h\n",
+           gustSeen, lullSeen);
+    printf("stamp ring overruns: %lu\n\n", (unsigned long)a.overruns());
+
+    check(periodFast, "period path settles within 0.6 s of every wind step");
+    check(periodBetter, "period path more accurate than the 1 s count in every windy segment");
+    check(steps[CALM].settle_s[2] >= 0 && steps[CALM].settle_s[2] <= 3.5,
+          "calm: period path below 0.5 km/h within 3.5 s (1 revolution at 0.5 km/h)");
+    check(fabsf(gustSeen - 30.0f) < 1.5f, "gust window reports the 30 km/h gust");
+    check(fabsf(lullSeen - 4.0f) < 0.5f, "lull window reports the 4 km/h lull");
+    check(a.overruns() == 0 && anemoTotal == trueTotal,
+          "no pulses lost or double-counted (bounce rejected, 160 km/h resolved)");
+    return check_summary();
+}
@@ -0,0 +1,31 @@
+#ifndef TESTING_CHECK_H
+#define TESTING_CHECK_H
+
+// ---------------------------------------------------------------------------
+// Pass/fail reporting for the host checks in testing/<name>/main.cpp
+//
+// Each check is a single translation unit, so the failure count is a
+// file-static here rather than a global:
+//
+//   check(n == 4, "four slaves joined");
+//   ...
+//   return check_summary();     // "ALL PASSED (0 failures)", exit status 0
+// ---------------------------------------------------------------------------
+
+#include <stdio.h>
+
+static int check_failures = 0;
+
+static inline void check(bool ok, const char* what) {
+    printf("  [%s] %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok) check_failures++;
+}
+
+// Prints the summary line and returns the process exit status
+static inline int check_summary() {
+    printf("\n%s (%d failure%s)\n", check_failures ? "FAILED" : "ALL PASSED",
+           check_failures, check_failures == 1 ? "" : "s");
+    return check_failures ? 1 : 0;
+}
+
+#endif // TESTING_CHECK_H
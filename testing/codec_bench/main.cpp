@@ -0,0 +1,192 @@
+// Packet Codec Decode Benchmark — host (platform = native)
+//
+// Run:  pio run -e codec_bench -t exec
+//
+// Decodes the same pre-built stream of received frames two ways:
+//   copy+switch — verify_checksum(), switch on packet_type, memcpy into a
+//                 local struct (what a hand-rolled receiver would do)
+//   codec       — PacketDispatcher: constexpr table lookup, in-place view
+//
+// Stream: all six packet structs in master-side proportions (mostly STATUS),
+// with 1 in 16 frames corrupted and 1 in 32 carrying an unknown type.
+// Both decoders must agree on every accepted/rejected frame and on the
+// field sums they accumulate. Reports ns/packet and packets/s.
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "common/protocol.h"
+#include "common/packet_codec.h"
+#include "testing/check.h"
+
+#define STREAM_FRAMES  4096
+#define BENCH_PASSES   200
+
+struct Frame {
+    uint8_t data[LORA_MAX_PAYLOAD];
+    uint8_t len;
+};
+
+static Frame stream[STREAM_FRAMES];
+
+// Accumulates a few fields per packet so neither decoder can be optimised away.
+struct Tally {
+    uint32_t packets;
+    uint32_t rejected;
+    uint32_t fieldSum;
+};
+
+// ---------------------------------------------------------------------------
+// Stream generation
+// ---------------------------------------------------------------------------
+static uint32_t rngState = 0xC0FFEE;
+static uint32_t nextRand() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState >> 8;
+}
+
+template <typename T>
+static void emit(Frame& f, T& pkt) {
+    f.len = packet_seal(pkt);
+    memcpy(f.data, &pkt, f.len);
+}
+
+static void buildStream() {
+    for (int i = 0; i < STREAM_FRAMES; i++) {
+        Frame&  f  = stream[i];
+        uint8_t id = (uint8_t)(1 + nextRand() % 4);
+        switch (nextRand() % 10) {
+            case 0: { AssignPacket p       = { PKT_ASSIGN, id, 43.65f, -79.38f, 3, 0 };          emit(f, p); break; }
+            case 1: { AckAssignPacket p    = { PKT_ACK_ASSIGN, id, 1, 43.65f, -79.38f, 0 };      emit(f, p); break; }
+            case 2: { PingStatusPacket p   = { PKT_PING_STATUS, id, nextRand(), 0 };             emit(f, p); break; }
+            case 3: { RcCommandPacket p    = { (uint8_t)(PKT_RC_START + nextRand() % 3), BUOY_REMOTE, 0 }; emit(f, p); break; }
+            case 4: { MasterStatusPacket p = { PKT_MASTER_STATUS, BUOY_MASTER, FLEET_STATE_READY, 0, 0 }; emit(f, p); break; }
+            default: {
+                StatusPacket p = { PKT_STATUS, id, 43.65f, -79.38f, (uint16_t)(nextRand() % 1000), 148, 0 };
+                emit(f, p);
+                break;
+            }
+        }
+        if (i % 16 == 7)  f.data[2] ^= 0x40;   // corrupted in flight
+        if (i % 32 == 19) f.data[0]  = 0x42;   // unknown packet type
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Decoder 1: verify, switch, copy
+// ---------------------------------------------------------------------------
+static void decodeCopySwitch(const Frame& f, Tally& t) {
+    if (!verify_checksum(f.data, f.len)) { t.rejected++; return; }
+    switch (f.data[0]) {
+        case PKT_ASSIGN: {
+            if (f.len != sizeof(AssignPacket)) { t.rejected++; return; }
+            AssignPacket p; memcpy(&p, f.data, sizeof(p));
+            t.fieldSum += p.hold_radius;
+            break;
+        }
+        case PKT_ACK_ASSIGN: {
+            if (f.len != sizeof(AckAssignPacket)) { t.rejected++; return; }
+            AckAssignPacket p; memcpy(&p, f.data, sizeof(p));
+            t.fieldSum += p.accepted;
+            break;
+        }
+        case PKT_STATUS: {
+            if (f.len != sizeof(StatusPacket)) { t.rejected++; return; }
+            StatusPacket p; memcpy(&p, f.data, sizeof(p));
+            t.fieldSum += p.dist_to_target_cm;
+            break;
+        }
+        case PKT_PING_STATUS: {
+            if (f.len != sizeof(PingStatusPacket)) { t.rejected++; return; }
+            PingStatusPacket p; memcpy(&p, f.data, sizeof(p));
+            t.fieldSum += p.timestamp & 0xFF;
+            break;
+        }
+        case PKT_RC_START:
+        case PKT_RC_STOP:
+        case PKT_RC_RTH: {
+            if (f.len != sizeof(RcCommandPacket)) { t.rejected++; return; }
+            RcCommandPacket p; memcpy(&p, f.data, sizeof(p));
+            t.fieldSum += p.packet_type;
+            break;
+        }
+        case PKT_MASTER_STATUS: {
+            if (f.len != sizeof(MasterStatusPacket)) { t.rejected++; return; }
+            MasterStatusPacket p; memcpy(&p, f.data, sizeof(p));
+            t.fieldSum += p.fleet_state;
+            break;
+        }
+        default:
+            t.rejected++;
+            return;
+    }
+    t.packets++;
+}
+
+// ---------------------------------------------------------------------------
+// Decoder 2: PacketDispatcher
+// ---------------------------------------------------------------------------
+struct TallyHandler : PacketHandlerBase {
+    Tally t;
+    void onAssign(const AssignPacket& p)             { t.fieldSum += p.hold_radius;       t.packets++; }
+    void onAckAssign(const AckAssignPacket& p)       { t.fieldSum += p.accepted;          t.packets++; }
+    void onStatus(const StatusPacket& p)             { t.fieldSum += p.dist_to_target_cm; t.packets++; }
+    void onPing(const PingStatusPacket& p)           { t.fieldSum += p.timestamp & 0xFF;  t.packets++; }
+    void onRcCommand(const RcCommandPacket& p)       { t.fieldSum += p.packet_type;       t.packets++; }
+    void onMasterStatus(const MasterStatusPacket& p) { t.fieldSum += p.fleet_state;       t.packets++; }
+};
+
+// ---------------------------------------------------------------------------
+static double nowNs() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main() {
+    printf("Packet codec decode benchmark — %d frames x %d passes\n", STREAM_FRAMES, BENCH_PASSES);
+    buildStream();
+
+    Tally copyTally = {};
+    double t0 = nowNs();
+    for (int pass = 0; pass < BENCH_PASSES; pass++) {
+        for (int i = 0; i < STREAM_FRAMES; i++) decodeCopySwitch(stream[i], copyTally);
+    }
+    double copyNs = nowNs() - t0;
+
+    TallyHandler handler;
+    handler.t = Tally();
+    PacketDispatcher<TallyHandler> dispatcher(handler);
+    t0 = nowNs();
+    for (int pass = 0; pass < BENCH_PASSES; pass++) {
+        for (int i = 0; i < STREAM_FRAMES; i++) {
+            if (dispatcher.dispatch(stream[i].data, stream[i].len) != PACKET_OK) handler.t.rejected++;
+        }
+    }
+    double codecNs = nowNs() - t0;
+
+    // packet_view<T> spot checks
+    StatusPacket s = { PKT_STATUS, BUOY_LEEWARD, 1.0f, 2.0f, 300, 150, 0 };
+    uint8_t      len = packet_seal(s);
+    bool viewOk   = packet_view<StatusPacket>((const uint8_t*)&s, len) == &s;
+    bool wrongT   = packet_view<AssignPacket>((const uint8_t*)&s, len) == nullptr;
+    s.battery_tenths_v++;
+    bool badCrc   = packet_view<StatusPacket>((const uint8_t*)&s, len) == nullptr;
+
+    const double total = (double)STREAM_FRAMES * BENCH_PASSES;
+    printf("\n%-12s %10s %10s %12s %14s\n", "decoder", "accepted", "rejected", "ns/packet", "packets/s");
+    printf("%-12s %10u %10u %12.2f %14.0f\n", "copy+switch",
+           copyTally.packets, copyTally.rejected, copyNs / total, total / copyNs * 1e9);
+    printf("%-12s %10u %10u %12.2f %14.0f\n", "codec",
+           handler.t.packets, handler.t.rejected, codecNs / total, total / codecNs * 1e9);
+    printf("speed-up: %.2fx\n", copyNs / codecNs);
+
+    bool agree = copyTally.packets  == handler.t.packets &&
+                 copyTally.rejected == handler.t.rejected &&
+                 copyTally.fieldSum == handler.t.fieldSum;
+    printf("\n");
+    check(agree,  "decoders agree on every frame");
+    check(viewOk, "packet_view returns the buffer in place");
+    check(wrongT, "packet_view rejects wrong type");
+    check(badCrc, "packet_view rejects bad CRC");
+    return check_summary();
+}
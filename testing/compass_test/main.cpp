@@ -1,39 +1,37 @@
 #include <Arduino.h>
 #include <Wire.h>
-#include <QMC5883LCompass.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include "common/config.h"
+#include "firmware/common/compass/mag_cal.h"
+#include "firmware/common/compass/qmc5883l.h"
+#include "firmware/common/display/oled_flush.h"
+#include "firmware/common/i2c/i2c_bus.h"
 
 // -----------------------------------------------------------------------
-// Set CALIBRATION_MODE 1 to find your axis min/max values:
-//   - Flash with CALIBRATION_MODE 1
-//   - Slowly rotate the board through all orientations for ~30 seconds
-//   - Note the X_MIN, X_MAX, Y_MIN, Y_MAX, Z_MIN, Z_MAX printed
-//   - Paste those values into the setCalibration() call below
-//   - Reflash with CALIBRATION_MODE 0 for normal operation
+// Calibration is automatic: every reading feeds the online hard/soft-iron
+// fit (mag_cal.h), and the result is kept in NVS. On a fresh board rotate it
+// through all headings (with some tilt) for a minute; "cal" on the serial
+// line shows the accepted fits, the field estimate and the fit residual.
+// After a reboot the stored calibration is used straight away.
+//
+// Once setup() has probed the devices, Wire belongs to the I2cBus task: the
+// compass is its HIGH device and the OLED flusher its LOW one, so a compass
+// read waits for at most the display run already on the wire.
 // -----------------------------------------------------------------------
-#define CALIBRATION_MODE 0
 
-// Calibration values — replace after running CALIBRATION_MODE 1
-#define CAL_X_MIN  -1500
-#define CAL_X_MAX   1500
-#define CAL_Y_MIN  -1500
-#define CAL_Y_MAX   1500
-#define CAL_Z_MIN  -1500
-#define CAL_Z_MAX   1500
-
-#define COMPASS_ADDR   0x0D
 #define SCREEN_WIDTH   128
 #define SCREEN_HEIGHT   64
 #define OLED_RESET      -1
 
-QMC5883LCompass compass;
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+I2cBus    bus;    // sole owner of Wire after setup() (i2c_bus.h)
+OledFlush oled;   // sends only changed columns, from its own task
+MagCalibrator cal;
+int compassDev = -1;
 
-#if CALIBRATION_MODE
-int16_t xMin, xMax, yMin, yMax, zMin, zMax;
-#endif
+static const char* const DIRS[] = { "N  ", "NNE", "NE ", "ENE", "E  ", "ESE", "SE ", "SSE",
+                                    "S  ", "SSW", "SW ", "WSW", "W  ", "WNW", "NW ", "NNW" };
 
 bool oledOk = false;
 
@@ -78,70 +76,53 @@ void setup() {
         display.display();
     }
 
-    // Compass init
-    compass.setADDR(COMPASS_ADDR);
-    compass.init();
-    compass.setSmoothing(5, true);
-
-#if CALIBRATION_MODE
-    Serial.println("CALIBRATION MODE — rotate board slowly through all axes");
-    Serial.println("Watch for min/max values to stabilise, then note them.");
-    xMin = xMax = yMin = yMax = zMin = zMax = 0;
-#else
-    compass.setCalibration(CAL_X_MIN, CAL_X_MAX, CAL_Y_MIN, CAL_Y_MAX, CAL_Z_MIN, CAL_Z_MAX);
+    // From here on only the bus task drives Wire
+    compassDev = bus.addDevice("compass", COMPASS_ADDR, I2C_PRIO_HIGH);
+    if (oledOk) oled.attachBus(bus);
+    bus.startTask();
+    if (oledOk) oled.startTask();
+
+    if (!qmc5883l_init(bus, compassDev)) Serial.println("ERROR: QMC5883L init failed");
+
+    // Raw counts (no library calibration or smoothing): the fit needs every
+    // reading as measured, and the shown heading is not lagged
+    if (cal.load()) Serial.println("Calibration restored from NVS.");
+    else            Serial.println("No stored calibration — rotate board through all headings.");
     Serial.println("Running — rotate board to verify heading changes.");
-    Serial.println("Heading   X       Y       Z");
-#endif
+    Serial.println("Heading   X       Y       Z        cal              OLED flush      I2C wait");
 }
 
 void loop() {
-    compass.read();
-
-    int16_t x = compass.getX();
-    int16_t y = compass.getY();
-    int16_t z = compass.getZ();
-    int     az = compass.getAzimuth();
-
-    char dir[3];
-    compass.getDirection(dir, az);
-
-#if CALIBRATION_MODE
-    bool updated = false;
-    if (x < xMin) { xMin = x; updated = true; }
-    if (x > xMax) { xMax = x; updated = true; }
-    if (y < yMin) { yMin = y; updated = true; }
-    if (y > yMax) { yMax = y; updated = true; }
-    if (z < zMin) { zMin = z; updated = true; }
-    if (z > zMax) { zMax = z; updated = true; }
-
-    if (updated) {
-        Serial.print("setCalibration(");
-        Serial.print(xMin); Serial.print(", ");
-        Serial.print(xMax); Serial.print(", ");
-        Serial.print(yMin); Serial.print(", ");
-        Serial.print(yMax); Serial.print(", ");
-        Serial.print(zMin); Serial.print(", ");
-        Serial.print(zMax); Serial.println(");");
+    int16_t x, y, z;
+    if (!qmc5883l_read(bus, compassDev, &x, &y, &z)) {
+        Serial.println("compass read failed");
+        delay(200);
+        return;
     }
+    cal.add(x, y, z);
+    if (cal.service(millis())) Serial.println("calibration updated");
+    int az = (int)cal.heading(x, y, z) % 360;
 
-    if (oledOk) {
-        display.clearDisplay();
-        display.setCursor(0, 0);
-        display.println("= CALIBRATION MODE =");
-        display.print("Rotate board slowly");
-        display.setCursor(0, 24);
-        display.print("X: "); display.print(xMin); display.print(" / "); display.println(xMax);
-        display.print("Y: "); display.print(yMin); display.print(" / "); display.println(yMax);
-        display.print("Z: "); display.print(zMin); display.print(" / "); display.println(zMax);
-        display.display();
-    }
+    const char* dir = DIRS[((az * 2 + 22) / 45) % 16];   // 22.5° sectors centred on each point
 
-#else
     Serial.print(az); Serial.print("° ");
-    Serial.print(dir[0]); Serial.print(dir[1]); Serial.print(dir[2]);
+    Serial.print(dir);
     Serial.print("   X:"); Serial.print(x);
     Serial.print("  Y:"); Serial.print(y);
-    Serial.print("  Z:"); Serial.println(z);
+    Serial.print("  Z:"); Serial.print(z);
+
+    MagCalStats cs = cal.stats();
+    Serial.print("   cal "); Serial.print(cs.accepted);
+    Serial.print(" F"); Serial.print(cal.cal().field, 0);
+    Serial.print(" rms "); Serial.print(cal.cal().rms * 100, 1); Serial.print("%");
+
+    // Previous frame's flush: I2C bytes and time until the panel matched
+    OledStats os = oled.stats();
+    Serial.print("   oled "); Serial.print(os.last_bytes);
+    Serial.print(" B "); Serial.print(os.last_flush_us); Serial.print(" us");
+
+    // Compass queue wait behind the display, worst since boot
+    Serial.print("   i2c wait "); Serial.print(bus.deviceStats(compassDev).wait_max_us); Serial.println(" us");
 
     if (oledOk) {
         display.clearDisplay();
@@ -154,18 +135,18 @@ void loop() {
         display.print(az);
         display.print((char)247);  // degree symbol
         display.print(" ");
-        display.print(dir[0]); display.print(dir[1]); display.print(dir[2]);
+        display.print(dir);
 
         display.setTextSize(1);
         display.setCursor(0, 40);
         display.print("X:"); display.print(x);
         display.print(" Y:"); display.print(y);
         display.setCursor(0, 52);
-        display.print("Z:"); display.println(z);
+        display.print("Z:"); display.print(z);
+        display.print(cal.cal().samples ? "  cal" : "  uncal");
 
-        display.display();
+        oled.submit(display.getBuffer());
     }
-#endif
 
     delay(200);
 }
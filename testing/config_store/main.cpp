@@ -0,0 +1,315 @@
+// Config Store Check — host (platform = native)
+//
+// Run:  pio run -e config_store -t exec
+//
+// The NVS config blob (firmware/common/config/config_store.h) across
+// reboots (hal_host_reset() keeps the host NVS) and firmware versions:
+//   1. factory-fresh: defaults equal the old compile-time #defines, nothing
+//      is written until a value is saved
+//   2. serial console: set / get / save through feed(), range limits
+//   3. reboot: the saved values come back in one load()
+//   4. LoRa: PKT_CONFIG_SET through PacketDispatcher, ACK sealed and
+//      decodable; other buoy, unknown key, out of range, query
+//   5. migration: a shorter blob (firmware with fewer fields) keeps its
+//      values and defaults the rest; a version 1 blob has its tuned stop
+//      distance carried into the v2 side-sensor field; a longer, newer blob
+//      keeps ours and a save() writes the newer fields back untouched; a v2
+//      blob saved by v1 firmware (rollback) comes back as v2, not migrated
+//   6. damage: bad CRC, magic or size → defaults; one out-of-range value
+//      → only that field defaulted
+//   7. cost: load() and a field read
+//
+// Pass criteria: every check below; a field read is a RAM load.
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "common/config.h"
+#include "common/crc16.h"
+#include "common/packet_codec.h"
+#include "firmware/common/config/config_store.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/ultrasonic/ultrasonic.h"
+#include "testing/check.h"
+
+static double seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Type a line into the serial console; returns the reply
+static const char* console(ConfigStore& cfg, const char* line) {
+    static char reply[512];
+    reply[0] = 0;
+    for (const char* p = line; *p; p++) cfg.feed(*p, reply, sizeof(reply));
+    cfg.feed('\n', reply, sizeof(reply));
+    return reply;
+}
+
+// Raw blob as another firmware would write it: header + body bytes, CRC sealed
+static void writeBlob(const uint8_t* body, size_t bodyLen, uint16_t version) {
+    uint8_t    blob[CONFIG_BLOB_MAX];
+    BuoyConfig hdr;
+    hdr.magic   = CONFIG_MAGIC;
+    hdr.version = version;
+    hdr.size    = (uint16_t)(CONFIG_HEADER_SIZE + bodyLen);
+    hdr.crc     = crc16_ccitt(body, bodyLen);
+    memcpy(blob, &hdr, CONFIG_HEADER_SIZE);
+    memcpy(blob + CONFIG_HEADER_SIZE, body, bodyLen);
+    hal_nvs_write(CONFIG_NVS_KEY, blob, hdr.size);
+}
+
+struct AckCatcher : PacketHandlerBase {
+    ConfigStore* cfg;
+    uint8_t      self;
+    ConfigAckPacket ack;
+    int          acks = 0;
+
+    void onConfigSet(const ConfigSetPacket& p) {
+        if (cfg->apply(p, self, &ack)) acks++;
+    }
+};
+
+// What v1 firmware's load() + save() do to a blob (config_store.cpp at
+// CONFIG_VERSION 1, 28 B BuoyConfig): bytes past its struct are a newer
+// firmware's tail, written back with that firmware's version. Sets one v1
+// field on the way, as an operator would.
+#define V1_STRUCT_SIZE 28
+static bool v1FirmwareSetHoldTime(uint8_t holdTime) {
+    uint8_t    blob[CONFIG_BLOB_MAX];
+    size_t     len = hal_nvs_size(CONFIG_NVS_KEY);
+    BuoyConfig hdr;
+    if (len < V1_STRUCT_SIZE || len > CONFIG_BLOB_MAX || !hal_nvs_read(CONFIG_NVS_KEY, blob, len)) return false;
+    memcpy(&hdr, blob, CONFIG_HEADER_SIZE);
+    blob[offsetof(BuoyConfig, hold_time_s)] = holdTime;
+    if (len == V1_STRUCT_SIZE) hdr.version = 1;
+    hdr.crc = crc16_ccitt(blob + CONFIG_HEADER_SIZE, len - CONFIG_HEADER_SIZE);
+    memcpy(blob, &hdr, CONFIG_HEADER_SIZE);
+    return hal_nvs_write(CONFIG_NVS_KEY, blob, len);
+}
+
+static ConfigSetPacket setPacket(uint8_t buoy, uint8_t seq, uint8_t key, uint8_t flags, int32_t value) {
+    ConfigSetPacket p = { PKT_CONFIG_SET, buoy, seq, key, flags, value, 0 };
+    packet_seal(p);
+    return p;
+}
+
+int main() {
+    hal_host_reset();
+    hal_host_nvs_erase();
+    printf("\n=== Config store: BuoyConfig v%d, %zu B blob, %d keys ===\n", CONFIG_VERSION, sizeof(BuoyConfig),
+           CFG_KEY_COUNT);
+
+    // 1. factory-fresh
+    printf("\n-- 1. factory-fresh --\n");
+    ConfigStore cfg;
+    bool loaded = cfg.load();
+    const BuoyConfig& c = cfg.get();
+    check(!loaded && cfg.stats().source == CONFIG_FROM_DEFAULTS, "no blob: load() false, defaults in use");
+    check(c.hold_radius_m == HOLD_RADIUS_DEFAULT && c.hold_time_s == HOLD_TIME_REQUIRED_S &&
+              c.comms_timeout_s == COMMS_TIMEOUT_MS / 1000 && c.dist_emergency_cm == DIST_EMERGENCY_CM &&
+              c.dist_avoidance_cm == DIST_AVOIDANCE_CM && c.wind_shift_deg == WIND_CHANGE_THRESHOLD_DEG &&
+              c.vane_offset_deg == 0.0f,
+          "defaults equal the compile-time values they replace");
+    check(hal_nvs_size(CONFIG_NVS_KEY) == 0, "nothing written by load()");
+
+    // 2. serial console
+    printf("\n-- 2. serial console --\n");
+    printf("%s", console(cfg, "set vane_offset 12.5"));
+    printf("%s", console(cfg, "set hold_radius 99"));
+    printf("%s", console(cfg, "set dist_avoidance 250"));
+    printf("%s", console(cfg, "bogus"));
+    check(c.vane_offset_deg == 12.5f, "set vane_offset 12.5");
+    check(c.hold_radius_m == HOLD_RADIUS_DEFAULT, "hold_radius 99 refused (limit 50 m)");
+    check(strstr(console(cfg, "get"), "(unsaved)") != nullptr, "get lists every key, marks unsaved");
+    printf("%s", console(cfg, "save"));
+    check(!cfg.dirty() && hal_nvs_size(CONFIG_NVS_KEY) == sizeof(BuoyConfig), "save writes one blob");
+
+    // 3. reboot
+    printf("\n-- 3. reboot --\n");
+    hal_host_reset();
+    {
+        ConfigStore boot;
+        check(boot.load() && boot.stats().source == CONFIG_FROM_NVS, "load() from NVS, current version");
+        check(boot.get().vane_offset_deg == 12.5f && boot.get().dist_avoidance_cm == 250,
+              "saved values back after reboot");
+        check(ultrasonic_classify({ 230, 400, 300 }, boot.get().dist_emergency_cm, boot.get().dist_avoidance_cm) ==
+                  ZONE_AVOID_PORT,
+              "ultrasonic zone uses the stored threshold (230 cm fwd < 250)");
+    }
+
+    // 4. LoRa
+    printf("\n-- 4. LoRa --\n");
+    AckCatcher h;
+    h.cfg  = &cfg;
+    h.self = BUOY_WINDWARD;
+    PacketDispatcher<AckCatcher> rx(h);
+    ConfigSetPacket p = setPacket(BUOY_WINDWARD, 7, CFG_HOLD_RADIUS, CONFIG_FLAG_SAVE, 5);
+    check(rx.dispatch((const uint8_t*)&p, sizeof(p)) == PACKET_OK && h.acks == 1, "CONFIG_SET dispatched, ACK built");
+    const ConfigAckPacket* a = packet_view<ConfigAckPacket>((const uint8_t*)&h.ack, sizeof(h.ack));
+    check(a && a->seq == 7 && a->status == CONFIG_STATUS_OK && a->value == 5 && c.hold_radius_m == 5,
+          "ACK decodes: seq echoed, hold_radius 5 m in effect");
+    check(!cfg.dirty(), "CONFIG_FLAG_SAVE wrote NVS");
+    p = setPacket(BUOY_LEEWARD, 8, CFG_HOLD_RADIUS, 0, 9);
+    rx.dispatch((const uint8_t*)&p, sizeof(p));
+    check(h.acks == 1 && c.hold_radius_m == 5, "packet for another buoy ignored");
+    p = setPacket(BUOY_WINDWARD, 9, 200, 0, 1);
+    rx.dispatch((const uint8_t*)&p, sizeof(p));
+    check(h.ack.status == CONFIG_STATUS_KEY, "unknown key → CONFIG_STATUS_KEY");
+    p = setPacket(BUOY_WINDWARD, 10, CFG_VANE_OFFSET, 0, 5000);
+    rx.dispatch((const uint8_t*)&p, sizeof(p));
+    check(h.ack.status == CONFIG_STATUS_RANGE && h.ack.value == 125, "500.0° → CONFIG_STATUS_RANGE, 12.5° kept");
+    p = setPacket(BUOY_WINDWARD, 11, CFG_WIND_SHIFT, CONFIG_FLAG_QUERY, 0);
+    rx.dispatch((const uint8_t*)&p, sizeof(p));
+    check(h.ack.status == CONFIG_STATUS_OK && h.ack.value == (int32_t)lroundf(WIND_CHANGE_THRESHOLD_DEG * 10),
+          "query returns the value in tenths, changes nothing");
+
+    // 5. migration
+    printf("\n-- 5. migration --\n");
+    BuoyConfig full = cfg.get();
+    // Older firmware: body ended after dist_avoidance_cm (no hold or telemetry fields)
+    size_t shortBody = offsetof(BuoyConfig, hold_radius_m) - CONFIG_HEADER_SIZE;
+    full.dist_avoidance_cm = 180;
+    writeBlob((const uint8_t*)&full + CONFIG_HEADER_SIZE, shortBody, CONFIG_VERSION);
+    hal_host_reset();
+    {
+        ConfigStore boot;
+        bool ok = boot.load();
+        ConfigStats s = boot.stats();
+        printf("  shorter blob: %zu B, %u field(s) defaulted\n", CONFIG_HEADER_SIZE + shortBody, (unsigned)s.defaulted);
+        check(ok && s.source == CONFIG_MIGRATED && s.defaulted == 4, "shorter blob loaded, 4 new fields defaulted");
+        check(boot.get().dist_avoidance_cm == 180 && boot.get().vane_offset_deg == 12.5f &&
+                  boot.get().hold_radius_m == HOLD_RADIUS_DEFAULT && boot.get().hold_time_s == HOLD_TIME_REQUIRED_S &&
+                  boot.get().telemetry_mode == 0 && boot.get().dist_side_emergency_cm == DIST_SIDE_EMERGENCY_CM,
+              "old values kept, new ones at their defaults");
+        check(boot.dirty() && boot.save() && hal_nvs_size(CONFIG_NVS_KEY) == sizeof(BuoyConfig),
+              "marked dirty; save() upgrades to the current layout");
+    }
+    // Version 1 firmware: 28 B, one stop distance for all sensors
+    size_t v1Body = V1_STRUCT_SIZE - CONFIG_HEADER_SIZE;
+    BuoyConfig v1 = full;
+    v1.dist_emergency_cm = 80;
+    writeBlob((const uint8_t*)&v1 + CONFIG_HEADER_SIZE, v1Body, 1);
+    hal_host_reset();
+    {
+        ConfigStore boot;
+        bool ok = boot.load();
+        check(ok && boot.stats().source == CONFIG_MIGRATED && boot.stats().stored_version == 1 &&
+                  boot.get().dist_emergency_cm == 80 && boot.get().dist_side_emergency_cm == 80,
+              "v1 blob: side stop distance migrated from dist_emergency (80 cm), not the default");
+        check(ultrasonic_classify({ 300, 70, 300 }, boot.get().dist_emergency_cm, boot.get().dist_avoidance_cm,
+                                  boot.get().dist_side_emergency_cm) == ZONE_STOP,
+              "migrated buoy still stops on a side sensor at 70 cm, as v1 did");
+        boot.save();
+        BuoyConfig back;
+        hal_nvs_read(CONFIG_NVS_KEY, (uint8_t*)&back, sizeof(back));
+        check(hal_nvs_size(CONFIG_NVS_KEY) == sizeof(BuoyConfig) && back.version == CONFIG_VERSION &&
+                  back.dist_side_emergency_cm == 80,
+              "save() writes it back as the current version");
+    }
+    // A v2 blob that ends before the field: defaulted, not migrated
+    writeBlob((const uint8_t*)&v1 + CONFIG_HEADER_SIZE, offsetof(BuoyConfig, dist_side_emergency_cm) - CONFIG_HEADER_SIZE, 2);
+    hal_host_reset();
+    {
+        ConfigStore boot;
+        check(boot.load() && boot.get().dist_side_emergency_cm == DIST_SIDE_EMERGENCY_CM,
+              "short v2 blob: side stop distance defaulted, no migration");
+    }
+    // Rollback: v2 saves, v1 firmware loads and saves, v2 loads again
+    hal_host_nvs_erase();
+    {
+        ConfigStore v2;
+        v2.set(CFG_DIST_EMERGENCY, 80);
+        v2.set(CFG_DIST_SIDE_EMERGENCY, 120);
+        v2.save();
+    }
+    bool v1Saved = v1FirmwareSetHoldTime(30);
+    hal_host_reset();
+    {
+        ConfigStore boot;
+        bool ok = boot.load();
+        check(v1Saved && ok && boot.stats().stored_version == CONFIG_VERSION &&
+                  boot.stats().source == CONFIG_FROM_NVS,
+              "v2 -> v1 -> v2: v1's save keeps the v2 fields and stamps them v2");
+        check(boot.get().dist_side_emergency_cm == 120 && boot.get().dist_emergency_cm == 80 &&
+                  boot.get().hold_time_s == 30,
+              "v2 side stop distance survives the rollback (not re-migrated), v1's change kept");
+    }
+    // Newer firmware: our body plus fields we do not know, higher version
+    uint8_t newer[sizeof(BuoyConfig) - CONFIG_HEADER_SIZE + 12];
+    memcpy(newer, (const uint8_t*)&full + CONFIG_HEADER_SIZE, sizeof(BuoyConfig) - CONFIG_HEADER_SIZE);
+    for (int i = 0; i < 12; i++) newer[sizeof(BuoyConfig) - CONFIG_HEADER_SIZE + i] = (uint8_t)(0xA0 + i);
+    writeBlob(newer, sizeof(newer), CONFIG_VERSION + 1);
+    hal_host_reset();
+    {
+        ConfigStore boot;
+        bool ok = boot.load();
+        check(ok && boot.stats().source == CONFIG_MIGRATED && boot.stats().stored_version == CONFIG_VERSION + 1 &&
+                  !boot.dirty(),
+              "newer blob loaded (rollback), not rewritten");
+        check(boot.get().dist_avoidance_cm == 180, "known fields read from the newer layout");
+        boot.set(CFG_HOLD_TIME, 20);
+        boot.save();
+        uint8_t raw[CONFIG_BLOB_MAX];
+        size_t  n = hal_nvs_size(CONFIG_NVS_KEY);
+        hal_nvs_read(CONFIG_NVS_KEY, raw, n);
+        BuoyConfig back;
+        memcpy(&back, raw, sizeof(back));
+        check(n == CONFIG_HEADER_SIZE + sizeof(newer) && back.version == CONFIG_VERSION + 1 &&
+                  memcmp(raw + sizeof(BuoyConfig), newer + sizeof(BuoyConfig) - CONFIG_HEADER_SIZE, 12) == 0 &&
+                  back.hold_time_s == 20,
+              "save() keeps the newer fields and version, updates ours");
+    }
+
+    // 6. damage
+    printf("\n-- 6. damage --\n");
+    uint8_t body[sizeof(BuoyConfig) - CONFIG_HEADER_SIZE];
+    memcpy(body, (const uint8_t*)&full + CONFIG_HEADER_SIZE, sizeof(body));
+    writeBlob(body, sizeof(body), CONFIG_VERSION);
+    uint8_t raw[sizeof(BuoyConfig)];
+    hal_nvs_read(CONFIG_NVS_KEY, raw, sizeof(raw));
+    raw[12] ^= 0x40;
+    hal_nvs_write(CONFIG_NVS_KEY, raw, sizeof(raw));
+    {
+        ConfigStore boot;
+        check(!boot.load() && boot.stats().rejected == 1 && boot.get().vane_offset_deg == 0.0f,
+              "flipped bit: CRC refuses the blob, defaults");
+    }
+    raw[12] ^= 0x40;
+    raw[0] ^= 0xFF;
+    hal_nvs_write(CONFIG_NVS_KEY, raw, sizeof(raw));
+    {
+        ConfigStore boot;
+        check(!boot.load() && boot.stats().rejected == 1, "wrong magic refused");
+    }
+    raw[0] ^= 0xFF;
+    hal_nvs_write(CONFIG_NVS_KEY, raw, sizeof(raw) - 1);
+    {
+        ConfigStore boot;
+        check(!boot.load() && boot.stats().rejected == 1, "truncated blob (size ≠ header) refused");
+    }
+    BuoyConfig bad = full;
+    bad.dist_emergency_cm = 5;   // below the 20 cm limit
+    writeBlob((const uint8_t*)&bad + CONFIG_HEADER_SIZE, sizeof(body), CONFIG_VERSION);
+    {
+        ConfigStore boot;
+        bool ok = boot.load();
+        check(ok && boot.stats().defaulted == 1 && boot.get().dist_emergency_cm == DIST_EMERGENCY_CM &&
+                  boot.get().dist_avoidance_cm == 180,
+              "out-of-range value defaulted alone, rest kept");
+    }
+
+    // 7. cost
+    const int N = 200000;
+    double t0 = seconds();
+    for (int i = 0; i < N; i++) cfg.load();
+    double tLoad = (seconds() - t0) / N;
+    volatile uint32_t sink = 0;
+    t0 = seconds();
+    for (int i = 0; i < N * 10; i++) sink = sink + cfg.get().dist_avoidance_cm;
+    double tGet = (seconds() - t0) / (N * 10);
+    printf("\n  cost: load() %.0f ns, get().field %.1f ns, sizeof(ConfigStore) %zu B\n", tLoad * 1e9, tGet * 1e9,
+           sizeof(ConfigStore));
+
+    return check_summary();
+}
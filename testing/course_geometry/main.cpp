@@ -0,0 +1,269 @@
+// Course Geometry Engine Check — host (platform = native)
+//
+// Run:  pio run -e course_geometry -t exec
+//
+// Part 1 — geometry and assignment rules on CourseGeometry:
+//   - marks form the diamond for winds around the compass (incl. 359.9°)
+//   - a fresh course assigns all four marks; a shift that moves a mark less
+//     than its hold_radius assigns nothing; small shifts accumulate
+//   - a line-length change recomputes A and B only; a 6 m hold radius
+//     suppresses what 3 m would send; invalidate() re-sends everything
+//   - assign() builds an ASSIGN_V2 that packet_view() accepts
+//
+// Part 2 — 2 h replay at 1 Hz: wind around 220° with ±8° slow oscillation,
+// gusty noise and a 20° veer at 1 h, smoothed by WindWindow (60 s mean).
+// Baseline: whenever the mean moves ≥ 1° from the laid course, recompute all
+// marks and broadcast all four ASSIGNs. Engine: setWind() every second,
+// assign() only what update() flags. Reports packets, airtime, re-targets,
+// the worst mark error left standing, and ns per update.
+//
+// Pass criteria: all Part 1 checks; the engine sends fewer ASSIGNs than the
+// baseline while never leaving a mark further than its hold_radius from the
+// current solution (the baseline does).
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "common/protocol.h"
+#include "common/packet_codec.h"
+#include "common/lora_budget.h"
+#include "firmware/common/course/course_geometry.h"
+#include "firmware/common/wind/wind_window.h"
+#include "testing/check.h"
+
+#define REPLAY_S        (2 * 3600)
+#define VEER_AT_S       3600
+#define RELAY_DEG       1.0f     // baseline re-lays the course on a 1° mean change
+#define TIMING_ROUNDS   1000000
+
+static uint32_t rngState = 5;
+static float uniform(float lo, float hi) {
+    rngState = rngState * 1664525u + 1013904223u;
+    return lo + (hi - lo) * ((rngState >> 8) / 16777216.0f);
+}
+
+static float dist(const EnuPoint& a, const EnuPoint& b) {
+    float de = a.east_m - b.east_m, dn = a.north_m - b.north_m;
+    return sqrtf(de * de + dn * dn);
+}
+
+static bool near(float a, float b, float tol = 0.01f) { return fabsf(a - b) <= tol; }
+
+static uint8_t assignDue(CourseGeometry& c, uint8_t due) {
+    AssignV2Packet pkt;
+    uint8_t sent = 0;
+    for (uint8_t id = BUOY_START_A; id <= BUOY_LEEWARD; id++) {
+        if ((due & COURSE_MARK_BIT(id)) && c.assign(id, 1, &pkt)) sent |= COURSE_MARK_BIT(id);
+    }
+    return sent;
+}
+
+// ---------------------------------------------------------------------------
+// Baseline: recompute every mark and build every packet
+struct NaiveCourse {
+    CourseConfig cfg = { COURSE_LINE_DEFAULT_M, COURSE_WINDWARD_DEFAULT_M, COURSE_LEEWARD_DEFAULT_M };
+    EnuPoint     mark[MAX_BUOYS];
+
+    void relay(float from_deg) {
+        float r = from_deg * (float)(M_PI / 180.0), ue = sinf(r), un = cosf(r), h = cfg.line_m * 0.5f;
+        mark[BUOY_START_A]  = { -h * un,  h * ue };
+        mark[BUOY_START_B]  = {  h * un, -h * ue };
+        mark[BUOY_WINDWARD] = { cfg.windward_m * ue, cfg.windward_m * un };
+        mark[BUOY_LEEWARD]  = { -cfg.leeward_m * ue, -cfg.leeward_m * un };
+        for (uint8_t id = BUOY_START_A; id <= BUOY_LEEWARD; id++) {
+            AssignV2Packet p = { PKT_ASSIGN_V2, id, 1, {}, {}, HOLD_RADIUS_DEFAULT, 0 };
+            pos24_put(p.target_north_cm, (int32_t)lrintf(mark[id].north_m * 100.0f));
+            pos24_put(p.target_east_cm, (int32_t)lrintf(mark[id].east_m * 100.0f));
+            packet_seal(p);
+        }
+    }
+};
+
+static void partOne() {
+    printf("Part 1 — geometry and assignment rules\n");
+    const CourseConfig cfg = { COURSE_LINE_DEFAULT_M, COURSE_WINDWARD_DEFAULT_M, COURSE_LEEWARD_DEFAULT_M };
+
+    bool diamond = true;
+    static const float WINDS[] = { 0.0f, 90.0f, 225.0f, 359.9f };
+    for (float w : WINDS) {
+        CourseGeometry c(cfg, { 10.0f, -20.0f });
+        c.setWind(w);
+        c.update();
+        const EnuPoint &a = c.target(BUOY_START_A), &b = c.target(BUOY_START_B);
+        const EnuPoint &ww = c.target(BUOY_WINDWARD), &lw = c.target(BUOY_LEEWARD);
+        float r  = w * (float)(M_PI / 180.0);
+        float ue = sinf(r), un = cosf(r);
+        float abE = b.east_m - a.east_m, abN = b.north_m - a.north_m;
+        diamond &= near(dist(a, b), cfg.line_m);
+        diamond &= near(abE * ue + abN * un, 0.0f);                                 // line ⟂ wind
+        diamond &= near((a.east_m + b.east_m) / 2, 10.0f) && near((a.north_m + b.north_m) / 2, -20.0f);
+        diamond &= near((ww.east_m - 10.0f) * ue + (ww.north_m + 20.0f) * un, cfg.windward_m);
+        diamond &= near((lw.east_m - 10.0f) * ue + (lw.north_m + 20.0f) * un, -cfg.leeward_m);
+        diamond &= (ue * (a.north_m + 20.0f) - un * (a.east_m - 10.0f)) > 0.0f;     // A left looking upwind
+    }
+    check(diamond, "diamond: line length, line perpendicular to wind, centred, marks up/downwind, A to port");
+
+    CourseGeometry c(cfg);
+    check(c.update() == 0 && !c.solved(), "no wind yet: nothing to assign");
+    c.setWind(220.0f);
+    check(c.update() == COURSE_MARKS_ALL, "fresh course: all four marks due");
+    check(assignDue(c, c.pending()) == COURSE_MARKS_ALL && c.pending() == 0, "assign() clears each mark");
+
+    c.setWind(220.3f);   // windward moves 2.1 m, < 3 m
+    check(c.update() == 0, "0.3 deg shift (windward 2.1 m): nothing sent");
+    c.setWind(220.5f);   // windward 3.5 m, start marks 0.26 m
+    check(c.update() == COURSE_MARK_BIT(BUOY_WINDWARD), "0.5 deg shift: windward only");
+    assignDue(c, c.pending());
+
+    int steps = 0;
+    while (steps < 20 && !c.pending()) {
+        c.setWind(220.5f + 0.1f * ++steps);
+        c.update();
+    }
+    check(c.pending() == COURSE_MARK_BIT(BUOY_WINDWARD) && steps == 5,
+          "0.1 deg steps accumulate: windward due after 5 (3.5 m), no creep");
+    assignDue(c, c.pending());
+
+    uint32_t before = c.stats().recomputed;
+    CourseConfig longer = cfg;
+    longer.line_m = cfg.line_m + 10.0f;
+    c.setConfig(longer);
+    uint8_t due = c.update();
+    check(c.stats().recomputed - before == 2 &&
+          due == (COURSE_MARK_BIT(BUOY_START_A) | COURSE_MARK_BIT(BUOY_START_B)),
+          "line +10 m: recompute and send A and B only");
+    assignDue(c, due);
+
+    c.setHoldRadius(BUOY_WINDWARD, 6);
+    c.setWind(221.5f);   // windward 3.5 m from its assignment
+    due = c.update();
+    check(!(due & COURSE_MARK_BIT(BUOY_WINDWARD)), "hold radius 6 m: 0.5 deg shift not sent to windward");
+    check(near(c.drift(BUOY_WINDWARD), 3.49f, 0.05f), "drift() reports the unsent displacement");
+
+    c.invalidate();
+    check(c.update() == COURSE_MARKS_ALL, "invalidate(): every mark due again");
+
+    AssignV2Packet pkt;
+    check(c.assign(BUOY_LEEWARD, 9, &pkt), "assign() builds a packet");
+    const AssignV2Packet* v = packet_view<AssignV2Packet>((const uint8_t*)&pkt, sizeof(pkt));
+    check(v && v->buoy_id == BUOY_LEEWARD && v->origin_seq == 9 && v->hold_radius == HOLD_RADIUS_DEFAULT &&
+          pos24_get(v->target_north_cm) == lrintf(c.target(BUOY_LEEWARD).north_m * 100.0f) &&
+          pos24_get(v->target_east_cm) == lrintf(c.target(BUOY_LEEWARD).east_m * 100.0f),
+          "ASSIGN_V2 passes packet_view() with the target in cm");
+    check(!c.assign(BUOY_MASTER, 9, &pkt), "assign() refuses non-mark buoys");
+}
+
+// ---------------------------------------------------------------------------
+static float windAt(uint32_t t_s) {
+    float d = 220.0f + 8.0f * sinf((float)(2.0 * M_PI * t_s / 900.0)) + uniform(-6.0f, 6.0f);
+    if (t_s >= VEER_AT_S) d += 20.0f;
+    return fmodf(d + 360.0f, 360.0f);
+}
+
+static uint32_t assignAirtimeUs() {
+    for (int i = 0; i < LORA_PACKET_TYPE_COUNT; i++) {
+        if (LORA_PACKET_AIRTIMES.entry[i].type == PKT_ASSIGN_V2) return LORA_PACKET_AIRTIMES.entry[i].toa_us;
+    }
+    return 0;
+}
+
+static void partTwo() {
+    printf("\nPart 2 — %d s replay at 1 Hz, 60 s mean, veer 20 deg at %d s\n", REPLAY_S, VEER_AT_S);
+    static WindWindow window;
+    CourseGeometry    engine;
+    NaiveCourse       naive;
+    CourseGeometry    truth;           // solution at every second, for the error columns
+    float    laid = -1000.0f;
+    uint32_t naivePackets = 0, enginePackets = 0;
+    float    naiveWorst = 0.0f, engineWorst = 0.0f;
+    float    engineTravel = 0.0f, naiveTravel = 0.0f;
+    EnuPoint naiveLast[MAX_BUOYS] = {};
+
+    for (uint32_t t = 0; t < REPLAY_S; t++) {
+        window.add(windAt(t), t * 1000);
+        if (!window.full()) continue;
+        float mean = window.mean_deg();
+
+        float d = fabsf(fmodf(mean - laid + 540.0f, 360.0f) - 180.0f);
+        if (d >= RELAY_DEG) {
+            naive.relay(mean);
+            laid = mean;
+            for (uint8_t id = BUOY_START_A; id <= BUOY_LEEWARD; id++) {
+                if (naivePackets >= 4) naiveTravel += dist(naive.mark[id], naiveLast[id]);
+                naiveLast[id] = naive.mark[id];
+            }
+            naivePackets += 4;
+        }
+
+        engine.setWind(mean);
+        uint8_t due = engine.update();
+        for (uint8_t id = BUOY_START_A; id <= BUOY_LEEWARD; id++) {
+            if (!(due & COURSE_MARK_BIT(id))) continue;
+            EnuPoint prev = engine.assigned(id);
+            bool     first = engine.stats().assigned < 4;
+            AssignV2Packet pkt;
+            if (engine.assign(id, 1, &pkt)) {
+                enginePackets++;
+                if (!first) engineTravel += dist(engine.target(id), prev);
+            }
+        }
+
+        truth.setWind(mean);
+        truth.update();
+        for (uint8_t id = BUOY_START_A; id <= BUOY_LEEWARD; id++) {
+            float ne = dist(naive.mark[id], truth.target(id));
+            float ee = dist(engine.assigned(id), truth.target(id));
+            if (ne > naiveWorst)  naiveWorst  = ne;
+            if (ee > engineWorst) engineWorst = ee;
+        }
+    }
+
+    uint32_t toa = assignAirtimeUs();
+    printf("%-26s %10s %12s %14s %16s\n", "", "ASSIGNs", "airtime ms", "travel m", "worst error m");
+    printf("%-26s %10lu %12.1f %14.1f %16.2f\n", "baseline (all on 1 deg)",
+           (unsigned long)naivePackets, naivePackets * toa / 1000.0, naiveTravel, naiveWorst);
+    printf("%-26s %10lu %12.1f %14.1f %16.2f\n", "engine (hold_radius 3 m)",
+           (unsigned long)enginePackets, enginePackets * toa / 1000.0, engineTravel, engineWorst);
+
+    // Timing: a 0.2° wind change (all four marks recomputed), an unchanged
+    // wind (nothing dirty), and the baseline re-lay with four packet builds
+    CourseGeometry c;
+    volatile uint8_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMING_ROUNDS; i++) {
+        c.setWind(200.0f + (i & 63) * 0.2f);
+        sink = sink + c.update();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double shiftNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / TIMING_ROUNDS;
+
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMING_ROUNDS; i++) {
+        c.setWind(212.6f);
+        sink = sink + c.update();
+    }
+    t1 = std::chrono::steady_clock::now();
+    double idleNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / TIMING_ROUNDS;
+
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMING_ROUNDS; i++) {
+        naive.relay(200.0f + (i & 63) * 0.2f);
+        sink = sink + (uint8_t)naive.mark[BUOY_WINDWARD].east_m;
+    }
+    t1 = std::chrono::steady_clock::now();
+    double naiveNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / TIMING_ROUNDS;
+
+    printf("\nsetWind + update, wind moved      %8.1f ns\n", shiftNs);
+    printf("setWind + update, wind unchanged  %8.1f ns\n", idleNs);
+    printf("baseline re-lay + 4 packet seals  %8.1f ns\n\n", naiveNs);
+
+    check(enginePackets < naivePackets, "engine sends fewer ASSIGNs than the baseline");
+    check(engineWorst <= HOLD_RADIUS_DEFAULT + 0.01f, "engine never leaves a mark beyond hold_radius of the solution");
+    check(naiveWorst > HOLD_RADIUS_DEFAULT, "baseline leaves marks beyond hold_radius between 1 deg re-lays");
+}
+
+int main() {
+    partOne();
+    partTwo();
+    return check_summary();
+}
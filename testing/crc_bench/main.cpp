@@ -0,0 +1,158 @@
+// CRC16-CCITT Backend Benchmark — host (platform = native)
+//
+// Run:  pio run -e crc_bench -t exec
+//
+// 1. Equivalence: every backend must match crc16_bitwise() byte for byte for
+//    every length 0..LORA_MAX_PAYLOAD over pseudo-random data, at every
+//    alignment 0..7 (slice-by-N reads in blocks, so the tail paths matter).
+// 2. Throughput: bytes/cycle for each backend at every packet size
+//    1..LORA_MAX_PAYLOAD. Cycles come from the TSC on x86; elsewhere the
+//    steady clock in ns is used and the column header says so.
+//
+// Output: CSV — size,bitwise,table,slice4,slice8 — followed by a summary for
+// the fixed-size packets in common/protocol.h. Exit code 1 on any mismatch.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+#include "common/crc16.h"
+#include "common/protocol.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLE_UNIT "cycle"
+static inline uint64_t readCycles() { return __rdtsc(); }
+#else
+#define CYCLE_UNIT "ns"
+static inline uint64_t readCycles() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+typedef uint16_t (*Crc16Fn)(uint16_t, const uint8_t*, size_t);
+
+struct Backend {
+    const char* name;
+    Crc16Fn     fn;
+};
+
+static const Backend BACKENDS[] = {
+    { "bitwise", crc16_bitwise },
+    { "table",   crc16_table   },
+    { "slice4",  crc16_slice4  },
+    { "slice8",  crc16_slice8  },
+};
+static const int NUM_BACKENDS = sizeof(BACKENDS) / sizeof(BACKENDS[0]);
+
+// Iterations per measurement — enough to swamp timer overhead at 1-byte sizes.
+#define BENCH_ITERATIONS  20000
+
+static uint8_t buf[LORA_MAX_PAYLOAD + 8];
+
+// Defeats dead-code elimination of the benchmarked calls.
+static volatile uint16_t sink;
+
+// ---------------------------------------------------------------------------
+static uint32_t rngState = 0x12345678;
+static uint8_t nextByte() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return (uint8_t)(rngState >> 24);
+}
+
+// ---------------------------------------------------------------------------
+static int checkEquivalence() {
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(buf); i++) buf[i] = nextByte();
+
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t len = 0; len <= LORA_MAX_PAYLOAD; len++) {
+            const uint8_t* p = buf + offset;
+            uint16_t ref = crc16_bitwise(CRC16_INIT, p, len);
+            for (int b = 1; b < NUM_BACKENDS; b++) {
+                uint16_t got = BACKENDS[b].fn(CRC16_INIT, p, len);
+                if (got != ref) {
+                    if (failures < 10) {
+                        printf("MISMATCH %s len=%u off=%u: 0x%04X != 0x%04X\n",
+                               BACKENDS[b].name, (unsigned)len, (unsigned)offset, got, ref);
+                    }
+                    failures++;
+                }
+            }
+            if (crc16_rom(CRC16_INIT, p, len) != ref || crc16_ccitt(p, len) != ref) failures++;
+        }
+    }
+
+    // Known-answer test: CRC-16/CCITT-FALSE("123456789") = 0x29B1
+    const char* kat = "123456789";
+    if (crc16_ccitt((const uint8_t*)kat, 9) != 0x29B1) {
+        printf("MISMATCH known-answer test: 0x%04X != 0x29B1\n",
+               crc16_ccitt((const uint8_t*)kat, 9));
+        failures++;
+    }
+    return failures;
+}
+
+// ---------------------------------------------------------------------------
+static double bytesPerCycle(Crc16Fn fn, size_t len) {
+    uint16_t acc = 0;
+    uint64_t start = readCycles();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        acc ^= fn((uint16_t)(CRC16_INIT ^ acc), buf, len);
+    }
+    uint64_t elapsed = readCycles() - start;
+    sink = acc;
+    if (elapsed == 0) elapsed = 1;
+    return (double)len * BENCH_ITERATIONS / (double)elapsed;
+}
+
+// ---------------------------------------------------------------------------
+int main() {
+    printf("CRC16-CCITT backend benchmark (calculate_checksum backend = %d)\n", CRC16_BACKEND);
+
+    int failures = checkEquivalence();
+    printf("Equivalence vs bitwise, lengths 0..%d, 8 alignments: %s\n",
+           LORA_MAX_PAYLOAD, failures ? "FAIL" : "PASS");
+    if (failures) return 1;
+
+    static double results[LORA_MAX_PAYLOAD + 1][NUM_BACKENDS];
+
+    printf("\nsize");
+    for (int b = 0; b < NUM_BACKENDS; b++) printf(",%s_B_per_%s", BACKENDS[b].name, CYCLE_UNIT);
+    printf("\n");
+
+    for (size_t len = 1; len <= LORA_MAX_PAYLOAD; len++) {
+        printf("%u", (unsigned)len);
+        for (int b = 0; b < NUM_BACKENDS; b++) {
+            results[len][b] = bytesPerCycle(BACKENDS[b].fn, len);
+            printf(",%.4f", results[len][b]);
+        }
+        printf("\n");
+    }
+
+    // Summary at the sizes the protocol actually sends (checksum excluded)
+    struct { const char* name; size_t len; } packets[] = {
+        { "RcCommandPacket",    sizeof(RcCommandPacket)    - 2 },
+        { "MasterStatusPacket", sizeof(MasterStatusPacket) - 2 },
+        { "PingStatusPacket",   sizeof(PingStatusPacket)   - 2 },
+        { "AssignPacket",       sizeof(AssignPacket)       - 2 },
+        { "AckAssignPacket",    sizeof(AckAssignPacket)    - 2 },
+        { "StatusPacket",       sizeof(StatusPacket)       - 2 },
+        { "LORA_MAX_PAYLOAD",   LORA_MAX_PAYLOAD               },
+    };
+
+    printf("\nSummary (B/%s, speed-up vs bitwise)\n", CYCLE_UNIT);
+    printf("%-20s %5s", "packet", "bytes");
+    for (int b = 0; b < NUM_BACKENDS; b++) printf(" %16s", BACKENDS[b].name);
+    printf("\n");
+    for (size_t i = 0; i < sizeof(packets) / sizeof(packets[0]); i++) {
+        size_t len = packets[i].len;
+        printf("%-20s %5u", packets[i].name, (unsigned)len);
+        for (int b = 0; b < NUM_BACKENDS; b++) {
+            printf("   %6.3f (%4.1fx)", results[len][b], results[len][b] / results[len][0]);
+        }
+        printf("\n");
+    }
+    return 0;
+}
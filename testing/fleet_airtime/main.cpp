@@ -0,0 +1,124 @@
+// Fleet Summary Airtime Comparison — host (platform = native)
+//
+// Run:  pio run -e fleet_airtime -t exec
+//
+// Compares the airtime needed to give a remote/logger the full fleet state:
+//   per-packet — master relays each slave's StatusPacket + one MasterStatusPacket
+//                (N + 1 frames, N + 1 preambles/headers, N + 1 receptions)
+//   summary    — PKT_FLEET_SUMMARY frames of up to FLEET_SUMMARY_MAX_ENTRIES
+//                entries each (one frame up to 22 slaves)
+// The slave → master uplink (N × StatusPacket) is the same in both schemes and
+// is shown for the per-cycle channel total.
+//
+// Modem: LORA_MODEM_DEFAULT (SF7, 125 kHz, CR4/5, 8-symbol preamble, CRC on).
+// Also round-trips a summary through build_fleet_summary() + PacketDispatcher.
+
+#include <stdio.h>
+#include <string.h>
+#include "common/protocol.h"
+#include "common/packet_codec.h"
+#include "common/lora_airtime.h"
+#include "common/position.h"
+#include "testing/check.h"
+
+static const int FLEET_SIZES[] = { MAX_BUOYS - 2, 8, 12, 16, 22, 24, 32 };   // slaves (MAX_BUOYS less master + remote)
+
+static uint32_t perPacketDownlinkUs(int slaves) {
+    return (uint32_t)slaves * lora_time_on_air_us(LORA_MODEM_DEFAULT, sizeof(StatusPacket))
+         + lora_time_on_air_us(LORA_MODEM_DEFAULT, sizeof(MasterStatusPacket));
+}
+
+static uint32_t summaryDownlinkUs(int slaves, int* frames) {
+    uint32_t us = 0;
+    *frames = 0;
+    do {
+        int n = slaves > (int)FLEET_SUMMARY_MAX_ENTRIES ? (int)FLEET_SUMMARY_MAX_ENTRIES : slaves;
+        us += lora_time_on_air_us(LORA_MODEM_DEFAULT, (uint16_t)fleet_summary_size((uint8_t)n));
+        slaves -= n;
+        (*frames)++;
+    } while (slaves > 0);
+    return us;
+}
+
+// ---------------------------------------------------------------------------
+struct SummaryCheck : PacketHandlerBase {
+    int      count  = -1;
+    uint8_t  faults = 0;
+    uint16_t distSum = 0;
+    int32_t  eastSum = 0;
+    void onFleetSummary(const FleetSummaryView& v) {
+        count  = v.header->count;
+        faults = v.header->fault_flags;
+        for (int i = 0; i < count; i++) {
+            distSum += v.entries[i].dist_to_target_cm;
+            eastSum += pos24_get(v.entries[i].east_cm);
+        }
+    }
+};
+
+static bool roundTrip() {
+    FleetEntry entries[4];
+    for (uint8_t i = 0; i < 4; i++) {
+        entries[i].buoy_id           = (uint8_t)(BUOY_START_A + i);
+        pos24_put(entries[i].north_cm, 1100 * i);
+        pos24_put(entries[i].east_cm,  -250 * i);
+        entries[i].dist_to_target_cm = (uint16_t)(100 * (i + 1));
+        entries[i].battery_tenths_v  = 148;
+        entries[i].error_flags       = 0;
+    }
+    entries[2].error_flags = ERROR_FLAG_LOW_BATTERY;
+    entries[3].error_flags = ERROR_FLAG_OBSTACLE;
+
+    uint8_t buf[LORA_MAX_PAYLOAD];
+    size_t  len = build_fleet_summary(buf, FLEET_STATE_REPOSITIONING, 1, entries, 4);
+
+    SummaryCheck h;
+    PacketDispatcher<SummaryCheck> d(h);
+    bool ok = len == fleet_summary_size(4) && d.dispatch(buf, len) == PACKET_OK &&
+              h.count == 4 && h.faults == (ERROR_FLAG_LOW_BATTERY | ERROR_FLAG_OBSTACLE) &&
+              h.distSum == 1000 && h.eastSum == -1500;
+
+    // An explicit fault_flags (the registry's, which covers nodes not in
+    // the list) replaces the OR of the entries
+    SummaryCheck h2;
+    PacketDispatcher<SummaryCheck> d2(h2);
+    len = build_fleet_summary(buf, FLEET_STATE_REPOSITIONING, 1, entries, 4, ERROR_FLAG_COMMS_LOST);
+    ok = ok && d2.dispatch(buf, len) == PACKET_OK && h2.faults == ERROR_FLAG_COMMS_LOST;
+
+    buf[10] ^= 0x01;
+    ok = ok && d.dispatch(buf, len) == PACKET_BAD_CHECKSUM;
+    ok = ok && d.dispatch(buf, len - 1) == PACKET_BAD_LENGTH;
+    ok = ok && build_fleet_summary(buf, 0, 1, entries, FLEET_SUMMARY_MAX_ENTRIES + 1) == 0;
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+int main() {
+    printf("Fleet summary airtime — SF%u, %lu Hz, CR4/%u, preamble %u\n",
+           LORA_MODEM_DEFAULT.sf, (unsigned long)LORA_MODEM_DEFAULT.bw_hz,
+           LORA_MODEM_DEFAULT.cr_denom, LORA_MODEM_DEFAULT.preamble);
+    printf("StatusPacket %u B = %.2f ms, MasterStatusPacket %u B = %.2f ms, summary max %u entries\n\n",
+           (unsigned)sizeof(StatusPacket), lora_time_on_air_us(LORA_MODEM_DEFAULT, sizeof(StatusPacket)) / 1000.0,
+           (unsigned)sizeof(MasterStatusPacket), lora_time_on_air_us(LORA_MODEM_DEFAULT, sizeof(MasterStatusPacket)) / 1000.0,
+           (unsigned)FLEET_SUMMARY_MAX_ENTRIES);
+
+    printf("%6s | %21s | %21s | %7s | %22s\n", "", "downlink per-packet", "downlink summary", "", "cycle total (+uplink)");
+    printf("%6s | %7s %13s | %7s %13s | %7s | %10s %11s\n",
+           "slaves", "frames", "airtime ms", "frames", "airtime ms", "saving", "per-packet", "summary");
+
+    for (size_t i = 0; i < sizeof(FLEET_SIZES) / sizeof(FLEET_SIZES[0]); i++) {
+        int      n        = FLEET_SIZES[i];
+        uint32_t uplink   = (uint32_t)n * lora_time_on_air_us(LORA_MODEM_DEFAULT, sizeof(StatusPacket));
+        uint32_t perPkt   = perPacketDownlinkUs(n);
+        int      frames   = 0;
+        uint32_t summary  = summaryDownlinkUs(n, &frames);
+        printf("%6d | %7d %13.2f | %7d %13.2f | %6.1f%% | %10.2f %11.2f\n",
+               n, n + 1, perPkt / 1000.0, frames, summary / 1000.0,
+               100.0 * (1.0 - (double)summary / perPkt),
+               (uplink + perPkt) / 1000.0, (uplink + summary) / 1000.0);
+    }
+
+    printf("\n");
+    check(roundTrip(), "build_fleet_summary -> PacketDispatcher round trip");
+    return check_summary();
+}
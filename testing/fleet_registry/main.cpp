@@ -0,0 +1,461 @@
+// Fleet Registry Check — host (platform = native)
+//
+// Run:  pio run -e fleet_registry -t exec
+//
+// The master's join-time registry (common/registry.h) and the join protocol:
+//   1. join: buoys get dense addresses 1… and the plan's roles (the first four
+//      equal the fixed BuoyIDs), remotes distinct addresses from 0xE0; a
+//      requested mark is honoured while free; a rejoining UID keeps its
+//      address; past 32 buoys the reply is JOIN_STATUS_FULL
+//   2. leave / expire: the freed address is reused, the columns stay packed
+//      and the address map consistent
+//   3. codec: JOIN_REQUEST / JOIN_ACCEPT through PacketDispatcher; a request
+//      fits a contention sub-slot
+//   4. aggregate: one pass over the columns agrees with a per-node struct
+//      (AoS) reference on random fleets, silent buoys flag COMMS_LOST
+//   5. summary: 30 buoys need two FLEET_SUMMARY frames; the header carries
+//      the whole fleet's fault_flags in each
+//   6. benchmarks at 6, 16 and 32 nodes (two of them remotes): superframe and
+//      telemetry rate for the registry's layout, cold-start join over the
+//      contention slot (nodes power up within 5 s, 1/2 persistence, 2% frame
+//      loss, one JOIN_ACCEPT per downlink), master CPU per superframe, and
+//      aggregate() against the AoS scan
+//
+// Pass criteria: every check below; at every size all nodes join within
+// JOIN_DEADLINE_S in 99% of runs, and the master's per-superframe work stays
+// under 20 µs on the host. Join time is bounded by one JOIN_ACCEPT per
+// superframe while the superframe grows with every buoy that joins (32
+// nodes: ~1 min mean).
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "common/protocol.h"
+#include "common/packet_codec.h"
+#include "common/position.h"
+#include "common/lora_airtime.h"
+#include "common/lora_budget.h"
+#include "common/tdma.h"
+#include "common/registry.h"
+#include "testing/check.h"
+
+#define JOIN_TRIALS        500
+#define JOIN_DEADLINE_S    120.0   // power-on to a full fleet, p99
+#define JOIN_PERSIST       0.5     // chance an unjoined node uses this superframe
+#define JOIN_LOSS          0.02
+#define POWER_ON_SPREAD_S  5.0
+#define JOIN_MAX_WAIT      4       // superframes, back-off cap
+#define TIMEOUT_MS         COMMS_TIMEOUT_MS
+#define HOLD_CM            (HOLD_RADIUS_DEFAULT * 100)
+#define BENCH_REPS         200000
+
+static const LoRaModem& MODEM = LORA_MODEM_DEFAULT;
+
+static uint64_t rngState = 7;
+static double uniform01() {
+    rngState = rngState * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (rngState >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static JoinRequestPacket request(uint32_t uid, uint8_t role) {
+    JoinRequestPacket r = { PKT_JOIN_REQUEST, NODE_ADDR_UNASSIGNED, uid, role, 0 };
+    packet_seal(r);
+    return r;
+}
+
+static StatusV2Packet status(uint8_t addr, int32_t n, int32_t e, uint16_t dist, uint8_t batt, uint8_t origin) {
+    StatusV2Packet p = {};
+    p.packet_type = PKT_STATUS_V2;
+    p.buoy_id     = addr;
+    p.origin_seq  = origin;
+    pos24_put(p.current_north_cm, n);
+    pos24_put(p.current_east_cm, e);
+    p.dist_to_target_cm = dist;
+    p.battery_tenths_v  = batt;
+    packet_seal(p);
+    return p;
+}
+
+static bool mapConsistent(const NodeRegistry& reg) {
+    for (int i = 0; i < reg.size(); i++) {
+        if (reg.indexOf(reg.addrAt(i)) != i) return false;
+    }
+    int mapped = 0;
+    for (int a = 0; a < 256; a++) mapped += reg.indexOf((uint8_t)a) >= 0;
+    return mapped == reg.size();
+}
+
+// ---------------------------------------------------------------------------
+// AoS reference: one struct per node, as a master would otherwise keep it
+// ---------------------------------------------------------------------------
+struct NodeRecord {
+    uint32_t uid;
+    uint8_t  addr;
+    uint8_t  role;
+    uint8_t  state;
+    bool     reported;
+    int32_t  north_cm;
+    int32_t  east_cm;
+    int32_t  target_north_cm;
+    int32_t  target_east_cm;
+    uint16_t dist_cm;
+    uint8_t  battery;
+    uint8_t  flags;
+    uint32_t last_ms;
+    uint32_t last_assign_ms;
+    uint16_t retries;
+    uint8_t  hold_m;
+    float    heading;
+    float    speed;
+    char     name[12];
+};
+
+static FleetAggregate aggregateAos(const NodeRecord* r, int n, uint32_t now, uint32_t timeout, uint16_t hold) {
+    FleetAggregate a = {};
+    uint8_t minB = 0xFF;
+    for (int i = 0; i < n; i++) {
+        if (r[i].addr > REGISTRY_MAX_BUOYS) {
+            a.remotes++;
+            continue;
+        }
+        bool fresh = r[i].reported && (uint32_t)(now - r[i].last_ms) <= timeout;
+        a.buoys++;
+        a.fault_flags |= r[i].flags | (fresh ? 0 : ERROR_FLAG_COMMS_LOST);
+        if (!fresh) continue;
+        a.reporting++;
+        a.on_station += r[i].dist_cm <= hold;
+        if (r[i].battery < minB) minB = r[i].battery;
+        if (r[i].dist_cm > a.max_dist_cm) a.max_dist_cm = r[i].dist_cm;
+    }
+    a.min_battery_tenths_v = a.reporting ? minB : 0;
+    return a;
+}
+
+static bool sameAggregate(const FleetAggregate& x, const FleetAggregate& y) {
+    return x.fault_flags == y.fault_flags && x.buoys == y.buoys && x.remotes == y.remotes &&
+           x.reporting == y.reporting && x.on_station == y.on_station &&
+           x.min_battery_tenths_v == y.min_battery_tenths_v && x.max_dist_cm == y.max_dist_cm;
+}
+
+// Random fleet in both layouts: joined, some reporting, some silent, some flagged
+static int randomFleet(NodeRegistry& reg, NodeRecord* aos, int buoys, int remotes, uint32_t now) {
+    reg.clear();
+    int n = 0;
+    for (int k = 0; k < buoys + remotes; k++) {
+        JoinAcceptPacket acc;
+        bool remote = k >= buoys;
+        reg.join(request(0x1000u + k, remote ? NODE_ROLE_REMOTE : NODE_ROLE_ANY), now, &acc);
+        NodeRecord& r = aos[n++];
+        memset(&r, 0, sizeof(r));
+        r.uid  = acc.uid;
+        r.addr = acc.address;
+        r.role = acc.role;
+        r.last_ms = now;
+        if (remote) continue;
+        if (uniform01() < 0.9) {
+            uint32_t heard = now - (uint32_t)(uniform01() < 0.1 ? TIMEOUT_MS + 5000 : uniform01() * 2000);
+            r.dist_cm  = (uint16_t)(uniform01() * 900);
+            r.battery  = (uint8_t)(110 + uniform01() * 20);
+            r.north_cm = (int32_t)(uniform01() * 200000) - 100000;
+            r.east_cm  = (int32_t)(uniform01() * 200000) - 100000;
+            r.reported = true;
+            r.last_ms  = heard;
+            reg.onStatus(status(r.addr, r.north_cm, r.east_cm, r.dist_cm, r.battery, 1), 1, heard);
+        }
+        if (uniform01() < 0.05) {
+            r.flags = (uint8_t)(1u << (int)(uniform01() * 7));
+            reg.setFlags(r.addr, r.flags);
+        }
+    }
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Cold-start join over the contention slot
+//
+// Per superframe: the master sends one queued JOIN_ACCEPT in its downlink,
+// then every powered, unjoined node whose back-off has run out sends a
+// JOIN_REQUEST in a random contention sub-slot of the layout the current
+// beacon announces. One request in a sub-slot is heard; two or more collide.
+// A node not accepted within its wait doubles the wait (capped at
+// JOIN_MAX_WAIT superframes), as a buoy on the water would.
+// ---------------------------------------------------------------------------
+struct JoinRun {
+    double   allJoinedS;
+    uint32_t requests;
+    uint32_t collisions;
+};
+
+static JoinRun simulateJoin(int buoys, int remotes) {
+    const int total = buoys + remotes;
+    std::vector<double>   powerOn(total);
+    std::vector<bool>     joined(total, false);
+    std::vector<bool>     queued(total, false);
+    std::vector<uint32_t> wait(total, 0), window(total, 1);
+    std::vector<int>      queue;                 // JOIN_ACCEPTs owed, oldest first
+    for (int k = 0; k < total; k++) powerOn[k] = uniform01() * POWER_ON_SPREAD_S * 1e6;
+
+    NodeRegistry reg;
+    JoinRun run = {};
+    double  T = 0.0;
+    int     done = 0;
+    while (done < total && T < 600e6) {
+        TdmaConfig cfg = reg.tdmaConfig();
+
+        if (!queue.empty()) {
+            int k = queue.front();
+            queue.erase(queue.begin());
+            queued[k] = false;
+            JoinAcceptPacket acc;
+            reg.join(request(0xA000u + k, k < buoys ? NODE_ROLE_ANY : NODE_ROLE_REMOTE), (uint32_t)(T / 1000), &acc);
+            if (!joined[k] && uniform01() >= JOIN_LOSS &&
+                packet_view<JoinAcceptPacket>((const uint8_t*)&acc, sizeof(acc)) && acc.status == JOIN_STATUS_OK) {
+                joined[k] = true;
+                done++;
+            }
+        }
+
+        int sender[4] = { -1, -1, -1, -1 };
+        int senders[4] = {};
+        for (int k = 0; k < total; k++) {
+            if (joined[k] || powerOn[k] > T) continue;
+            if (wait[k] > 0) {
+                wait[k]--;
+                continue;
+            }
+            if (uniform01() < JOIN_LOSS) continue;          // missed the beacon
+            if (uniform01() >= JOIN_PERSIST) continue;
+            int sub = (int)(uniform01() * cfg.contention_slots);
+            sender[sub] = k;
+            senders[sub]++;
+            run.requests++;
+            wait[k]   = window[k] + (uint32_t)(uniform01() * window[k]);
+            window[k] = window[k] < JOIN_MAX_WAIT ? window[k] * 2 : JOIN_MAX_WAIT;
+        }
+        for (int sub = 0; sub < cfg.contention_slots; sub++) {
+            if (senders[sub] > 1) run.collisions++;
+            if (senders[sub] != 1 || uniform01() < JOIN_LOSS) continue;
+            int k = sender[sub];
+            if (!queued[k]) {
+                queued[k] = true;
+                queue.push_back(k);
+            }
+        }
+        TdmaSchedule sched;
+        tdma_build_schedule(MODEM, cfg, &sched);
+        T += sched.superframe_us;
+    }
+    run.allJoinedS = done == total ? T / 1e6 : 1e9;
+    return run;
+}
+
+// ---------------------------------------------------------------------------
+// Master work per superframe: N STATUS_V2 dispatched, aggregate, summary
+// ---------------------------------------------------------------------------
+struct MasterRx : PacketHandlerBase {
+    NodeRegistry* reg;
+    uint32_t      now;
+    uint32_t      accepted;
+    void onStatusV2(const StatusV2Packet& p) { accepted += reg->onStatus(p, 1, now); }
+    void onJoinRequest(const JoinRequestPacket& p) {
+        JoinAcceptPacket acc;
+        accepted += reg->join(p, now, &acc);
+    }
+};
+
+static volatile uint32_t sink;
+
+int main() {
+    printf("Fleet registry check — capacity %d nodes, %d buoys, %u-B contention sub-slots\n\n",
+           REGISTRY_CAPACITY, REGISTRY_MAX_BUOYS, (unsigned)TDMA_CONTENTION_LEN);
+    static NodeRegistry reg;
+    JoinAcceptPacket    acc;
+
+    // --- 1. join ------------------------------------------------------------
+    printf("Join\n");
+    bool dense = true, rolesOk = true;
+    for (int k = 0; k < 30; k++) {
+        reg.join(request(100 + k, NODE_ROLE_ANY), 0, &acc);
+        dense &= acc.status == JOIN_STATUS_OK && acc.address == NODE_ADDR_BUOY_FIRST + k;
+        uint8_t want = k < 9 ? (uint8_t)(NODE_ROLE_START_A + k) : (uint8_t)NODE_ROLE_SPARE;
+        rolesOk &= acc.role == want;
+    }
+    check(dense, "30 buoys get addresses 1..30 in join order");
+    check(rolesOk && reg.roleAt(0) == BUOY_START_A && reg.roleAt(3) == BUOY_LEEWARD,
+          "roles follow the plan (first four = fixed BuoyIDs), then SPARE");
+    reg.join(request(900, NODE_ROLE_REMOTE), 0, &acc);
+    bool r0 = acc.address == NODE_ADDR_REMOTE_FIRST && acc.role == NODE_ROLE_REMOTE;
+    reg.join(request(901, NODE_ROLE_REMOTE), 0, &acc);
+    check(r0 && acc.address == NODE_ADDR_REMOTE_FIRST + 1 && reg.isRemote(acc.address),
+          "two remotes get distinct addresses 0xE0, 0xE1");
+    reg.join(request(107, NODE_ROLE_ANY), 5000, &acc);
+    check(acc.address == 8 && acc.role == NODE_ROLE_FINISH_PIN && reg.size() == 32,
+          "rejoining UID keeps its address and role");
+
+    NodeRegistry fresh;
+    fresh.join(request(1, NODE_ROLE_LEEWARD), 0, &acc);
+    bool asked = acc.address == 1 && acc.role == NODE_ROLE_LEEWARD;
+    fresh.join(request(2, NODE_ROLE_LEEWARD), 0, &acc);
+    bool taken = acc.role == NODE_ROLE_START_A;
+    fresh.join(request(3, NODE_ROLE_ANY), 0, &acc);
+    check(asked && taken && acc.role == NODE_ROLE_START_B,
+          "requested mark granted while free, else the next open plan role");
+
+    reg.join(request(130, NODE_ROLE_ANY), 0, &acc);
+    reg.join(request(131, NODE_ROLE_ANY), 0, &acc);
+    bool last = acc.address == REGISTRY_MAX_BUOYS;
+    bool full = !reg.join(request(132, NODE_ROLE_ANY), 0, &acc);
+    check(last && full && acc.status == JOIN_STATUS_FULL && acc.address == NODE_ADDR_UNASSIGNED &&
+              packet_view<JoinAcceptPacket>((const uint8_t*)&acc, sizeof(acc)),
+          "33rd buoy refused with JOIN_STATUS_FULL (sealed reply)");
+
+    // --- 2. leave / expire --------------------------------------------------
+    printf("\nLeave / expire\n");
+    bool left = reg.leave(5) && reg.indexOf(5) < 0 && mapConsistent(reg);
+    reg.join(request(132, NODE_ROLE_ANY), 0, &acc);
+    check(left && acc.address == 5 && acc.role == NODE_ROLE_GATE_PORT, "freed address and role go to the next joiner");
+    for (int a = 1; a <= 16; a++) reg.heard((uint8_t)a, 70000);
+    reg.heard(NODE_ADDR_REMOTE_FIRST, 70000);
+    uint8_t gone = reg.expire(70000, 30000);
+    bool    kept = true;
+    for (int i = 0; i < reg.size(); i++) kept &= reg.addrAt(i) <= 16 || reg.addrAt(i) == NODE_ADDR_REMOTE_FIRST;
+    check(gone == 17 && reg.size() == 17 && kept && mapConsistent(reg),
+          "expire drops 17 silent nodes, columns packed, address map consistent");
+
+    // --- 3. codec -----------------------------------------------------------
+    printf("\nCodec\n");
+    MasterRx rx = {};
+    NodeRegistry codecReg;
+    rx.reg = &codecReg;
+    PacketDispatcher<MasterRx> disp(rx);
+    JoinRequestPacket jr = request(0xDEADBEEF, NODE_ROLE_WINDWARD);
+    bool viaDisp = disp.dispatch((const uint8_t*)&jr, sizeof(jr)) == PACKET_OK && rx.accepted == 1 &&
+                   codecReg.roleAt(0) == NODE_ROLE_WINDWARD && codecReg.uidAt(0) == 0xDEADBEEF;
+    ((uint8_t*)&jr)[3] ^= 1;
+    check(viaDisp && disp.dispatch((const uint8_t*)&jr, sizeof(jr)) == PACKET_BAD_CHECKSUM,
+          "JOIN_REQUEST dispatched; corrupted one rejected");
+    codecReg.join(request(0xDEADBEEF, NODE_ROLE_ANY), 0, &acc);
+    check(disp.dispatch((const uint8_t*)&acc, sizeof(acc)) == PACKET_OK && acc.address == 1,
+          "JOIN_ACCEPT dispatched");
+    check(sizeof(JoinRequestPacket) <= TDMA_CONTENTION_LEN && sizeof(JoinAcceptPacket) <= reg.tdmaConfig().downlink_len,
+          "JOIN_REQUEST fits a contention sub-slot, JOIN_ACCEPT the downlink");
+
+    // --- 4. aggregate -------------------------------------------------------
+    printf("\nAggregate\n");
+    static NodeRecord aos[REGISTRY_CAPACITY];
+    bool     agree = true;
+    uint32_t now   = 1000000;
+    for (int t = 0; t < 200; t++) {
+        int n = randomFleet(reg, aos, 1 + t % REGISTRY_MAX_BUOYS, t % 3, now);
+        agree &= sameAggregate(reg.aggregate(now, TIMEOUT_MS, HOLD_CM), aggregateAos(aos, n, now, TIMEOUT_MS, HOLD_CM));
+    }
+    check(agree, "one-pass SoA aggregate == AoS reference on 200 random fleets");
+    reg.clear();
+    reg.join(request(1, NODE_ROLE_ANY), 0, &acc);
+    reg.join(request(2, NODE_ROLE_ANY), 0, &acc);
+    reg.onStatus(status(1, 0, 0, 100, 120, 1), 1, now);
+    FleetAggregate a = reg.aggregate(now, TIMEOUT_MS, HOLD_CM);
+    check(a.fault_flags == ERROR_FLAG_COMMS_LOST && a.reporting == 1 && a.on_station == 1 && a.min_battery_tenths_v == 120,
+          "buoy that never reported raises COMMS_LOST");
+
+    // --- 5. summary ---------------------------------------------------------
+    printf("\nSummary\n");
+    reg.clear();
+    for (int k = 0; k < 30; k++) {
+        reg.join(request(200 + k, NODE_ROLE_ANY), 0, &acc);
+        reg.onStatus(status(acc.address, k * 100, -k * 100, (uint16_t)k, 125, 1), 1, now);
+    }
+    reg.setFlags(28, ERROR_FLAG_LOW_BATTERY);
+    uint8_t          buf[LORA_MAX_PAYLOAD];
+    bool             seen[REGISTRY_MAX_BUOYS + 1] = {};
+    bool             framesOk = true, headerOk = true;
+    FleetSummaryView v;
+    for (int f = 0; f < 2; f++) {
+        size_t len = reg.buildSummary(buf, FLEET_STATE_READY, 1, now, TIMEOUT_MS);
+        framesOk &= fleet_summary_view(buf, len, &v);
+        if (!framesOk) break;
+        headerOk &= (v.header->fault_flags & ERROR_FLAG_LOW_BATTERY) != 0;
+        for (int e = 0; e < v.header->count; e++) {
+            seen[v.entries[e].buoy_id] = true;
+            framesOk &= pos24_get(v.entries[e].north_cm) == (v.entries[e].buoy_id - 1) * 100;
+        }
+    }
+    int covered = 0;
+    for (int b = 1; b <= 30; b++) covered += seen[b];
+    check(framesOk && covered == 30, "30 buoys covered by two rotating FLEET_SUMMARY frames");
+    check(headerOk, "both headers carry the fault of a buoy only one frame lists");
+    TdmaConfig tc = reg.tdmaConfig();
+    check(tc.uplink_slots == 30 && tc.downlink_len == fleet_summary_size(FLEET_SUMMARY_MAX_ENTRIES) &&
+              tc.uplink_len == sizeof(StatusV2Packet) && tc.contention_slots == 4,
+          "beacon layout: 30 uplink slots, full-summary downlink, 4 sub-slots");
+
+    // --- 6. benchmarks ------------------------------------------------------
+    printf("\nBenchmarks (nodes = buoys + 2 remotes)\n");
+    printf("  nodes  superframe  per-buoy  airtime  join mean  join p99  collisions  master/sf  aggr SoA  aggr AoS\n");
+    static const int SIZES[] = { 6, 16, 32 };
+    bool joinOk = true, cpuOk = true, benchAgree = true;
+    for (int nodes : SIZES) {
+        int buoys = nodes - 2;
+
+        std::vector<double> t;
+        uint64_t            reqs = 0, coll = 0;
+        for (int r = 0; r < JOIN_TRIALS; r++) {
+            JoinRun jr2 = simulateJoin(buoys, 2);
+            t.push_back(jr2.allJoinedS);
+            reqs += jr2.requests;
+            coll += jr2.collisions;
+        }
+        std::sort(t.begin(), t.end());
+        double mean = 0;
+        for (double x : t) mean += x;
+        mean /= t.size();
+        double p99 = t[t.size() * 99 / 100];
+        joinOk &= p99 < JOIN_DEADLINE_S;
+
+        int n = randomFleet(reg, aos, buoys, 2, now);
+        TdmaConfig   cfg = reg.tdmaConfig();
+        TdmaSchedule sched;
+        tdma_build_schedule(MODEM, cfg, &sched);
+
+        // One superframe's uplink, as received
+        StatusV2Packet frames[REGISTRY_MAX_BUOYS];
+        for (int b = 0; b < buoys; b++) frames[b] = status((uint8_t)(b + 1), b * 50, b * 70, (uint16_t)(b * 10), 124, 1);
+        MasterRx master = {};
+        master.reg = &reg;
+        PacketDispatcher<MasterRx> md(master);
+        int    reps = BENCH_REPS / nodes;
+        double t0   = seconds();
+        for (int r = 0; r < reps; r++) {
+            master.now = now + r;
+            for (int b = 0; b < buoys; b++) md.dispatch((const uint8_t*)&frames[b], sizeof(frames[b]));
+            sink += reg.aggregate(master.now, TIMEOUT_MS, HOLD_CM).fault_flags;
+            sink += (uint32_t)reg.buildSummary(buf, FLEET_STATE_READY, 1, master.now, TIMEOUT_MS);
+        }
+        double masterUs = (seconds() - t0) / reps * 1e6;
+        cpuOk &= master.accepted == (uint32_t)(reps * buoys) && masterUs < 20.0;
+
+        n = randomFleet(reg, aos, buoys, 2, now);
+        benchAgree &= sameAggregate(reg.aggregate(now, TIMEOUT_MS, HOLD_CM), aggregateAos(aos, n, now, TIMEOUT_MS, HOLD_CM));
+        t0 = seconds();
+        for (int r = 0; r < BENCH_REPS; r++) sink += reg.aggregate(now + (r & 1023), TIMEOUT_MS, HOLD_CM).max_dist_cm;
+        double soaNs = (seconds() - t0) / BENCH_REPS * 1e9;
+        t0 = seconds();
+        for (int r = 0; r < BENCH_REPS; r++) sink += aggregateAos(aos, n, now + (r & 1023), TIMEOUT_MS, HOLD_CM).max_dist_cm;
+        double aosNs = (seconds() - t0) / BENCH_REPS * 1e9;
+
+        printf("  %5d  %7.1f ms  %5.2f Hz  %6.1f%%  %7.1f s  %6.1f s  %9.1f%%  %6.2f µs  %6.0f ns  %6.0f ns\n", nodes,
+               sched.superframe_us / 1000.0, 1e6 / sched.superframe_us, 100.0 * sched.airtime_us / sched.superframe_us,
+               mean, p99, reqs ? 100.0 * coll / reqs : 0.0, masterUs, soaNs, aosNs);
+    }
+    check(joinOk, "every fleet size fully joined within 120 s (p99)");
+    check(cpuOk, "master per-superframe work < 20 µs, every STATUS_V2 accepted");
+    check(benchAgree, "benchmark fleets: SoA aggregate == AoS reference");
+
+    return check_summary();
+}
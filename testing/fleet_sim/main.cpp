@@ -0,0 +1,807 @@
+// Fleet & LoRa Channel Simulation — host (platform = native)
+//
+// Run:  pio run -e fleet_sim -t exec
+//       .pio/build/fleet_sim/program 1000          # race-hours per scenario (default 20)
+//
+// Discrete-event simulation of a whole fleet sharing one LoRa channel. Every
+// node runs the real protocol code: the master opens each superframe with
+// tdma_fill_beacon() and sends a build_fleet_summary() downlink, slaves send
+// StatusV2 (position_encode, pos24_put) in their tdma_uplink_slot(), two
+// remotes (their own addresses from NODE_ADDR_REMOTE_FIRST, as the registry
+// hands out) send PKT_RC_START / PKT_RC_RTH in a random contention
+// sub-slot, and every received frame goes through a
+// PacketDispatcher. Timing follows testing/tdma_sim: ±40 ppm crystals with
+// local µs clocks near the 32-bit wrap, 0–300 µs RX-done latency, 0–200 µs TX
+// jitter, tdma_on_beacon() / tdma_advance() for sync.
+//
+// Channel, per frame and receiver:
+//   - time-on-air from lora_time_on_air_us(); radios are half-duplex
+//   - received power: LORA_TX_POWER_DBM + both antenna gains − log-distance
+//     path loss (exponent 3.3, low antennas over swell) − 6 dB log-normal
+//     shadowing; below lora_sensitivity_cdbm() the frame is lost (range)
+//   - overlap: the receiver stays locked on a detectable frame that started
+//     first; otherwise a frame survives interference only CAPTURE_DB stronger
+//
+// Course: master 50 m behind the start line, START_A/B 300 m apart, windward
+// 1.2 km up, leeward 300 m down, further slaves on a ring between them — all
+// times the scenario's scale. One remote sits on the committee boat, the
+// other on a mark boat circling the course.
+//
+// Reports per scenario: channel utilisation, delivery per frame kind and why
+// frames were lost, telemetry age (sampled every superframe: at the master,
+// and end-to-end at the remotes via the fleet summary), RC latency from the
+// button to the master and to the remote seeing the new fleet_state in a
+// beacon, and simulated time per wall-clock second.
+//
+// Pass criteria: no frame lost to overlap between two scheduled frames; at
+// nominal scale ≥ 99% of STATUS frames delivered, every RC command confirmed
+// within 3 superframes (p99), master telemetry age < 1.5 superframes (mean),
+// remote positions within 3 m of the station; uplink loss grows with course
+// scale; the same seed gives the same run; at least 10000× real time.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "common/protocol.h"
+#include "common/packet_codec.h"
+#include "common/position.h"
+#include "common/lora_airtime.h"
+#include "common/lora_budget.h"
+#include "common/tdma.h"
+#include "testing/check.h"
+
+#define RACE_HOURS_DEFAULT   20      // per scenario; argv[1] overrides
+#define WARMUP_S             10      // ages and presses counted after this
+#define REMOTES              2
+#define DRIFT_PPM            40.0
+#define RX_LATENCY_MAX_US    300
+#define TX_JITTER_MAX_US     200
+#define GPS_FIX_PERIOD_MS    100     // position sampled up to one fix before TX
+#define WANDER_CM            200     // slaves hold station within this
+#define PATH_LOSS_1M_DB      31.7    // free space at 1 m, 915 MHz
+#define PATH_LOSS_EXPONENT   3.3     // antennas ~1 m above swell: between free space (2) and two-ray (4)
+#define SHADOW_SIGMA_DB      6.0     // per frame and link: waves, hull, heading
+#define CAPTURE_DB           6.0     // same-SF capture margin
+#define RC_MEAN_INTERVAL_S   60.0    // per remote, Poisson
+#define RC_GIVE_UP_S         10.0    // remote stops retrying
+#define FLEET_HOLD_S         20.0    // master returns to READY this long after a command
+#define RING                 64      // frames kept for overlap checks
+
+#define HIST_BIN_US          10000   // 10 ms
+#define HIST_BINS            6000    // 60 s; anything longer lands in the last bin
+
+static const LoRaModem& MODEM    = LORA_MODEM_DEFAULT;
+static const double     SENS_DBM = lora_sensitivity_cdbm(LORA_MODEM_DEFAULT) / 100.0;
+static const double     EIRP_DBM = LORA_TX_POWER_DBM + 2 * LORA_ANT_GAIN_DBI;   // both antenna gains
+static const double     TWO_PI   = 6.283185307179586;
+
+static uint64_t rngState = 7;
+static uint64_t nextRandom() {
+    rngState = rngState * 6364136223846793005ULL + 1442695040888963407ULL;
+    return rngState;
+}
+static double uniform01() {
+    return (nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+static double exponential(double mean) {
+    return -log(1.0 - uniform01()) * mean;
+}
+
+// Shadowing draws come from a table filled once: a Box–Muller per receiver
+// per frame would cost more than the rest of the simulation
+#define GAUSS_TABLE 65536
+static float gaussTable[GAUSS_TABLE];
+static void initGauss() {
+    for (int i = 0; i < GAUSS_TABLE; i += 2) {
+        double r = sqrt(-2.0 * log(1.0 - uniform01())), a = TWO_PI * uniform01();
+        gaussTable[i]     = (float)(r * cos(a));
+        gaussTable[i + 1] = (float)(r * sin(a));
+    }
+}
+static float gauss() {
+    return gaussTable[nextRandom() >> 48];
+}
+
+// ---------------------------------------------------------------------------
+// Node clocks: local = offset + global × (1 + ppm·1e-6), wrapping at 2^32 µs
+// ---------------------------------------------------------------------------
+struct Clock {
+    double   ppm;
+    uint32_t offset;
+
+    uint32_t local(double g) const { return offset + (uint32_t)(uint64_t)llround(g * (1.0 + ppm * 1e-6)); }
+    double   global(uint32_t l, double gRef) const {
+        return gRef + (int32_t)(l - local(gRef)) / (1.0 + ppm * 1e-6);
+    }
+};
+
+struct Hist {
+    uint32_t bin[HIST_BINS];
+    uint64_t n;
+    double   sum;
+
+    void add(double us) {
+        int b = (int)(us / HIST_BIN_US);
+        bin[b < 0 ? 0 : b >= HIST_BINS ? HIST_BINS - 1 : b]++;
+        n++;
+        sum += us;
+    }
+    double meanMs() const { return n ? sum / n / 1000.0 : 0.0; }
+    // Upper edge of the bin holding the p-quantile
+    double pctMs(double p) const {
+        uint64_t want = (uint64_t)ceil(p * n), seen = 0;
+        for (int b = 0; b < HIST_BINS; b++) {
+            seen += bin[b];
+            if (want && seen >= want) return (b + 1) * (HIST_BIN_US / 1000.0);
+        }
+        return 0.0;
+    }
+};
+
+enum RxResult { RX_OK = 0, RX_LOST_RANGE, RX_LOST_COLLISION, RX_LOST_HALF_DUPLEX };
+
+// Deliveries to the nodes that want a frame kind (TdmaSlotKind)
+struct LinkStats {
+    uint32_t wanted;
+    uint32_t ok;
+    uint32_t range;
+    uint32_t collision;
+    uint32_t halfDuplex;
+};
+
+enum RcKind { RC_START = 0, RC_RTH, RC_KINDS };
+
+struct Result {
+    double    simS;
+    double    wallS;
+    uint64_t  events;
+    uint32_t  superframeUs;
+    double    airtimeUs;         // everything actually transmitted
+    LinkStats link[4];
+    uint32_t  schedOverlap;      // frames lost to overlap between two scheduled frames
+    uint32_t  rcCollisions;      // remote vs remote in the contention slot
+    uint32_t  skipped;           // slave slots passed while not locked
+    double    posErrMaxM;        // remote's decoded slave position vs its station
+    Hist      ageMaster;
+    Hist      ageRemote;
+    Hist      rcDeliver[RC_KINDS];   // button → master
+    Hist      rcConfirm[RC_KINDS];   // button → remote sees the new fleet_state
+    uint32_t  presses[RC_KINDS];
+    uint32_t  superseded;        // the other remote's command won
+    uint32_t  gaveUp;
+    uint32_t  pendingAtEnd;      // pressed, still unconfirmed when the run stopped
+};
+
+struct Scenario {
+    const char* name;
+    uint8_t     slaves;
+    double      scale;           // course size, 1 = 1.2 km beat
+};
+
+static TdmaConfig scenarioConfig(const Scenario& sc) {
+    uint8_t entries = sc.slaves < FLEET_SUMMARY_MAX_ENTRIES ? sc.slaves : (uint8_t)FLEET_SUMMARY_MAX_ENTRIES;
+    TdmaConfig c = { sc.slaves, (uint8_t)fleet_summary_size(entries), sizeof(StatusV2Packet),
+                     (uint8_t)(sc.slaves > 16 ? 4 : 2) };
+    return c;
+}
+
+// ---------------------------------------------------------------------------
+// Simulation
+// ---------------------------------------------------------------------------
+enum Role { ROLE_MASTER, ROLE_SLAVE, ROLE_REMOTE };
+enum EventKind : uint8_t { EV_SUPERFRAME, EV_PLAN, EV_TX_START, EV_TX_END, EV_RC_PRESS };
+
+#define MAX_NODES (1 + TDMA_MAX_UPLINK_SLOTS + REMOTES)
+
+struct Vec {
+    double n, e;              // metres from the course origin
+};
+
+struct Node {
+    uint8_t      role;
+    uint8_t      id;
+    Clock        clock;
+    Vec          station;
+    bool         moving;
+    TdmaSync     sync;
+    TdmaConfig   cfg;
+    TdmaSchedule sched;
+    bool         haveSched;
+    bool         heard;        // beacon of the current superframe received
+    uint8_t      fleetState;   // from the last beacon
+    double       lastSample[TDMA_MAX_UPLINK_SLOTS + 1];   // master / remote view: newest data per slave
+    // remotes
+    bool         pending;
+    bool         delivered;
+    uint8_t      cmd;
+    uint32_t     pressId;
+    double       pressAt;
+};
+
+struct Tx {
+    double   start;
+    double   end;
+    uint8_t  node;
+    uint8_t  kind;             // TdmaSlotKind
+    uint8_t  len;
+    uint8_t  buf[LORA_MAX_PAYLOAD];
+    float    rxDbm[MAX_NODES];
+    double   sampledAt;        // STATUS: GPS fix time; RC: button press
+    uint32_t pressId;
+    double   entrySampled[TDMA_MAX_UPLINK_SLOTS + 1];   // FLEET_SUMMARY: fix time per slave
+};
+
+struct Event {
+    double   t;
+    uint64_t seq;
+    uint8_t  kind;
+    uint8_t  node;
+    uint8_t  arg;              // slot, or ring index for EV_TX_END
+
+    bool operator>(const Event& o) const { return t > o.t || (t == o.t && seq > o.seq); }
+};
+
+struct Sim;
+
+struct MasterRx : PacketHandlerBase {
+    Sim* sim;
+    void onStatusV2(const StatusV2Packet& p);
+    void onRcCommand(const RcCommandPacket& p);
+};
+
+struct NodeRx : PacketHandlerBase {
+    Sim* sim;
+    void onBeacon(const BeaconPacket& b);
+    void onFleetSummary(const FleetSummaryView& v);
+};
+
+struct Sim {
+    Scenario     sc;
+    Result*      res;
+    TdmaConfig   cfg;
+    TdmaSchedule sched;
+    CourseOrigin origin;
+    int          nodeCount;
+    Node         nodes[MAX_NODES];
+    double       pathLoss[MAX_NODES][MAX_NODES];   // static pairs
+    uint32_t     airtime[LORA_MAX_PAYLOAD + 1];
+    Tx           ring[RING];
+    int          ringNext;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> queue;
+    uint64_t     seq;
+
+    // master
+    uint8_t      fleetState;
+    double       stateUntil;
+    uint8_t      frameSeq;
+    FleetEntry   table[TDMA_MAX_UPLINK_SLOTS];
+    bool         known[TDMA_MAX_UPLINK_SLOTS + 1];
+    double       sampled[TDMA_MAX_UPLINK_SLOTS + 1];
+    int          cursor;       // fleet summary window when slaves > FLEET_SUMMARY_MAX_ENTRIES
+
+    // receive context for the handlers
+    int          rxNode;
+    double       rxAt;
+    const Tx*    rxTx;
+
+    MasterRx                   masterRx;
+    NodeRx                     nodeRx;
+    PacketDispatcher<MasterRx> masterDisp{ masterRx };
+    PacketDispatcher<NodeRx>   nodeDisp{ nodeRx };
+
+    void push(double t, uint8_t kind, uint8_t node, uint8_t arg) {
+        queue.push(Event{ t, seq++, kind, node, arg });
+    }
+
+    Vec position(int i, double t) const {
+        const Node& n = nodes[i];
+        if (!n.moving) return n.station;
+        double s = t * 1e-6;
+        return { sc.scale * (450.0 + 750.0 * sin(TWO_PI * s / 1800.0)), sc.scale * 600.0 * sin(TWO_PI * s / 1300.0) };
+    }
+
+    static double lossDb(Vec a, Vec b) {
+        double d = hypot(a.n - b.n, a.e - b.e);
+        return PATH_LOSS_1M_DB + 10.0 * PATH_LOSS_EXPONENT * log10(d < 1.0 ? 1.0 : d);
+    }
+
+    void init(const Scenario& s, Result* out);
+    void run(double hours);
+    void superframe(double T);
+    void plan(double P);
+    void txStart(double t, int i, uint8_t slot);
+    void txEnd(uint8_t idx);
+    int  receive(const Tx& a, int r, const Tx* const* over, int nOver, const Tx** culprit) const;
+    void press(double t, int i);
+    void sampleAges(double T);
+
+    void masterStatus(const StatusV2Packet& p);
+    void masterRc(const RcCommandPacket& p);
+    void nodeBeacon(const BeaconPacket& b);
+    void nodeSummary(const FleetSummaryView& v);
+};
+
+void MasterRx::onStatusV2(const StatusV2Packet& p)      { sim->masterStatus(p); }
+void MasterRx::onRcCommand(const RcCommandPacket& p)    { sim->masterRc(p); }
+void NodeRx::onBeacon(const BeaconPacket& b)            { sim->nodeBeacon(b); }
+void NodeRx::onFleetSummary(const FleetSummaryView& v)  { sim->nodeSummary(v); }
+
+static Vec stationOf(uint8_t id, uint8_t slaves, double scale) {
+    switch (id) {
+        case BUOY_START_A:  return { 0.0, -150.0 * scale };
+        case BUOY_START_B:  return { 0.0, 150.0 * scale };
+        case BUOY_WINDWARD: return { 1200.0 * scale, 0.0 };
+        case BUOY_LEEWARD:  return { -300.0 * scale, 0.0 };
+        default: break;
+    }
+    double a = TWO_PI * (id - 5) / (slaves - 4);   // gates and offsets on a ring
+    return { scale * (450.0 + 650.0 * cos(a)), scale * 650.0 * sin(a) };
+}
+
+void Sim::init(const Scenario& s, Result* out) {
+    sc  = s;
+    res = out;
+    memset(res, 0, sizeof(*res));
+    cfg = scenarioConfig(sc);
+    tdma_build_schedule(MODEM, cfg, &sched);
+    res->superframeUs = sched.superframe_us;
+    course_origin_set(&origin, deg_to_e7(45.3210), deg_to_e7(-73.8760), 1);
+    for (int len = 0; len <= LORA_MAX_PAYLOAD; len++) airtime[len] = lora_time_on_air_us(MODEM, (uint16_t)len);
+
+    nodeCount = 1 + sc.slaves + REMOTES;
+    for (int i = 0; i < nodeCount; i++) {
+        Node& n = nodes[i];
+        n = Node();
+        n.role = i == 0 ? ROLE_MASTER : i <= sc.slaves ? ROLE_SLAVE : ROLE_REMOTE;
+        n.id   = i == 0 ? (uint8_t)BUOY_MASTER
+               : n.role == ROLE_SLAVE ? (uint8_t)i
+               : (uint8_t)(NODE_ADDR_REMOTE_FIRST + i - 1 - sc.slaves);
+        n.clock.ppm    = i == 0 ? 0.0 : (uniform01() * 2.0 - 1.0) * DRIFT_PPM;
+        n.clock.offset = i == 0 ? 0 : 0xFFFFFFFFu - (uint32_t)(uniform01() * 60e6);   // wraps in < 60 s
+        n.fleetState   = FLEET_STATE_READY;
+        if (n.role == ROLE_MASTER)      n.station = { -50.0 * sc.scale, 0.0 };
+        else if (n.role == ROLE_SLAVE)  n.station = stationOf(n.id, sc.slaves, sc.scale);
+        else if (i == sc.slaves + 1)    n.station = { -60.0 * sc.scale, 40.0 };   // committee boat
+        else                            n.moving  = true;                          // mark boat
+    }
+    for (int i = 0; i < nodeCount; i++) {
+        for (int j = 0; j < nodeCount; j++) pathLoss[i][j] = lossDb(nodes[i].station, nodes[j].station);
+    }
+
+    memset(ring, 0, sizeof(ring));
+    ringNext   = 0;
+    queue      = decltype(queue)();
+    seq        = 0;
+    fleetState = FLEET_STATE_READY;
+    stateUntil = 0.0;
+    frameSeq   = 0;
+    cursor     = 0;
+    memset(known, 0, sizeof(known));
+    masterRx.sim = this;
+    nodeRx.sim   = this;
+
+    push(0.0, EV_SUPERFRAME, 0, 0);
+    for (int i = 1 + sc.slaves; i < nodeCount; i++) push(exponential(RC_MEAN_INTERVAL_S * 1e6), EV_RC_PRESS, (uint8_t)i, 0);
+}
+
+void Sim::run(double hours) {
+    const double endUs = hours * 3600e6;
+    while (!queue.empty()) {
+        Event ev = queue.top();
+        if (ev.t > endUs) break;
+        queue.pop();
+        res->events++;
+        switch (ev.kind) {
+            case EV_SUPERFRAME: superframe(ev.t); break;
+            case EV_PLAN:       plan(ev.t); break;
+            case EV_TX_START:   txStart(ev.t, ev.node, ev.arg); break;
+            case EV_TX_END:     txEnd(ev.arg); break;
+            case EV_RC_PRESS:   press(ev.t, ev.node); break;
+        }
+    }
+    for (int i = 1 + sc.slaves; i < nodeCount; i++) res->pendingAtEnd += nodes[i].pending;
+    res->simS = endUs / 1e6;
+}
+
+// Master clock is the reference: superframe k starts at k × superframe_us
+void Sim::superframe(double T) {
+    if (fleetState != FLEET_STATE_READY && T >= stateUntil) fleetState = FLEET_STATE_READY;
+    for (uint8_t s = 0; s < sched.count && sched.slot[s].owner == BUOY_MASTER; s++) {
+        push(T + sched.slot[s].start_us + TDMA_GUARD_US / 2, EV_TX_START, 0, s);
+    }
+    // Every listener has taken the beacon's RX-done by now
+    push(T + TDMA_GUARD_US / 2 + sched.beacon_us + RX_LATENCY_MAX_US + 1, EV_PLAN, 0, 0);
+    push(T + sched.superframe_us, EV_SUPERFRAME, 0, 0);
+    if (T >= WARMUP_S * 1e6) sampleAges(T);
+}
+
+// Slaves and remotes pick this superframe's transmission, as the firmware
+// does after the beacon: free-run if it was missed, then slot → local TX time
+void Sim::plan(double P) {
+    for (int i = 1; i < nodeCount; i++) {
+        Node& n = nodes[i];
+        if (!n.haveSched) continue;
+        uint32_t now = n.clock.local(P);
+        if (!n.heard) tdma_advance(&n.sync, n.sched, now);
+        n.heard = false;
+
+        int slot;
+        if (n.role == ROLE_REMOTE) {
+            if (!n.pending) continue;
+            if (P - n.pressAt > RC_GIVE_UP_S * 1e6) {
+                n.pending = false;
+                res->gaveUp++;
+                continue;
+            }
+            slot = tdma_contention_slot(n.sched, (uint8_t)(uniform01() * n.cfg.contention_slots));
+        } else {
+            slot = tdma_uplink_slot(n.sched, n.id);
+        }
+        if (slot < 0) continue;
+        if (!n.sync.locked) {
+            if (n.role == ROLE_SLAVE) res->skipped++;
+            continue;
+        }
+        uint32_t txLocal = tdma_tx_time_us(n.sync, n.sched, (uint8_t)slot) + (uint32_t)(uniform01() * TX_JITTER_MAX_US);
+        if (!tdma_may_transmit(n.sync, n.sched, (uint8_t)slot, txLocal)) {
+            if (n.role == ROLE_SLAVE) res->skipped++;
+            continue;
+        }
+        push(n.clock.global(txLocal, P), EV_TX_START, (uint8_t)i, (uint8_t)slot);
+    }
+}
+
+void Sim::txStart(double t, int i, uint8_t slot) {
+    const uint8_t idx = (uint8_t)ringNext;
+    ringNext = (ringNext + 1) % RING;
+    Tx& tx   = ring[idx];
+    Node& n  = nodes[i];
+    tx.node  = (uint8_t)i;
+    tx.kind  = (i == 0 ? sched : n.sched).slot[slot].kind;
+
+    if (tx.kind == TDMA_SLOT_BEACON) {
+        BeaconPacket b;
+        tdma_fill_beacon(&b, cfg, fleetState, frameSeq++);
+        tx.len = packet_seal(b);
+        memcpy(tx.buf, &b, tx.len);
+    } else if (tx.kind == TDMA_SLOT_DOWNLINK) {
+        const uint8_t maxEntries = (uint8_t)((cfg.downlink_len - fleet_summary_size(0)) / sizeof(FleetEntry));
+        FleetEntry    list[FLEET_SUMMARY_MAX_ENTRIES];
+        uint8_t       count = 0;
+        int           k     = 0;
+        for (; k < sc.slaves && count < maxEntries; k++) {
+            int id = 1 + (cursor + k) % sc.slaves;
+            if (!known[id]) continue;
+            list[count++]       = table[id - 1];
+            tx.entrySampled[id] = sampled[id];
+        }
+        if (sc.slaves > maxEntries) cursor = (cursor + k) % sc.slaves;
+        tx.len = (uint8_t)build_fleet_summary(tx.buf, fleetState, origin.seq, list, count);
+    } else if (tx.kind == TDMA_SLOT_UPLINK) {
+        // GPS fix up to one period old, wandering around the station
+        tx.sampledAt = t - uniform01() * GPS_FIX_PERIOD_MS * 1000.0;
+        double ph    = TWO_PI * tx.sampledAt * 1e-6 / 97.0 + n.id;
+        double r     = WANDER_CM * (0.5 + 0.5 * sin(0.37 * ph));
+        PositionCm fix = { (int32_t)lround(n.station.n * 100.0 + r * sin(ph)),
+                           (int32_t)lround(n.station.e * 100.0 + r * cos(ph)) };
+        int32_t lat, lon;
+        position_decode(origin, fix, &lat, &lon);
+
+        StatusV2Packet p = {};
+        PositionCm     enc;
+        position_encode(origin, lat, lon, &enc);
+        p.packet_type       = PKT_STATUS_V2;
+        p.buoy_id           = n.id;
+        p.origin_seq        = origin.seq;
+        pos24_put(p.current_north_cm, enc.north_cm);
+        pos24_put(p.current_east_cm, enc.east_cm);
+        p.dist_to_target_cm = (uint16_t)lround(r);
+        p.battery_tenths_v  = (uint8_t)(126 - (int)fmin(26.0, t / 3600e6));
+        tx.len = packet_seal(p);
+        memcpy(tx.buf, &p, tx.len);
+    } else {
+        RcCommandPacket p = { n.cmd, n.id, 0 };
+        tx.len       = packet_seal(p);
+        tx.sampledAt = n.pressAt;
+        tx.pressId   = n.pressId;
+        memcpy(tx.buf, &p, tx.len);
+    }
+
+    tx.start = t;
+    tx.end   = t + airtime[tx.len];
+    res->airtimeUs += airtime[tx.len];
+
+    for (int j = 0; j < nodeCount; j++) {
+        if (j == i) continue;
+        double pl = nodes[i].moving || nodes[j].moving ? lossDb(position(i, t), position(j, t)) : pathLoss[i][j];
+        tx.rxDbm[j] = (float)(EIRP_DBM - pl + SHADOW_SIGMA_DB * gauss());
+    }
+    push(tx.end, EV_TX_END, (uint8_t)i, idx);
+}
+
+// Who listens for what: beacons everyone, the fleet summary the remotes,
+// STATUS and RC the master
+static bool wants(const Node& n, uint8_t kind) {
+    switch (kind) {
+        case TDMA_SLOT_BEACON:   return n.role != ROLE_MASTER;
+        case TDMA_SLOT_DOWNLINK: return n.role == ROLE_REMOTE;
+        default:                 return n.role == ROLE_MASTER;
+    }
+}
+
+int Sim::receive(const Tx& a, int r, const Tx* const* over, int nOver, const Tx** culprit) const {
+    if (a.rxDbm[r] < SENS_DBM) return RX_LOST_RANGE;
+    for (int k = 0; k < nOver; k++) {
+        const Tx* b = over[k];
+        *culprit    = b;
+        if (b->node == r) return RX_LOST_HALF_DUPLEX;
+        bool locked = b->start <= a.start && b->rxDbm[r] >= SENS_DBM;   // already demodulating b
+        if (locked || a.rxDbm[r] - b->rxDbm[r] < CAPTURE_DB) return RX_LOST_COLLISION;
+    }
+    return RX_OK;
+}
+
+void Sim::txEnd(uint8_t idx) {
+    const Tx& a = ring[idx];
+    const Tx* over[RING];
+    int       nOver = 0;
+    for (int k = 0; k < RING; k++) {
+        const Tx& b = ring[k];
+        if (k != idx && b.len && b.start < a.end && b.end > a.start) over[nOver++] = &b;
+    }
+
+    LinkStats& ls = res->link[a.kind];
+    for (int r = 0; r < nodeCount; r++) {
+        if (r == a.node || !wants(nodes[r], a.kind)) continue;
+        ls.wanted++;
+        const Tx* culprit = nullptr;
+        int why = receive(a, r, over, nOver, &culprit);
+        if (why == RX_LOST_RANGE) {
+            ls.range++;
+            continue;
+        }
+        if (why != RX_OK) {
+            (why == RX_LOST_COLLISION ? ls.collision : ls.halfDuplex)++;
+            bool aRc = a.kind == TDMA_SLOT_CONTENTION, bRc = culprit->kind == TDMA_SLOT_CONTENTION;
+            if (!aRc && !bRc) res->schedOverlap++;
+            if (aRc && bRc) res->rcCollisions++;
+            continue;
+        }
+        ls.ok++;
+        rxNode = r;
+        rxAt   = a.end + uniform01() * RX_LATENCY_MAX_US;
+        rxTx   = &a;
+        if (r == 0) masterDisp.dispatch(a.buf, a.len);
+        else        nodeDisp.dispatch(a.buf, a.len);
+    }
+}
+
+void Sim::press(double t, int i) {
+    Node& n = nodes[i];
+    push(t + exponential(RC_MEAN_INTERVAL_S * 1e6), EV_RC_PRESS, (uint8_t)i, 0);
+    // The operator acts on a quiet fleet; a press mid-sequence would only repeat the state
+    if (n.pending || n.fleetState != FLEET_STATE_READY || t < WARMUP_S * 1e6) return;
+    bool start  = uniform01() < 0.5;
+    n.pending   = true;
+    n.delivered = false;
+    n.cmd       = start ? PKT_RC_START : PKT_RC_RTH;
+    n.pressAt   = t;
+    n.pressId++;
+    res->presses[start ? RC_START : RC_RTH]++;
+}
+
+void Sim::sampleAges(double T) {
+    for (int id = 1; id <= sc.slaves; id++) res->ageMaster.add(T - nodes[0].lastSample[id]);
+    for (int i = 1 + sc.slaves; i < nodeCount; i++) {
+        for (int id = 1; id <= sc.slaves; id++) res->ageRemote.add(T - nodes[i].lastSample[id]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Receive side — what the master and the remotes do with a frame
+// ---------------------------------------------------------------------------
+void Sim::masterStatus(const StatusV2Packet& p) {
+    uint8_t id = p.buoy_id;
+    if (id < 1 || id > sc.slaves || p.origin_seq != origin.seq) return;
+    FleetEntry& e = table[id - 1];
+    e.buoy_id = id;
+    memcpy(e.north_cm, p.current_north_cm, 3);
+    memcpy(e.east_cm, p.current_east_cm, 3);
+    e.dist_to_target_cm = p.dist_to_target_cm;
+    e.battery_tenths_v  = p.battery_tenths_v;
+    e.error_flags       = 0;
+    known[id]   = true;
+    sampled[id] = rxTx->sampledAt;
+    nodes[0].lastSample[id] = rxTx->sampledAt;
+}
+
+void Sim::masterRc(const RcCommandPacket& p) {
+    int r = 1 + sc.slaves;
+    while (r < nodeCount && nodes[r].id != p.buoy_id) r++;
+    if (r == nodeCount) return;   // not one of ours
+    Node& rm = nodes[r];
+    int kind = p.packet_type == PKT_RC_START ? RC_START : RC_RTH;
+    if (rxTx->pressId == rm.pressId && !rm.delivered) {
+        rm.delivered = true;
+        if (p.packet_type != PKT_RC_STOP) res->rcDeliver[kind].add(rxAt - rm.pressAt);
+    }
+    switch (p.packet_type) {
+        case PKT_RC_START:
+            if (fleetState == FLEET_STATE_READY) {
+                fleetState = FLEET_STATE_COUNTDOWN;
+                stateUntil = rxAt + FLEET_HOLD_S * 1e6;
+            }
+            break;
+        case PKT_RC_RTH:
+            if (fleetState != FLEET_STATE_RTH) {
+                fleetState = FLEET_STATE_RTH;
+                stateUntil = rxAt + FLEET_HOLD_S * 1e6;
+            }
+            break;
+        default:
+            fleetState = FLEET_STATE_READY;
+            break;
+    }
+}
+
+void Sim::nodeBeacon(const BeaconPacket& b) {
+    Node& n = nodes[rxNode];
+    TdmaConfig c = tdma_config_from_beacon(b);
+    if (!n.haveSched || memcmp(&c, &n.cfg, sizeof(c)) != 0) {
+        n.haveSched = tdma_build_schedule(MODEM, c, &n.sched);
+        n.cfg       = c;
+    }
+    tdma_on_beacon(&n.sync, n.sched, b, n.clock.local(rxAt));
+    n.heard      = true;
+    n.fleetState = b.fleet_state;
+
+    if (n.role != ROLE_REMOTE || !n.pending) return;
+    uint8_t want = n.cmd == PKT_RC_START ? FLEET_STATE_COUNTDOWN : FLEET_STATE_RTH;
+    if (b.fleet_state == want) {
+        res->rcConfirm[n.cmd == PKT_RC_START ? RC_START : RC_RTH].add(rxAt - n.pressAt);
+        n.pending = false;
+    } else if (b.fleet_state != FLEET_STATE_READY) {
+        res->superseded++;
+        n.pending = false;
+    }
+}
+
+void Sim::nodeSummary(const FleetSummaryView& v) {
+    Node& n = nodes[rxNode];
+    for (uint8_t k = 0; k < v.header->count; k++) {
+        const FleetEntry& e = v.entries[k];
+        if (e.buoy_id < 1 || e.buoy_id > sc.slaves) continue;
+        double s = rxTx->entrySampled[e.buoy_id];
+        if (s > n.lastSample[e.buoy_id]) n.lastSample[e.buoy_id] = s;
+        const Vec& st = nodes[e.buoy_id].station;
+        double err = hypot(pos24_get(e.north_cm) / 100.0 - st.n, pos24_get(e.east_cm) / 100.0 - st.e);
+        if (err > res->posErrMaxM) res->posErrMaxM = err;
+    }
+}
+
+// ---------------------------------------------------------------------------
+static double seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static Sim sim;
+
+static void runScenario(const Scenario& sc, double hours, uint64_t seed, Result* out) {
+    rngState = seed;
+    double t0 = seconds();
+    sim.init(sc, out);
+    sim.run(hours);
+    out->wallS = seconds() - t0;
+}
+
+static double pdr(const LinkStats& l) {
+    return l.wanted ? 100.0 * l.ok / l.wanted : 0.0;
+}
+
+int main(int argc, char** argv) {
+    double hours = argc > 1 ? atof(argv[1]) : RACE_HOURS_DEFAULT;
+    if (hours <= 0) hours = RACE_HOURS_DEFAULT;
+    initGauss();
+
+    printf("Fleet & channel simulation — SF%u, %lu Hz, %d dBm + 2 x %d dBi, sensitivity %.1f dBm, "
+           "path loss n = %.1f, shadowing %.0f dB, %g race-hours per scenario\n\n",
+           MODEM.sf, (unsigned long)MODEM.bw_hz, LORA_TX_POWER_DBM, LORA_ANT_GAIN_DBI, SENS_DBM,
+           PATH_LOSS_EXPONENT, SHADOW_SIGMA_DB, hours);
+
+    const Scenario scenarios[] = {
+        { "4 slaves 0.5x", 4,  0.5 },
+        { "4 slaves 1x",   4,  1.0 },
+        { "4 slaves 2x",   4,  2.0 },
+        { "4 slaves 3x",   4,  3.0 },
+        { "4 slaves 4x",   4,  4.0 },
+        { "16 slaves 1x",  16, 1.0 },
+        { "32 slaves 1x",  32, 1.0 },
+    };
+    const int NOMINAL = 1;
+    const int COUNT   = sizeof(scenarios) / sizeof(scenarios[0]);
+    static Result results[sizeof(scenarios) / sizeof(scenarios[0])];
+
+    double simS = 0.0, wallS = 0.0;
+    uint64_t events = 0;
+    for (int i = 0; i < COUNT; i++) {
+        runScenario(scenarios[i], hours, 7 + i, &results[i]);
+        simS   += results[i].simS;
+        wallS  += results[i].wallS;
+        events += results[i].events;
+    }
+
+    printf("%-14s %6s %6s %7s %7s %7s %7s %7s %7s %7s %7s %6s\n", "channel", "frame", "util", "beacon", "down",
+           "STATUS", "RC", "range", "collide", "half-dx", "rc-col", "skip");
+    printf("%-14s %6s %6s %7s %7s %7s %7s %7s %7s %7s %7s %6s\n", "", "ms", "%", "PDR %", "PDR %", "PDR %",
+           "PDR %", "lost", "lost", "lost", "", "");
+    for (int i = 0; i < COUNT; i++) {
+        const Result& r = results[i];
+        uint32_t range = 0, coll = 0, hd = 0;
+        for (const LinkStats& l : r.link) {
+            range += l.range;
+            coll  += l.collision;
+            hd    += l.halfDuplex;
+        }
+        printf("%-14s %6.0f %6.1f %7.2f %7.2f %7.2f %7.2f %7u %7u %7u %7u %6u\n", scenarios[i].name,
+               r.superframeUs / 1000.0, 100.0 * r.airtimeUs / (r.simS * 1e6), pdr(r.link[TDMA_SLOT_BEACON]),
+               pdr(r.link[TDMA_SLOT_DOWNLINK]), pdr(r.link[TDMA_SLOT_UPLINK]), pdr(r.link[TDMA_SLOT_CONTENTION]),
+               range, coll, hd, r.rcCollisions, r.skipped);
+    }
+
+    printf("\n%-14s %15s %15s %21s %21s %9s\n", "latency (ms)", "age @ master", "age @ remote",
+           "START press→master", "RTH press→master", "RC");
+    printf("%-14s %7s %7s %7s %7s %10s %10s %10s %10s %9s\n", "", "mean", "p99", "mean", "p99", "deliver",
+           "confirm", "deliver", "confirm", "sup/fail");
+    for (int i = 0; i < COUNT; i++) {
+        const Result& r = results[i];
+        printf("%-14s %7.0f %7.0f %7.0f %7.0f %4.0f /%4.0f %4.0f /%4.0f %4.0f /%4.0f %4.0f /%4.0f %4u/%-4u\n",
+               scenarios[i].name, r.ageMaster.meanMs(), r.ageMaster.pctMs(0.99), r.ageRemote.meanMs(),
+               r.ageRemote.pctMs(0.99), r.rcDeliver[RC_START].meanMs(), r.rcDeliver[RC_START].pctMs(0.99),
+               r.rcConfirm[RC_START].meanMs(), r.rcConfirm[RC_START].pctMs(0.99), r.rcDeliver[RC_RTH].meanMs(),
+               r.rcDeliver[RC_RTH].pctMs(0.99), r.rcConfirm[RC_RTH].meanMs(), r.rcConfirm[RC_RTH].pctMs(0.99),
+               r.superseded, r.gaveUp);
+    }
+    printf("               (mean / p99 per cell; sup: the other remote's command won, fail: no confirmation "
+           "in %.0f s)\n", RC_GIVE_UP_S);
+
+    double speedup = simS / wallS;
+    printf("\n%g race-hours in %.2f s wall: %.0fx real time, %.1f M events/s\n\n", simS / 3600.0, wallS,
+           speedup, events / wallS / 1e6);
+
+    uint32_t sched = 0;
+    for (const Result& r : results) sched += r.schedOverlap;
+    check(sched == 0, "no frame lost to overlap between two scheduled frames");
+
+    const Result& nom = results[NOMINAL];
+    check(pdr(nom.link[TDMA_SLOT_UPLINK]) >= 99.0, "nominal course: >= 99% of STATUS frames reach the master");
+    uint32_t presses = nom.presses[RC_START] + nom.presses[RC_RTH];
+    uint32_t confirmed = (uint32_t)(nom.rcConfirm[RC_START].n + nom.rcConfirm[RC_RTH].n);
+    double   p99 = fmax(nom.rcConfirm[RC_START].pctMs(0.99), nom.rcConfirm[RC_RTH].pctMs(0.99));
+    printf("  nominal: %u presses, %u confirmed, %u superseded, %u given up, %u pending at the end, "
+           "confirm p99 %.0f ms\n", presses, confirmed, nom.superseded, nom.gaveUp, nom.pendingAtEnd, p99);
+    check(presses > 0 && nom.gaveUp == 0 && confirmed + nom.superseded + nom.pendingAtEnd == presses,
+          "nominal course: every RC command confirmed or superseded (or still pending at the end)");
+    check(p99 <= 3.0 * nom.superframeUs / 1000.0, "nominal course: RC confirmation p99 within 3 superframes");
+    check(nom.ageMaster.meanMs() < 1.5 * nom.superframeUs / 1000.0,
+          "nominal course: mean telemetry age at the master < 1.5 superframes");
+    check(nom.posErrMaxM > 0.0 && nom.posErrMaxM <= 3.0, "remote decodes slave positions within 3 m of station");
+
+    bool grows = pdr(results[4].link[TDMA_SLOT_UPLINK]) < pdr(results[0].link[TDMA_SLOT_UPLINK]);
+    for (int i = 1; i <= 4; i++) grows &= pdr(results[i].link[TDMA_SLOT_UPLINK]) <= pdr(results[i - 1].link[TDMA_SLOT_UPLINK]);
+    check(grows, "STATUS loss grows with course scale");
+
+    static Result once, again;
+    runScenario(scenarios[NOMINAL], 1.0, 99, &once);
+    runScenario(scenarios[NOMINAL], 1.0, 99, &again);
+    check(memcmp(once.link, again.link, sizeof(once.link)) == 0 && once.ageMaster.sum == again.ageMaster.sum &&
+              once.events == again.events,
+          "same seed, same run");
+    check(speedup >= 10000.0, "at least 10000x real time");
+
+    return check_summary();
+}
@@ -0,0 +1,173 @@
+// Flight Log Decoder — host (platform = native)
+//
+// Run:  esptool.py --chip esp32s3 read_flash 0x610000 0x1F0000 rec.bin
+//       .pio/build/flight_decode/program rec.bin out/
+//       pio run -e flight_decode -t exec          # no image: decodes a 60 s demo log
+//
+// Turns a dump of the "rec" partition (partitions_recorder.csv, written by
+// firmware/common/recorder/flight_recorder.h) into one file pair per record
+// type in the output directory:
+//
+//   <type>.csv   t_ms,seq,<fields>            — spreadsheets, pandas.read_csv
+//   <type>.col   columnar, Parquet-like        — one contiguous array per field
+//
+// .col layout (little-endian):
+//   magic "RCOL"  u16 version (1)  u16 columns  u32 rows
+//   per column:   char name[24] (NUL-padded)  u8 kind (0: u32, 1: i32)  u8 pad[3]
+//   per column:   rows × 4 B values, in the order above
+// Column 0 is t_ms (u32), column 1 the page seq (u32), then the record's
+// fields as i32. Loading one column is a single read at a fixed offset, e.g.
+//   numpy.frombuffer(buf, "<i4", rows, 12 + cols * 28 + col * rows * 4)
+//
+// Units are the recorder's: 1e-7° positions, centidegrees, cm, cm/s,
+// 0.01 km/h, mV, dBm / dB. A summary of pages, CRC failures and records the
+// buoy dropped goes to stdout.
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vector>
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/hal/hal_host.h"
+#include "firmware/common/recorder/flight_recorder.h"
+
+#define COL_MAGIC   "RCOL"
+#define COL_VERSION 1
+#define COL_NAME    24
+
+struct Table {
+    std::vector<RecEntry> rows;
+};
+
+static void collect(const RecEntry& e, void* ctx) {
+    Table* tables = (Table*)ctx;
+    if (e.type < REC_TYPE_COUNT) tables[e.type].rows.push_back(e);
+}
+
+static bool writeCsv(const char* path, uint8_t type, const Table& t) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    const char* const* names;
+    int nf = rec_field_names(type, &names);
+    fprintf(f, "t_ms,seq");
+    for (int i = 0; i < nf; i++) fprintf(f, ",%s", names[i]);
+    fprintf(f, "\n");
+    for (const RecEntry& e : t.rows) {
+        fprintf(f, "%u,%u", e.t_ms, e.seq);
+        for (int i = 0; i < nf; i++) fprintf(f, ",%d", e.v[i]);
+        fprintf(f, "\n");
+    }
+    return fclose(f) == 0;
+}
+
+static void colHeader(FILE* f, const char* name, uint8_t kind) {
+    char    n[COL_NAME] = {};
+    uint8_t tail[4]     = { kind, 0, 0, 0 };
+    strncpy(n, name, COL_NAME - 1);
+    fwrite(n, 1, COL_NAME, f);
+    fwrite(tail, 1, sizeof(tail), f);
+}
+
+static bool writeCol(const char* path, uint8_t type, const Table& t) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    const char* const* names;
+    int      nf   = rec_field_names(type, &names);
+    uint16_t ver  = COL_VERSION, cols = (uint16_t)(2 + nf);
+    uint32_t rows = (uint32_t)t.rows.size();
+    fwrite(COL_MAGIC, 1, 4, f);
+    fwrite(&ver, 2, 1, f);
+    fwrite(&cols, 2, 1, f);
+    fwrite(&rows, 4, 1, f);
+    colHeader(f, "t_ms", 0);
+    colHeader(f, "seq", 0);
+    for (int i = 0; i < nf; i++) colHeader(f, names[i], 1);
+
+    std::vector<int32_t> col(rows);
+    for (int c = -2; c < nf; c++) {
+        for (uint32_t r = 0; r < rows; r++) {
+            const RecEntry& e = t.rows[r];
+            col[r] = c == -2 ? (int32_t)e.t_ms : c == -1 ? (int32_t)e.seq : e.v[c];
+        }
+        fwrite(col.data(), 4, rows, f);
+    }
+    return fclose(f) == 0;
+}
+
+// No image given: log 60 s of a synthetic buoy into the host flash image
+static std::vector<uint8_t> demoImage() {
+    hal_host_reset();
+    hal_host_flash_fill(0xFF);
+    FlightRecorder rec;
+    rec.begin();
+    for (uint32_t t = 0; t < 60000; t += 100) {
+        int32_t k = (int32_t)(t / 100);
+        rec.gps(t, 453210000 + 9 * k, -738760000 + 13 * k, 105, 4500, 11);
+        rec.compass(t, (uint16_t)(k * 37 % 36000), (int16_t)(k % 900 - 450), 120, -820);
+        UltrasonicScan scan = { (uint16_t)(400 - k % 300), 350, 420 };
+        rec.range(t, scan, 0);
+        if (k % 2 == 0) {
+            rec.vane(t, 12000, 9000, (int16_t)(k % 400 - 200));
+            rec.wind(t, 1250, 1800, 700);
+        }
+        if (k % 10 == 5) rec.radio(t, REC_RADIO_RX, 0x55, 15, -97, -4, 2);
+        if (k % 100 == 0) rec.battery(t, 12600);
+        rec.sync(t);
+        if (k % 2 == 1) rec.service();
+    }
+    rec.flush();
+    rec.service();
+    const uint8_t* img = hal_host_flash_image();
+    return std::vector<uint8_t>(img, img + HAL_HOST_FLASH_SIZE);
+}
+
+int main(int argc, char** argv) {
+    std::vector<uint8_t> image;
+    const char*          outDir = argc > 2 ? argv[2] : "rec_out";
+    if (argc > 1) {
+        FILE* f = fopen(argv[1], "rb");
+        if (!f) {
+            fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+            return 1;
+        }
+        uint8_t buf[4096];
+        size_t  n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) image.insert(image.end(), buf, buf + n);
+        fclose(f);
+    } else {
+        printf("No image given — decoding a 60 s demo log\n");
+        image = demoImage();
+    }
+    if (mkdir(outDir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "%s: %s\n", outDir, strerror(errno));
+        return 1;
+    }
+
+    Table    tables[REC_TYPE_COUNT];
+    uint32_t bad = 0, dropped = 0;
+    uint32_t n = rec_decode_image(image.data(), image.size(), collect, tables, &bad, &dropped);
+
+    uint32_t first = UINT32_MAX, last = 0;
+    for (const Table& t : tables) {
+        if (t.rows.empty()) continue;
+        if (t.rows.front().t_ms < first) first = t.rows.front().t_ms;
+        if (t.rows.back().t_ms > last) last = t.rows.back().t_ms;
+    }
+    printf("%zu KB image: %u records, %.1f min, %u pages failed CRC, %u records dropped on the buoy\n\n",
+           image.size() / 1024, n, n ? (last - first) / 60000.0 : 0.0, bad, dropped);
+
+    int errors = 0;
+    for (uint8_t type = 0; type < REC_TYPE_COUNT; type++) {
+        const char* const* names;
+        if (rec_field_names(type, &names) == 0 || tables[type].rows.empty()) continue;
+        char csv[512], col[512];
+        snprintf(csv, sizeof(csv), "%s/%s.csv", outDir, rec_type_name(type));
+        snprintf(col, sizeof(col), "%s/%s.col", outDir, rec_type_name(type));
+        bool ok = writeCsv(csv, type, tables[type]) && writeCol(col, type, tables[type]);
+        printf("  %-8s %7zu rows  %s\n", rec_type_name(type), tables[type].rows.size(), ok ? csv : "write failed");
+        if (!ok) errors++;
+    }
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,282 @@
+// Flight Recorder Check — host (platform = native)
+//
+// Run:  pio run -e flight_recorder -t exec
+//
+// The binary flight-data recorder (firmware/common/recorder/flight_recorder.h)
+// on the host flash image (256 KB, NOR semantics, 45 ms sector erase and
+// 0.7 ms page program on the virtual clock). A simulated buoy logs at the
+// control rate (LOOP_RATE_HZ): GPS 10 Hz, compass 10 Hz, ranges 10 Hz, vane
+// and wind 5 Hz, a radio event per second and the battery every 10 s; the
+// writer runs at the ui / log task rate (5 Hz).
+//   1. producer cost: no flash access and no virtual time in the append path
+//   2. nominal rate: nothing dropped, RAM ring high-water mark
+//   3. round trip: every record decoded with its time and position, a GPS
+//      jump past the int16 delta re-anchored
+//   4. log task stalled: 3 s absorbed by the RAM pages; 10 s drops records
+//      and the loss is reported in the next page header
+//   5. ring wrap: the oldest sectors go, the newest records are all there
+//   6. reboot: begin() resumes after the newest page, sequence continues
+//   7. power cut: a torn page fails its CRC, is skipped by the decoder and
+//      begin() does not write over it
+//   8. size and CPU against the tab-separated text line the sketches print
+//
+// Pass criteria: every check below; appending a record costs under 100 ns on
+// the host and a record, its share of the page header included, is at least
+// 2.5× smaller than the same values as a text line.
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "common/config.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/hal/hal_host.h"
+#include "firmware/common/recorder/flight_recorder.h"
+#include "testing/check.h"
+
+#define SIM_STEP_MS   (1000 / LOOP_RATE_HZ)
+#define LOG_PERIOD_MS 200                         // ui / log task, 5 Hz
+
+static double seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------------------------------------------------------------------------
+// Simulated buoy: every record also kept as the decoder should return it
+// ---------------------------------------------------------------------------
+struct Sim {
+    FlightRecorder*       rec;
+    std::vector<RecEntry> sent;
+    uint32_t              t    = 0;
+    int32_t               lat  = 453210000;       // 45.321° N
+    int32_t               lon  = -738760000;      // 73.876° W
+    uint32_t              step = 0;
+
+    void expect(uint8_t type, std::initializer_list<int32_t> v) {
+        RecEntry e;
+        memset(&e, 0, sizeof(e));
+        e.t_ms = t;
+        e.type = type;
+        int i = 0;
+        for (int32_t x : v) e.v[i++] = x;
+        sent.push_back(e);
+    }
+
+    // One control step; returns the virtual µs the producer calls took
+    uint64_t control() {
+        uint64_t before = hal_host_time_us();
+        uint16_t hdg    = (uint16_t)((step * 37) % 36000);
+        int16_t  mx = (int16_t)(step % 900 - 450), my = (int16_t)(300 - step % 600), mz = -820;
+        lat += 9;                                  // ~1 m/s north-east
+        lon += 13;
+        rec->gps(t, lat, lon, 105, 4500, 11);
+        expect(REC_GPS, { lat, lon, 105, 4500, 11 });
+        rec->compass(t, hdg, mx, my, mz);
+        expect(REC_COMPASS, { hdg, mx, my, mz });
+        UltrasonicScan scan = { (uint16_t)(400 - step % 300), 350, 420 };
+        rec->range(t, scan, 0);
+        expect(REC_RANGE, { scan.fwd_cm, scan.port_cm, scan.stbd_cm, 0 });
+        if (step % 2 == 0) {
+            rec->vane(t, 12000, 9000, (int16_t)(step % 400 - 200));
+            expect(REC_VANE, { 12000, 9000, (int16_t)(step % 400 - 200) });
+            rec->wind(t, 1250, 1800, 700);
+            expect(REC_WIND, { 1250, 1800, 700 });
+        }
+        if (step % 10 == 5) {
+            rec->radio(t, REC_RADIO_RX, 0x55, 15, -97, -4, 2);
+            expect(REC_RADIO, { REC_RADIO_RX, 0x55, 15, -97, -4, 2 });
+        }
+        if (step % 100 == 0) {
+            rec->battery(t, (uint16_t)(12600 - step / 100));
+            expect(REC_BATTERY, { (int32_t)(12600 - step / 100) });
+        }
+        rec->sync(t);
+        uint64_t spent = hal_host_time_us() - before;
+        t += SIM_STEP_MS;
+        step++;
+        return spent;
+    }
+
+    // Run for ms with the writer every LOG_PERIOD_MS (or not at all)
+    uint64_t run(uint32_t ms, bool writer = true) {
+        uint64_t producerUs = 0;
+        for (uint32_t end = t + ms; t < end;) {
+            producerUs += control();
+            if (writer && t % LOG_PERIOD_MS == 0) rec->service();
+        }
+        return producerUs;
+    }
+};
+
+struct Collected {
+    std::vector<RecEntry> got;
+};
+
+static void collect(const RecEntry& e, void* ctx) {
+    ((Collected*)ctx)->got.push_back(e);
+}
+
+static bool same(const RecEntry& a, const RecEntry& b) {
+    return a.t_ms == b.t_ms && a.type == b.type && memcmp(a.v, b.v, sizeof(a.v)) == 0;
+}
+
+// The decoded log must be the newest records sent, in order
+static bool tailMatches(const std::vector<RecEntry>& got, const std::vector<RecEntry>& sent) {
+    if (got.empty() || got.size() > sent.size()) return false;
+    size_t off = sent.size() - got.size();
+    for (size_t i = 0; i < got.size(); i++) {
+        if (!same(got[i], sent[off + i])) return false;
+    }
+    return true;
+}
+
+static Collected decode(uint32_t* bad = nullptr, uint32_t* dropped = nullptr) {
+    Collected c;
+    rec_decode_image(hal_host_flash_image(), HAL_HOST_FLASH_SIZE, collect, &c, bad, dropped);
+    return c;
+}
+
+int main() {
+    printf("Flight Recorder Check — %d KB image, %d B pages of %d × %d B records\n\n",
+           HAL_HOST_FLASH_SIZE / 1024, REC_PAGE_SIZE, REC_PAGE_RECORDS, REC_RECORD_SIZE);
+
+    hal_host_reset();
+    hal_host_flash_fill(0xFF);
+    FlightRecorder rec;
+    Sim sim;
+    sim.rec = &rec;
+
+    // 1 + 2. five minutes at the nominal rate
+    check(rec.begin() && rec.nextSeq() == 0, "fresh partition: begin() starts at page 0");
+    uint64_t producerUs = sim.run(5 * 60 * 1000);
+    rec.flush();
+    rec.service();
+    RecStats st = rec.stats();
+    printf("  5 min: %u records, %u pages, %u erases, RAM ring high-water %u / %d, writer %.1f ms/s\n",
+           st.records, st.pages, st.erases, st.max_queue, REC_RAM_PAGES, st.write_us / 1000.0 / 300);
+    check(producerUs == 0, "producer calls never touch flash (no virtual time)");
+    check(st.dropped == 0 && st.flash_errors == 0, "nominal rate: nothing dropped");
+    check(st.max_queue <= 2, "writer keeps up: at most 2 pages waiting");
+
+    // 3. round trip
+    Collected c = decode();
+    check(c.got.size() == sim.sent.size() && tailMatches(c.got, sim.sent), "decoded records equal the ones logged");
+    sim.lat += 500000;                             // 5.5 km jump: past the int16 delta
+    sim.run(2000);
+    rec.flush();
+    rec.service();
+    c = decode();
+    check(tailMatches(c.got, sim.sent) && c.got.back().type != REC_GPS_ABS, "GPS jump re-anchored, position exact");
+
+    // 4. log task stalled
+    sim.run(3000, false);
+    check(rec.stats().dropped == 0, "3 s writer stall absorbed by the RAM pages");
+    rec.service();
+    sim.run(10000, false);
+    uint32_t lost = rec.stats().dropped;
+    rec.service();
+    sim.run(2000);
+    rec.flush();
+    rec.service();
+    uint32_t reported = 0;
+    c = decode(nullptr, &reported);
+    printf("  10 s stall: %u records dropped, %u reported in page headers\n", lost, reported);
+    check(lost > 0 && reported == lost, "10 s stall: loss counted and reported in the log");
+    check(c.got.size() == sim.sent.size() - lost && same(c.got.back(), sim.sent.back()),
+          "records after the stall decoded");
+
+    // 5. wrap: well past the 256 KB image
+    sim.run(20 * 60 * 1000);
+    rec.flush();
+    rec.service();
+    st = rec.stats();
+    c  = decode();
+    bool ordered = true;
+    for (size_t i = 1; i < c.got.size(); i++) ordered &= c.got[i].t_ms >= c.got[i - 1].t_ms;
+    uint32_t minPages = st.capacity_pages - HAL_FLASH_SECTOR / REC_PAGE_SIZE;
+    printf("  wrap: %u pages written into %u, %zu records kept (%.1f min)\n", st.pages, st.capacity_pages,
+           c.got.size(), (c.got.back().t_ms - c.got.front().t_ms) / 60000.0);
+    check(st.pages > st.capacity_pages, "ring wrapped");
+    check(ordered && tailMatches(c.got, sim.sent), "after wrap: newest records kept, oldest first, exact");
+    check(c.got.size() >= (size_t)minPages * (REC_PAGE_RECORDS - 1), "after wrap: all but one sector in use");
+
+    // 6. reboot
+    uint32_t seqBefore = rec.nextSeq();
+    hal_host_reset();
+    FlightRecorder boot;
+    sim.rec = &boot;
+    check(boot.begin() && boot.nextSeq() == seqBefore, "reboot: sequence continues after the newest page");
+    sim.run(60 * 1000);
+    boot.flush();
+    boot.service();
+    c = decode();
+    check(tailMatches(c.got, sim.sent), "reboot: old and new records decode as one log");
+
+    // 7. power cut while a page was being programmed: NOR leaves it partly written
+    sim.run(3000, false);
+    boot.flush();
+    RecStats b = boot.stats();
+    boot.service();
+    uint32_t pagesNow = boot.stats().pages - b.pages;
+    uint8_t* img      = hal_host_flash_image();
+    // Find the newest page and tear it: its second half still erased
+    uint32_t newest = 0, newestSeq = 0;
+    for (uint32_t i = 0; i < boot.stats().capacity_pages; i++) {
+        RecPage p;
+        memcpy(&p, img + i * REC_PAGE_SIZE, sizeof(p));
+        if (rec_page_valid(p) && p.h.seq >= newestSeq) { newest = i; newestSeq = p.h.seq; }
+    }
+    memset(img + newest * REC_PAGE_SIZE + REC_PAGE_SIZE / 2, 0xFF, REC_PAGE_SIZE / 2);
+    uint32_t bad = 0;
+    c = decode(&bad);
+    check(pagesNow > 0 && bad == 1, "torn page fails its CRC");
+    check(!c.got.empty() && c.got.back().t_ms < sim.sent.back().t_ms, "torn page skipped, the rest decodes");
+    hal_host_reset();
+    FlightRecorder again;
+    sim.rec = &again;
+    again.begin();
+    check(again.nextSeq() == newestSeq, "reboot after the cut: the torn page's number is reused");
+    sim.run(5000);
+    again.flush();
+    again.service();
+    RecPage torn;
+    memcpy(&torn, img + newest * REC_PAGE_SIZE, sizeof(torn));
+    c = decode(&bad);
+    check(!rec_page_valid(torn) && bad == 1 && same(c.got.back(), sim.sent.back()),
+          "resumed in a fresh sector, torn page left alone");
+
+    // 8. size and CPU against text
+    const int N = 200000;
+    hal_host_reset();
+    hal_host_flash_fill(0xFF);
+    FlightRecorder bench;
+    bench.begin();
+    double t0 = seconds();
+    for (int i = 0; i < N; i++) {
+        bench.compass((uint32_t)i * 10, (uint16_t)(i % 36000), (int16_t)i, -12, 400);
+        if ((i & 15) == 15) bench.service();
+    }
+    double tRec = (seconds() - t0) / N;
+    double tWrite = bench.stats().write_us / 1e6;   // virtual: flash time on target
+    char   line[96];
+    size_t textBytes = 0;
+    volatile size_t sink = 0;
+    t0 = seconds();
+    for (int i = 0; i < N; i++) {
+        int n = snprintf(line, sizeof(line), "%lu\tcompass\t%.2f\t%d\t%d\t%d\n", (unsigned long)i * 10,
+                         (i % 36000) / 100.0, (int16_t)i, -12, 400);
+        textBytes += (size_t)n;
+        sink = sink + (size_t)line[n / 2];
+    }
+    double tText = (seconds() - t0) / N;
+    double textPer = (double)textBytes / N;
+    double binPer  = (double)REC_PAGE_SIZE / REC_PAGE_RECORDS;   // header included
+    printf("\n  compass record: %.1f B binary (header share included) vs %.1f B text, "
+           "%.0f ns vs %.0f ns per record (host), flash %.0f µs/record\n",
+           binPer, textPer, tRec * 1e9, tText * 1e9, tWrite * 1e6 / N);
+    printf("  sizeof(FlightRecorder) %zu B\n", sizeof(FlightRecorder));
+    check(tRec < 100e-9, "append under 100 ns per record");
+    check(textPer >= 2.5 * binPer, "binary at least 2.5× smaller than text");
+
+    return check_summary();
+}
@@ -0,0 +1,244 @@
+// Geodesy Kernel Benchmark — ENU frame vs Haversine — host (platform = native)
+//
+// Run:  pio run -e geodesy_bench -t exec
+//
+// For five course origins (equator, Toronto, 45° S, 60° N, antimeridian) draws
+// random point pairs within GEO_SPEC_RADIUS_M of the origin and computes
+// distance and initial bearing three ways:
+//
+//   geodesic   Vincenty inverse on WGS-84 (double) — the reference
+//   haversine  the spherical formula from hardware/specs/be-880-gps.md (double)
+//   enu        geo_to_enu() once per point, then geo_vector() (float)
+//
+// Reports the worst distance error (absolute and relative), worst bearing
+// error on legs ≥ 10 m, and the worst error on hold-radius legs (≤ 20 m), for
+// Haversine and the kernel. Then times both per target, and geo_vectors() over
+// MAX_BUOYS pairs. Host doubles are hardware, so the speedup understates the
+// ESP32-S3, whose FPU is single precision only.
+//
+// Pass criteria: kernel within the geodesy.h spec at every origin with
+// |lat| ≤ GEO_SPEC_LAT_DEG; kernel closer to the geodesic than Haversine;
+// geo_atan2_deg() within 0.001° of atan2 over a full turn.
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "common/protocol.h"
+#include "common/position.h"
+#include "firmware/common/gps/geodesy.h"
+#include "testing/check.h"
+
+#define PAIRS_PER_ORIGIN   200000
+#define HOLD_LEG_M         20.0
+#define TIMING_PAIRS       (1 << 16)
+#define TIMING_ROUNDS      20
+
+struct OriginCase {
+    const char* name;
+    double      lat;
+    double      lon;
+};
+
+static const OriginCase ORIGINS[] = {
+    { "equator",       0.0,        0.0      },
+    { "toronto",      43.654321, -79.381234 },
+    { "45S",         -45.0,      170.5      },
+    { "60N",          60.0,       10.0      },
+    { "antimeridian", 10.0,      179.999    },
+};
+static const size_t ORIGIN_COUNT = sizeof(ORIGINS) / sizeof(ORIGINS[0]);
+
+static uint64_t rngState = 12;
+static double uniform(double lo, double hi) {
+    rngState = rngState * 6364136223846793005ULL + 1442695040888963407ULL;
+    return lo + (hi - lo) * ((rngState >> 11) * (1.0 / 9007199254740992.0));
+}
+
+static double rad(double d) { return d * M_PI / 180.0; }
+static double deg(double r) { return r * 180.0 / M_PI; }
+
+static double bearingDiff(double a, double b) {
+    double d = fmod(a - b + 540.0, 360.0) - 180.0;
+    return fabs(d);
+}
+
+// ---------------------------------------------------------------------------
+// The per-loop path the navigation notes call for
+static double haversine(double lat1, double lon1, double lat2, double lon2) {
+    double dLat = rad(lat2 - lat1);
+    double dLon = rad(lon2 - lon1);
+    double a = sin(dLat / 2) * sin(dLat / 2) +
+               cos(rad(lat1)) * cos(rad(lat2)) * sin(dLon / 2) * sin(dLon / 2);
+    double c = 2 * atan2(sqrt(a), sqrt(1 - a));
+    return 6371000 * c;
+}
+
+static double bearing(double lat1, double lon1, double lat2, double lon2) {
+    double dLon = rad(lon2 - lon1);
+    double y = sin(dLon) * cos(rad(lat2));
+    double x = cos(rad(lat1)) * sin(rad(lat2)) - sin(rad(lat1)) * cos(rad(lat2)) * cos(dLon);
+    return fmod(deg(atan2(y, x)) + 360, 360);
+}
+
+// Vincenty inverse, WGS-84: distance (m) and initial azimuth (deg)
+static double vincenty(double lat1, double lon1, double lat2, double lon2, double* az1) {
+    const double a = 6378137.0, f = 1 / 298.257223563, b = a * (1 - f);
+    double L = rad(lon2 - lon1);
+    if (L >  M_PI) L -= 2 * M_PI;
+    if (L < -M_PI) L += 2 * M_PI;
+    double U1 = atan((1 - f) * tan(rad(lat1))), U2 = atan((1 - f) * tan(rad(lat2)));
+    double sinU1 = sin(U1), cosU1 = cos(U1), sinU2 = sin(U2), cosU2 = cos(U2);
+    double lambda = L, prev, sinS, cosS, sigma, cos2A, cos2Sm, sinL, cosL;
+    int    iter = 0;
+    do {
+        sinL = sin(lambda);
+        cosL = cos(lambda);
+        double t1 = cosU2 * sinL, t2 = cosU1 * sinU2 - sinU1 * cosU2 * cosL;
+        sinS = sqrt(t1 * t1 + t2 * t2);
+        if (sinS == 0) { *az1 = 0; return 0; }
+        cosS   = sinU1 * sinU2 + cosU1 * cosU2 * cosL;
+        sigma  = atan2(sinS, cosS);
+        double sinA = cosU1 * cosU2 * sinL / sinS;
+        cos2A  = 1 - sinA * sinA;
+        cos2Sm = cos2A != 0 ? cosS - 2 * sinU1 * sinU2 / cos2A : 0;
+        double C = f / 16 * cos2A * (4 + f * (4 - 3 * cos2A));
+        prev   = lambda;
+        lambda = L + (1 - C) * f * sinA * (sigma + C * sinS * (cos2Sm + C * cosS * (-1 + 2 * cos2Sm * cos2Sm)));
+    } while (fabs(lambda - prev) > 1e-12 && ++iter < 200);
+    double u2 = cos2A * (a * a - b * b) / (b * b);
+    double A  = 1 + u2 / 16384 * (4096 + u2 * (-768 + u2 * (320 - 175 * u2)));
+    double B  = u2 / 1024 * (256 + u2 * (-128 + u2 * (74 - 47 * u2)));
+    double dS = B * sinS * (cos2Sm + B / 4 * (cosS * (-1 + 2 * cos2Sm * cos2Sm) -
+                B / 6 * cos2Sm * (-3 + 4 * sinS * sinS) * (-3 + 4 * cos2Sm * cos2Sm)));
+    *az1 = fmod(deg(atan2(cosU2 * sinL, cosU1 * sinU2 - sinU1 * cosU2 * cosL)) + 360, 360);
+    return b * A * (sigma - dS);
+}
+
+// ---------------------------------------------------------------------------
+struct ErrorReport {
+    double distAbs, distRel, bearing, holdAbs;
+};
+
+static void track(ErrorReport* r, double d, double ref, double b, double refB) {
+    double e = fabs(d - ref);
+    if (e > r->distAbs) r->distAbs = e;
+    if (ref > 1.0 && e / ref > r->distRel) r->distRel = e / ref;
+    if (ref >= 10.0 && bearingDiff(b, refB) > r->bearing) r->bearing = bearingDiff(b, refB);
+    if (ref <= HOLD_LEG_M && e > r->holdAbs) r->holdAbs = e;
+}
+
+// Random point within the spec radius of the origin, as GPS-native e7
+static void randomPoint(const CourseOrigin& o, double radius, int32_t* lat, int32_t* lon) {
+    double r = radius * sqrt(uniform(0, 1)), th = uniform(0, 2 * M_PI);
+    PositionCm p = { (int32_t)lround(r * cos(th) * 100), (int32_t)lround(r * sin(th) * 100) };
+    position_decode(o, p, lat, lon);
+}
+
+int main() {
+    printf("Geodesy kernel — %d pairs per origin within %.0f m, geodesic = Vincenty WGS-84\n\n",
+           PAIRS_PER_ORIGIN, GEO_SPEC_RADIUS_M);
+    printf("%-13s | %-40s | %-40s\n", "", "haversine (double)", "enu kernel (float)");
+    printf("%-13s | %9s %9s %9s %9s | %9s %9s %9s %9s\n", "origin",
+           "dist m", "dist rel", "brg deg", "hold cm", "dist m", "dist rel", "brg deg", "hold cm");
+
+    bool spec = true, better = true;
+    for (size_t c = 0; c < ORIGIN_COUNT; c++) {
+        const OriginCase& oc = ORIGINS[c];
+        CourseOrigin o;
+        course_origin_set(&o, deg_to_e7(oc.lat), deg_to_e7(oc.lon), 1);
+
+        ErrorReport hv = {}, enu = {};
+        bool        distOk = true;
+        for (int i = 0; i < PAIRS_PER_ORIGIN; i++) {
+            int32_t lat1, lon1, lat2, lon2;
+            randomPoint(o, GEO_SPEC_RADIUS_M, &lat1, &lon1);
+            if (i % 4 == 0) {
+                // hold-radius leg: second point within HOLD_LEG_M of the first
+                double th = uniform(0, 2 * M_PI), r = uniform(0, HOLD_LEG_M);
+                lat2 = lat1 + (int32_t)lround(r * cos(th) * 100 / o.cm_per_e7_lat);
+                lon2 = lon1 + (int32_t)lround(r * sin(th) * 100 / o.cm_per_e7_lon);
+            } else {
+                randomPoint(o, GEO_SPEC_RADIUS_M, &lat2, &lon2);
+            }
+            double la1 = e7_to_deg(lat1), lo1 = e7_to_deg(lon1);
+            double la2 = e7_to_deg(lat2), lo2 = e7_to_deg(lon2);
+
+            double refB, ref = vincenty(la1, lo1, la2, lo2, &refB);
+            track(&hv, haversine(la1, lo1, la2, lo2), ref, bearing(la1, lo1, la2, lo2), refB);
+
+            GeoVector v = geo_vector(geo_to_enu(o, lat1, lon1), geo_to_enu(o, lat2, lon2));
+            track(&enu, v.dist_m, ref, v.bearing_deg, refB);
+            if (fabs(v.dist_m - ref) > GEO_SPEC_DIST_REL * ref + 0.01) distOk = false;
+        }
+        printf("%-13s | %9.3f %9.2e %9.4f %9.2f | %9.3f %9.2e %9.4f %9.2f\n", oc.name,
+               hv.distAbs, hv.distRel, hv.bearing, hv.holdAbs * 100,
+               enu.distAbs, enu.distRel, enu.bearing, enu.holdAbs * 100);
+
+        if (fabs(oc.lat) <= GEO_SPEC_LAT_DEG && !(distOk && enu.bearing <= GEO_SPEC_BEARING_DEG)) spec = false;
+        if (enu.distAbs > hv.distAbs || enu.holdAbs > hv.holdAbs) better = false;
+    }
+
+    // geo_atan2_deg() over a full turn, radius 1e-3 to 1e4 m
+    double atanErr = 0;
+    for (int i = 0; i < 3600000; i++) {
+        double th = i * (2 * M_PI / 3600000), r = pow(10.0, (i % 8) - 3);
+        float  y = (float)(r * sin(th)), x = (float)(r * cos(th));
+        double e = bearingDiff(geo_atan2_deg(y, x), deg(atan2((double)y, (double)x)));
+        if (e > atanErr) atanErr = e;
+    }
+    printf("\ngeo_atan2_deg max error vs atan2: %.6f deg\n\n", atanErr);
+
+    // -----------------------------------------------------------------------
+    // Timing: per target from a fresh fix, and the master's MAX_BUOYS batch
+    static int32_t  lat[TIMING_PAIRS], lon[TIMING_PAIRS];
+    static EnuPoint enuPts[TIMING_PAIRS];
+    static GeoVector out[TIMING_PAIRS];
+    CourseOrigin o;
+    course_origin_set(&o, deg_to_e7(ORIGINS[1].lat), deg_to_e7(ORIGINS[1].lon), 1);
+    for (int i = 0; i < TIMING_PAIRS; i++) randomPoint(o, GEO_SPEC_RADIUS_M, &lat[i], &lon[i]);
+
+    volatile double sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < TIMING_ROUNDS; k++) {
+        for (int i = 0; i + 1 < TIMING_PAIRS; i += 2) {
+            double la1 = e7_to_deg(lat[i]), lo1 = e7_to_deg(lon[i]);
+            double la2 = e7_to_deg(lat[i + 1]), lo2 = e7_to_deg(lon[i + 1]);
+            sink = sink + haversine(la1, lo1, la2, lo2) + bearing(la1, lo1, la2, lo2);
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double hvNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / (TIMING_ROUNDS * TIMING_PAIRS / 2);
+
+    t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < TIMING_ROUNDS; k++) {
+        for (int i = 0; i + 1 < TIMING_PAIRS; i += 2) {
+            GeoVector v = geo_vector(geo_to_enu(o, lat[i], lon[i]), geo_to_enu(o, lat[i + 1], lon[i + 1]));
+            sink = sink + v.dist_m + v.bearing_deg;
+        }
+    }
+    t1 = std::chrono::steady_clock::now();
+    double enuNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / (TIMING_ROUNDS * TIMING_PAIRS / 2);
+
+    for (int i = 0; i < TIMING_PAIRS; i++) enuPts[i] = geo_to_enu(o, lat[i], lon[i]);
+    const int batches = TIMING_PAIRS / (2 * MAX_BUOYS);
+    t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < TIMING_ROUNDS; k++) {
+        for (int b = 0; b < batches; b++) {
+            geo_vectors(&enuPts[b * 2 * MAX_BUOYS], &enuPts[b * 2 * MAX_BUOYS + MAX_BUOYS], &out[b * MAX_BUOYS]);
+        }
+        sink = sink + out[k].dist_m;
+    }
+    t1 = std::chrono::steady_clock::now();
+    double batchNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / (TIMING_ROUNDS * batches);
+
+    printf("%-42s %10.1f ns\n", "haversine + bearing (double), per target", hvNs);
+    printf("%-42s %10.1f ns  (%.1fx)\n", "geo_to_enu x2 + geo_vector, per target", enuNs, hvNs / enuNs);
+    printf("%-42s %10.1f ns  (%.1f ns per buoy)\n", "geo_vectors, MAX_BUOYS batch", batchNs, batchNs / MAX_BUOYS);
+    printf("\n");
+
+    check(spec, "kernel within spec (distance, bearing) at every origin up to the spec latitude");
+    check(better, "kernel closer to the geodesic than Haversine (all legs and hold-radius legs)");
+    check(atanErr <= 0.001, "geo_atan2_deg within 0.001 deg of atan2");
+    check(enuNs < hvNs, "kernel faster than Haversine per target");
+    return check_summary();
+}
@@ -2,7 +2,6 @@
 // ESP32-S3-DevKitC-1 + BE-880 GPS (UART) + SSD1306 0.96" OLED (I2C)
 //
 // platformio.ini lib_deps:
-//   mikalhart/TinyGPSPlus
 //   adafruit/Adafruit GFX Library
 //   adafruit/Adafruit SSD1306
 //
@@ -16,22 +15,34 @@
 // Baud rates:
 //   GPS_BAUD (115200) — GPSSerial UART1 to BE-880 module (configured at 115200, not factory default)
 //   115200            — Serial USB CDC to computer (serial monitor)
+//
+// The module is switched to UBX NAV-PVT at GPS_UBX_RATE_HZ (UbxReader); until
+// it answers, or if it later comes back on NMEA, the same reader decodes
+// GGA/RMC instead. The UART driver buffers each burst, onReceive() flags the
+// end of it, and poll() takes it in bulk. Raw NMEA is echoed to the monitor
+// at most NMEA_ECHO_PER_S sentences per second — the full stream (~8 KB/s)
+// would otherwise stall loop() on the USB CDC.
 
 #include <Arduino.h>
 #include <HardwareSerial.h>
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
-#include <TinyGPS++.h>
 #include "common/config.h"
+#include "firmware/common/display/oled_flush.h"
+#include "firmware/common/gps/ubx.h"
 
 #define SCREEN_WIDTH  128
 #define SCREEN_HEIGHT  64
 #define OLED_RESET     -1
+#define GPS_RX_BUFFER   1024   // > one epoch of NMEA at 10 Hz
+#define NMEA_ECHO_PER_S 10
 
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+OledFlush oled;   // sends only changed columns, from its own task
 HardwareSerial GPSSerial(1);
-TinyGPSPlus gps;
+UbxReader gps;
+volatile bool gpsRx = false;   // set by the UART driver at the end of each burst
 
 unsigned long lastDisplayUpdate = 0;
 const unsigned long DISPLAY_INTERVAL_MS = 1000;
@@ -55,9 +66,16 @@ void setup() {
     display.println("  === GPS TEST ===");
     display.println("  Initializing...");
     display.display();
-
-    GPSSerial.begin(GPS_BAUD, SERIAL_8N1, GPS_RX_PIN, GPS_TX_PIN);  // 9600 baud to BE-880
-    Serial.println("Waiting for GPS data — raw NMEA below:");
+    oled.startTask();
+
+    GPSSerial.setRxBufferSize(GPS_RX_BUFFER);   // before begin()
+    GPSSerial.begin(GPS_BAUD, SERIAL_8N1, GPS_RX_PIN, GPS_TX_PIN);
+    GPSSerial.onReceive([] { gpsRx = true; });
+    hal_uart_bind(HAL_GPS_UART, &GPSSerial);
+    hal_uart_bind(0, &Serial);
+    gps.text().setEcho(0, NMEA_ECHO_PER_S);
+    gps.begin(GPS_UBX_RATE_HZ);
+    Serial.println("Waiting for GPS data — raw NMEA below until UBX takes over:");
 }
 
 // ── Display helpers ─────────────────────────────────────────────────────────
@@ -74,81 +92,83 @@ void showSearching() {
 
     display.setTextSize(1);
     display.setCursor(0, 38);
-    display.print("Sats visible: ");
-    display.println(gps.satellites.isValid() ? (int)gps.satellites.value() : 0);
+    UbxStats us = gps.stats();
+    display.print("Sats used: ");
+    display.println(gps.fix().sats);
 
     display.print("Chars recv'd: ");
-    display.println(gps.charsProcessed());
+    display.println(us.bytes);
 
     display.print("Data flowing: ");
-    display.println(gps.charsProcessed() > 10 ? "YES" : "NO");
+    display.println(us.frames > 0 ? "UBX" : gps.text().stats().sentences > 0 ? "NMEA" : "NO");
 
-    display.display();
+    oled.submit(display.getBuffer());
 }
 
 void showFix() {
+    const GpsFix& f = gps.fix();
     display.clearDisplay();
     display.setTextSize(1);
     display.setCursor(0, 0);
     display.println("  === GPS TEST ===");
 
-    display.print("Fix: GPS  Sats: ");
-    display.println(gps.satellites.value());
+    display.print(f.source == GPS_SRC_UBX ? "Fix: UBX  Sats: " : "Fix: NMEA Sats: ");
+    display.println(f.sats);
 
     display.print("Lat: ");
-    if (gps.location.lat() >= 0) display.print(" ");
-    display.println(gps.location.lat(), 6);
+    if (f.lat_e7 >= 0) display.print(" ");
+    display.println(f.lat_e7 / 1e7, 6);
 
     display.print("Lon: ");
-    display.println(gps.location.lng(), 6);
+    display.println(f.lon_e7 / 1e7, 6);
 
     display.print("HDOP: ");
-    display.print(gps.hdop.hdop(), 1);
+    display.print(f.hdop_x100 / 100.0f, 1);
     display.print("  Alt: ");
-    display.print((int)gps.altitude.meters());
+    display.print((int)(f.alt_cm / 100));
     display.println("m");
 
     display.print("Age: ");
-    display.print(gps.location.age());
+    display.print(millis() - f.rx_ms);
     display.println("ms");
 
-    display.display();
+    oled.submit(display.getBuffer());
 }
 
 // ── Main loop ───────────────────────────────────────────────────────────────
 
 void loop() {
-    // Feed every byte from GPS UART to TinyGPS++ and echo NMEA to serial monitor
-    while (GPSSerial.available()) {
-        char c = GPSSerial.read();
-        gps.encode(c);
-
-        static char lineBuf[128];
-        static uint8_t lineIdx = 0;
-        if (c == '\n' || lineIdx >= sizeof(lineBuf) - 1) {
-            lineBuf[lineIdx] = '\0';
-            if (lineIdx > 1) Serial.println(lineBuf);
-            lineIdx = 0;
-        } else if (c != '\r') {
-            lineBuf[lineIdx++] = c;
-        }
+    // Take each burst from the UART driver in bulk; echo is rate-limited inside
+    if (gpsRx) {
+        gpsRx = false;
+        gps.poll();
     }
 
     // Refresh display at 1 Hz
     if (millis() - lastDisplayUpdate >= DISPLAY_INTERVAL_MS) {
         lastDisplayUpdate = millis();
 
-        if (gps.location.isValid()) {
+        const GpsFix& f = gps.fix();
+        if (f.valid) {
             showFix();
+            UbxStats us = gps.stats();
             Serial.print("[GPS] Fix: ");
-            Serial.print(gps.location.lat(), 7);
+            Serial.print(f.lat_e7 / 1e7, 7);
             Serial.print(", ");
-            Serial.print(gps.location.lng(), 7);
-            Serial.print("  Sats: "); Serial.print(gps.satellites.value());
-            Serial.print("  HDOP: "); Serial.print(gps.hdop.hdop(), 1);
-            Serial.print("  Alt: "); Serial.print(gps.altitude.meters(), 1);
-            Serial.print("m  Age: "); Serial.print(gps.location.age());
-            Serial.println("ms");
+            Serial.print(f.lon_e7 / 1e7, 7);
+            Serial.print("  Sats: "); Serial.print(f.sats);
+            Serial.print("  HDOP: "); Serial.print(f.hdop_x100 / 100.0f, 1);
+            Serial.print("  Alt: "); Serial.print(f.alt_cm / 100.0f, 1);
+            Serial.print("m  Age: "); Serial.print(millis() - f.rx_ms);
+            Serial.print("ms  "); Serial.print(f.source == GPS_SRC_UBX ? "UBX" : "NMEA");
+            Serial.print("  SOG: "); Serial.print(f.sog_cms / 100.0f, 2);
+            Serial.print("m/s COG: "); Serial.print(f.cog_cdeg / 100.0f, 1);
+            Serial.print("  PVT: "); Serial.print(us.pvt);
+            Serial.print(" bad "); Serial.print(us.bad);
+            Serial.print(" fallbacks "); Serial.print(us.fallbacks);
+            OledStats os = oled.stats();   // previous frame's flush
+            Serial.print("  OLED: "); Serial.print(os.last_bytes);
+            Serial.print(" B "); Serial.print(os.last_flush_us); Serial.println(" us");
         } else {
             showSearching();
         }
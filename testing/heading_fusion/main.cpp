@@ -0,0 +1,293 @@
+// Heading Fusion Benchmark — host (platform = native)
+//
+// Run:  pio run -e heading_fusion -t exec
+//       .pio/build/heading_fusion/program log.csv     # replay a recorded log
+//
+// Simulated buoy, 30 min: legs between marks at 1.5 m/s with turns of
+// 30–150° (yaw rate ≤ 15 °/s, 1 s response), station-keeping pauses, wave yaw
+// ±3° at 0.3 Hz. The compass is read at the sensor task rate (50 Hz) with
+// 2.5° noise plus a wave-roll error (untilted QMC at 65° inclination); every
+// ~60 s the thrusters or a passing hull add a 25° disturbance for 2 s. GPS
+// (UBX, 10 Hz) reports COG = heading + 4° current set + a lag in turns, with
+// noise σ = atan(0.1 m/s / sog) once moving.
+//
+// Heading is sampled by the control step (LOOP_RATE_HZ) and scored against
+// the true heading at that instant:
+//   raw       newest compass reading (sample-and-hold)
+//   smoothed  QMC5883LCompass setSmoothing(5, true): mean of the last 5
+//             readings with the highest and lowest dropped
+//   filter    HeadingFilter: compass + COG, extrapolated to the control step
+// Lag is the least-squares delay fitted to error ≈ −lag · yaw rate.
+//
+// Pass criteria: filter RMS error within 10% of smoothed with no more lag,
+// mean peak error during disturbances ≤ 1/2 of smoothed and at least half of
+// them kept under 8°, course offset within 2° of the set, cost per compass
+// update under 1 µs on the host. A disturbance that starts in a fast turn
+// (no COG, rate still settling) can get in — the compass alone cannot tell
+// it from the turn.
+//
+// Replay: CSV lines "t_ms,mag_deg[,cog_deg,sog_cms]" — prints
+// "t_ms,heading,rate,sigma" for each compass line after running the filter.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include "common/config.h"
+#include "firmware/common/compass/heading_filter.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/tasks/buoy_tasks.h"
+#include "testing/check.h"
+
+#define SIM_MINUTES       30
+#define SIM_STEP_US       2000                     // truth integration
+#define MAG_PERIOD_US     TASK_SENSOR_PERIOD_US
+#define GPS_PERIOD_US     100000
+#define CONTROL_PERIOD_US TASK_CONTROL_PERIOD_US
+#define DIST_DEG          25.0                     // thruster / hull disturbance
+#define DIST_S            2.0
+#define HELD_DEG          8.0                      // disturbance kept out: peak error below this
+
+static double seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double wrap180(double a) {
+    while (a > 180) a -= 360;
+    while (a <= -180) a += 360;
+    return a;
+}
+
+static double wrap360(double a) {
+    a = fmod(a, 360.0);
+    return a < 0 ? a + 360 : a;
+}
+
+// ---------------------------------------------------------------------------
+// Truth: heading-hold autopilot on legs, first-order yaw rate response
+struct Buoy {
+    double       course = 40, yaw = 40, rate = 0, sog = 0, cogLagged = 40;
+    double       legLeft = 20, pause = 0, t = 0;
+    std::mt19937 rng;
+
+    explicit Buoy(uint32_t seed) : rng(seed) {}
+
+    void step(double dt) {
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        t += dt;
+        legLeft -= dt;
+        if (legLeft <= 0) {
+            if (pause <= 0 && u(rng) < 0.3) {
+                pause   = 10 + 20 * u(rng);   // hold station
+                legLeft = pause;
+            } else {
+                pause    = 0;
+                double turn = 30 + 120 * u(rng);
+                course   = wrap360(course + (u(rng) < 0.5 ? -turn : turn));
+                legLeft  = 20 + 25 * u(rng);
+            }
+        }
+        if (pause > 0) pause -= dt;
+        double want = std::max(-15.0, std::min(15.0, 0.8 * wrap180(course - yaw)));
+        rate += (want - rate) * dt / 1.0;
+        yaw   = wrap360(yaw + rate * dt);
+        double sogWant = pause > 0 ? 0.1 : 1.5;
+        sog  += (sogWant - sog) * dt / 3.0;
+        cogLagged = wrap360(cogLagged + wrap180(yaw - cogLagged) * dt / 1.5);
+    }
+
+    double wave() const { return 3.0 * sin(2 * M_PI * 0.3 * t); }
+    double heading() const { return wrap360(yaw + wave()); }
+    double headingRate() const { return rate + 3.0 * 2 * M_PI * 0.3 * cos(2 * M_PI * 0.3 * t); }
+};
+
+// QMC5883LCompass smoothing, advanced: 5 readings, drop highest and lowest
+struct LibSmoothing {
+    double h[5] = {};
+    int    n = 0, next = 0;
+
+    double add(double v) {
+        h[next] = v;
+        next    = (next + 1) % 5;
+        if (n < 5) n++;
+        double ref = v, d[5];
+        for (int i = 0; i < n; i++) d[i] = wrap180(h[i] - ref);
+        for (int i = 1; i < n; i++)   // insertion sort, ≤ 5
+            for (int j = i; j > 0 && d[j] < d[j - 1]; j--) std::swap(d[j], d[j - 1]);
+        double sum = 0;
+        int    lo = n > 2 ? 1 : 0, hi = n > 2 ? n - 1 : n;
+        for (int i = lo; i < hi; i++) sum += d[i];
+        return wrap360(ref + sum / (hi - lo));
+    }
+};
+
+// Error / lag outside disturbances (plus 2 s to settle); per disturbance, the peak error
+struct Score {
+    double sum2 = 0, max = 0, er = 0, rr = 0, eventMax = 0, peaks = 0;
+    int    n = 0, events = 0, held = 0;
+
+    void add(double est, double truth, double rate, bool clean) {
+        double e = wrap180(est - truth);
+        if (!clean) {
+            eventMax = std::max(eventMax, fabs(e));
+            return;
+        }
+        sum2 += e * e;
+        max   = std::max(max, fabs(e));
+        er   += e * rate;
+        rr   += rate * rate;
+        n++;
+    }
+    void endEvent() {
+        events++;
+        held    += eventMax <= HELD_DEG;
+        peaks   += eventMax;
+        eventMax = 0;
+    }
+    double rms() const { return sqrt(sum2 / n); }
+    double lagMs() const { return -er / rr * 1000; }
+    double meanPeak() const { return peaks / events; }
+};
+
+// ---------------------------------------------------------------------------
+static int replay(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+    HeadingFilter hf;
+    GpsFix        fix = {};
+    char          line[160];
+    uint32_t      lines = 0;
+    double        spent = 0;
+    printf("t_ms,heading,rate,sigma\n");
+    while (fgets(line, sizeof(line), f)) {
+        double t, magDeg, cogDeg = 0, sog = 0;
+        int    got = sscanf(line, "%lf,%lf,%lf,%lf", &t, &magDeg, &cogDeg, &sog);
+        if (got < 2) continue;   // header, comments
+        uint32_t t_us = (uint32_t)(t * 1000);
+        double   t0   = seconds();
+        if (got == 4) {
+            fix.valid    = true;
+            fix.rx_ms    = (uint32_t)t;
+            fix.cog_cdeg = (uint16_t)lround(wrap360(cogDeg) * 100) % 36000;
+            fix.sog_cms  = (uint16_t)std::min(sog, 65535.0);
+            hf.gps(fix, t_us);
+        }
+        hf.mag((float)magDeg, t_us);
+        spent += seconds() - t0;
+        printf("%.0f,%.2f,%.2f,%.2f\n", t, hf.heading(t_us), hf.rate(), hf.sigma());
+        lines++;
+    }
+    fclose(f);
+    HeadingStats s = hf.stats();
+    fprintf(stderr, "%u lines, %.0f ns per update; compass %u used %u rejected %u re-acquired; COG %u used %u skipped\n",
+            (unsigned)lines, lines ? spent / lines * 1e9 : 0.0, (unsigned)s.mag, (unsigned)s.mag_rejected,
+            (unsigned)s.reacquired, (unsigned)s.gps, (unsigned)s.gps_skipped);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) return replay(argv[1]);
+    hal_host_reset();
+
+    printf("\n=== Heading fusion: %d min, compass %d Hz, GPS %d Hz, control %d Hz ===\n", SIM_MINUTES,
+           1000000 / MAG_PERIOD_US, 1000000 / GPS_PERIOD_US, LOOP_RATE_HZ);
+
+    std::mt19937                     rng(5);
+    std::normal_distribution<double> g(0.0, 1.0);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    Buoy          buoy(3);
+    HeadingFilter hf;
+    LibSmoothing  lib;
+    Score         sRaw, sLib, sKf;
+    double        raw = 0, smoothed = 0, distUntil = -1, distNext = 30, distBias = 0;
+    bool          inEvent = false;
+    const double  setDeg = 4.0;
+
+    uint32_t t_us = 0, end_us = (uint32_t)(SIM_MINUTES * 60 * 1e6);
+    for (; t_us < end_us; t_us += SIM_STEP_US) {
+        buoy.step(SIM_STEP_US * 1e-6);
+        double t = t_us * 1e-6;
+        if (t >= distNext) {
+            distUntil = t + DIST_S;
+            distBias  = u(rng) < 0.5 ? -DIST_DEG : DIST_DEG;
+            distNext  = t + 40 + 40 * u(rng);
+            inEvent   = true;
+        }
+        bool disturbed = t < distUntil;
+        bool clean     = t >= distUntil + 2.0;
+        if (inEvent && clean) {
+            sRaw.endEvent();
+            sLib.endEvent();
+            sKf.endEvent();
+            inEvent = false;
+        }
+
+        if (t_us % MAG_PERIOD_US == 0) {
+            double roll = 0.7 * 6.0 * sin(2 * M_PI * 0.37 * t);   // °, tilt error ~ roll·tan(incl)·sin
+            double m    = buoy.heading() + 2.5 * g(rng) + roll * sin(buoy.yaw * M_PI / 180) +
+                          (disturbed ? distBias : 0.0);
+            raw      = wrap360(m);
+            smoothed = lib.add(raw);
+            hf.mag((float)raw, t_us);
+        }
+        if (t_us % GPS_PERIOD_US == 0 && t_us > 0) {
+            GpsFix fix = {};
+            fix.valid   = true;
+            fix.rx_ms   = t_us / 1000;
+            fix.sog_cms = (uint16_t)(buoy.sog * 100);
+            double sigma = atan2(0.1, std::max(buoy.sog, 0.01)) * 180 / M_PI;
+            fix.cog_cdeg      = (uint16_t)lround(wrap360(buoy.cogLagged + setDeg + sigma * g(rng)) * 100) % 36000;
+            fix.head_acc_cdeg = (uint16_t)std::min(sigma * 100, 18000.0);
+            hf.gps(fix, t_us);
+        }
+        if (t_us % CONTROL_PERIOD_US == 0 && t > 10) {
+            double truth = buoy.heading(), r = buoy.headingRate();
+            sRaw.add(raw, truth, r, clean);
+            sLib.add(smoothed, truth, r, clean);
+            sKf.add(hf.heading(t_us), truth, r, clean);
+        }
+    }
+
+    HeadingStats hs = hf.stats();
+    printf("  %d disturbances; compass %u used, %u rejected, %u re-acquired; COG %u used, %u skipped\n",
+           sKf.events, (unsigned)hs.mag, (unsigned)hs.mag_rejected, (unsigned)hs.reacquired,
+           (unsigned)hs.gps, (unsigned)hs.gps_skipped);
+    printf("  course offset estimate %.1f° (current set %.1f°)\n", hf.offset(), setDeg);
+    printf("\n  %-10s %9s %9s %9s   %s\n", "heading", "RMS", "max", "lag", "disturbances: mean peak, kept < 8°");
+    const char*  names[3]  = { "raw", "smoothed", "filter" };
+    const Score* scores[3] = { &sRaw, &sLib, &sKf };
+    for (int i = 0; i < 3; i++)
+        printf("  %-10s %8.2f° %8.2f° %6.0f ms   %5.1f°  %d / %d\n", names[i], scores[i]->rms(), scores[i]->max,
+               scores[i]->lagMs(), scores[i]->meanPeak(), scores[i]->held, scores[i]->events);
+
+    // Cost: one compass update (predict + update) and one control-step read
+    const int N = 2000000;
+    HeadingFilter bench;
+    float         samples[256];
+    for (int i = 0; i < 256; i++) samples[i] = (float)wrap360(90 + 2.5 * g(rng));
+    double t0 = seconds();
+    for (int i = 0; i < N; i++) bench.mag(samples[i & 255], (uint32_t)i * MAG_PERIOD_US);
+    double tMag = (seconds() - t0) / N;
+    volatile float sink = 0;
+    t0 = seconds();
+    for (int i = 0; i < N; i++) sink = sink + bench.heading((uint32_t)(N - 1) * MAG_PERIOD_US + (i & 1023) * 10);
+    double tRead = (seconds() - t0) / N;
+    printf("\n  cost: mag() %.1f ns, heading() %.1f ns, sizeof(HeadingFilter) %zu B\n", tMag * 1e9, tRead * 1e9,
+           sizeof(HeadingFilter));
+
+    printf("\n");
+    check(sKf.rms() <= 1.1 * sLib.rms(), "filter RMS within 10% of library smoothing");
+    check(sKf.lagMs() <= sLib.lagMs(), "filter lag no worse than library smoothing");
+    check(sKf.meanPeak() <= 0.5 * sLib.meanPeak(), "disturbance peak ≤ 1/2 of library smoothing");
+    check(sKf.held * 2 >= sKf.events, "≥ 1/2 of the disturbances kept under 8° (library smoothing: none)");
+    check(fabs(hf.offset() - setDeg) < 2.0, "course offset converges on the current set");
+    check(tMag < 1e-6, "compass update < 1 µs on host");
+
+    return check_summary();
+}
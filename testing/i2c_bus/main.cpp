@@ -0,0 +1,334 @@
+// Shared I2C Bus Benchmark — host (platform = native)
+//
+// Run:  pio run -e i2c_bus -t exec
+//
+// One I2C bus (400 kHz), two devices, as on the compass/wind sketches:
+//
+//   compass   QMC5883L read every 20 ms (50 Hz heading): write register 0x00, read 6 bytes
+//   oled      SSD1306 frame every ~200 ms (5 Hz): a few text cells change per
+//             frame, and every 2 s the screen switches (invalidate → whole frame)
+//
+// Two ways to share it, 60 s of virtual time each:
+//
+//   legacy     loop() reads the compass, then Adafruit display() blocks for the
+//              whole 1 KB frame (127-byte writes) — the read due meanwhile waits
+//   bus        I2cBus, compass HIGH, OledFlush::attachBus() at LOW
+//
+// The bus is serviced as its task would be: OLED flusher queues one run,
+// bus runs one transaction, the loop's compass read is queued when due.
+// Compass latency = read completed − read due.
+//
+// The OLED keeps a single run queued, so with two devices even round-robin
+// would bound the wait; priority keeps that bound when a device queues
+// deeper — checked separately with a LOW device holding a full queue of
+// 64-byte writes.
+//
+// Reports compass latency p50/p99/max and the bus's per-device accounting
+// (transactions, bytes, bus time, utilisation, queue wait). Pass criteria:
+// prioritised compass latency never exceeds one OLED run + one read (2 ms);
+// p99 at least 10× better than legacy; panel RAM matches the last frame;
+// per-device byte counts match what the devices saw on the wire; the
+// utilisation breakdown sums to the bus's busy time.
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "common/config.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/compass/qmc5883l.h"
+#include "firmware/common/i2c/i2c_bus.h"
+#include "firmware/common/display/oled_flush.h"
+#include "testing/check.h"
+
+#define RUN_US           60000000u
+#define COMPASS_EVERY_US 20000u
+#define FRAME_EVERY_US   199300u     // not phase-locked to the compass
+#define SCREEN_EVERY     10          // frames between screen switches
+#define ADAFRUIT_WIRE_MAX 128
+
+static uint32_t rngState = 5;
+static uint32_t rnd(uint32_t n) {
+    rngState = rngState * 1664525u + 1013904223u;
+    return (rngState >> 8) % n;
+}
+
+// ---------------------------------------------------------------------------
+// Devices
+class CompassModel : public HostI2cDevice {
+public:
+    uint64_t bytes = 0;
+    uint32_t reads = 0;
+    bool onWrite(const uint8_t*, size_t len) override { bytes += len + 1; return true; }
+    bool onRead(uint8_t* d, size_t len) override {
+        for (size_t i = 0; i < len; i++) d[i] = (uint8_t)(reads + i);
+        bytes += len + 1;
+        reads++;
+        return true;
+    }
+};
+
+// SSD1306: horizontal addressing, column/page window
+class Ssd1306Model : public HostI2cDevice {
+public:
+    uint8_t  ram[OLED_FRAME_BYTES] = {};
+    uint64_t bytes = 0;
+
+    bool onWrite(const uint8_t* d, size_t len) override {
+        bytes += len + 1;
+        if (len == 0) return true;
+        if (d[0] == 0x40) {
+            for (size_t i = 1; i < len; i++) {
+                ram[page * OLED_WIDTH + col] = d[i];
+                if (col++ == colEnd) {
+                    col = colStart;
+                    if (page++ == pageEnd) page = pageStart;
+                }
+            }
+            return true;
+        }
+        for (size_t i = 1; i < len; i++) command(d[i]);
+        return true;
+    }
+    bool onRead(uint8_t*, size_t) override { return false; }
+
+private:
+    uint8_t colStart = 0, colEnd = OLED_WIDTH - 1, pageStart = 0, pageEnd = OLED_PAGES - 1;
+    uint8_t col = 0, page = 0;
+    uint8_t pending = 0, argc = 0, args[2] = {};
+
+    void command(uint8_t c) {
+        if (pending) {
+            args[argc++] = c;
+            if (argc < 2) return;
+            if (pending == 0x21) { colStart = args[0] & 0x7F; colEnd = args[1] & 0x7F; col = colStart; }
+            else                 { pageStart = args[0] & 7; pageEnd = args[1] & 7; page = pageStart; }
+            pending = 0;
+            return;
+        }
+        if (c == 0x21 || c == 0x22) { pending = c; argc = 0; }
+    }
+};
+
+static CompassModel compassDev;
+static Ssd1306Model panel;
+
+// ---------------------------------------------------------------------------
+// Frames: 6-column text cells; a few change per frame, all on a screen switch
+static uint8_t frame[OLED_FRAME_BYTES];
+
+static void nextFrame(int i) {
+    if (i % SCREEN_EVERY == 0) {
+        for (size_t k = 0; k < OLED_FRAME_BYTES; k++) frame[k] = (uint8_t)rnd(256);
+        return;
+    }
+    for (int c = 0; c < 4; c++) {
+        uint32_t cell = rnd(OLED_FRAME_BYTES / 6);
+        for (int k = 0; k < 5; k++) frame[cell * 6 + k] = (uint8_t)rnd(256);
+    }
+}
+
+// Adafruit_SSD1306::display() transaction pattern
+static void fullDisplay(const uint8_t* f) {
+    const uint8_t dlist1[] = { 0x00, 0x22, 0x00, 0xFF, 0x21, 0x00 };
+    const uint8_t colEnd[] = { 0x00, OLED_WIDTH - 1 };
+    hal_i2c_write(OLED_ADDRESS, dlist1, sizeof(dlist1));
+    hal_i2c_write(OLED_ADDRESS, colEnd, sizeof(colEnd));
+    uint8_t buf[ADAFRUIT_WIRE_MAX];
+    for (size_t off = 0; off < OLED_FRAME_BYTES; off += ADAFRUIT_WIRE_MAX - 1) {
+        size_t n = std::min((size_t)(ADAFRUIT_WIRE_MAX - 1), OLED_FRAME_BYTES - off);
+        buf[0] = 0x40;
+        memcpy(buf + 1, f + off, n);
+        hal_i2c_write(OLED_ADDRESS, buf, n + 1);
+    }
+}
+
+// ---------------------------------------------------------------------------
+struct Latency {
+    std::vector<uint32_t> us;
+    uint32_t pct(double p) {
+        std::sort(us.begin(), us.end());
+        return us.empty() ? 0 : us[std::min(us.size() - 1, (size_t)(p * us.size()))];
+    }
+};
+
+static void reset() {
+    hal_host_reset();
+    compassDev = CompassModel();
+    panel      = Ssd1306Model();
+    hal_host_i2c_attach(COMPASS_ADDR, &compassDev);
+    hal_host_i2c_attach(OLED_ADDRESS, &panel);
+    rngState = 5;
+    memset(frame, 0, sizeof(frame));
+}
+
+static const uint8_t COMPASS_REG[] = { QMC5883L_REG_DATA };
+
+static Latency runLegacy() {
+    reset();
+    Latency  lat;
+    uint32_t compassDue = 0, frameDue = 0;
+    int      frames = 0;
+    uint8_t  raw[6];
+    while (hal_micros() < RUN_US) {
+        uint32_t now = hal_micros();
+        uint32_t next = std::min(compassDue, frameDue);
+        if (now < next) hal_host_advance_us(next - now);
+        if (hal_micros() >= compassDue) {
+            hal_i2c_write(COMPASS_ADDR, COMPASS_REG, sizeof(COMPASS_REG));
+            hal_i2c_read(COMPASS_ADDR, raw, sizeof(raw));
+            lat.us.push_back(hal_micros() - compassDue);
+            compassDue += COMPASS_EVERY_US;
+        }
+        if (hal_micros() >= frameDue) {
+            nextFrame(frames++);
+            fullDisplay(frame);
+            frameDue += FRAME_EVERY_US;
+        }
+    }
+    return lat;
+}
+
+struct CompassRead {
+    uint8_t   raw[6];
+    uint32_t  due;
+    bool      busy;
+    Latency*  lat;
+};
+
+static void compassDone(void* ctx, bool ok) {
+    CompassRead* r = static_cast<CompassRead*>(ctx);
+    if (ok) r->lat->us.push_back(hal_micros() - r->due);
+    r->busy = false;
+}
+
+static const char* PRIO_NAME[] = { "LOW", "NORMAL", "HIGH" };
+
+static Latency runBus() {
+    reset();
+    I2cBus    bus;
+    OledFlush oled;
+    int compass = bus.addDevice("compass", COMPASS_ADDR, I2C_PRIO_HIGH);
+    oled.attachBus(bus, I2C_PRIO_LOW);
+    bus.resetStats();
+
+    Latency     lat;
+    CompassRead rd = {};
+    rd.lat = &lat;
+    uint32_t compassDue = 0, frameDue = 0;
+    int      frames = 0;
+    while (hal_micros() < RUN_US || !oled.idle() || bus.pending()) {
+        uint32_t now = hal_micros();
+        if (now < RUN_US && now >= compassDue && !rd.busy) {
+            rd.due  = compassDue;
+            rd.busy = true;
+            I2cTxn t = { COMPASS_REG, sizeof(COMPASS_REG), rd.raw, sizeof(rd.raw), compassDone, &rd, 0 };
+            bus.submit(compass, t);
+            compassDue += COMPASS_EVERY_US;
+        }
+        if (now < RUN_US && now >= frameDue) {
+            nextFrame(frames);
+            if (frames++ % SCREEN_EVERY == 0) oled.invalidate();
+            oled.submit(frame);
+            frameDue += FRAME_EVERY_US;
+        }
+        oled.service();
+        if (bus.service()) continue;
+        if (!oled.idle()) continue;
+        uint32_t next = std::min(compassDue, frameDue);
+        if (next > now) hal_host_advance_us(next - now);
+        else if (now >= RUN_US) break;
+    }
+
+    uint32_t window = bus.windowUs(), busy = 0;
+    printf("\n  %-8s %4s %-6s %7s %8s %8s %6s %9s %9s\n",
+           "device", "addr", "prio", "txns", "bytes", "bus ms", "util", "wait avg", "wait max");
+    for (int i = 0; i < bus.devices(); i++) {
+        I2cDeviceStats s = bus.deviceStats(i);
+        busy += s.bus_us;
+        printf("  %-8s 0x%02X %-6s %7u %8u %8.1f %5.2f%% %6.0f us %6u us\n",
+               s.name, s.addr, PRIO_NAME[s.priority], (unsigned)s.txns, (unsigned)s.bytes,
+               s.bus_us / 1000.0, 100.0 * s.bus_us / window,
+               s.txns ? (double)s.wait_total_us / s.txns : 0.0, (unsigned)s.wait_max_us);
+    }
+    printf("  bus busy %.2f%% of %.1f s\n\n", 100.0 * busy / window, window / 1e6);
+
+    I2cDeviceStats c = bus.deviceStats(compass), o = bus.deviceStats(compass + 1);
+    check(c.bytes == compassDev.bytes && o.bytes == panel.bytes, "per-device bytes match the devices' own counts");
+    check(c.errors == 0 && o.errors == 0 && c.rejected == 0 && o.rejected == 0, "no errors, no rejected submits");
+    check(c.txns == RUN_US / COMPASS_EVERY_US && compassDev.reads == c.txns, "every compass read ran");
+    // 400 kHz: 9 bit times per byte → bus time follows from bytes alone
+    uint32_t expect = (uint32_t)((c.bytes + o.bytes) * 9 * 1000000ull / 400000);
+    check(busy <= window && (busy > expect ? busy - expect : expect - busy) <= expect / 100,
+          "utilisation breakdown sums to the bus busy time");
+    check(memcmp(panel.ram, frame, OLED_FRAME_BYTES) == 0, "panel RAM matches the last frame");
+    return lat;
+}
+
+// A LOW device with a full queue: the compass read goes next, not ninth
+class SinkModel : public HostI2cDevice {
+public:
+    bool onWrite(const uint8_t*, size_t) override { return true; }
+    bool onRead(uint8_t*, size_t) override { return false; }
+};
+
+static void preemptCheck() {
+    reset();
+    SinkModel sink;
+    hal_host_i2c_attach(0x50, &sink);
+    I2cBus  bus;
+    int     compass = bus.addDevice("compass", COMPASS_ADDR, I2C_PRIO_HIGH);
+    int     logger  = bus.addDevice("logger", 0x50, I2C_PRIO_LOW);
+    uint8_t block[64] = {}, raw[6];
+    I2cTxn  w = { block, sizeof(block), nullptr, 0, nullptr, nullptr, 0 };
+    while (bus.submit(logger, w)) {}
+    bus.service();                                   // first block on the wire
+    I2cTxn  r = { COMPASS_REG, sizeof(COMPASS_REG), raw, sizeof(raw), nullptr, nullptr, 0 };
+    bus.submit(compass, r);
+    bus.service();
+    check(compassDev.reads == 1 && bus.deviceStats(logger).txns == 1,
+          "HIGH read runs right after the transfer in progress, ahead of 7 queued LOW writes");
+    while (bus.service()) {}
+}
+
+// Blocking transfer(): no bus task on host, so it runs the queue itself
+static void transferCheck() {
+    reset();
+    I2cBus  bus;
+    int     compass = bus.addDevice("compass", COMPASS_ADDR, I2C_PRIO_HIGH);
+    int     ghost   = bus.addDevice("absent", 0x50, I2C_PRIO_NORMAL);
+    uint8_t raw[6] = {};
+    check(bus.transfer(compass, COMPASS_REG, sizeof(COMPASS_REG), raw, sizeof(raw)) && raw[1] == 1,
+          "transfer() blocks until the read lands");
+    int16_t x = 0, y = 0, z = 0;
+    check(qmc5883l_read(bus, compass, &x, &y, &z) && x == 0x0201 && y == 0x0403 && z == 0x0605,
+          "qmc5883l_read() is one register read, X/Y/Z little-endian");
+    check(!bus.transfer(ghost, COMPASS_REG, sizeof(COMPASS_REG)) && bus.deviceStats(ghost).errors == 1,
+          "transfer() to an absent device fails and is counted");
+    I2cTxn t = { COMPASS_REG, sizeof(COMPASS_REG), nullptr, 0, nullptr, nullptr, 0 };
+    int queued = 0;
+    while (bus.submit(compass, t)) queued++;
+    check(queued == I2C_BUS_QUEUE && bus.deviceStats(compass).rejected == 1, "full device queue rejects the submit");
+    while (bus.service()) {}
+}
+
+int main() {
+    printf("\n=== Shared I2C bus: compass 50 Hz + OLED 5 Hz, %u s ===\n", RUN_US / 1000000u);
+
+    Latency legacy = runLegacy();
+    uint32_t legacyBytes = (uint32_t)panel.bytes;
+    printf("\n-- bus: compass HIGH, oled LOW --");
+    Latency prio   = runBus();
+    uint32_t busBytes = (uint32_t)panel.bytes;
+
+    printf("  %-10s %9s %9s %9s %12s\n", "compass", "p50 us", "p99 us", "max us", "oled bytes");
+    printf("  %-10s %9u %9u %9u %12u\n", "legacy", legacy.pct(0.5), legacy.pct(0.99), legacy.pct(1.0), legacyBytes);
+    printf("  %-10s %9u %9u %9u %12u\n\n", "bus", prio.pct(0.5), prio.pct(0.99), prio.pct(1.0), busBytes);
+
+    check(prio.pct(1.0) <= 2000, "prioritised compass read waits at most one OLED run (≤ 2 ms)");
+    check(prio.pct(0.99) * 10 <= legacy.pct(0.99), "p99 compass latency ≥ 10× better than blocking display()");
+    preemptCheck();
+    transferCheck();
+
+    return check_summary();
+}
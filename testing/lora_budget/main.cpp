@@ -0,0 +1,67 @@
+// LoRa Airtime and Link Budget Report — host (platform = native)
+//
+// Run:  pio run -e lora_budget -t exec
+//
+// Prints the compile-time figures from common/lora_budget.h:
+//   1. Per-packet-type time-on-air and channel-saturated message rate for
+//      the modem in config.h
+//   2. The TDMA_CONFIG_DEFAULT superframe: per-slave telemetry rate, duty
+//      cycle per node, channel load, against the config.h budget
+//   3. A sweep over SF7–SF12 × 125/250/500 kHz: STATUS airtime, superframe,
+//      per-slave rate, sensitivity, link budget, free-space range, and
+//      whether that modem would pass the build-time budget checks
+//
+// Everything in tables 1–2 is a constant expression; the static_asserts at
+// the bottom of lora_budget.h already passed for this binary to build.
+
+#include <stdio.h>
+#include "common/config.h"
+#include "common/lora_budget.h"
+
+static bool fitsBudget(const LoRaModem& m) {
+    return lora_bw_log_cdb(m.bw_hz) != 0 &&
+           lora_max_airtime_us(lora_packet_airtimes(m)) <= LORA_MAX_DWELL_MS * 1000UL &&
+           tdma_slot_rate_mhz(m, TDMA_CONFIG_DEFAULT) >= TELEMETRY_RATE_MIN_MHZ &&
+           tdma_master_duty_permille(m, TDMA_CONFIG_DEFAULT) <= 10 * LORA_DUTY_CYCLE_MAX_PCT &&
+           tdma_slave_duty_permille(m, TDMA_CONFIG_DEFAULT) <= 10 * LORA_DUTY_CYCLE_MAX_PCT &&
+           tdma_channel_load_permille(m, TDMA_CONFIG_DEFAULT) <= 10 * LORA_CHANNEL_LOAD_MAX_PCT;
+}
+
+int main() {
+    const LoRaModem& m = LORA_MODEM_DEFAULT;
+    printf("LoRa budget — SF%u, %lu Hz, CR4/%u, preamble %u, %d dBm, %d dBi antennas, %.1f MHz\n\n",
+           m.sf, (unsigned long)m.bw_hz, m.cr_denom, m.preamble, LORA_TX_POWER_DBM, LORA_ANT_GAIN_DBI, LORA_FREQ);
+
+    printf("%-14s %4s %6s %10s %11s\n", "packet", "type", "bytes", "airtime ms", "max msg/s");
+    for (int i = 0; i < LORA_PACKET_TYPE_COUNT; i++) {
+        const PacketAirtime& p = LORA_PACKET_AIRTIMES.entry[i];
+        printf("%-14s 0x%02X %6u %10.2f %11.2f\n", p.name, p.type, p.size, p.toa_us / 1000.0, p.max_rate_mhz / 1000.0);
+    }
+
+    const TdmaConfig& c = TDMA_CONFIG_DEFAULT;
+    printf("\nTDMA_CONFIG_DEFAULT: %u slaves x %u B, downlink %u B, %u RC sub-slots\n",
+           c.uplink_slots, c.uplink_len, c.downlink_len, c.contention_slots);
+    printf("  superframe        %8.2f ms\n", tdma_superframe_us(m, c) / 1000.0);
+    printf("  per-slave rate    %8.2f Hz   (min %.2f)\n", tdma_slot_rate_mhz(m, c) / 1000.0, TELEMETRY_RATE_MIN_MHZ / 1000.0);
+    printf("  master duty       %8.1f %%    (max %d)\n", tdma_master_duty_permille(m, c) / 10.0, LORA_DUTY_CYCLE_MAX_PCT);
+    printf("  slave duty        %8.1f %%    (max %d)\n", tdma_slave_duty_permille(m, c) / 10.0, LORA_DUTY_CYCLE_MAX_PCT);
+    printf("  channel load      %8.1f %%    (max %d)\n", tdma_channel_load_permille(m, c) / 10.0, LORA_CHANNEL_LOAD_MAX_PCT);
+    printf("  longest frame     %8.2f ms   (dwell max %d)\n",
+           lora_max_airtime_us(LORA_PACKET_AIRTIMES) / 1000.0, LORA_MAX_DWELL_MS);
+
+    printf("\n%4s %7s %10s %11s %9s %12s %11s %10s %7s\n",
+           "SF", "BW kHz", "STATUS ms", "superframe", "slave Hz", "sensitivity", "budget dB", "FS range", "budget");
+    static const uint32_t BWS[] = { 125000, 250000, 500000 };
+    for (uint8_t sf = 7; sf <= 12; sf++) {
+        for (size_t b = 0; b < sizeof(BWS) / sizeof(BWS[0]); b++) {
+            LoRaModem s = lora_modem(sf, BWS[b], LORA_CR_DENOM, LORA_PREAMBLE);
+            int32_t budget = lora_link_budget_cdb(s, LORA_TX_POWER_DBM, LORA_ANT_GAIN_DBI);
+            printf("%4u %7lu %10.2f %8.0f ms %9.2f %8.1f dBm %11.1f %7.1f km %7s\n",
+                   sf, (unsigned long)(BWS[b] / 1000), lora_time_on_air_us(s, sizeof(StatusPacket)) / 1000.0,
+                   tdma_superframe_us(s, TDMA_CONFIG_DEFAULT) / 1000.0, tdma_slot_rate_mhz(s, TDMA_CONFIG_DEFAULT) / 1000.0,
+                   lora_sensitivity_cdbm(s) / 100.0, budget / 100.0,
+                   lora_free_space_range_m(budget, (float)LORA_FREQ) / 1000.0f, fitsBudget(s) ? "ok" : "FAIL");
+        }
+    }
+    return 0;
+}
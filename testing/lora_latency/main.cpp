@@ -0,0 +1,304 @@
+// LoRa Async Driver Latency — host (platform = native)
+//
+// Run:  pio run -e lora_latency -t exec
+//
+// Drives firmware/common/lora/lora_async.cpp over HostRadio on the virtual
+// clock. Incoming STATUS frames arrive back-to-back with random gaps
+// (mean 60 ms after the previous frame's airtime); the nav loop runs at
+// LOOP_RATE_HZ and queues a STATUS every TX_EVERY_NAV iterations, plus a
+// burst of three every 5 s.
+//
+//   poll() in nav loop — poll() called once per nav iteration
+//   poll() at 1 kHz    — poll() in a radio task, nav loop only drains the ring
+//   blocking           — the lora_test_tx pattern: send(), waitPacketSent(),
+//                        waitAvailableTimeout(3000) inside the nav loop
+//
+// Histograms: RX-done IRQ → frame handed to the nav loop, send() → on air,
+// and nav-loop stall (virtual time the loop spends inside radio calls).
+// Also reports host CPU ns per poll/send/receive call.
+//
+// Pass criteria: async nav-loop stall is zero; frames keep their RSSI/SNR;
+// with a 1 kHz poll every frame reaches the nav loop within one nav period
+// with no drops or overruns; when a frame is overwritten before poll(), the
+// survivor keeps its own RX-done stamp and the lost one is a single overrun.
+// HostRadio holds one RX frame, as RH_RF95 does.
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include "common/config.h"
+#include "common/protocol.h"
+#include "common/packet_codec.h"
+#include "common/lora_airtime.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/lora/lora_async.h"
+#include "testing/check.h"
+
+#define SIM_SECONDS      600
+#define ARRIVAL_GAP_MS   60.0
+#define NAV_PERIOD_US    (1000000 / LOOP_RATE_HZ)
+#define FAST_POLL_US     1000
+#define TX_EVERY_NAV     5
+
+static uint64_t rngState = 99;
+static double uniform01() {
+    rngState = rngState * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (rngState >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static const uint32_t STATUS_US = lora_time_on_air_us(LORA_MODEM_DEFAULT, sizeof(StatusPacket));
+
+// ---------------------------------------------------------------------------
+// Log-spaced histogram in µs
+// ---------------------------------------------------------------------------
+static const uint32_t EDGES_US[] = { 100, 500, 1000, 2000, 5000, 10000, 20000, 50000,
+                                     100000, 200000, 500000, 1000000, 3100000 };
+#define BUCKETS (sizeof(EDGES_US) / sizeof(EDGES_US[0]) + 1)
+#define MAX_SAMPLES 100000
+
+struct Histogram {
+    uint32_t count[BUCKETS];
+    uint32_t samples[MAX_SAMPLES];
+    uint32_t n;
+
+    void add(uint32_t us) {
+        size_t b = 0;
+        while (b < BUCKETS - 1 && us >= EDGES_US[b]) b++;
+        count[b]++;
+        if (n < MAX_SAMPLES) samples[n++] = us;
+    }
+    uint32_t pct(double p) {
+        if (n == 0) return 0;
+        static uint32_t sorted[MAX_SAMPLES];
+        memcpy(sorted, samples, n * sizeof(uint32_t));
+        for (uint32_t gap = n / 2; gap > 0; gap /= 2)
+            for (uint32_t i = gap; i < n; i++)
+                for (uint32_t j = i; j >= gap && sorted[j - gap] > sorted[j]; j -= gap) {
+                    uint32_t t = sorted[j]; sorted[j] = sorted[j - gap]; sorted[j - gap] = t;
+                }
+        return sorted[(uint32_t)(p * (n - 1))];
+    }
+};
+
+static void printHistograms(const char* title, Histogram* h[], const char* names[], int cols) {
+    printf("\n%s\n%-14s", title, "bucket");
+    for (int c = 0; c < cols; c++) printf(" %14s", names[c]);
+    printf("\n");
+    for (size_t b = 0; b < BUCKETS; b++) {
+        char label[32];
+        double lo = b == 0 ? 0.0 : EDGES_US[b - 1] / 1000.0;
+        if (b < BUCKETS - 1) snprintf(label, sizeof(label), "%g-%g ms", lo, EDGES_US[b] / 1000.0);
+        else                 snprintf(label, sizeof(label), ">= %g ms", lo);
+        printf("%-14s", label);
+        for (int c = 0; c < cols; c++) printf(" %14u", h[c]->count[b]);
+        printf("\n");
+    }
+    const char* pn[] = { "p50 ms", "p99 ms", "max ms" };
+    const double pv[] = { 0.5, 0.99, 1.0 };
+    for (int p = 0; p < 3; p++) {
+        printf("%-14s", pn[p]);
+        for (int c = 0; c < cols; c++) printf(" %14.2f", h[c]->pct(pv[p]) / 1000.0);
+        printf("\n");
+    }
+}
+
+static double nowNs() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------------------------------------------------------------------------
+struct RunResult {
+    Histogram rx, tx, stall;
+    uint32_t  halfDuplexLost;
+    bool      stampsOk;
+    double    cpuNs;
+    uint32_t  cpuCalls;
+    LoraAsyncStats stats;
+};
+
+static StatusPacket makeStatus(uint16_t seq) {
+    StatusPacket p = { PKT_STATUS, BUOY_WINDWARD, 43.65f, -79.38f, seq, 148, 0 };
+    packet_seal(p);
+    return p;
+}
+
+// Async driver; pollUs = 0 → poll once per nav iteration
+static void runAsync(RunResult& r, uint32_t pollUs) {
+    hal_host_reset();
+    rngState = 99;
+    HostRadio radio;
+    radio.setSingleFrame(true);   // RH_RF95: one RX frame
+    LoraAsync lora(radio);
+    lora.begin();
+
+    const uint64_t end = (uint64_t)SIM_SECONDS * 1000000;
+    uint64_t nextArrival = 50000;
+    uint64_t nextNav     = 0;
+    uint64_t nextPoll    = pollUs ? 0 : end + 1;
+    static uint64_t queuedAt[65536];
+    uint16_t seq = 0, rxSeq = 0;
+    r.stampsOk = true;
+
+    while (true) {
+        uint64_t t = nextArrival;
+        if (nextNav < t)  t = nextNav;
+        if (nextPoll < t) t = nextPoll;
+        if (t >= end) break;
+        hal_host_advance_us((uint32_t)(t - hal_host_time_us()));
+
+        if (t == nextArrival) {
+            if (radio.txBusy()) {
+                r.halfDuplexLost++;
+            } else {
+                StatusPacket p = makeStatus(rxSeq++);
+                radio.inject((const uint8_t*)&p, sizeof(p), -70 - (int16_t)(rxSeq % 30), (int8_t)(rxSeq % 12));
+            }
+            nextArrival = t + STATUS_US + (uint64_t)(-log(1.0 - uniform01()) * ARRIVAL_GAP_MS * 1000.0);
+        }
+        if (t == nextPoll) {
+            double c0 = nowNs();
+            lora.poll();
+            r.cpuNs += nowNs() - c0;
+            r.cpuCalls++;
+            nextPoll += pollUs;
+        }
+        if (t == nextNav) {
+            uint64_t before = hal_host_time_us();
+            double c0 = nowNs();
+            if (!pollUs) lora.poll();
+            LoraRxFrame f;
+            while (lora.receive(&f)) {
+                r.rx.add((uint32_t)(hal_micros() - f.rx_us));
+                const StatusPacket* s = packet_view<StatusPacket>(f.data, f.len);
+                uint16_t id = s ? s->dist_to_target_cm : 0;
+                if (!s || f.rssi != -70 - (int16_t)((id + 1) % 30) || f.snr != (int8_t)((id + 1) % 12)) r.stampsOk = false;
+            }
+            uint64_t it = t / NAV_PERIOD_US;
+            int burst = it % (5 * LOOP_RATE_HZ) == 0 ? 3 : (it % TX_EVERY_NAV == 0 ? 1 : 0);
+            for (int i = 0; i < burst; i++) {
+                StatusPacket p = makeStatus(seq);
+                queuedAt[seq] = hal_host_time_us();
+                if (lora.send((const uint8_t*)&p, sizeof(p))) seq++;
+            }
+            r.cpuNs += nowNs() - c0;
+            r.cpuCalls++;
+            r.stall.add((uint32_t)(hal_host_time_us() - before));
+            nextNav += NAV_PERIOD_US;
+        }
+
+        HostRadio::Frame sent;
+        while (radio.popSent(&sent)) {
+            const StatusPacket* s = (const StatusPacket*)sent.data;
+            r.tx.add((uint32_t)(hal_host_time_us() - queuedAt[s->dist_to_target_cm]));
+        }
+    }
+    r.stats = lora.stats();
+}
+
+// Two RX-done IRQs before one poll(): the radio holds only the second frame,
+// which must carry the second stamp; the first counts as one overrun
+static bool overrunKeepsNewestStamp() {
+    hal_host_reset();
+    HostRadio radio;
+    radio.setSingleFrame(true);
+    LoraAsync lora(radio);
+    lora.begin();
+
+    StatusPacket a = makeStatus(1), b = makeStatus(2);
+    hal_host_advance_us(1000);
+    radio.inject((const uint8_t*)&a, sizeof(a));
+    hal_host_advance_us(STATUS_US + 500);
+    uint32_t stampB = hal_micros();
+    radio.inject((const uint8_t*)&b, sizeof(b));
+    hal_host_advance_us(2000);
+
+    lora.poll();
+    LoraRxFrame f;
+    bool got   = lora.receive(&f);
+    const StatusPacket* s = got ? packet_view<StatusPacket>(f.data, f.len) : nullptr;
+    bool newest = s && s->dist_to_target_cm == 2 && f.rx_us == stampB && !lora.receive(&f);
+    uint32_t overruns = lora.stats().rx_overruns;
+    lora.poll();   // no stamp may be left over to count again
+    return newest && overruns == 1 && lora.stats().rx_overruns == 1 && lora.stats().rx_frames == 1;
+}
+
+// lora_test_tx pattern in the nav loop: each send blocks for the airtime,
+// then for the reply (the next incoming frame) or the 3 s timeout.
+static void runBlocking(RunResult& r) {
+    hal_host_reset();
+    rngState = 99;
+    HostRadio radio;
+
+    const uint64_t end = (uint64_t)SIM_SECONDS * 1000000;
+    uint64_t nextArrival = 50000;
+    uint64_t nextNav     = 0;
+    for (uint64_t it = 0; nextNav < end; it++) {
+        if (hal_host_time_us() < nextNav) hal_host_advance_us((uint32_t)(nextNav - hal_host_time_us()));
+        uint64_t start = hal_host_time_us();
+
+        int sends = it % (5 * LOOP_RATE_HZ) == 0 ? 3 : (it % TX_EVERY_NAV == 0 ? 1 : 0);
+        for (int i = 0; i < sends; i++) {
+            StatusPacket p = makeStatus(0);
+            radio.send((const uint8_t*)&p, sizeof(p));
+            radio.waitPacketSent();
+            r.tx.add(0);
+
+            // frames that started while we were transmitting are lost
+            while (nextArrival < hal_host_time_us()) {
+                r.halfDuplexLost++;
+                nextArrival += STATUS_US + (uint64_t)(-log(1.0 - uniform01()) * ARRIVAL_GAP_MS * 1000.0);
+            }
+            uint64_t rxDone = nextArrival + STATUS_US;
+            if (rxDone - hal_host_time_us() <= 3000000) {
+                hal_host_advance_us((uint32_t)(rxDone - hal_host_time_us()));
+                r.rx.add(0);
+                nextArrival += STATUS_US + (uint64_t)(-log(1.0 - uniform01()) * ARRIVAL_GAP_MS * 1000.0);
+            } else {
+                hal_host_advance_us(3000000);
+            }
+        }
+        r.stall.add((uint32_t)(hal_host_time_us() - start));
+        nextNav += NAV_PERIOD_US;
+        if (hal_host_time_us() > nextNav) nextNav = hal_host_time_us();
+    }
+}
+
+int main() {
+    printf("LoRa async driver latency — %d s virtual, nav loop %d Hz, STATUS airtime %.2f ms\n",
+           SIM_SECONDS, LOOP_RATE_HZ, STATUS_US / 1000.0);
+
+    static RunResult navPoll, fastPoll, blocking;
+    runAsync(navPoll, 0);
+    runAsync(fastPoll, FAST_POLL_US);
+    runBlocking(blocking);
+
+    const char* names[] = { "poll in nav", "poll 1 kHz", "blocking" };
+    Histogram* rx[]    = { &navPoll.rx, &fastPoll.rx, &blocking.rx };
+    Histogram* tx[]    = { &navPoll.tx, &fastPoll.tx, &blocking.tx };
+    Histogram* stall[] = { &navPoll.stall, &fastPoll.stall, &blocking.stall };
+    printHistograms("RX-done IRQ timestamp -> frame read by the nav loop", rx, names, 2);
+    printHistograms("send() -> on air", tx, names, 2);
+    printHistograms("Nav-loop stall per iteration (virtual time inside radio calls)", stall, names, 3);
+
+    printf("\n%-14s %10s %10s %10s %10s %10s %10s %12s\n",
+           "", "rx frames", "rx drop", "overruns", "tx frames", "tx drop", "half-dup", "ns/call");
+    RunResult* rs[] = { &navPoll, &fastPoll };
+    for (int i = 0; i < 2; i++) {
+        printf("%-14s %10u %10u %10u %10u %10u %10u %12.1f\n", names[i],
+               rs[i]->stats.rx_frames, rs[i]->stats.rx_dropped, rs[i]->stats.rx_overruns,
+               rs[i]->stats.tx_frames, rs[i]->stats.tx_dropped, rs[i]->halfDuplexLost,
+               rs[i]->cpuNs / rs[i]->cpuCalls);
+    }
+    printf("%-14s %10u %10s %10s %10u %10s %10u %12s\n", names[2],
+           blocking.rx.n, "-", "-", blocking.tx.n, "-", blocking.halfDuplexLost, "-");
+    printf("\n");
+
+    check(navPoll.stall.pct(1.0) == 0 && fastPoll.stall.pct(1.0) == 0, "async nav loop never waits on the radio");
+    check(navPoll.stampsOk && fastPoll.stampsOk, "frames carry RSSI/SNR and decode intact");
+    check(fastPoll.rx.pct(1.0) <= NAV_PERIOD_US, "1 kHz poll: frame reaches the nav loop within one nav period");
+    check(fastPoll.stats.rx_dropped == 0 && fastPoll.stats.rx_overruns == 0, "1 kHz poll: no RX drops or overruns");
+    check(overrunKeepsNewestStamp(), "two RX IRQs before one poll: newest frame, its own stamp, one overrun");
+    return check_summary();
+}
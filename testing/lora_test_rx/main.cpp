@@ -1,9 +1,13 @@
 #include <Arduino.h>
 #include <SPI.h>
-#include <RH_RF95.h>
 #include "common/config.h"
+#include "common/lora_budget.h"
+#include "firmware/common/hal/rf95_radio.h"
+#include "firmware/common/lora/lora_async.h"
 
-RH_RF95 rf95(LORA_CS_PIN, LORA_IRQ_PIN);
+Rf95Driver rf95(LORA_CS_PIN, LORA_IRQ_PIN);
+Rf95Radio  radio(rf95);
+LoraAsync  lora(radio);
 
 void setup() {
     Serial.begin(115200);
@@ -29,37 +33,44 @@ void setup() {
         while (1);
     }
 
-    rf95.setTxPower(23, false);
-    rf95.setSpreadingFactor(7);
-    rf95.setSignalBandwidth(125000);
-    rf95.setCodingRate4(5);
+    rf95.setTxPower(LORA_TX_POWER_DBM, false);
+    rf95.setSpreadingFactor(LORA_SF);
+    rf95.setSignalBandwidth(LORA_BW_HZ);
+    rf95.setCodingRate4(LORA_CR_DENOM);
+    rf95.setPreambleLength(LORA_PREAMBLE);
+    lora.begin();
 
     Serial.print("LoRa initialized at ");
     Serial.print(LORA_FREQ);
     Serial.println(" MHz");
+    Serial.printf("SF%d, %lu Hz, CR4/%d — sensitivity %.1f dBm, link budget %.1f dB\n",
+                  LORA_SF, (unsigned long)LORA_BW_HZ, LORA_CR_DENOM,
+                  lora_sensitivity_cdbm(LORA_MODEM_DEFAULT) / 100.0f,
+                  lora_link_budget_cdb(LORA_MODEM_DEFAULT, LORA_TX_POWER_DBM, LORA_ANT_GAIN_DBI) / 100.0f);
     Serial.println("Waiting for packets...");
 }
 
 void loop() {
-    if (rf95.available()) {
-        uint8_t buf[RH_RF95_MAX_MESSAGE_LEN];
-        uint8_t len = sizeof(buf);
+    lora.poll();
 
-        if (rf95.recv(buf, &len)) {
-            buf[len] = '\0';
-            Serial.print("Received: ");
-            Serial.println((char*)buf);
-            Serial.print("RSSI: ");
-            Serial.println(rf95.lastRssi(), DEC);
-            Serial.print("SNR: ");
-            Serial.println(rf95.lastSNR(), DEC);
+    LoraRxFrame f;
+    if (lora.receive(&f)) {
+        Serial.print("Received: ");
+        Serial.write(f.data, f.len);
+        Serial.println();
+        Serial.printf("RSSI: %d  SNR: %d\n", f.rssi, f.snr);
 
-            char reply[] = "ACK from Slave";
-            rf95.send((uint8_t *)reply, strlen(reply));
-            rf95.waitPacketSent();
-            Serial.println("Sent reply");
-        } else {
-            Serial.println("Receive failed");
-        }
+        // Queued; poll() puts it on air once the radio is idle
+        static const char reply[] = "ACK from Slave";
+        if (lora.send((const uint8_t*)reply, sizeof(reply) - 1)) Serial.println("Queued reply");
+    }
+
+    static uint32_t lastStatsMs = 0;
+    if (millis() - lastStatsMs >= 10000) {
+        lastStatsMs = millis();
+        const LoraAsyncStats& st = lora.stats();
+        Serial.printf("rx %lu (dropped %lu, overruns %lu)  tx %lu (max wait %lu us)\n",
+                      (unsigned long)st.rx_frames, (unsigned long)st.rx_dropped, (unsigned long)st.rx_overruns,
+                      (unsigned long)st.tx_frames, (unsigned long)st.tx_wait_max_us);
     }
 }
@@ -1,9 +1,13 @@
 #include <Arduino.h>
 #include <SPI.h>
-#include <RH_RF95.h>
 #include "common/config.h"
+#include "common/lora_budget.h"
+#include "firmware/common/hal/rf95_radio.h"
+#include "firmware/common/lora/lora_async.h"
 
-RH_RF95 rf95(LORA_CS_PIN, LORA_IRQ_PIN);
+Rf95Driver rf95(LORA_CS_PIN, LORA_IRQ_PIN);
+Rf95Radio  radio(rf95);
+LoraAsync  lora(radio);
 
 void setup() {
     Serial.begin(115200);
@@ -29,46 +33,54 @@ void setup() {
         while (1);
     }
 
-    rf95.setTxPower(23, false);
-    rf95.setSpreadingFactor(7);
-    rf95.setSignalBandwidth(125000);
-    rf95.setCodingRate4(5);
+    rf95.setTxPower(LORA_TX_POWER_DBM, false);
+    rf95.setSpreadingFactor(LORA_SF);
+    rf95.setSignalBandwidth(LORA_BW_HZ);
+    rf95.setCodingRate4(LORA_CR_DENOM);
+    rf95.setPreambleLength(LORA_PREAMBLE);
+    lora.begin();
 
     Serial.print("LoRa initialized at ");
     Serial.print(LORA_FREQ);
     Serial.println(" MHz");
+    Serial.printf("SF%d, %lu Hz, CR4/%d — sensitivity %.1f dBm, link budget %.1f dB\n",
+                  LORA_SF, (unsigned long)LORA_BW_HZ, LORA_CR_DENOM,
+                  lora_sensitivity_cdbm(LORA_MODEM_DEFAULT) / 100.0f,
+                  lora_link_budget_cdb(LORA_MODEM_DEFAULT, LORA_TX_POWER_DBM, LORA_ANT_GAIN_DBI) / 100.0f);
 }
 
 uint16_t packetNum = 0;
+uint32_t lastSendMs = 0;
+uint32_t sentUs = 0;
+bool awaitingReply = false;
 
-void loop() {
-    char radiopacket[50];
-    sprintf(radiopacket, "Packet #%d - Test from Master", packetNum++);
-
-    Serial.print("Sending: ");
-    Serial.println(radiopacket);
+static void printFrame(const LoraRxFrame& f) {
+    Serial.print("Received: ");
+    Serial.write(f.data, f.len);
+    Serial.println();
+    Serial.printf("RSSI: %d  SNR: %d  RTT: %.1f ms\n", f.rssi, f.snr, (f.rx_us - sentUs) / 1000.0f);
+}
 
-    rf95.send((uint8_t *)radiopacket, strlen(radiopacket));
-    rf95.waitPacketSent();
+// Never blocks: poll() services the radio, send/receive only touch the rings.
+void loop() {
+    lora.poll();
 
-    uint8_t buf[RH_RF95_MAX_MESSAGE_LEN];
-    uint8_t len = sizeof(buf);
+    uint32_t now = millis();
+    if (now - lastSendMs >= 2000) {
+        if (awaitingReply) Serial.println("No reply, is receiver running?");
+        lastSendMs = now;
 
-    if (rf95.waitAvailableTimeout(3000)) {
-        if (rf95.recv(buf, &len)) {
-            buf[len] = '\0';
-            Serial.print("Received: ");
-            Serial.println((char*)buf);
-            Serial.print("RSSI: ");
-            Serial.println(rf95.lastRssi(), DEC);
-            Serial.print("SNR: ");
-            Serial.println(rf95.lastSNR(), DEC);
-        } else {
-            Serial.println("Receive failed");
-        }
-    } else {
-        Serial.println("No reply, is receiver running?");
+        char radiopacket[50];
+        int len = snprintf(radiopacket, sizeof(radiopacket), "Packet #%d - Test from Master", packetNum++);
+        Serial.print("Sending: ");
+        Serial.println(radiopacket);
+        sentUs = micros();
+        awaitingReply = lora.send((const uint8_t*)radiopacket, (uint8_t)len);
     }
 
-    delay(2000);
+    LoraRxFrame f;
+    if (lora.receive(&f)) {
+        printFrame(f);
+        awaitingReply = false;
+    }
 }
@@ -0,0 +1,316 @@
+// Magnetometer Calibration Check — host (platform = native)
+//
+// Run:  pio run -e mag_cal -t exec
+//
+// A QMC5883L on a buoy, simulated at 10 Hz: earth field 1500 counts at 65°
+// inclination, the hull yawing through all headings (anchor swing and
+// station-keeping turns) while waves roll it ±12° and pitch it ±8°. The
+// sensor sees it through a soft-iron matrix (scale 0.91…1.12, cross-axis
+// terms up to 8%) plus a hard-iron offset of ~550 counts, with 6 counts of
+// noise. Calibration quality is measured on a level 360° sweep, against the
+// heading of the undistorted field by the same atan2(y, x) formula, so only
+// the calibration is scored (not tilt).
+//
+// Scenarios:
+//   1. fresh buoy, 15 min of normal motion through add()/service() — vs raw
+//      readings and the old CALIBRATION_MODE min/max (first 2 min rotating)
+//   2. reboot: calibration restored from NVS bit-for-bit; a corrupted blob
+//      is refused
+//   3. payload change: new hard iron (+280 counts) and soft iron, 20 min more
+//   4. level-only yawing (no roll/pitch) from a fresh calibrator
+//   5. anchored in one direction (±20° swing): no calibration accepted
+//   6. cost: apply() + heading() per reading, add(), solve(); memory
+//
+// Pass criteria: sweep error ≤ 0.5° RMS / 1.0° max after scenario 1 and 3
+// (min/max is worse); restore exact; corrupted blob rejected; level-only
+// ≤ 1.0° max; narrow swing accepts nothing; hot path within 2× a bare
+// float atan2f on raw counts.
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include "common/config.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/compass/mag_cal.h"
+#include "testing/check.h"
+
+#define SAMPLE_MS       100
+#define FIELD           1500.0
+#define INCLINATION_DEG 65.0
+#define NOISE           6.0
+
+static double seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const double D2R = M_PI / 180.0;
+
+// ---------------------------------------------------------------------------
+// Sensor model
+struct Distortion {
+    double soft[3][3];
+    double hard[3];
+};
+
+static const Distortion HULL = {
+    { { 1.12, 0.08, -0.04 }, { 0.08, 0.91, 0.05 }, { -0.04, 0.05, 1.03 } },
+    { 420, -310, 180 },
+};
+static const Distortion HULL_RELOADED = {   // battery pack moved, bracket re-bent
+    { { 1.06, -0.05, 0.02 }, { -0.05, 0.95, 0.07 }, { 0.02, 0.07, 1.08 } },
+    { 640, -140, 60 },
+};
+
+// Body-frame field (x forward, y right, z down) for yaw / pitch / roll in degrees
+static void bodyField(double yaw, double pitch, double roll, double b[3]) {
+    double n = FIELD * cos(INCLINATION_DEG * D2R), d = FIELD * sin(INCLINATION_DEG * D2R);
+    double cy = cos(yaw * D2R), sy = sin(yaw * D2R), cp = cos(pitch * D2R), sp = sin(pitch * D2R);
+    double cr = cos(roll * D2R), sr = sin(roll * D2R);
+    // world (N, E, D) → body: Rx(roll)ᵀ·Ry(pitch)ᵀ·Rz(yaw)ᵀ
+    double x1 = cy * n, y1 = -sy * n, z1 = d;
+    double x2 = cp * x1 - sp * z1, z2 = sp * x1 + cp * z1;
+    b[0] = x2;
+    b[1] = cr * y1 + sr * z2;
+    b[2] = -sr * y1 + cr * z2;
+}
+
+static void sense(const Distortion& h, const double b[3], double noise, std::mt19937& rng, int16_t raw[3]) {
+    std::normal_distribution<double> g(0.0, noise);
+    for (int i = 0; i < 3; i++) {
+        double v = h.hard[i] + h.soft[i][0] * b[0] + h.soft[i][1] * b[1] + h.soft[i][2] * b[2];
+        raw[i]   = (int16_t)lround(v + (noise > 0 ? g(rng) : 0.0));
+    }
+}
+
+static double wrap180(double a) {
+    while (a > 180) a -= 360;
+    while (a < -180) a += 360;
+    return a;
+}
+
+static double truthHeading(const double b[3]) {
+    double h = atan2(b[1], b[0]) / D2R;
+    return h < 0 ? h + 360 : h;
+}
+
+// Level sweep: RMS and max heading error of a calibration function
+struct SweepErr {
+    double rms, max;
+};
+
+template <typename Heading>
+static SweepErr sweep(const Distortion& h, Heading heading) {
+    std::mt19937 rng(1);
+    double sum = 0, mx = 0;
+    for (int yaw = 0; yaw < 360; yaw++) {
+        double  b[3];
+        int16_t raw[3];
+        bodyField(yaw, 0, 0, b);
+        sense(h, b, 0, rng, raw);
+        double e = fabs(wrap180(heading(raw) - truthHeading(b)));
+        sum += e * e;
+        mx   = e > mx ? e : mx;
+    }
+    return { sqrt(sum / 360), mx };
+}
+
+// Buoy motion: yaw random walk with occasional full turns, wave roll/pitch
+struct Motion {
+    double       yaw = 0, yawRate = 0, t = 0;
+    double       rollAmp, pitchAmp, swingDeg;
+    std::mt19937 rng;
+
+    Motion(double roll, double pitch, double swing, uint32_t seed)
+        : rollAmp(roll), pitchAmp(pitch), swingDeg(swing), rng(seed) {}
+
+    void step(double b[3]) {
+        std::normal_distribution<double> g(0.0, 1.0);
+        t += SAMPLE_MS / 1000.0;
+        if (swingDeg > 0) {
+            yaw = swingDeg * sin(2 * M_PI * t / 47.0) + 2 * g(rng);
+        } else {
+            yawRate = 0.98 * yawRate + 0.6 * g(rng);                 // °/s, ~±10 °/s turns
+            yaw    += yawRate * SAMPLE_MS / 1000.0 + 0.6;            // plus a slow drift round
+        }
+        double roll  = rollAmp * sin(2 * M_PI * t / 3.1) + 0.2 * rollAmp * g(rng);
+        double pitch = pitchAmp * sin(2 * M_PI * t / 4.7 + 1.0) + 0.2 * pitchAmp * g(rng);
+        bodyField(yaw, pitch, roll, b);
+    }
+};
+
+// Feed `minutes` of motion through add()/service(); returns sample count
+static uint32_t run(MagCalibrator& cal, Motion& m, const Distortion& h, double minutes, std::mt19937& rng,
+                    uint32_t* clockMs) {
+    uint32_t n = (uint32_t)(minutes * 60000 / SAMPLE_MS);
+    for (uint32_t i = 0; i < n; i++) {
+        double  b[3];
+        int16_t raw[3];
+        m.step(b);
+        sense(h, b, NOISE, rng, raw);
+        cal.add(raw[0], raw[1], raw[2]);
+        *clockMs += SAMPLE_MS;
+        cal.service(*clockMs);
+    }
+    return n;
+}
+
+static void printCal(const char* name, const MagCal& c) {
+    printf("  %s: offset %.1f %.1f %.1f  field %.1f  rms %.4f  W [%.3f %.3f %.3f; %.3f %.3f %.3f; %.3f %.3f %.3f]\n",
+           name, c.offset[0], c.offset[1], c.offset[2], c.field, c.rms, c.soft[0], c.soft[1], c.soft[2],
+           c.soft[3], c.soft[4], c.soft[5], c.soft[6], c.soft[7], c.soft[8]);
+}
+
+static SweepErr sweepCal(const Distortion& h, const MagCalibrator& cal) {
+    return sweep(h, [&](const int16_t* r) { return (double)cal.heading(r[0], r[1], r[2]); });
+}
+
+// ---------------------------------------------------------------------------
+int main() {
+    hal_host_reset();
+    hal_host_nvs_erase();
+    std::mt19937 rng(42);
+    uint32_t     clockMs = 0;
+
+    // 1. Fresh buoy
+    printf("\n=== 1. Fresh buoy, 15 min of normal motion ===\n");
+    MagCalibrator cal;
+    Motion        sea(12, 8, 0, 7);
+
+    // Legacy CALIBRATION_MODE: min/max over the first 2 minutes of the same motion
+    int16_t mn[3] = { 32767, 32767, 32767 }, mx[3] = { -32768, -32768, -32768 };
+    {
+        Motion       copy = sea;
+        std::mt19937 r2   = rng;
+        for (int i = 0; i < 2 * 600; i++) {
+            double  b[3];
+            int16_t raw[3];
+            copy.step(b);
+            sense(HULL, b, NOISE, r2, raw);
+            for (int k = 0; k < 3; k++) {
+                if (raw[k] < mn[k]) mn[k] = raw[k];
+                if (raw[k] > mx[k]) mx[k] = raw[k];
+            }
+        }
+    }
+    auto minmax = [&](const int16_t* r) {   // QMC5883LCompass::setCalibration(): offset + per-axis scale
+        double off[3], half[3], avg = 0;
+        for (int k = 0; k < 3; k++) {
+            off[k]  = (mn[k] + mx[k]) / 2.0;
+            half[k] = (mx[k] - mn[k]) / 2.0;
+            avg    += half[k] / 3;
+        }
+        double x = (r[0] - off[0]) * avg / half[0], y = (r[1] - off[1]) * avg / half[1];
+        double h = atan2(y, x) / D2R;
+        return h < 0 ? h + 360 : h;
+    };
+    auto rawHeading = [](const int16_t* r) {
+        double h = atan2((double)r[1], (double)r[0]) / D2R;
+        return h < 0 ? h + 360 : h;
+    };
+
+    uint32_t   firstAccept = 0;
+    for (int minute = 0; minute < 15; minute++) {
+        run(cal, sea, HULL, 1, rng, &clockMs);
+        if (!firstAccept && cal.stats().accepted) firstAccept = clockMs;
+    }
+    MagCalStats s1 = cal.stats();
+    SweepErr    e1 = sweepCal(HULL, cal), eRaw = sweep(HULL, rawHeading), eMm = sweep(HULL, minmax);
+    printCal("fit ", cal.cal());
+    printf("  %u readings, %u kept, %u solves (%u accepted, %u rejected), %u NVS writes, "
+           "first accepted at %.0f s\n", (unsigned)s1.seen, (unsigned)s1.kept, (unsigned)s1.solves,
+           (unsigned)s1.accepted, (unsigned)s1.rejected, (unsigned)s1.saves,
+           firstAccept / 1000.0);
+    printf("  level sweep error   RMS      max\n");
+    printf("    raw             %6.2f°  %6.2f°\n", eRaw.rms, eRaw.max);
+    printf("    min/max (2 min) %6.2f°  %6.2f°\n", eMm.rms, eMm.max);
+    printf("    ellipsoid fit   %6.2f°  %6.2f°\n", e1.rms, e1.max);
+    check(e1.rms <= 0.5 && e1.max <= 1.0, "fresh buoy: ≤ 0.5° RMS, ≤ 1.0° max after 15 min");
+    check(e1.max < eMm.max, "better than the min/max calibration");
+    check(s1.saves >= 1 && s1.saves <= 3, "persisted, without a flash write per solve");
+
+    // 2. Reboot
+    printf("\n=== 2. Reboot ===\n");
+    cal.save();
+    MagCal before = cal.cal();
+    hal_host_reset();   // NVS survives
+    MagCalibrator boot;
+    bool          loaded = boot.load();
+    SweepErr      e2     = sweepCal(HULL, boot);
+    printf("  loaded %s, sweep %.2f° RMS %.2f° max\n", loaded ? "yes" : "no", e2.rms, e2.max);
+    check(loaded && memcmp(&boot.cal(), &before, sizeof(MagCal)) == 0 && e2.max == sweepCal(HULL, cal).max,
+          "calibration restored from NVS bit-for-bit, no calibration run");
+    MagCal bad = before;
+    bad.offset[1] += 1.0f;   // CRC no longer matches
+    hal_nvs_write(MAG_CAL_NVS_KEY, &bad, sizeof(bad));
+    MagCalibrator corrupt;
+    check(!corrupt.load() && corrupt.cal().samples == 0, "corrupted blob refused, identity kept");
+    hal_nvs_write(MAG_CAL_NVS_KEY, &before, sizeof(before));
+
+    // 3. Payload change
+    printf("\n=== 3. Payload change, 20 min ===\n");
+    SweepErr eStale = sweepCal(HULL_RELOADED, boot);
+    double   recoverMin = -1;
+    for (int minute = 1; minute <= 20; minute++) {
+        run(boot, sea, HULL_RELOADED, 1, rng, &clockMs);
+        if (recoverMin < 0 && sweepCal(HULL_RELOADED, boot).max <= 2.0) recoverMin = minute;
+    }
+    SweepErr e3 = sweepCal(HULL_RELOADED, boot);
+    printCal("fit ", boot.cal());
+    printf("  stale calibration %.2f° RMS %.2f° max → %.2f° RMS %.2f° max; ≤ 2° after %.0f min\n", eStale.rms,
+           eStale.max, e3.rms, e3.max, recoverMin);
+    check(e3.rms <= 0.5 && e3.max <= 1.0, "tracks the payload change: ≤ 0.5° RMS, ≤ 1.0° max");
+
+    // 4. Level-only yawing
+    printf("\n=== 4. Level-only yawing, fresh calibrator, 15 min ===\n");
+    MagCalibrator flat;
+    Motion        calm(0, 0, 0, 11);
+    run(flat, calm, HULL, 15, rng, &clockMs);
+    SweepErr e4 = sweepCal(HULL, flat);
+    printCal("fit ", flat.cal());
+    printf("  %u accepted, sweep %.2f° RMS %.2f° max\n", (unsigned)flat.stats().accepted, e4.rms, e4.max);
+    check(flat.stats().accepted > 0 && e4.max <= 1.0, "z never excited: fit stays sane, ≤ 1.0° max");
+
+    // 5. Anchored, narrow swing
+    printf("\n=== 5. Anchored, ±20° swing, 15 min ===\n");
+    MagCalibrator narrow;
+    Motion        anchored(12, 8, 20, 13);
+    run(narrow, anchored, HULL, 15, rng, &clockMs);
+    MagCalStats s5 = narrow.stats();
+    printf("  %u solves, %u accepted, lean %.2f (max %.2f)\n", (unsigned)s5.solves, (unsigned)s5.accepted,
+           s5.lean, MAG_CAL_MAX_LEAN);
+    check(s5.accepted == 0 && narrow.cal().samples == 0, "no calibration from a narrow swing");
+
+    // 6. Cost
+    printf("\n=== 6. Cost ===\n");
+    const int N = 2000000;
+    int16_t   xs[256][3];
+    for (int i = 0; i < 256; i++) {
+        double b[3];
+        sea.step(b);
+        sense(HULL, b, NOISE, rng, xs[i]);
+    }
+    volatile float sink = 0;
+    double t0 = seconds();
+    for (int i = 0; i < N; i++) sink = sink + cal.heading(xs[i & 255][0], xs[i & 255][1], xs[i & 255][2]);
+    double tCal = (seconds() - t0) / N;
+    t0 = seconds();
+    for (int i = 0; i < N; i++) sink = sink + atan2f((float)xs[i & 255][1], (float)xs[i & 255][0]) * 57.29578f;
+    double tBare = (seconds() - t0) / N;
+    MagCalibrator work = cal;
+    t0 = seconds();
+    uint32_t kept = 0;
+    for (int i = 0; i < N / 10; i++) kept += work.add(xs[i & 255][0], xs[i & 255][1], xs[i & 255][2]);
+    double tAdd = (seconds() - t0) / (N / 10);
+    t0 = seconds();
+    int solves = 0;
+    for (int i = 0; i < 2000; i++) solves += work.solve();
+    double tSolve = (seconds() - t0) / 2000;
+    printf("  heading() with correction %6.1f ns   bare atan2f %6.1f ns\n", tCal * 1e9, tBare * 1e9);
+    printf("  add() %6.1f ns (%u%% kept)   solve() %6.2f us   sizeof(MagCalibrator) %zu B, MagCal %zu B\n",
+           tAdd * 1e9, (unsigned)(100ull * kept / (N / 10)), tSolve * 1e6, sizeof(MagCalibrator), sizeof(MagCal));
+    check(tCal <= 2 * tBare, "correction + heading within 2× a bare atan2f");
+
+    return check_summary();
+}
@@ -0,0 +1,190 @@
+// Native Host Run — shared sensor and protocol logic on a Linux workstation
+//
+// Run:  pio run -e native -t exec
+//
+// Drives the same code the ESP32-S3 sketches use (firmware/common/**, common/**)
+// through the host HAL stand-ins with scripted inputs. Time is virtual, so the
+// output is identical on every run and can be diffed after a change.
+//
+//   1. Collision avoidance  — echo widths queued on the three ECHO pins;
+//                             prints the ultrasonic_test CSV
+//   2. Wind + compass fusion — vane ADC sweep against fixed compass headings;
+//                             prints the wind_sensor_test TSV
+//   3. I2C scan             — fake QMC5883L + SSD1306 on the bus
+//   4. Protocol             — StatusPacket over a linked HostRadio pair,
+//                             CRC verified on receive, corruption rejected
+//   5. UART                 — NMEA sentences fed into the GPS port, split into lines
+//
+// Exit code 1 if any self-check fails.
+
+#include <stdio.h>
+#include <string.h>
+#include "common/config.h"
+#include "common/protocol.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/ultrasonic/ultrasonic.h"
+#include "firmware/common/wind/wind.h"
+#include "testing/check.h"
+
+// Echo width in µs for a target distance (inverse of ultrasonic_echo_to_cm)
+static uint32_t echoFor(uint16_t cm) {
+    return cm >= DIST_NONE_CM ? 0 : (uint32_t)((cm + 0.5f) * 2.0f / 0.034f);
+}
+
+// Minimal register-less I2C device — ACKs everything, reads back zeros
+class AckDevice : public HostI2cDevice {
+public:
+    bool onWrite(const uint8_t*, size_t) override { return true; }
+    bool onRead(uint8_t* data, size_t len) override { memset(data, 0, len); return true; }
+};
+
+// ---------------------------------------------------------------------------
+static void runUltrasonic() {
+    printf("\n== Collision avoidance ==\n");
+    printf("time_ms,fwd_cm,port_cm,stbd_cm,status\n");
+
+    // Boat closing on an obstacle dead ahead, with more room to port.
+    static const uint16_t script[][3] = {
+        // fwd   port  stbd
+        { 500,  500,  500 },
+        { 320,  410,  380 },
+        { 190,  300,  150 },
+        { 140,  120,  260 },
+        {  45,  200,  210 },
+        { 500,  500,  500 },
+    };
+    static const ObstacleZone expected[] = {
+        ZONE_CLEAR, ZONE_CLEAR, ZONE_AVOID_PORT, ZONE_AVOID_STBD, ZONE_STOP, ZONE_CLEAR
+    };
+
+    bool allMatch = true;
+    for (size_t i = 0; i < sizeof(script) / sizeof(script[0]); i++) {
+        hal_host_queue_pulse(ULTRASONIC_ECHO_FWD,  echoFor(script[i][0]));
+        hal_host_queue_pulse(ULTRASONIC_ECHO_PORT, echoFor(script[i][1]));
+        hal_host_queue_pulse(ULTRASONIC_ECHO_STBD, echoFor(script[i][2]));
+
+        uint32_t cycleStart = hal_millis();
+        UltrasonicScan scan = ultrasonic_scan();
+        ObstacleZone   zone = ultrasonic_classify(scan);
+        if (zone != expected[i]) allMatch = false;
+
+        printf("%lu,%u,%u,%u,%s\n", (unsigned long)hal_millis(),
+               scan.fwd_cm, scan.port_cm, scan.stbd_cm, ultrasonic_zone_name(zone));
+
+        uint32_t elapsed = hal_millis() - cycleStart;
+        if (elapsed < 90) hal_delay_ms(90 - elapsed);
+    }
+    check(allMatch, "zone classification matches script");
+}
+
+// ---------------------------------------------------------------------------
+static void runWindFusion() {
+    printf("\n== Wind + compass fusion ==\n");
+    printf("vane_raw\tvane_rel\tcompass\tabs_wind\terror\tspeed_kmh\n");
+
+    static const uint16_t vaneAdc[] = { 0, 512, 1024, 2048, 3072, 4095 };
+    static const float    heading[] = { 0.0f, 90.0f, 180.0f, 270.0f, 350.0f, 45.0f };
+    const float vaneOffset = 10.0f;
+
+    bool inRange = true;
+    for (size_t i = 0; i < sizeof(vaneAdc) / sizeof(vaneAdc[0]); i++) {
+        hal_host_set_analog(WIND_DIR_PIN, vaneAdc[i]);
+        float      raw   = wind_vane_read();
+        WindFusion f     = wind_fuse(raw, vaneOffset, heading[i]);
+        float      speed = wind_speed_kmh((uint32_t)(i * 3), 1000);
+
+        if (f.abs_wind_dir < 0.0f || f.abs_wind_dir >= 360.0f ||
+            f.heading_error <= -180.0f || f.heading_error > 180.0f) {
+            inRange = false;
+        }
+        printf("%.1f\t%.1f\t%.0f\t%.1f\t%.1f\t%.2f\n",
+               raw, f.vane_relative, heading[i], f.abs_wind_dir, f.heading_error, speed);
+        hal_delay_ms(200);
+    }
+    check(inRange, "fused angles stay within 0–360 / ±180");
+    check(wind_speed_kmh(10, 1000) > 16.09f && wind_speed_kmh(10, 1000) < 16.10f,
+          "10 pulses/s = 16.09 km/h");
+}
+
+// ---------------------------------------------------------------------------
+static void runI2cScan() {
+    printf("\n== I2C scan ==\n");
+    static AckDevice compass, oled;
+    hal_host_i2c_attach(COMPASS_ADDR, &compass);
+    hal_host_i2c_attach(OLED_ADDRESS, &oled);
+
+    int found = 0;
+    for (uint8_t addr = 1; addr < 127; addr++) {
+        if (hal_i2c_probe(addr)) {
+            printf("  0x%02X%s\n", addr,
+                   addr == COMPASS_ADDR ? "  <- QMC5883L" : addr == OLED_ADDRESS ? "  <- OLED" : "");
+            found++;
+        }
+    }
+    check(found == 2, "two devices on the bus");
+}
+
+// ---------------------------------------------------------------------------
+static void runProtocol() {
+    printf("\n== Protocol over HostRadio ==\n");
+    HostRadio slave, master;
+    slave.link(&master);
+
+    StatusPacket tx;
+    tx.packet_type       = PKT_STATUS;
+    tx.buoy_id           = BUOY_WINDWARD;
+    tx.current_lat       = 43.654321f;
+    tx.current_lon       = -79.381234f;
+    tx.dist_to_target_cm = 215;
+    tx.battery_tenths_v  = 148;
+    tx.checksum          = calculate_checksum((uint8_t*)&tx, sizeof(tx) - 2);
+    slave.send((const uint8_t*)&tx, sizeof(tx));
+
+    uint8_t buf[LORA_MAX_PAYLOAD];
+    uint8_t len = sizeof(buf);
+    bool got = master.available() && master.recv(buf, &len);
+    check(got && len == sizeof(StatusPacket), "StatusPacket delivered, 15 bytes");
+    check(got && verify_checksum(buf, len), "checksum verifies on receive");
+
+    buf[3] ^= 0x01;
+    check(!verify_checksum(buf, len), "single-bit corruption rejected");
+}
+
+// ---------------------------------------------------------------------------
+static void runUart() {
+    printf("\n== GPS UART ==\n");
+    const char* nmea =
+        "$GNGGA,123519.00,4339.25926,N,07922.87404,W,1,08,0.9,85.0,M,-34.0,M,,*5C\r\n"
+        "$GNRMC,123519.00,A,4339.25926,N,07922.87404,W,0.02,,170226,,,A*7B\r\n";
+    hal_host_uart_feed(HAL_GPS_UART, (const uint8_t*)nmea, strlen(nmea));
+
+    char    line[128];
+    uint8_t idx   = 0;
+    int     lines = 0;
+    while (hal_uart_available(HAL_GPS_UART)) {
+        char c = (char)hal_uart_read(HAL_GPS_UART);
+        if (c == '\n' || idx >= sizeof(line) - 1) {
+            line[idx] = '\0';
+            if (idx > 1) { printf("  %s\n", line); lines++; }
+            idx = 0;
+        } else if (c != '\r') {
+            line[idx++] = c;
+        }
+    }
+    check(lines == 2, "two sentences framed");
+}
+
+// ---------------------------------------------------------------------------
+int main() {
+    printf("Native host run — virtual clock, scripted inputs\n");
+    hal_host_reset();
+
+    runUltrasonic();
+    runWindFusion();
+    runI2cScan();
+    runProtocol();
+    runUart();
+
+    printf("\nVirtual time elapsed: %lu ms\n", (unsigned long)hal_millis());
+    return check_summary();
+}
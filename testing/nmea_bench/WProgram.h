@@ -0,0 +1,23 @@
+// Minimal Arduino surface for building TinyGPSPlus on the host ([env:nmea_bench]).
+// TinyGPS++.h includes "WProgram.h" when ARDUINO is undefined; this supplies
+// the few core helpers it uses, on the HAL's virtual clock.
+#ifndef NMEA_BENCH_WPROGRAM_H
+#define NMEA_BENCH_WPROGRAM_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "firmware/common/hal/hal.h"
+
+typedef uint8_t byte;
+
+#ifndef TWO_PI
+#define TWO_PI      6.283185307179586476925286766559
+#endif
+#define radians(deg) ((deg) * 0.017453292519943295769236907684886)
+#define degrees(rad) ((rad) * 57.295779513082320876798154814105)
+#define sq(x)        ((x) * (x))
+
+static inline unsigned long millis() { return hal_millis(); }
+
+#endif // NMEA_BENCH_WPROGRAM_H
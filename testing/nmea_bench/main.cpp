@@ -0,0 +1,365 @@
+// NMEA Ingestion Benchmark — host (platform = native)
+//
+// Run:  pio run -e nmea_bench -t exec
+//       .pio/build/nmea_bench/program path/to/recording.nmea   (a recorded log instead)
+//
+// Input: a 10-minute BE-880 session at 10 Hz, GN talker (RMC, VTG, GGA,
+// 3× GSA, 7× GSV, GLL per epoch, high-precision 7-decimal minutes), the
+// buoy circling a 300 m loop. Every 101st sentence has one byte corrupted and
+// one 200-byte line of garbage is injected. The bytes arrive through the host
+// UART in 256-byte bursts (the ESP32 RX FIFO / onReceive granularity), with
+// the virtual clock at 100 ms per epoch.
+//
+// Paths compared, each over the same bytes:
+//
+//   framing only   hal_uart_read() per byte into lineBuf — the sketch's echo
+//                  loop without any parsing (floor for any per-byte design)
+//   TinyGPSPlus    hal_uart_read() per byte into TinyGPSPlus::encode()
+//   sketch         TinyGPSPlus + the lineBuf copy + echo of every sentence
+//   NmeaReader     poll(): bulk reads, GGA + RMC parsed in place
+//   NmeaReader +   GGA / RMC / VTG / GSA
+//   NmeaReader e   GGA + RMC, echo limited to 10 sentences/s
+//
+// TinyGPSPlus rows need the library (lib_deps in [env:nmea_bench]; WProgram.h
+// here provides the Arduino helpers it uses) and are skipped without it.
+//
+// Pass criteria (synthetic session): every uncorrupted GGA/RMC decoded, and
+// the fix after each epoch equals the generated position to 1e-7° with the
+// right time, satellites and HDOP; every corrupted sentence of a wanted type
+// counted as bad (other types are dropped before the checksum),
+// the garbage line as one overflow; GGA alone sets and clears fix.valid (a
+// GGA-only reader works); echo never exceeds its rate; NmeaReader
+// ≥ 1.5× the sentences/s of the per-byte framing loop alone and ≥ 3× those
+// of TinyGPSPlus when present. The host per-byte read is an inline ring
+// index; on the ESP32 each HardwareSerial::read() takes the driver's
+// ring-buffer lock, so the gap there is wider than shown here.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "common/config.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/gps/nmea.h"
+#include "testing/check.h"
+
+#if __has_include(<TinyGPS++.h>)
+#include <TinyGPS++.h>
+#define HAVE_TINYGPS 1
+#else
+#define HAVE_TINYGPS 0
+#endif
+
+#define EPOCHS          6000        // 10 min at 10 Hz
+#define EPOCH_MS        100
+#define BURST_BYTES     256
+#define CORRUPT_EVERY   101
+#define ECHO_PORT       0
+#define ECHO_PER_S      10
+
+static double seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------------------------------------------------------------------------
+// Synthetic session
+struct Truth {
+    int32_t  lat_e7, lon_e7;
+    uint32_t time_ms;
+    uint8_t  sats;
+    uint16_t hdop_x100;
+    bool     ggaOk, rmcOk;      // not corrupted
+};
+
+struct Session {
+    std::vector<char>     bytes;
+    std::vector<size_t>   epochEnd;     // byte offset after each epoch
+    std::vector<Truth>    truth;
+    uint32_t              sentences = 0, corrupted = 0, overflowLines = 0;
+    uint32_t              badFix = 0, badAll = 0;   // corrupted GGA/RMC, + VTG/GSA
+};
+
+static void coord(char* out, size_t n, int32_t e7, bool lat) {
+    uint32_t a   = (uint32_t)(e7 < 0 ? -e7 : e7);
+    uint32_t deg = a / 10000000u;
+    uint64_t min = (uint64_t)(a % 10000000u) * 60;   // minutes × 1e7, exact
+    snprintf(out, n, lat ? "%02u%02u.%07u,%c" : "%03u%02u.%07u,%c", deg, (unsigned)(min / 10000000u),
+             (unsigned)(min % 10000000u), lat ? (e7 < 0 ? 'S' : 'N') : (e7 < 0 ? 'W' : 'E'));
+}
+
+static bool emit(Session& s, const char* body) {
+    char    line[160];
+    uint8_t sum = 0;
+    for (const char* p = body; *p; p++) sum ^= (uint8_t)*p;
+    int n = snprintf(line, sizeof(line), "$%s*%02X\r\n", body, sum);
+    bool corrupt = ++s.sentences % CORRUPT_EVERY == 0;
+    if (corrupt) {
+        line[n / 2] ^= 0x01;
+        s.corrupted++;
+    }
+    s.bytes.insert(s.bytes.end(), line, line + n);
+    return !corrupt;
+}
+
+// GGA alone sets and clears fix.valid; RMC and GGA agree sentence by sentence
+static bool parse(const char* body, uint8_t types, GpsFix* fix) {
+    char    line[160];
+    uint8_t sum = 0;
+    for (const char* p = body; *p; p++) sum ^= (uint8_t)*p;
+    int n = snprintf(line, sizeof(line), "$%s*%02X", body, sum);
+    return nmea_parse(line, (size_t)n, types, fix) != NMEA_BAD;
+}
+
+static void validityCheck() {
+    const char* GGA_FIX   = "GNGGA,123519.00,4339.2592600,N,07922.8740400,W,1,11,0.80,85.3,M,-34.0,M,,";
+    const char* GGA_NOFIX = "GNGGA,123520.00,,,,,0,00,99.99,,,,,,";
+    const char* RMC_FIX   = "GNRMC,123521.00,A,4339.2592600,N,07922.8740400,W,3.888,90.00,170226,,,A,V";
+
+    GpsFix gga = {};
+    bool   ok  = parse(GGA_FIX, NMEA_GGA, &gga);
+    check(ok && gga.valid && gga.lat_e7 == 436543210 && gga.lon_e7 == -793812340,
+          "GGA-only reader: a GGA with quality 1 makes the fix valid");
+    ok &= parse(GGA_NOFIX, NMEA_GGA, &gga);
+    bool cleared = !gga.valid;
+    ok &= parse(GGA_FIX, NMEA_GGA, &gga);
+    check(ok && cleared && gga.valid, "GGA quality 0 clears the fix, the next fixed GGA restores it");
+
+    GpsFix both = {};
+    ok = parse(RMC_FIX, NMEA_TYPES_DEFAULT, &both) && parse(GGA_NOFIX, NMEA_TYPES_DEFAULT, &both) &&
+         parse(GGA_FIX, NMEA_TYPES_DEFAULT, &both);
+    check(ok && both.valid, "default types: a fixed GGA after a no-fix one is valid without waiting for RMC");
+}
+
+static void buildSession(Session& s) {
+    const double LAT0 = 43.6543210, LON0 = -79.3812340, R_M = 300.0, V_MS = 2.0;
+    for (int e = 0; e < EPOCHS; e++) {
+        double   ang = V_MS * e * EPOCH_MS / 1000.0 / R_M;
+        double   lat = LAT0 + R_M * sin(ang) / 111320.0;
+        double   lon = LON0 + R_M * (1 - cos(ang)) / (111320.0 * cos(LAT0 * M_PI / 180));
+        Truth    t;
+        t.lat_e7    = (int32_t)lround(lat * 1e7);
+        t.lon_e7    = (int32_t)lround(lon * 1e7);
+        t.time_ms   = 12 * 3600000u + 35 * 60000u + (uint32_t)e * EPOCH_MS;
+        t.sats      = (uint8_t)(11 + (e / 300) % 3);
+        t.hdop_x100 = (uint16_t)(70 + (e / 50) % 20);
+        uint32_t ms = t.time_ms;
+        char hms[16], la[24], lo[24], body[160];
+        snprintf(hms, sizeof(hms), "%02u%02u%02u.%02u", ms / 3600000, ms / 60000 % 60, ms / 1000 % 60, ms % 1000 / 10);
+        coord(la, sizeof(la), t.lat_e7, true);
+        coord(lo, sizeof(lo), t.lon_e7, false);
+        double cog = fmod(90.0 - ang * 180 / M_PI + 720.0, 360.0);
+
+        snprintf(body, sizeof(body), "GNRMC,%s,A,%s,%s,3.888,%.2f,170226,,,A,V", hms, la, lo, cog);
+        t.rmcOk = emit(s, body);
+        s.badFix += !t.rmcOk;
+        snprintf(body, sizeof(body), "GNVTG,%.2f,T,,M,3.888,N,7.200,K,A", cog);
+        s.badAll += !emit(s, body);
+        snprintf(body, sizeof(body), "GNGGA,%s,%s,%s,1,%02u,%u.%02u,85.3,M,-34.0,M,,", hms, la, lo, t.sats,
+                 t.hdop_x100 / 100, t.hdop_x100 % 100);
+        t.ggaOk = emit(s, body);
+        s.badFix += !t.ggaOk;
+        s.badAll += !emit(s, "GNGSA,A,3,01,03,08,10,14,17,21,22,,,,,1.32,0.80,1.05,1");
+        s.badAll += !emit(s, "GNGSA,A,3,67,68,77,78,,,,,,,,,1.32,0.80,1.05,2");
+        s.badAll += !emit(s, "GNGSA,A,3,02,07,11,,,,,,,,,,1.32,0.80,1.05,3");
+        emit(s, "GPGSV,3,1,11,01,45,123,42,03,12,045,35,08,67,301,44,10,23,201,38,1");
+        emit(s, "GPGSV,3,2,11,14,55,088,45,17,31,250,40,21,08,318,29,22,40,160,41,1");
+        emit(s, "GPGSV,3,3,11,27,05,020,,30,02,110,,32,14,280,31,1");
+        emit(s, "GLGSV,2,1,06,67,44,050,39,68,61,140,43,77,25,290,36,78,30,345,37,1");
+        emit(s, "GLGSV,2,2,06,84,09,100,,85,03,160,,1");
+        emit(s, "GAGSV,2,1,05,02,50,070,41,07,35,210,39,11,20,330,35,12,06,010,,7");
+        emit(s, "GAGSV,2,2,05,19,01,180,,7");
+        snprintf(body, sizeof(body), "GNGLL,%s,%s,%s,A,A", la, lo, hms);
+        emit(s, body);
+        if (e == EPOCHS / 2) {   // a line with no end in sight
+            s.bytes.insert(s.bytes.end(), 200, 'x');
+            s.bytes.push_back('\n');
+            s.overflowLines++;
+        }
+        s.badAll += !t.ggaOk + !t.rmcOk;
+        s.truth.push_back(t);
+        s.epochEnd.push_back(s.bytes.size());
+    }
+}
+
+static bool loadFile(Session& s, const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) s.bytes.insert(s.bytes.end(), buf, buf + n);
+    fclose(f);
+    for (char c : s.bytes) if (c == '\n') s.sentences++;
+    // One "epoch" per ~1 KB keeps the UART feed and the clock moving
+    for (size_t off = 1024; off < s.bytes.size(); off += 1024) s.epochEnd.push_back(off);
+    s.epochEnd.push_back(s.bytes.size());
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Drive a path over the session: feed each epoch's bytes in bursts, call
+// `drain` after every burst, `epochDone` after each epoch
+template <typename Drain, typename EpochDone>
+static double run(const Session& s, Drain drain, EpochDone epochDone) {
+    hal_host_reset();
+    uint8_t sink[HAL_HOST_UART_BUF];
+    double  busy = 0;
+    size_t  off  = 0;
+    for (size_t e = 0; e < s.epochEnd.size(); e++) {
+        while (off < s.epochEnd[e]) {
+            size_t n = s.epochEnd[e] - off < BURST_BYTES ? s.epochEnd[e] - off : BURST_BYTES;
+            hal_host_uart_feed(HAL_GPS_UART, (const uint8_t*)&s.bytes[off], n);
+            off += n;
+            double t0 = seconds();
+            drain();
+            busy += seconds() - t0;
+            while (hal_host_uart_drain(ECHO_PORT, sink, sizeof(sink))) {}
+        }
+        epochDone(e);
+        hal_host_advance_us(EPOCH_MS * 1000);
+    }
+    return busy;
+}
+
+struct Row {
+    const char* name;
+    double      busy;
+};
+
+static void printRow(const Session& s, const Row& r, double ref) {
+    printf("  %-26s %12.0f %9.1f %8.2fx\n", r.name, s.sentences / r.busy, r.busy * 1e9 / s.bytes.size(), ref / r.busy);
+}
+
+int main(int argc, char** argv) {
+    Session s;
+    bool synthetic = argc < 2;
+    if (synthetic) {
+        buildSession(s);
+    } else if (!loadFile(s, argv[1])) {
+        printf("cannot read %s\n", argv[1]);
+        return 1;
+    }
+    printf("\n=== NMEA ingestion: %s, %zu bytes, %u sentences ===\n",
+           synthetic ? "synthetic BE-880 10 Hz session" : argv[1], s.bytes.size(), (unsigned)s.sentences);
+
+    std::vector<Row> rows;
+    auto nothing = [](size_t) {};
+
+    // Framing only: the sketch's per-byte lineBuf loop
+    uint32_t framed = 0;
+    rows.push_back({ "framing only (per byte)", run(s, [&] {
+        static char    lineBuf[128];
+        static uint8_t lineIdx = 0;
+        while (hal_uart_available(HAL_GPS_UART)) {
+            char c = (char)hal_uart_read(HAL_GPS_UART);
+            if (c == '\n' || lineIdx >= sizeof(lineBuf) - 1) {
+                lineBuf[lineIdx] = '\0';
+                if (lineIdx > 1) framed++;
+                lineIdx = 0;
+            } else if (c != '\r') {
+                lineBuf[lineIdx++] = c;
+            }
+        }
+    }, nothing) });
+    double ref = rows[0].busy;
+
+#if HAVE_TINYGPS
+    {
+        TinyGPSPlus gps;
+        rows.push_back({ "TinyGPSPlus (per byte)", run(s, [&] {
+            while (hal_uart_available(HAL_GPS_UART)) gps.encode((char)hal_uart_read(HAL_GPS_UART));
+        }, nothing) });
+        printf("  TinyGPSPlus: %u passed, %u failed checksum, last %.7f, %.7f\n",
+               (unsigned)gps.passedChecksum(), (unsigned)gps.failedChecksum(), gps.location.lat(), gps.location.lng());
+    }
+    {
+        TinyGPSPlus gps;
+        rows.push_back({ "sketch (TinyGPS + echo)", run(s, [&] {
+            static char    lineBuf[128];
+            static uint8_t lineIdx = 0;
+            while (hal_uart_available(HAL_GPS_UART)) {
+                char c = (char)hal_uart_read(HAL_GPS_UART);
+                gps.encode(c);
+                if (c == '\n' || lineIdx >= sizeof(lineBuf) - 1) {
+                    lineBuf[lineIdx] = '\0';
+                    if (lineIdx > 1) {
+                        hal_uart_write(ECHO_PORT, (const uint8_t*)lineBuf, lineIdx);
+                        hal_uart_write(ECHO_PORT, (const uint8_t*)"\r\n", 2);
+                    }
+                    lineIdx = 0;
+                } else if (c != '\r') {
+                    lineBuf[lineIdx++] = c;
+                }
+            }
+        }, nothing) });
+    }
+#else
+    printf("  (TinyGPSPlus not available: its rows are skipped)\n");
+#endif
+
+    // NmeaReader, default types, checked epoch by epoch against the truth
+    NmeaReader nmea;
+    uint32_t   mismatches = 0, checked = 0;
+    rows.push_back({ "NmeaReader GGA+RMC", run(s, [&] { nmea.poll(); }, [&](size_t e) {
+        if (!synthetic) return;
+        const Truth&  t = s.truth[e];
+        const GpsFix& f = nmea.fix();
+        if (!t.ggaOk || !t.rmcOk) return;
+        checked++;
+        if (f.lat_e7 != t.lat_e7 || f.lon_e7 != t.lon_e7 || f.time_ms != t.time_ms || f.sats != t.sats ||
+            f.hdop_x100 != t.hdop_x100 || !f.valid || f.quality != 1) mismatches++;
+    }) });
+    NmeaStats ns = nmea.stats();
+
+    NmeaReader all(HAL_GPS_UART, NMEA_GGA | NMEA_RMC | NMEA_VTG | NMEA_GSA);
+    rows.push_back({ "NmeaReader +VTG+GSA", run(s, [&] { all.poll(); }, nothing) });
+    NmeaStats as = all.stats();
+
+    NmeaReader echoed;
+    rows.push_back({ "NmeaReader echo 10/s", run(s, [&] {
+        static bool init = false;
+        if (!init) { echoed.setEcho(ECHO_PORT, ECHO_PER_S); init = true; }
+        echoed.poll();
+    }, nothing) });
+    NmeaStats es = echoed.stats();
+
+    printf("\n  %-26s %12s %9s %9s\n", "path", "sentences/s", "ns/byte", "vs frame");
+    for (const Row& r : rows) printRow(s, r, ref);
+
+    const GpsFix& f = all.fix();
+    printf("\n  NmeaReader: %u sentences, GGA %u RMC %u VTG %u GSA %u, %u ignored, %u bad, %u overflow\n",
+           (unsigned)as.sentences, (unsigned)as.decoded[0], (unsigned)as.decoded[1], (unsigned)as.decoded[2],
+           (unsigned)as.decoded[3], (unsigned)as.ignored, (unsigned)as.bad, (unsigned)as.overflows);
+    printf("  last fix: %.7f, %.7f  %u sats  HDOP %.2f  PDOP %.2f  mode %uD  %.2f m/s  %.2f°\n",
+           f.lat_e7 / 1e7, f.lon_e7 / 1e7, f.sats, f.hdop_x100 / 100.0, f.pdop_x100 / 100.0, f.mode,
+           f.sog_cms / 100.0, f.cog_cdeg / 100.0);
+    printf("  input: %u corrupted, %u over-long; per-byte loop framed %u lines\n", (unsigned)s.corrupted,
+           (unsigned)s.overflowLines, (unsigned)framed);
+    printf("  echo: %u sent, %u dropped over %.0f s\n\n", (unsigned)es.echoed, (unsigned)es.echo_dropped,
+           s.epochEnd.size() * EPOCH_MS / 1000.0);
+
+    if (synthetic) {
+        uint32_t okGga = 0, okRmc = 0;
+        for (const Truth& t : s.truth) { okGga += t.ggaOk; okRmc += t.rmcOk; }
+        check(ns.decoded[0] == okGga && ns.decoded[1] == okRmc, "every uncorrupted GGA and RMC decoded");
+        check(mismatches == 0 && checked > 0, "fix matches the generated position exactly (1e-7°), time, sats, HDOP");
+        check(ns.bad == s.badFix && as.bad == s.badAll, "every corrupted sentence of a wanted type counted bad");
+        check(ns.overflows == s.overflowLines, "over-long line dropped as one overflow");
+        check(ns.sentences + ns.bad == s.sentences, "all sentences framed across 256-byte bursts");
+        check(as.decoded[2] > 0 && as.decoded[3] > 0 && f.mode == 3 && f.pdop_x100 == 132,
+              "VTG / GSA decoded on request");
+        check(es.echoed <= (s.epochEnd.size() * EPOCH_MS / 1000 + 1) * ECHO_PER_S && es.echo_dropped > 0,
+              "echo held to its rate");
+    }
+    validityCheck();
+    if (s.bytes.size() >= 65536) {   // a short recording times nothing meaningful
+        check(ref / rows[HAVE_TINYGPS ? 3 : 1].busy >= 1.5,
+              "NmeaReader ≥ 1.5× the sentences/s of per-byte framing alone");
+#if HAVE_TINYGPS
+        check(rows[1].busy / rows[3].busy >= 3.0, "NmeaReader ≥ 3× TinyGPSPlus");
+#endif
+    }
+
+    return check_summary();
+}
@@ -0,0 +1,318 @@
+// OLED Dirty-Region Flush Benchmark — host (platform = native)
+//
+// Run:  pio run -e oled_flush -t exec
+//
+// Renders the OLED layouts of three hardware sketches frame by frame, with
+// the values they show evolving as on the water:
+//
+//   gps_test_display  showFix() at 1 Hz — lat/lon jitter in the 6th decimal, fix age, HDOP, altitude
+//   compass_test      5 Hz — size-2 azimuth + cardinal, raw X/Y/Z with sensor noise
+//   ultrasonic_test   one frame per sweep (~10 Hz) — three distances, a target approaching, status
+//
+// Each frame is drawn from scratch (clearDisplay() + text, as the sketches do)
+// and sent two ways to a modelled SSD1306 on the host I2C bus (400 kHz):
+//
+//   full   Adafruit_SSD1306::display() transaction pattern — window commands,
+//          then the whole buffer in 127-byte writes; the loop blocks throughout
+//   dirty  OledFlush::submit(), then service() until the panel matches
+//
+// Glyphs are pseudo-random 5×7 bitmaps keyed by character (real font shapes
+// do not matter: the cost depends on which character cells change).
+//
+// Reports I2C bytes and bus time per frame, and the loop-side cost of
+// submit(). Pass criteria: the modelled panel RAM equals every frame after
+// each flush; dirty flush sends ≤ 15% of the full-frame bytes on every
+// layout; a frame submitted mid-flush supersedes the older one (coalesced)
+// and the panel converges to it; invalidate() re-sends the whole frame.
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include "common/config.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/display/oled_flush.h"
+#include "testing/check.h"
+
+#define ADAFRUIT_WIRE_MAX   128   // ESP32 Wire I2C_BUFFER_LENGTH → 127 data bytes per write
+
+static uint32_t rngState = 9;
+static float uniform(float lo, float hi) {
+    rngState = rngState * 1664525u + 1013904223u;
+    return lo + (hi - lo) * ((rngState >> 8) / 16777216.0f);
+}
+
+// ---------------------------------------------------------------------------
+// SSD1306 model: horizontal addressing, column/page window, 1 KB GDDRAM
+class Ssd1306Model : public HostI2cDevice {
+public:
+    uint8_t  ram[OLED_FRAME_BYTES] = {};
+    uint64_t bytes = 0, writes = 0;
+
+    bool onWrite(const uint8_t* d, size_t len) override {
+        bytes += len + 1;
+        writes++;
+        if (len == 0) return true;
+        if (d[0] == 0x40) {
+            for (size_t i = 1; i < len; i++) {
+                ram[page * OLED_WIDTH + col] = d[i];
+                if (col++ == colEnd) {
+                    col = colStart;
+                    if (page++ == pageEnd) page = pageStart;
+                }
+            }
+            return true;
+        }
+        // Command stream: 0x21 c0 c1 / 0x22 p0 p1 may be split across writes
+        for (size_t i = 1; i < len; i++) command(d[i]);
+        return true;
+    }
+    bool onRead(uint8_t*, size_t) override { return false; }
+
+private:
+    uint8_t colStart = 0, colEnd = OLED_WIDTH - 1, pageStart = 0, pageEnd = OLED_PAGES - 1;
+    uint8_t col = 0, page = 0;
+    uint8_t pending = 0, argc = 0, args[2] = {};
+
+    void command(uint8_t c) {
+        if (pending) {
+            args[argc++] = c;
+            if (argc < 2) return;
+            if (pending == 0x21) { colStart = args[0] & 0x7F; colEnd = args[1] & 0x7F; col = colStart; }
+            else                 { pageStart = args[0] & 7; pageEnd = args[1] & 7; page = pageStart; }
+            pending = 0;
+            return;
+        }
+        if (c == 0x21 || c == 0x22) { pending = c; argc = 0; }
+    }
+};
+
+static Ssd1306Model panel;
+
+// Adafruit_SSD1306::display(): dlist1 + column end, then the buffer in WIRE_MAX − 1 chunks
+static void fullDisplay(const uint8_t* frame) {
+    const uint8_t dlist1[] = { 0x00, 0x22, 0x00, 0xFF, 0x21, 0x00 };
+    const uint8_t colEnd[] = { 0x00, OLED_WIDTH - 1 };
+    hal_i2c_write(OLED_ADDRESS, dlist1, sizeof(dlist1));
+    hal_i2c_write(OLED_ADDRESS, colEnd, sizeof(colEnd));
+    uint8_t buf[ADAFRUIT_WIRE_MAX];
+    for (size_t off = 0; off < OLED_FRAME_BYTES; off += ADAFRUIT_WIRE_MAX - 1) {
+        size_t n = OLED_FRAME_BYTES - off < ADAFRUIT_WIRE_MAX - 1 ? OLED_FRAME_BYTES - off : ADAFRUIT_WIRE_MAX - 1;
+        buf[0] = 0x40;
+        memcpy(buf + 1, frame + off, n);
+        hal_i2c_write(OLED_ADDRESS, buf, n + 1);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Minimal GFX text: Adafruit cursor/size semantics, 6×8 cells
+struct Canvas {
+    uint8_t buf[OLED_FRAME_BYTES];
+    int     x = 0, y = 0, size = 1;
+
+    void clear() { memset(buf, 0, sizeof(buf)); x = y = 0; }
+    void setCursor(int cx, int cy) { x = cx; y = cy; }
+    void setTextSize(int s) { size = s; }
+
+    void pixel(int px, int py) {
+        if (px < 0 || px >= OLED_WIDTH || py < 0 || py >= OLED_PAGES * 8) return;
+        buf[(py / 8) * OLED_WIDTH + px] |= (uint8_t)(1u << (py & 7));
+    }
+
+    void glyph(uint8_t c) {
+        for (int gx = 0; gx < 5; gx++) {
+            uint32_t h = (c * 2654435761u) ^ (gx * 40503u);
+            uint8_t  bits = c == ' ' ? 0 : (uint8_t)((h >> 13) & 0x7F);
+            for (int gy = 0; gy < 7; gy++) {
+                if (!(bits & (1u << gy))) continue;
+                for (int sx = 0; sx < size; sx++)
+                    for (int sy = 0; sy < size; sy++) pixel(x + gx * size + sx, y + gy * size + sy);
+            }
+        }
+    }
+
+    void print(const char* s) {
+        for (; *s; s++) {
+            if (*s == '\n') { x = 0; y += 8 * size; continue; }
+            glyph((uint8_t)*s);
+            x += 6 * size;
+        }
+    }
+
+    void printf(const char* fmt, ...) {
+        char line[64];
+        va_list ap;
+        va_start(ap, fmt);
+        vsnprintf(line, sizeof(line), fmt, ap);
+        va_end(ap);
+        print(line);
+    }
+};
+
+static Canvas canvas;
+
+// ---------------------------------------------------------------------------
+// Layouts — text and positions as in the sketches
+static void gpsFrame(int i) {
+    double lat = 43.6543210 + uniform(-0.0000025f, 0.0000025f);
+    double lon = -79.3812340 + uniform(-0.0000025f, 0.0000025f);
+    canvas.clear();
+    canvas.setTextSize(1);
+    canvas.print("  === GPS TEST ===\n");
+    canvas.printf("Fix: GPS  Sats: %d\n", i % 37 == 0 ? 10 : 11);
+    canvas.printf("Lat:  %.6f\n", lat);
+    canvas.printf("Lon: %.6f\n", lon);
+    canvas.printf("HDOP: %.1f  Alt: %dm\n", 0.8f + (i % 5 == 0) * 0.1f, 76 + (i / 20) % 3);
+    canvas.printf("Age: %dms\n", (int)uniform(5.0f, 999.0f));
+}
+
+static void compassFrame(int i) {
+    static const char* DIRS[] = { "N  ", "NNE", "NE ", "ENE", "E  ", "ESE", "SE ", "SSE",
+                                  "S  ", "SSW", "SW ", "WSW", "W  ", "WNW", "NW ", "NNW" };
+    float az = fmodf(120.0f + 15.0f * sinf(i * 0.02f) + uniform(-1.5f, 1.5f) + 360.0f, 360.0f);
+    float r  = az * (float)(M_PI / 180.0);
+    canvas.clear();
+    canvas.setTextSize(1);
+    canvas.setCursor(0, 0);
+    canvas.print("== COMPASS TEST ==\n");
+    canvas.setTextSize(2);
+    canvas.setCursor(0, 16);
+    canvas.printf("%d\xF7 %s", (int)az, DIRS[(int)((az + 11.25f) / 22.5f) % 16]);
+    canvas.setTextSize(1);
+    canvas.setCursor(0, 40);
+    canvas.printf("X:%d Y:%d", (int)(1200 * cosf(r) + uniform(-3, 3)), (int)(-1200 * sinf(r) + uniform(-3, 3)));
+    canvas.setCursor(0, 52);
+    canvas.printf("Z:%d\n", (int)(-2400 + uniform(-3, 3)));
+}
+
+static void ultrasonicFrame(int i) {
+    // A moored dinghy approaches from ahead between frames 100 and 200
+    int fwd  = (i >= 100 && i < 200) ? 450 - (i - 100) * 4 + (int)uniform(-2, 2) : 0;
+    int port = (i % 50 < 10) ? 300 + (int)uniform(-3, 3) : 0;
+    canvas.clear();
+    canvas.setTextSize(1);
+    canvas.setCursor(0, 0);
+    canvas.print("= ULTRASONIC M9 =\n");
+    canvas.setCursor(0, 12);
+    fwd ? canvas.printf("FWD:  %d cm", fwd) : canvas.print("FWD:  --- cm");
+    canvas.setCursor(0, 22);
+    port ? canvas.printf("PORT: %d cm", port) : canvas.print("PORT: --- cm");
+    canvas.setCursor(0, 32);
+    canvas.print("STBD: --- cm");
+    canvas.setCursor(0, 50);
+    canvas.printf("> %s\n", fwd && fwd < 50 ? "STOP" : fwd && fwd < 200 ? "AVOID PORT" : "CLEAR");
+}
+
+struct Layout {
+    const char* name;
+    void      (*render)(int);
+    int         frames;
+    uint32_t    period_ms;
+};
+
+static const Layout LAYOUTS[] = {
+    { "gps_test_display", gpsFrame,        120, 1000 },
+    { "compass_test",     compassFrame,    300,  200 },
+    { "ultrasonic_test",  ultrasonicFrame, 300,  100 },
+};
+
+// ---------------------------------------------------------------------------
+struct Result {
+    double fullBytes, fullUs, dirtyBytes, dirtyUs, dirtyMaxUs, submitNs;
+    bool   match;
+};
+
+static Result runLayout(const Layout& l) {
+    Result r = {};
+    r.match = true;
+    hal_host_reset();
+    hal_host_i2c_attach(OLED_ADDRESS, &panel);
+    rngState = 9;
+
+    // Baseline pass
+    for (int i = 0; i < l.frames; i++) {
+        l.render(i);
+        uint64_t b0 = panel.bytes, t0 = hal_host_time_us();
+        fullDisplay(canvas.buf);
+        r.fullBytes += panel.bytes - b0;
+        r.fullUs    += hal_host_time_us() - t0;
+        if (memcmp(panel.ram, canvas.buf, OLED_FRAME_BYTES) != 0) r.match = false;
+        hal_host_advance_us(l.period_ms * 1000);
+    }
+
+    // Dirty-region pass: same frames, panel starts unknown
+    memset(panel.ram, 0xA5, sizeof(panel.ram));
+    rngState = 9;
+    OledFlush oled;
+    double submitNs = 0;
+    for (int i = 0; i < l.frames; i++) {
+        l.render(i);
+        auto c0 = std::chrono::steady_clock::now();
+        oled.submit(canvas.buf);
+        auto c1 = std::chrono::steady_clock::now();
+        submitNs += std::chrono::duration<double, std::nano>(c1 - c0).count();
+        while (oled.service() || !oled.idle()) {}
+        OledStats s = oled.stats();
+        if (i > 0) {   // frame 0 is the full first paint
+            r.dirtyBytes += s.last_bytes;
+            r.dirtyUs    += s.last_flush_us;
+            if (s.last_flush_us > r.dirtyMaxUs) r.dirtyMaxUs = s.last_flush_us;
+        }
+        if (memcmp(panel.ram, canvas.buf, OLED_FRAME_BYTES) != 0) r.match = false;
+        hal_host_advance_us(l.period_ms * 1000);
+    }
+    r.fullBytes  /= l.frames;
+    r.fullUs     /= l.frames;
+    r.dirtyBytes /= l.frames - 1;
+    r.dirtyUs    /= l.frames - 1;
+    r.submitNs    = submitNs / l.frames;
+    return r;
+}
+
+int main() {
+    printf("SSD1306 flush — 128x64, 400 kHz I2C, full display() vs dirty runs (chunk %d B, merge gap %d B)\n\n",
+           OLED_CHUNK_BYTES, OLED_MERGE_GAP);
+    printf("%-17s %6s | %9s %10s | %9s %10s %10s %8s | %12s\n", "layout", "frames",
+           "full B", "full ms", "dirty B", "dirty ms", "max ms", "bytes %", "submit() ns");
+
+    bool match = true, small = true;
+    for (const Layout& l : LAYOUTS) {
+        Result r = runLayout(l);
+        printf("%-17s %6d | %9.0f %10.2f | %9.1f %10.3f %10.3f %7.1f%% | %12.0f\n", l.name, l.frames,
+               r.fullBytes, r.fullUs / 1000, r.dirtyBytes, r.dirtyUs / 1000, r.dirtyMaxUs / 1000,
+               100 * r.dirtyBytes / r.fullBytes, r.submitNs);
+        match &= r.match;
+        small &= r.dirtyBytes <= 0.15 * r.fullBytes;
+    }
+    printf("\nfull: loop blocked for the whole transfer; dirty: loop pays submit() only,\n"
+           "the flush runs in the OLED task (core %d)\n\n", OLED_TASK_CORE);
+
+    check(match, "panel RAM equals every frame after each flush (both paths)");
+    check(small, "dirty flush sends <= 15% of the full-frame bytes on every layout");
+
+    // A newer frame submitted mid-flush wins; the panel converges on it
+    hal_host_reset();
+    hal_host_i2c_attach(OLED_ADDRESS, &panel);
+    static OledFlush oled;
+    rngState = 1;
+    compassFrame(0);
+    oled.submit(canvas.buf);
+    for (int k = 0; k < 3; k++) oled.service();
+    compassFrame(50);
+    uint8_t latest[OLED_FRAME_BYTES];
+    memcpy(latest, canvas.buf, sizeof(latest));
+    oled.submit(latest);
+    while (oled.service() || !oled.idle()) {}
+    OledStats s = oled.stats();
+    check(s.frames_coalesced == 1 && s.frames_flushed == 1 && memcmp(panel.ram, latest, OLED_FRAME_BYTES) == 0,
+          "frame submitted mid-flush supersedes the older one; panel shows the latest");
+
+    memset(panel.ram, 0, sizeof(panel.ram));   // panel reset behind our back
+    oled.invalidate();
+    while (oled.service() || !oled.idle()) {}
+    check(memcmp(panel.ram, latest, OLED_FRAME_BYTES) == 0 && oled.stats().last_bytes >= OLED_FRAME_BYTES,
+          "invalidate() re-sends the whole frame");
+
+    return check_summary();
+}
@@ -0,0 +1,145 @@
+// Protocol v2 Position Encoding Check — host (platform = native)
+//
+// Run:  pio run -e position_codec -t exec
+//
+// Round-trips positions through position_encode() → int24 packet fields →
+// position_decode() and reports the worst-case error in centimetres, next to
+// the error of the v1 encoding (float32 latitude/longitude).
+//
+//   Origins: equator, Toronto, 60° N, 70° S, and one straddling the antimeridian
+//   Offsets: uniform within ±5 km (race course) and ±80 km (int24 range edge)
+//
+// Pass criteria: v2 round trip ≤ 1 cm anywhere within ±80 km; offsets beyond
+// the int24 range are refused; a StatusV2Packet survives seal → dispatch.
+
+#include <stdio.h>
+#include <math.h>
+#include "common/protocol.h"
+#include "common/packet_codec.h"
+#include "common/position.h"
+#include "testing/check.h"
+
+#define SAMPLES_PER_CASE  200000
+#define MAX_ERROR_CM      1.0
+
+struct OriginCase {
+    const char* name;
+    double      lat;
+    double      lon;
+};
+
+static const OriginCase ORIGINS[] = {
+    { "equator",      0.0,        0.0       },
+    { "toronto",     43.654321, -79.381234  },
+    { "60N",         60.0,       10.0       },
+    { "70S",        -70.0,      -60.0       },
+    { "antimeridian", 10.0,     179.99      },
+};
+
+static uint64_t rngState = 42;
+static double uniform(double lo, double hi) {
+    rngState = rngState * 6364136223846793005ULL + 1442695040888963407ULL;
+    return lo + (hi - lo) * ((rngState >> 11) * (1.0 / 9007199254740992.0));
+}
+
+// Error between two e7 positions in cm, measured in the origin's local frame.
+static double errorCm(const CourseOrigin& o, int32_t latA, int32_t lonA, int32_t latB, int32_t lonB) {
+    int64_t dLon = (int64_t)lonA - lonB;
+    if (dLon >  1800000000LL) dLon -= 3600000000LL;
+    if (dLon < -1800000000LL) dLon += 3600000000LL;
+    double dn = (double)(latA - latB) * o.cm_per_e7_lat;
+    double de = (double)dLon * o.cm_per_e7_lon;
+    return sqrt(dn * dn + de * de);
+}
+
+// ---------------------------------------------------------------------------
+static double runCase(const OriginCase& c, double radiusM, double* floatMaxCm) {
+    CourseOrigin o;
+    course_origin_set(&o, deg_to_e7(c.lat), deg_to_e7(c.lon), 1);
+
+    double maxCm = 0.0;
+    *floatMaxCm  = 0.0;
+    for (int i = 0; i < SAMPLES_PER_CASE; i++) {
+        double northM = uniform(-radiusM, radiusM);
+        double eastM  = uniform(-radiusM, radiusM);
+        int32_t lat = o.lat_e7 + (int32_t)lround(northM * 100.0 / o.cm_per_e7_lat);
+        int64_t lon = (int64_t)o.lon_e7 + llround(eastM * 100.0 / o.cm_per_e7_lon);
+        if (lon >  1800000000LL) lon -= 3600000000LL;
+        if (lon < -1800000000LL) lon += 3600000000LL;
+
+        // v2: encode, pack into a packet field, unpack, decode
+        PositionCm p;
+        if (!position_encode(o, lat, (int32_t)lon, &p)) { check_failures++; continue; }
+        uint8_t n24[3], e24[3];
+        pos24_put(n24, p.north_cm);
+        pos24_put(e24, p.east_cm);
+        PositionCm q = { pos24_get(n24), pos24_get(e24) };
+        int32_t latOut, lonOut;
+        position_decode(o, q, &latOut, &lonOut);
+        double e = errorCm(o, lat, (int32_t)lon, latOut, lonOut);
+        if (e > maxCm) maxCm = e;
+
+        // v1: float32 degrees
+        float   fLat = (float)e7_to_deg(lat);
+        float   fLon = (float)e7_to_deg((int32_t)lon);
+        double  ef   = errorCm(o, lat, (int32_t)lon, deg_to_e7(fLat), deg_to_e7(fLon));
+        if (ef > *floatMaxCm) *floatMaxCm = ef;
+    }
+    return maxCm;
+}
+
+// ---------------------------------------------------------------------------
+struct StatusCheck : PacketHandlerBase {
+    int32_t north = 0, east = 0;
+    uint8_t seq = 0;
+    void onStatusV2(const StatusV2Packet& p) {
+        north = pos24_get(p.current_north_cm);
+        east  = pos24_get(p.current_east_cm);
+        seq   = p.origin_seq;
+    }
+};
+
+int main() {
+    printf("Protocol v2 position round trip — %d samples per case\n\n", SAMPLES_PER_CASE);
+    printf("%-13s %8s %14s %16s\n", "origin", "radius", "v2 max err cm", "float32 max cm");
+
+    double worst = 0.0;
+    static const double RADII_M[] = { 5000.0, 80000.0 };
+    for (size_t r = 0; r < 2; r++) {
+        for (size_t i = 0; i < sizeof(ORIGINS) / sizeof(ORIGINS[0]); i++) {
+            double floatMax;
+            double v2Max = runCase(ORIGINS[i], RADII_M[r], &floatMax);
+            if (v2Max > worst) worst = v2Max;
+            printf("%-13s %6.0fkm %14.3f %16.1f\n", ORIGINS[i].name, RADII_M[r] / 1000.0, v2Max, floatMax);
+        }
+    }
+
+    printf("\nPacket sizes (bytes): v1 -> v2\n");
+    printf("  ASSIGN      %2u -> %2u\n", (unsigned)sizeof(AssignPacket),    (unsigned)sizeof(AssignV2Packet));
+    printf("  ACK_ASSIGN  %2u -> %2u\n", (unsigned)sizeof(AckAssignPacket), (unsigned)sizeof(AckAssignV2Packet));
+    printf("  STATUS      %2u -> %2u\n", (unsigned)sizeof(StatusPacket),    (unsigned)sizeof(StatusV2Packet));
+    printf("  FleetEntry  13 -> %2u  (%u per summary frame)\n",
+           (unsigned)sizeof(FleetEntry), (unsigned)FLEET_SUMMARY_MAX_ENTRIES);
+    printf("\n");
+
+    check(worst <= MAX_ERROR_CM, "v2 round trip within 1 cm up to ±80 km");
+
+    CourseOrigin o;
+    course_origin_set(&o, deg_to_e7(43.65), deg_to_e7(-79.38), 7);
+    PositionCm p;
+    check(!position_encode(o, o.lat_e7 + 8000000, o.lon_e7, &p), "offset beyond int24 range refused");
+
+    StatusV2Packet s = {};
+    s.packet_type = PKT_STATUS_V2;
+    s.buoy_id     = BUOY_WINDWARD;
+    s.origin_seq  = o.seq;
+    pos24_put(s.current_north_cm, -123456);
+    pos24_put(s.current_east_cm,   7654321);
+    StatusCheck h;
+    PacketDispatcher<StatusCheck> d(h);
+    check(d.dispatch((const uint8_t*)&s, packet_seal(s)) == PACKET_OK &&
+          h.north == -123456 && h.east == 7654321 && h.seq == 7,
+          "StatusV2Packet seal -> dispatch keeps int24 offsets");
+
+    return check_summary();
+}
@@ -0,0 +1,384 @@
+// Inter-Task Queue Benchmark — host (platform = native)
+//
+// Run:  pio run -e task_queues -t exec
+//
+// Part 1 — cost per message, first on one thread (push + pop, uncontended:
+// the atomics vs lock/unlock), then on two real threads (the two ESP32-S3
+// cores' stand-in):
+//
+//   messages   SpscRing<ControlRecord, 16> vs a mutex-guarded ring of the same
+//              size (what a locked queue costs); producer pushes N records,
+//              consumer pops and checks the sequence
+//   latest     TripleBuffer<HeadingSample> vs a mutex-guarded copy of the
+//              latest sample; writer publishes as fast as it can, reader
+//              reads the newest. Every sample carries its sequence in all
+//              fields, so a torn read (fields from two samples) is detected
+//
+// Part 2 — the buoy task table (tasks/buoy_tasks.h) on the virtual clock,
+// 60 s: sensor publishes heading/ranges every step, GPS at 10 Hz and wind
+// at 2 Hz; control reads the latest of each and logs a ControlRecord;
+// radio wakes on notify() from control (a queued send) or its 5 ms
+// heartbeat; UI drains the log. Each step charges a modelled cost to the
+// clock. Reports per-task runs, CPU, worst step and start latency, and CPU
+// per core.
+//
+// Pass criteria: no lost, reordered or torn message; SpscRing push + pop at
+// most half the locked ring's cost, and on a multi-core host at least 2×
+// its cross-thread throughput (a single-core host only time-slices the two
+// threads, so that check is skipped there); every task ran at its rate with no
+// overrun; control never used a sample older than one sensor period; the
+// UI received every ControlRecord.
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "common/config.h"
+#include "common/spsc_ring.h"
+#include "common/triple_buffer.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/tasks/task_set.h"
+#include "firmware/common/tasks/buoy_tasks.h"
+#include "testing/check.h"
+
+#define MESSAGES        4000000u
+#define LATEST_WRITES   4000000u
+#define SIM_US          60000000u
+
+static double seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------------------------------------------------------------------------
+// Baselines: the same shapes behind a mutex
+template <typename T, size_t N>
+class LockedRing {
+public:
+    bool push(const T& v) {
+        std::lock_guard<std::mutex> g(m);
+        if (n == N) return false;
+        buf[(head + n++) % N] = v;
+        return true;
+    }
+    bool pop(T* out) {
+        std::lock_guard<std::mutex> g(m);
+        if (n == 0) return false;
+        *out = buf[head];
+        head = (head + 1) % N;
+        n--;
+        return true;
+    }
+
+private:
+    std::mutex m;
+    T          buf[N];
+    size_t     head = 0, n = 0;
+};
+
+template <typename T>
+class LockedLatest {
+public:
+    void publish(const T& v) { std::lock_guard<std::mutex> g(m); value = v; count++; }
+    bool read(T* out) {
+        std::lock_guard<std::mutex> g(m);
+        if (!count) return false;
+        *out = value;
+        return true;
+    }
+
+private:
+    std::mutex m;
+    T          value{};
+    uint32_t   count = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Part 1a — messages
+struct MsgResult { double mps; bool ordered; };
+
+template <typename Ring>
+static MsgResult runMessages(Ring& ring) {
+    std::atomic<bool> go(false);
+    bool   ordered = true;
+    double t0 = 0;
+    std::thread consumer([&] {
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+        ControlRecord r;
+        for (uint32_t expect = 0; expect < MESSAGES;) {
+            if (!ring.pop(&r)) { std::this_thread::yield(); continue; }
+            if (r.seq != expect || r.t_us != expect * 3u) ordered = false;
+            expect++;
+        }
+    });
+    t0 = seconds();
+    go.store(true, std::memory_order_release);
+    ControlRecord r = {};
+    for (uint32_t i = 0; i < MESSAGES; i++) {
+        r.seq  = i;
+        r.t_us = i * 3u;
+        while (!ring.push(r)) std::this_thread::yield();
+    }
+    consumer.join();
+    return { MESSAGES / (seconds() - t0), ordered };
+}
+
+// Uncontended push + pop pairs, ns each
+template <typename Ring>
+static double pairNs(Ring& ring) {
+    ControlRecord r = {}, out = {};
+    uint32_t      sum = 0;
+    double        t0  = seconds();
+    for (uint32_t i = 0; i < MESSAGES; i++) {
+        r.seq = i;
+        ring.push(r);
+        ring.pop(&out);
+        sum += out.seq;
+    }
+    double ns = (seconds() - t0) * 1e9 / MESSAGES;
+    return sum == (uint32_t)((uint64_t)MESSAGES * (MESSAGES - 1) / 2) ? ns : -1;
+}
+
+// Part 1b — latest sample
+struct LatestResult { double wps, rps; uint32_t reads, torn, backwards; };
+
+static bool consistent(const HeadingSample& s) {
+    return s.raw_x == (int16_t)s.t_us && s.raw_y == (int16_t)~s.t_us && s.raw_z == (int16_t)(s.t_us >> 3) &&
+           s.heading_deg == (float)(s.t_us % 3600) * 0.1f;
+}
+
+static void fill(HeadingSample* s, uint32_t seq) {
+    s->t_us        = seq;
+    s->raw_x       = (int16_t)seq;
+    s->raw_y       = (int16_t)~seq;
+    s->raw_z       = (int16_t)(seq >> 3);
+    s->heading_deg = (float)(seq % 3600) * 0.1f;
+}
+
+static LatestResult runTriple() {
+    TripleBuffer<HeadingSample> tb;
+    std::atomic<bool> done(false);
+    LatestResult res = {};
+    uint32_t last = 0;
+    std::thread reader([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            const HeadingSample* s = tb.read();
+            if (!s) continue;
+            res.reads++;
+            if (!consistent(*s)) res.torn++;
+            if (s->t_us < last) res.backwards++;
+            last = s->t_us;
+        }
+    });
+    double t0 = seconds();
+    for (uint32_t i = 1; i <= LATEST_WRITES; i++) {
+        fill(tb.write(), i);
+        tb.publish();
+    }
+    double tw = seconds() - t0;
+    done.store(true, std::memory_order_release);
+    reader.join();
+    double tr = seconds() - t0;
+    res.wps = LATEST_WRITES / tw;
+    res.rps = res.reads / tr;
+    return res;
+}
+
+static LatestResult runLockedLatest() {
+    LockedLatest<HeadingSample> lk;
+    std::atomic<bool> done(false);
+    LatestResult res = {};
+    uint32_t last = 0;
+    std::thread reader([&] {
+        HeadingSample s;
+        while (!done.load(std::memory_order_acquire)) {
+            if (!lk.read(&s)) continue;
+            res.reads++;
+            if (!consistent(s)) res.torn++;
+            if (s.t_us < last) res.backwards++;
+            last = s.t_us;
+        }
+    });
+    double t0 = seconds();
+    HeadingSample s;
+    for (uint32_t i = 1; i <= LATEST_WRITES; i++) {
+        fill(&s, i);
+        lk.publish(s);
+    }
+    double tw = seconds() - t0;
+    done.store(true, std::memory_order_release);
+    reader.join();
+    double tr = seconds() - t0;
+    res.wps = LATEST_WRITES / tw;
+    res.rps = res.reads / tr;
+    return res;
+}
+
+// ---------------------------------------------------------------------------
+// Part 2 — buoy tasks on the virtual clock
+#define COST_SENSOR_US    900     // compass + ranges via the bus, GPS/wind bookkeeping
+#define COST_CONTROL_US   2500
+#define COST_RADIO_US     150
+#define COST_UI_US        4000    // format + OledFlush::submit
+
+struct Buoy {
+    BuoyChannels ch;
+    TaskSet      tasks;
+    int          radioId;
+    uint32_t     sensorRuns, radioWakes, radioSends, logged, logDropped, logSeqErrors;
+    uint32_t     controlSeq, maxAgeUs, controlMissing;
+    uint32_t     pendingSends, lastRadioUs, maxRadioGapUs;
+};
+
+static void sensorStep(void* ctx) {
+    Buoy* b = static_cast<Buoy*>(ctx);
+    uint32_t now = hal_micros();
+    uint32_t n   = b->sensorRuns++;
+
+    HeadingSample* h = b->ch.heading.write();
+    fill(h, n);
+    h->t_us = now;
+    b->ch.heading.publish();
+
+    RangeSample* r = b->ch.range.write();
+    r->t_us = now;
+    r->scan = { (uint16_t)(300 + n % 50), 400, 400 };
+    b->ch.range.publish();
+
+    if (n % 5 == 0) {   // 10 Hz GPS
+        GpsSample* g = b->ch.gps.write();
+        *g = { now, 436543210 + (int32_t)n, -793812340, 8, 1, 11 };
+        b->ch.gps.publish();
+    }
+    if (n % 25 == 0) {  // 2 Hz wind
+        WindSample* w = b->ch.wind.write();
+        *w = { now, 215.0f, 18.0f, 24.0f, 12.0f };
+        b->ch.wind.publish();
+    }
+    hal_host_advance_us(COST_SENSOR_US);
+}
+
+static void controlStep(void* ctx) {
+    Buoy* b = static_cast<Buoy*>(ctx);
+    uint32_t now = hal_micros();
+    const HeadingSample* h = b->ch.heading.read();
+    const RangeSample*   r = b->ch.range.read();
+    const GpsSample*     g = b->ch.gps.read();
+    if (!h || !r || !g) {
+        b->controlMissing++;
+    } else {
+        uint32_t age = now - h->t_us;
+        if (now - r->t_us > age) age = now - r->t_us;
+        if (age > b->maxAgeUs) b->maxAgeUs = age;
+
+        ControlRecord rec = {};
+        rec.t_us             = now;
+        rec.seq              = b->controlSeq++;
+        rec.zone             = (uint8_t)ultrasonic_classify(r->scan);
+        rec.heading_cmd_cdeg = (int16_t)(h->heading_deg * 100);
+        rec.sample_age_ms    = (uint16_t)(age / 1000);
+        if (!b->ch.log.push(rec)) b->logDropped++;
+    }
+    if (b->controlSeq % 5 == 0) {   // STATUS at 2 Hz: queue it, wake the radio
+        b->pendingSends++;
+        b->tasks.notify(b->radioId);
+    }
+    hal_host_advance_us(COST_CONTROL_US);
+}
+
+static void radioStep(void* ctx) {
+    Buoy* b = static_cast<Buoy*>(ctx);
+    uint32_t now = hal_micros();
+    if (b->radioWakes++ && now - b->lastRadioUs > b->maxRadioGapUs) b->maxRadioGapUs = now - b->lastRadioUs;
+    b->lastRadioUs = now;
+    b->radioSends  += b->pendingSends;
+    b->pendingSends = 0;
+    hal_host_advance_us(COST_RADIO_US);
+}
+
+static void uiStep(void* ctx) {
+    Buoy* b = static_cast<Buoy*>(ctx);
+    ControlRecord rec;
+    while (b->ch.log.pop(&rec)) {
+        if (rec.seq != b->logged) b->logSeqErrors++;
+        b->logged++;
+    }
+    hal_host_advance_us(COST_UI_US);
+}
+
+static void runTasks() {
+    hal_host_reset();
+    static Buoy b;
+    b.tasks.add(buoy_task(TASK_SENSOR, sensorStep, &b));
+    b.tasks.add(buoy_task(TASK_CONTROL, controlStep, &b));
+    b.radioId = b.tasks.add(buoy_task(TASK_RADIO, radioStep, &b));
+    b.tasks.add(buoy_task(TASK_UI, uiStep, &b));
+    b.tasks.start();
+    b.tasks.runFor(SIM_US);
+
+    uint32_t window = b.tasks.windowUs();
+    printf("\n  %-8s %4s %4s %9s %7s %7s %6s %9s %9s %8s\n",
+           "task", "core", "prio", "period", "runs", "rate", "cpu", "step max", "late max", "overrun");
+    bool ratesOk = true, overrunsOk = true;
+    for (int i = 0; i < b.tasks.tasks(); i++) {
+        TaskStats s = b.tasks.stats(i);
+        double rate = s.runs / (window / 1e6);
+        printf("  %-8s %4u %4u %6.1f ms %7u %5.1f/s %5.1f%% %6u us %6u us %8u\n",
+               s.name, s.core, s.priority, s.period_us / 1000.0, (unsigned)s.runs, rate,
+               100.0 * s.busy_us / window, (unsigned)s.step_max_us, (unsigned)s.late_max_us, (unsigned)s.overruns);
+        if (s.overruns) overrunsOk = false;
+        if (!BUOY_TASKS[i].notifiable && s.runs + 1 < window / s.period_us) ratesOk = false;
+    }
+    for (uint8_t c = 0; c < TASK_CORES; c++) {
+        printf("  core %u: %.1f%% busy\n", c, 100.0 * b.tasks.coreBusyUs(c) / window);
+    }
+    printf("  radio: %u wakes (longest gap %.1f ms), %u sends; log: %u records, %u dropped; oldest control input %.1f ms\n\n",
+           (unsigned)b.radioWakes, b.maxRadioGapUs / 1000.0, (unsigned)b.radioSends, (unsigned)b.logged, (unsigned)b.logDropped,
+           b.maxAgeUs / 1000.0);
+
+    check(ratesOk, "fixed-rate tasks ran at their period");
+    check(overrunsOk, "no step overran its period");
+    check(b.controlMissing == 0 && b.maxAgeUs <= TASK_SENSOR_PERIOD_US,
+          "control always had samples, none older than one sensor period");
+    check(b.logged == b.controlSeq && b.logDropped == 0 && b.logSeqErrors == 0,
+          "UI received every ControlRecord in order");
+    // One host thread: a radio step due during another task's step waits for it
+    check(b.radioSends == b.controlSeq / 5 && b.maxRadioGapUs <= TASK_RADIO_PERIOD_US + COST_RADIO_US + COST_UI_US,
+          "radio handled every notify and kept its heartbeat");
+}
+
+int main() {
+    printf("\n=== Inter-task queues: %u messages, %u latest-sample writes ===\n", MESSAGES, LATEST_WRITES);
+    printf("  (host threads: %u hardware threads)\n", std::thread::hardware_concurrency());
+
+    static SpscRing<ControlRecord, TASK_LOG_QUEUE>   spsc;
+    static LockedRing<ControlRecord, TASK_LOG_QUEUE> locked;
+    double    ap = pairNs(spsc);
+    double    lp = pairNs(locked);
+    MsgResult a  = runMessages(spsc);
+    MsgResult l  = runMessages(locked);
+    printf("\n  %-26s %14s %14s %9s\n", "messages (ControlRecord)", "push+pop ns", "2-thread msg/s", "ns/msg");
+    printf("  %-26s %14.1f %14.0f %9.1f\n", "SpscRing", ap, a.mps, 1e9 / a.mps);
+    printf("  %-26s %14.1f %14.0f %9.1f\n", "mutex ring", lp, l.mps, 1e9 / l.mps);
+
+    LatestResult t = runTriple();
+    LatestResult m = runLockedLatest();
+    printf("\n  %-26s %12s %12s %8s\n", "latest (HeadingSample)", "writes/s", "reads/s", "torn");
+    printf("  %-26s %12.0f %12.0f %8u\n", "TripleBuffer", t.wps, t.rps, (unsigned)t.torn);
+    printf("  %-26s %12.0f %12.0f %8u\n\n", "mutex copy", m.wps, m.rps, (unsigned)m.torn);
+
+    check(a.ordered && l.ordered, "every message arrived once, in order");
+    check(ap > 0 && lp > 0 && 2 * ap <= lp, "SpscRing push + pop ≤ half the locked ring's cost");
+    if (std::thread::hardware_concurrency() >= 2) {
+        check(a.mps >= 2 * l.mps, "SpscRing ≥ 2× the locked ring's cross-thread throughput");
+    } else {
+        printf("  [SKIP] cross-thread throughput: single-core host\n");
+    }
+    check(t.torn == 0 && t.backwards == 0 && t.reads > 0, "TripleBuffer: no torn or stale-after-newer reads");
+
+    printf("\n-- buoy tasks, %u s virtual --", SIM_US / 1000000u);
+    runTasks();
+
+    return check_summary();
+}
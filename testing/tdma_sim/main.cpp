@@ -0,0 +1,306 @@
+// TDMA Superframe Simulation — host (platform = native)
+//
+// Run:  pio run -e tdma_sim -t exec
+//
+// Runs the common/tdma.cpp scheduler for a master, N slaves and two remotes
+// (both BUOY_REMOTE) on a shared simulated channel:
+//   - slave crystals drift uniformly within ±40 ppm, local µs clocks start
+//     near the 32-bit wrap so wrap-around is exercised
+//   - beacon RX-done is timestamped 0–300 µs late (IRQ + SPI latency),
+//     slaves start their TX 0–200 µs after the scheduled time (loop jitter)
+//   - each slave misses 5% of beacons; slave 1 is deaf for 10 superframes
+//   - each remote issues a PKT_RC_* command every 20 s on average (Poisson)
+//     and sends it in a random contention sub-slot, retrying on collision
+//
+// Every transmission is checked against every other and against its slot
+// boundaries in master time. Reports superframe length, designed utilisation,
+// per-slave telemetry rate and RC latency, next to the old reply stagger
+// (REPLY_DELAY_BASE_MS 100 + id × REPLY_DELAY_PER_ID_MS 50 after a master frame).
+//
+// Pass criteria: zero collisions and zero slot overruns in scheduled traffic;
+// a slave stops transmitting after TDMA_MAX_MISSED_BEACONS and re-syncs on
+// the next beacon.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "common/protocol.h"
+#include "common/packet_codec.h"
+#include "common/lora_airtime.h"
+#include "common/tdma.h"
+#include "testing/check.h"
+
+#define SUPERFRAMES         20000
+#define BEACON_LOSS         0.05
+#define DRIFT_PPM           40.0
+#define RX_LATENCY_MAX_US   300
+#define TX_JITTER_MAX_US    200
+#define RC_MEAN_INTERVAL_S  20.0
+#define REMOTES             2
+#define DEAF_FROM           100     // slave 1 misses beacons DEAF_FROM .. DEAF_FROM + 9
+#define DEAF_FRAMES         10
+
+// Old scheme, for comparison
+#define LEGACY_REPLY_BASE_MS    100
+#define LEGACY_REPLY_PER_ID_MS  50
+
+static const LoRaModem& MODEM = LORA_MODEM_DEFAULT;
+
+static uint64_t rngState = 7;
+static double uniform01() {
+    rngState = rngState * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (rngState >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// ---------------------------------------------------------------------------
+// Node clocks: local = offset + global × (1 + ppm·1e-6), wrapping at 2^32 µs
+// ---------------------------------------------------------------------------
+struct Clock {
+    double   ppm;
+    uint32_t offset;
+
+    uint32_t local(double g) const { return offset + (uint32_t)(uint64_t)llround(g * (1.0 + ppm * 1e-6)); }
+    double   global(uint32_t l, double gRef) const {
+        return gRef + (int32_t)(l - local(gRef)) / (1.0 + ppm * 1e-6);
+    }
+};
+
+struct Node {
+    uint8_t  id;
+    Clock    clock;
+    TdmaSync sync;
+    uint32_t sent;
+    uint32_t skipped;       // own slot passed while not locked
+    // remotes only
+    bool     pending;
+    double   requestAt;
+    double   nextRequest;
+};
+
+struct Tx {
+    double  start;
+    double  end;
+    uint8_t node;           // index into nodes[], 0 = master
+    bool    contention;
+    int     slot;
+};
+
+struct RunStats {
+    uint32_t superframeUs;
+    uint32_t airtimeUs;
+    uint32_t collisions;        // scheduled traffic
+    uint32_t rcCollisions;      // remote vs remote in the contention slot
+    uint32_t overruns;
+    uint32_t uplinks;
+    uint32_t skipped;
+    uint32_t rcSent;
+    double   rcLatencySum;
+    double   rcLatencyMax;
+    bool     deafStopped;
+    bool     deafResynced;
+};
+
+static int cmpDouble(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+// ---------------------------------------------------------------------------
+static RunStats run(const TdmaConfig& cfg, double* rcP99) {
+    RunStats st = {};
+    TdmaSchedule sched;
+    tdma_build_schedule(MODEM, cfg, &sched);
+    st.superframeUs = sched.superframe_us;
+    st.airtimeUs    = sched.airtime_us;
+
+    const int slaves = cfg.uplink_slots;
+    const int nodeCount = 1 + slaves + REMOTES;
+    static Node nodes[1 + TDMA_MAX_UPLINK_SLOTS + REMOTES];
+    for (int i = 0; i < nodeCount; i++) {
+        Node& n = nodes[i];
+        n = Node();
+        n.id = i == 0 ? (uint8_t)BUOY_MASTER : (i <= slaves ? (uint8_t)i : (uint8_t)BUOY_REMOTE);
+        n.clock.ppm    = i == 0 ? 0.0 : (uniform01() * 2.0 - 1.0) * DRIFT_PPM;
+        n.clock.offset = i == 0 ? 0 : 0xFFFFFFFFu - (uint32_t)(uniform01() * 60e6);   // wraps in < 60 s
+        n.nextRequest  = -log(1.0 - uniform01()) * RC_MEAN_INTERVAL_S * 1e6;
+    }
+
+    static double rcLatency[SUPERFRAMES * REMOTES];
+    static Tx     txs[TDMA_MAX_SLOTS + REMOTES];
+    Tx   lastTx = { -1e18, -1e18, 0, false, -1 };
+    int  deafTxDuringOutage = 0;
+    int  deafTxAfter        = 0;
+
+    for (uint32_t k = 0; k < SUPERFRAMES; k++) {
+        const double T = (double)k * sched.superframe_us;   // master clock is the reference
+        int nTx = 0;
+
+        BeaconPacket beacon;
+        tdma_fill_beacon(&beacon, cfg, FLEET_STATE_READY, (uint8_t)k);
+        uint8_t beaconLen = packet_seal(beacon);
+
+        // Master: beacon + downlink
+        TdmaSync master;
+        tdma_master_start(&master, (uint32_t)(uint64_t)T, (uint8_t)k);
+        for (uint8_t s = 0; s < sched.count && sched.slot[s].owner == BUOY_MASTER; s++) {
+            double start = T + sched.slot[s].start_us + TDMA_GUARD_US / 2;
+            txs[nTx++] = { start, start + sched.slot[s].length_us - TDMA_GUARD_US, 0, false, s };
+        }
+        const double rxDone = T + TDMA_GUARD_US / 2 + sched.beacon_us;
+
+        for (int i = 1; i < nodeCount; i++) {
+            Node& n = nodes[i];
+            bool deaf = n.id == 1 && k >= DEAF_FROM && k < DEAF_FROM + DEAF_FRAMES;
+            bool heard = !deaf && uniform01() >= BEACON_LOSS;
+            double rxAt = rxDone + uniform01() * RX_LATENCY_MAX_US;
+            if (heard) {
+                if (packet_view<BeaconPacket>((const uint8_t*)&beacon, beaconLen)) {
+                    TdmaSchedule rxSched;
+                    tdma_build_schedule(MODEM, tdma_config_from_beacon(beacon), &rxSched);
+                    tdma_on_beacon(&n.sync, rxSched, beacon, n.clock.local(rxAt));
+                }
+            } else {
+                tdma_advance(&n.sync, sched, n.clock.local(rxAt));
+            }
+
+            int slot;
+            if (n.id == BUOY_REMOTE) {
+                if (!n.pending && n.nextRequest < T + sched.superframe_us) {
+                    n.pending   = true;
+                    n.requestAt = n.nextRequest;
+                    n.nextRequest += -log(1.0 - uniform01()) * RC_MEAN_INTERVAL_S * 1e6;
+                }
+                if (!n.pending) continue;
+                slot = tdma_contention_slot(sched, (uint8_t)(uniform01() * cfg.contention_slots));
+                if (slot >= 0 && n.requestAt > T + sched.slot[slot].start_us) continue;   // too late for this one
+            } else {
+                slot = tdma_uplink_slot(sched, n.id);
+            }
+            if (slot < 0) continue;
+
+            if (!n.sync.locked) {
+                if (n.id != BUOY_REMOTE) n.skipped++;
+                continue;
+            }
+            uint32_t txLocal = tdma_tx_time_us(n.sync, sched, (uint8_t)slot) + (uint32_t)(uniform01() * TX_JITTER_MAX_US);
+            if (!tdma_may_transmit(n.sync, sched, (uint8_t)slot, txLocal)) {
+                if (n.id != BUOY_REMOTE) n.skipped++;
+                continue;
+            }
+            double start = n.clock.global(txLocal, rxAt);
+            double len   = sched.slot[slot].length_us - TDMA_GUARD_US;
+            txs[nTx++] = { start, start + len, (uint8_t)i, n.id == BUOY_REMOTE, slot };
+            n.sent++;
+
+            if (n.id == 1) {
+                if (k >= DEAF_FROM + TDMA_MAX_MISSED_BEACONS && k < DEAF_FROM + DEAF_FRAMES) deafTxDuringOutage++;
+                if (k == DEAF_FROM + DEAF_FRAMES) deafTxAfter++;
+            }
+        }
+
+        // Channel: slot containment, then pairwise overlap
+        qsort(txs, nTx, sizeof(Tx), [](const void* a, const void* b) {
+            return cmpDouble(&((const Tx*)a)->start, &((const Tx*)b)->start);
+        });
+        bool rcHit[REMOTES + 1 + TDMA_MAX_UPLINK_SLOTS + 1] = {};
+        for (int a = 0; a < nTx; a++) {
+            const TdmaSlot& s = sched.slot[txs[a].slot];
+            if (txs[a].start < T + s.start_us || txs[a].end > T + s.start_us + s.length_us) st.overruns++;
+            const Tx& prev = a == 0 ? lastTx : txs[a - 1];
+            if (txs[a].start < prev.end) {
+                if (txs[a].contention && prev.contention) {
+                    st.rcCollisions++;
+                    rcHit[txs[a].node] = rcHit[prev.node] = true;
+                } else {
+                    st.collisions++;
+                }
+            }
+        }
+        if (nTx) lastTx = txs[nTx - 1];
+
+        for (int a = 0; a < nTx; a++) {
+            Node& n = nodes[txs[a].node];
+            if (!txs[a].contention || rcHit[txs[a].node]) continue;
+            double lat = txs[a].end - n.requestAt;
+            rcLatency[st.rcSent++] = lat;
+            st.rcLatencySum += lat;
+            if (lat > st.rcLatencyMax) st.rcLatencyMax = lat;
+            n.pending = false;
+        }
+    }
+
+    for (int i = 1; i <= slaves; i++) {
+        st.uplinks += nodes[i].sent;
+        st.skipped += nodes[i].skipped;
+    }
+    st.deafStopped  = deafTxDuringOutage == 0;
+    st.deafResynced = deafTxAfter == 1;
+
+    qsort(rcLatency, st.rcSent, sizeof(double), cmpDouble);
+    *rcP99 = st.rcSent ? rcLatency[(size_t)(st.rcSent * 0.99)] : 0.0;
+    return st;
+}
+
+// ---------------------------------------------------------------------------
+// Old stagger: master frame, then slave id replies REPLY_DELAY_BASE + id × PER_ID
+// ms after it ends. Returns cycle length; counts overlapping reply pairs.
+static uint32_t legacyCycleUs(int slaves, uint16_t masterLen, uint16_t replyLen, int* overlaps) {
+    uint32_t masterUs = lora_time_on_air_us(MODEM, masterLen);
+    uint32_t replyUs  = lora_time_on_air_us(MODEM, replyLen);
+    *overlaps = 0;
+    for (int id = 2; id <= slaves; id++) {
+        if (LEGACY_REPLY_PER_ID_MS * 1000u < replyUs) (*overlaps)++;
+    }
+    return masterUs + (LEGACY_REPLY_BASE_MS + slaves * LEGACY_REPLY_PER_ID_MS) * 1000u + replyUs;
+}
+
+int main() {
+    printf("TDMA superframe simulation — SF%u, %lu Hz, CR4/%u, guard %u us, %d superframes per layout\n\n",
+           MODEM.sf, (unsigned long)MODEM.bw_hz, MODEM.cr_denom, TDMA_GUARD_US, SUPERFRAMES);
+
+    struct Layout { const char* name; TdmaConfig cfg; };
+    const Layout layouts[] = {
+        { "default",         TDMA_CONFIG_DEFAULT },
+        { "4 x STATUS_V2",   { 4,  0,                                 sizeof(StatusV2Packet), 2 } },
+        { "16 + summary",    { 16, (uint8_t)fleet_summary_size(16),   sizeof(StatusV2Packet), 2 } },
+        { "32 + summary",    { 32, (uint8_t)fleet_summary_size(FLEET_SUMMARY_MAX_ENTRIES), sizeof(StatusV2Packet), 4 } },
+    };
+
+    printf("%-14s %6s %11s %8s %9s %9s %7s %7s %6s %9s %9s\n",
+           "layout", "slaves", "superframe", "util", "per-slave", "fleet", "collide", "overrun",
+           "rc-col", "rc mean", "rc p99");
+    printf("%-14s %6s %11s %8s %9s %9s %7s %7s %6s %9s %9s\n",
+           "", "", "ms", "", "Hz", "upd/s", "", "", "", "ms", "ms");
+
+    uint32_t collisions = 0, overruns = 0;
+    bool stopped = true, resynced = true;
+    for (size_t i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++) {
+        const Layout& l = layouts[i];
+        double p99;
+        RunStats st = run(l.cfg, &p99);
+        double simS = (double)SUPERFRAMES * st.superframeUs / 1e6;
+        printf("%-14s %6u %11.2f %7.1f%% %9.2f %9.2f %7u %7u %6u %9.1f %9.1f\n",
+               l.name, l.cfg.uplink_slots, st.superframeUs / 1000.0, 100.0 * st.airtimeUs / st.superframeUs,
+               1e6 / st.superframeUs, st.uplinks / simS, st.collisions, st.overruns, st.rcCollisions,
+               st.rcSent ? st.rcLatencySum / st.rcSent / 1000.0 : 0.0, p99 / 1000.0);
+        collisions += st.collisions;
+        overruns   += st.overruns;
+        stopped  = stopped && st.deafStopped;
+        resynced = resynced && st.deafResynced;
+    }
+
+    int overlaps;
+    uint32_t legacyUs = legacyCycleUs(MAX_BUOYS - 2, sizeof(AssignPacket), sizeof(StatusPacket), &overlaps);
+    uint32_t legacyAir = lora_time_on_air_us(MODEM, sizeof(AssignPacket))
+                       + (MAX_BUOYS - 2) * lora_time_on_air_us(MODEM, sizeof(StatusPacket));
+    printf("\nold reply stagger, %d slaves: cycle %.2f ms, utilisation %.1f%%, %.2f Hz per slave, "
+           "%d adjacent reply pairs overlap (STATUS %.2f ms > %d ms spacing)\n\n",
+           MAX_BUOYS - 2, legacyUs / 1000.0, 100.0 * legacyAir / legacyUs, 1e6 / legacyUs, overlaps,
+           lora_time_on_air_us(MODEM, sizeof(StatusPacket)) / 1000.0, LEGACY_REPLY_PER_ID_MS);
+
+    check(collisions == 0, "no collisions in scheduled traffic");
+    check(overruns == 0, "every transmission stays inside its slot");
+    check(stopped, "slave goes quiet after TDMA_MAX_MISSED_BEACONS missed beacons");
+    check(resynced, "slave re-syncs and transmits on the next beacon");
+    return check_summary();
+}
@@ -0,0 +1,246 @@
+// Telemetry Check — host (platform = native)
+//
+// Run:  pio run -e telemetry -t exec
+//
+// Serial telemetry (firmware/common/telemetry/telemetry.h) written by
+// Telemetry and read back by TelemReader, as testing/telemetry_decode does:
+//   1. COBS: random payloads with and without zeros round-trip, no 0x00 in
+//      the encoding, overhead within COBS_MAX_ENCODED
+//   2. round trip: WIND and RANGE records with edge values (negative, clamped,
+//      enum labels) come back as the scaled integers, with time and sequence
+//   3. text mode: the same record as the sketches' tab-separated line
+//   4. damage: a flipped byte costs that record only (CRC), the sequence gap
+//      is counted; a reader started mid-stream syncs at the next delimiter
+//   5. console text between loops (config replies) is reported as text and
+//      leaves the records alone
+//   6. limits: buffer full and schema mismatches are counted, not written
+//   7. cost: bytes and CPU per WIND record, binary against text
+//
+// Pass criteria: every check below; a binary WIND record is at most half the
+// bytes of its text line and at least 3× cheaper to produce.
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "common/cobs.h"
+#include "firmware/common/telemetry/telemetry.h"
+#include "testing/check.h"
+
+static double seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Wind {
+    float vane_raw, vane_rel, compass, abs_wind, error, speed, gust, lull, mean, cvar, shift, state;
+};
+
+static void addWind(Telemetry& tm, uint32_t t, const Wind& w) {
+    tm.begin(TELEM_WIND, t);
+    tm.add(w.vane_raw);
+    tm.add(w.vane_rel);
+    tm.add(w.compass);
+    tm.add(w.abs_wind);
+    tm.add(w.error);
+    tm.add(w.speed);
+    tm.add(w.gust);
+    tm.add(w.lull);
+    tm.add(w.mean);
+    tm.add(w.cvar);
+    tm.add(w.shift);
+    tm.add(w.state);
+    tm.end();
+}
+
+static void addRange(Telemetry& tm, uint32_t t, uint16_t fwd, uint8_t zone, uint32_t oled_us) {
+    tm.begin(TELEM_RANGE, t);
+    tm.add(fwd);
+    tm.add(350);
+    tm.add(420);
+    tm.add(zone);
+    tm.add(41.7f);
+    tm.add(96);
+    tm.add((float)oled_us);
+    tm.end();
+}
+
+// Everything a reader makes of a byte stream
+struct Decoded {
+    std::vector<TelemRecord> recs;
+    std::vector<std::string> text;
+    TelemReaderStats         st;
+};
+
+static Decoded readAll(const uint8_t* data, size_t len, TelemReader& r) {
+    Decoded d;
+    for (size_t i = 0; i < len; i++) {
+        int got = r.feed(data[i]);
+        if (got == TELEM_GOT_RECORD) d.recs.push_back(r.record());
+        if (got == TELEM_GOT_TEXT) d.text.push_back(r.text());
+    }
+    d.st = r.stats();
+    return d;
+}
+
+static Decoded readAll(const std::vector<uint8_t>& s) {
+    TelemReader r;
+    return readAll(s.data(), s.size(), r);
+}
+
+static void take(Telemetry& tm, std::vector<uint8_t>* out) {
+    out->insert(out->end(), tm.data(), tm.data() + tm.size());
+    tm.clear();
+}
+
+int main() {
+    printf("Telemetry Check — %d B buffer, WIND %d fields, RANGE %d fields\n\n", TELEM_BUF,
+           TELEM_SCHEMAS[TELEM_WIND].count, TELEM_SCHEMAS[TELEM_RANGE].count);
+
+    // 1. COBS
+    std::mt19937 rng(7);
+    bool cobsOk = true, noZero = true, bounded = true;
+    for (int len = 1; len <= 600; len++) {
+        std::vector<uint8_t> in(len), enc(COBS_MAX_ENCODED(len)), dec(enc.size());
+        for (uint8_t& b : in) b = (len % 3 == 0) ? (uint8_t)(rng() % 255 + 1) : (uint8_t)(rng() % 4 == 0 ? 0 : rng());
+        size_t e = cobs_encode(in.data(), len, enc.data());
+        bounded &= e <= (size_t)COBS_MAX_ENCODED(len);
+        for (size_t i = 0; i < e; i++) noZero &= enc[i] != 0;
+        size_t d = cobs_decode(enc.data(), e, dec.data());
+        cobsOk &= d == (size_t)len && memcmp(in.data(), dec.data(), len) == 0;
+    }
+    check(cobsOk, "COBS round trip, 1–600 B, with and without zeros");
+    check(noZero && bounded, "no 0x00 in the encoding, overhead within COBS_MAX_ENCODED");
+
+    // 2. round trip
+    Telemetry tm;
+    tm.setMode(TELEM_BINARY);
+    std::vector<uint8_t> stream;
+    Wind w = { 359.9f, 12.5f, 271, 284.4f, -12.3f, 18.76f, 24.0f, 9.5f, 281.2f, 0.0123f, 14.8f, 1 };
+    addWind(tm, 1000, w);
+    addRange(tm, 1005, 12, 3, 5400000);           // STOP, µs past 16 bits
+    Wind clamp = { -5, 400, 0, 0, -9999, 0, 0, 0, 0, 7.0f, 0, 2 };
+    addWind(tm, 70000, clamp);
+    check(tm.size() > 0 && tm.data()[0] == 0, "binary batch opens with a delimiter");
+    take(tm, &stream);
+    Decoded d = readAll(stream);
+    bool rt = d.recs.size() == 3;
+    if (rt) {
+        const TelemRecord& a = d.recs[0];
+        const TelemRecord& b = d.recs[1];
+        const TelemRecord& c = d.recs[2];
+        rt = a.type == TELEM_WIND && a.t_ms == 1000 && a.seq == 0 && a.v[0] == 3599 && a.v[4] == -123 &&
+             a.v[5] == 1876 && a.v[9] == 123 && a.v[11] == 1 &&
+             b.type == TELEM_RANGE && b.seq == 1 && b.v[0] == 12 && b.v[3] == 3 && b.v[4] == 417 &&
+             (uint32_t)b.v[6] == 5400000 &&
+             c.t_ms == 70000 && c.v[0] == 0 && c.v[1] == 4000 && c.v[4] == -32768 && c.v[9] == 65535;
+    }
+    check(rt, "records decode to the scaled integers, time and sequence");
+    char label[16];
+    telem_format_value(TELEM_SCHEMAS[TELEM_RANGE].fields[3], 3, label, sizeof(label));
+    check(strcmp(label, "STOP") == 0, "enum field formats as its label");
+
+    // 3. text mode
+    tm.setMode(TELEM_TEXT);
+    tm.header(TELEM_RANGE);
+    addRange(tm, 1005, 12, 3, 5400000);
+    std::string text((const char*)tm.data(), tm.size());
+    tm.clear();
+    check(text == "# range: t_ms\tfwd_cm\tport_cm\tstbd_cm\tstatus\tsweep_ms\toled_bytes\toled_us\n"
+                  "1005\t12\t350\t420\tSTOP\t41.7\t96\t5400000\n",
+          "text mode: header and tab-separated line");
+    addWind(tm, 1000, w);
+    text.assign((const char*)tm.data(), tm.size());
+    tm.clear();
+    check(text == "1000\t359.9\t12.5\t271\t284.4\t-12.3\t18.76\t24.00\t9.50\t281.2\t0.0123\t14.8\tSTABLE\n",
+          "text mode: decimals, sign and label as the sketch printed them");
+
+    // 4. damage
+    tm.setMode(TELEM_BINARY);
+    stream.clear();
+    for (int i = 0; i < 10; i++) {
+        w.compass = (float)i;
+        addWind(tm, 2000 + 200 * i, w);
+        take(tm, &stream);
+    }
+    std::vector<uint8_t> hit = stream;
+    size_t frame4 = 0;
+    for (size_t i = 0, zeros = 0; i < hit.size(); i++) {
+        if (hit[i] == 0 && ++zeros == 7) { frame4 = i + 3; break; }   // inside the 4th batch's frame
+    }
+    hit[frame4] ^= 0x10;
+    d = readAll(hit);
+    check(d.recs.size() == 9 && d.st.bad_frames == 1 && d.st.lost == 1, "flipped byte: that record lost, gap counted");
+    bool others = true;
+    for (const TelemRecord& r : d.recs) others &= r.v[2] != 3;
+    check(others, "flipped byte: the other records intact");
+    TelemReader late;
+    d = readAll(stream.data() + 7, stream.size() - 7, late);
+    check(d.recs.size() == 9 && d.recs[0].v[2] == 1, "reader started mid-frame: in sync from the next record");
+
+    // 5. console text between loops
+    stream.clear();
+    addWind(tm, 5000, w);
+    take(tm, &stream);
+    const char* reply = "telemetry = 1 (0 text, 1 binary)\n";
+    stream.insert(stream.end(), reply, reply + strlen(reply));
+    addRange(tm, 5100, 200, 0, 900);
+    take(tm, &stream);
+    d = readAll(stream);
+    check(d.recs.size() == 2 && d.text.size() == 1 && d.text[0] == reply && d.st.bad_frames == 0,
+          "console text between batches reported as text, records intact");
+
+    // 6. limits
+    Telemetry full;
+    full.setMode(TELEM_BINARY);
+    int kept = 0;
+    for (int i = 0; i < 40; i++) {
+        full.begin(TELEM_WIND, i);
+        for (int k = 0; k < TELEM_SCHEMAS[TELEM_WIND].count; k++) full.add(1000.0f + k);
+        kept += full.end();
+    }
+    TelemStats fs = full.stats();
+    d = readAll(std::vector<uint8_t>(full.data(), full.data() + full.size()));
+    printf("  %d WIND records fit in one %d B buffer\n", kept, TELEM_BUF);
+    check(fs.dropped == (uint32_t)(40 - kept) && full.size() <= TELEM_BUF && d.recs.size() == (size_t)kept,
+          "buffer full: records dropped and counted, the buffer stays valid");
+    full.clear();
+    full.begin(TELEM_RANGE, 0);
+    full.add(1);
+    bool shortOk = !full.end();
+    full.begin(TELEM_TYPE_COUNT, 0);
+    full.add(1);
+    bool typeOk = !full.end();
+    check(shortOk && typeOk && full.stats().schema_errors == 2 && full.size() == 0,
+          "missing fields and unknown type refused");
+
+    // 7. cost
+    const int N = 200000;
+    size_t bytes[2];
+    double ns[2];
+    volatile size_t sink = 0;
+    for (int mode = 0; mode < 2; mode++) {
+        Telemetry t;
+        t.setMode(mode);
+        bytes[mode] = 0;
+        double t0 = seconds();
+        for (int i = 0; i < N; i++) {
+            w.compass = (float)(i % 360);
+            w.error   = (float)(i % 3600) / 10.0f - 180.0f;
+            addWind(t, (uint32_t)i * 100, w);
+            bytes[mode] += t.size();
+            sink = sink + t.data()[t.size() / 2];
+            t.clear();
+        }
+        ns[mode] = (seconds() - t0) / N * 1e9;
+    }
+    double textB = (double)bytes[TELEM_TEXT] / N, binB = (double)bytes[TELEM_BINARY] / N;
+    printf("\n  WIND record: text %.1f B / %.0f ns, binary %.1f B / %.0f ns (host)\n", textB, ns[TELEM_TEXT], binB,
+           ns[TELEM_BINARY]);
+    printf("  at 10 Hz: text %.0f B/s, binary %.0f B/s\n", textB * 10, binB * 10);
+    check(binB * 2 <= textB, "binary record at most half the bytes of text");
+    check(ns[TELEM_BINARY] * 3 <= ns[TELEM_TEXT], "binary record at least 3x cheaper than text");
+
+    return check_summary();
+}
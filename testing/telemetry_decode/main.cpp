@@ -0,0 +1,141 @@
+// Telemetry Decoder — host (platform = native)
+//
+// Run:  stty -F /dev/ttyACM0 raw 115200
+//       .pio/build/telemetry_decode/program /dev/ttyACM0 out/     # live, Ctrl-C to stop
+//       .pio/build/telemetry_decode/program capture.bin out/      # a saved capture
+//       pio run -e telemetry_decode -t exec                       # no input: a 60 s demo stream
+//
+// Reads the binary serial telemetry of a sketch switched to "set telemetry 1"
+// (firmware/common/telemetry/telemetry.h) and writes one CSV per record type
+// to the output directory:
+//
+//   <type>.csv   t_ms,seq,<fields>   — values in the units the text mode
+//                                      prints (decimals restored, labels)
+//
+// Console text the sketch prints between loops (config replies, warnings)
+// goes to stderr as it arrives. The summary counts records, frames that
+// failed COBS or CRC, and records missing from the sequence.
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vector>
+#include "firmware/common/telemetry/telemetry.h"
+
+// No input given: 60 s of the two sketches' records with a config reply
+static std::vector<uint8_t> demoStream() {
+    std::vector<uint8_t> s;
+    Telemetry tm;
+    tm.setMode(TELEM_BINARY);
+    for (uint32_t t = 0; t < 60000; t += 100) {
+        int k = (int)(t / 100);
+        if (k % 2 == 0) {
+            tm.begin(TELEM_WIND, t);
+            tm.add(120.0f + k % 50 / 10.0f);
+            tm.add(2.5f);
+            tm.add((float)(k % 360));
+            tm.add(284.4f);
+            tm.add(-3.5f + k % 70 / 10.0f);
+            tm.add(18.76f);
+            tm.add(24.0f);
+            tm.add(9.5f);
+            tm.add(281.2f);
+            tm.add(0.0123f);
+            tm.add(14.8f);
+            tm.add(k < 600 ? 0 : 1);
+            tm.end();
+        }
+        tm.begin(TELEM_RANGE, t);
+        tm.add((float)(400 - k % 300));
+        tm.add(350);
+        tm.add(420);
+        tm.add(k % 300 > 250 ? 3 : 0);
+        tm.add(41.7f);
+        tm.add(96);
+        tm.add(2100);
+        tm.end();
+        s.insert(s.end(), tm.data(), tm.data() + tm.size());
+        tm.clear();
+        if (k == 300) {
+            const char* reply = "telemetry = 1 (0 text, 1 binary)\n";
+            s.insert(s.end(), reply, reply + strlen(reply));
+        }
+    }
+    return s;
+}
+
+int main(int argc, char** argv) {
+    const char* outDir = argc > 2 ? argv[2] : "telem_out";
+    FILE*       in     = nullptr;
+    std::vector<uint8_t> demo;
+    if (argc > 1) {
+        in = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "rb");
+        if (!in) {
+            fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+            return 1;
+        }
+    } else {
+        printf("No input given — decoding a 60 s demo stream\n");
+        demo = demoStream();
+    }
+    if (mkdir(outDir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "%s: %s\n", outDir, strerror(errno));
+        return 1;
+    }
+
+    FILE*    csv[TELEM_TYPE_COUNT] = {};
+    uint32_t rows[TELEM_TYPE_COUNT] = {};
+    TelemReader reader;
+    char     value[32];
+
+    auto onByte = [&](uint8_t b) {
+        int got = reader.feed(b);
+        if (got == TELEM_GOT_TEXT) {
+            fputs(reader.text(), stderr);
+            return;
+        }
+        if (got != TELEM_GOT_RECORD) return;
+        const TelemRecord& r = reader.record();
+        const TelemSchema& s = TELEM_SCHEMAS[r.type];
+        if (!csv[r.type]) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/%s.csv", outDir, s.name);
+            csv[r.type] = fopen(path, "w");
+            if (!csv[r.type]) return;
+            setvbuf(csv[r.type], nullptr, _IOLBF, 0);   // live capture: rows land as they come
+            fprintf(csv[r.type], "t_ms,seq");
+            for (int i = 0; i < s.count; i++) fprintf(csv[r.type], ",%s", s.fields[i].name);
+            fprintf(csv[r.type], "\n");
+        }
+        fprintf(csv[r.type], "%u,%u", r.t_ms, r.seq);
+        for (int i = 0; i < s.count; i++) {
+            telem_format_value(s.fields[i], r.v[i], value, sizeof(value));
+            fprintf(csv[r.type], ",%s", value);
+        }
+        fprintf(csv[r.type], "\n");
+        rows[r.type]++;
+    };
+
+    if (in) {
+        uint8_t buf[4096];
+        size_t  n;
+        while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+            for (size_t i = 0; i < n; i++) onByte(buf[i]);
+        }
+        if (in != stdin) fclose(in);
+    } else {
+        for (uint8_t b : demo) onByte(b);
+    }
+    onByte(0);                                   // close a frame cut off by the end of input
+
+    TelemReaderStats st = reader.stats();
+    printf("\n%u records, %u bad frames, %u missing from the sequence, %u console text chunks\n", st.records,
+           st.bad_frames, st.lost, st.text_chunks);
+    for (uint8_t t = 1; t < TELEM_TYPE_COUNT; t++) {
+        if (!csv[t]) continue;
+        fclose(csv[t]);
+        printf("  %-6s %7u rows  %s/%s.csv\n", TELEM_SCHEMAS[t].name, rows[t], outDir, TELEM_SCHEMAS[t].name);
+    }
+    return 0;
+}
@@ -0,0 +1,380 @@
+// UBX NAV-PVT Parser Check + Benchmark — host (platform = native)
+//
+// Run:  pio run -e ubx_bench -t exec
+//
+// Part 1 — canned capture (below, 523 bytes): the BE-880 switching over from
+// NMEA right after CFG-VALSET — a GGA line, ACK-ACK, NAV-PVT (3D fix), NAV-DOP,
+// MON-VER (160-byte payload, too long to buffer), NAV-SAT (not decoded) and a
+// no-fix NAV-PVT with a negative nano field. Fed whole, split at every byte
+// position, one byte at a time, and with one payload byte corrupted.
+//
+// Part 2 — mode switching on the host UART and virtual clock at 25 Hz:
+// NMEA only → ACK + NAV-PVT (switch to UBX) → module browns out and comes
+// back on NMEA (fall back, config re-sent) → NAV-PVT again → NAK (retries
+// stop).
+//
+// Part 3 — parse cost per epoch of position + velocity + heading: NAV-PVT
+// frames vs the NMEA GGA + RMC + VTG carrying the same, both through the
+// reader's in-memory consume(); plus bytes per epoch, which bound the rate
+// the 115200 baud link can carry (the BE-880's default NMEA set included).
+//
+// Pass criteria: every capture field decoded exactly, identical results for
+// every split; the corrupted frame counted bad and nothing else lost; the
+// reader switches to UBX on the first NAV-PVT, falls back within
+// UBX_LOST_MIN_MS + one epoch of the last, re-sends the config while on
+// NMEA and stops after a NAK; NAV-PVT cheaper to decode than the NMEA trio.
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "common/config.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/gps/nmea.h"
+#include "firmware/common/gps/ubx.h"
+#include "testing/check.h"
+
+#define EPOCH_US        40000       // 25 Hz
+#define COST_EPOCHS     2000
+#define COST_REPEAT     50
+#define LINK_BYTES_S    (GPS_BAUD / 10)
+
+static double seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------------------------------------------------------------------------
+// Canned capture. NAV-PVT #1: 2026-02-17 12:35:07.100 UTC, 3D fix, 14 SV,
+// 43.6543210, -79.3812340, hMSL 85.3 m, hAcc 0.64 m, vel N 1.5 / E -2.0 /
+// D 0.03 m/s, gSpeed 2.5 m/s, headMot 306.87° ± 0.52°, pDOP 1.32.
+// NAV-DOP: pDOP 1.32, vDOP 1.05, hDOP 0.80. NAV-PVT #2: 12:35:07.995, no fix.
+static const uint8_t CAPTURE[] = {
+    0x24, 0x47, 0x4E, 0x47, 0x47, 0x41, 0x2C, 0x31, 0x32, 0x33, 0x35, 0x30, 0x36, 0x2E, 0x39, 0x30,
+    0x2C, 0x34, 0x33, 0x33, 0x39, 0x2E, 0x32, 0x35, 0x39, 0x32, 0x36, 0x30, 0x30, 0x2C, 0x4E, 0x2C,
+    0x30, 0x37, 0x39, 0x32, 0x32, 0x2E, 0x38, 0x37, 0x34, 0x30, 0x34, 0x30, 0x30, 0x2C, 0x57, 0x2C,
+    0x31, 0x2C, 0x31, 0x32, 0x2C, 0x30, 0x2E, 0x39, 0x30, 0x2C, 0x38, 0x35, 0x2E, 0x33, 0x2C, 0x4D,
+    0x2C, 0x2D, 0x33, 0x34, 0x2E, 0x30, 0x2C, 0x4D, 0x2C, 0x2C, 0x2A, 0x34, 0x32, 0x0D, 0x0A, 0xB5,
+    0x62, 0x05, 0x01, 0x02, 0x00, 0x06, 0x8A, 0x98, 0xC1, 0xB5, 0x62, 0x01, 0x07, 0x5C, 0x00, 0x2C,
+    0x53, 0x00, 0x0D, 0xEA, 0x07, 0x02, 0x11, 0x0C, 0x23, 0x07, 0x07, 0x19, 0x00, 0x00, 0x00, 0x00,
+    0xE1, 0xF5, 0x05, 0x03, 0x01, 0xEA, 0x0E, 0x8C, 0x62, 0xAF, 0xD0, 0xEA, 0x1E, 0x05, 0x1A, 0x64,
+    0xC8, 0x00, 0x00, 0x34, 0x4D, 0x01, 0x00, 0x80, 0x02, 0x00, 0x00, 0xD4, 0x03, 0x00, 0x00, 0xDC,
+    0x05, 0x00, 0x00, 0x30, 0xF8, 0xFF, 0xFF, 0x1E, 0x00, 0x00, 0x00, 0xC4, 0x09, 0x00, 0x00, 0x18,
+    0x3F, 0xD4, 0x01, 0xB4, 0x00, 0x00, 0x00, 0x20, 0xCB, 0x00, 0x00, 0x84, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFD, 0xC6, 0xB5, 0x62, 0x01,
+    0x04, 0x12, 0x00, 0x2C, 0x53, 0x00, 0x0D, 0xB4, 0x00, 0x84, 0x00, 0x5A, 0x00, 0x69, 0x00, 0x50,
+    0x00, 0x3C, 0x00, 0x37, 0x00, 0x61, 0x42, 0xB5, 0x62, 0x0A, 0x04, 0xA0, 0x00, 0x00, 0x07, 0x0E,
+    0x15, 0x1C, 0x23, 0x2A, 0x31, 0x38, 0x3F, 0x46, 0x4D, 0x54, 0x5B, 0x62, 0x69, 0x70, 0x77, 0x7E,
+    0x85, 0x8C, 0x93, 0x9A, 0xA1, 0xA8, 0xAF, 0xB6, 0xBD, 0xC4, 0xCB, 0xD2, 0xD9, 0xE0, 0xE7, 0xEE,
+    0xF5, 0xFC, 0x03, 0x0A, 0x11, 0x18, 0x1F, 0x26, 0x2D, 0x34, 0x3B, 0x42, 0x49, 0x50, 0x57, 0x5E,
+    0x65, 0x6C, 0x73, 0x7A, 0x81, 0x88, 0x8F, 0x96, 0x9D, 0xA4, 0xAB, 0xB2, 0xB9, 0xC0, 0xC7, 0xCE,
+    0xD5, 0xDC, 0xE3, 0xEA, 0xF1, 0xF8, 0xFF, 0x06, 0x0D, 0x14, 0x1B, 0x22, 0x29, 0x30, 0x37, 0x3E,
+    0x45, 0x4C, 0x53, 0x5A, 0x61, 0x68, 0x6F, 0x76, 0x7D, 0x84, 0x8B, 0x92, 0x99, 0xA0, 0xA7, 0xAE,
+    0xB5, 0xBC, 0xC3, 0xCA, 0xD1, 0xD8, 0xDF, 0xE6, 0xED, 0xF4, 0xFB, 0x02, 0x09, 0x10, 0x17, 0x1E,
+    0x25, 0x2C, 0x33, 0x3A, 0x41, 0x48, 0x4F, 0x56, 0x5D, 0x64, 0x6B, 0x72, 0x79, 0x80, 0x87, 0x8E,
+    0x95, 0x9C, 0xA3, 0xAA, 0xB1, 0xB8, 0xBF, 0xC6, 0xCD, 0xD4, 0xDB, 0xE2, 0xE9, 0xF0, 0xF7, 0xFE,
+    0x05, 0x0C, 0x13, 0x1A, 0x21, 0x28, 0x2F, 0x36, 0x3D, 0x44, 0x4B, 0x52, 0x59, 0x7E, 0x24, 0xB5,
+    0x62, 0x01, 0x35, 0x20, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A,
+    0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A,
+    0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x46, 0xF3, 0xB5, 0x62, 0x01, 0x07, 0x5C, 0x00, 0x2C, 0x53, 0x00,
+    0x0D, 0xEA, 0x07, 0x02, 0x11, 0x0C, 0x23, 0x08, 0x07, 0x19, 0x00, 0x00, 0x00, 0xC0, 0xB4, 0xB3,
+    0xFF, 0x00, 0x00, 0xEA, 0x03, 0x8C, 0x62, 0xAF, 0xD0, 0xEA, 0x1E, 0x05, 0x1A, 0x64, 0xC8, 0x00,
+    0x00, 0x34, 0x4D, 0x01, 0x00, 0x80, 0x02, 0x00, 0x00, 0xD4, 0x03, 0x00, 0x00, 0xDC, 0x05, 0x00,
+    0x00, 0x30, 0xF8, 0xFF, 0xFF, 0x1E, 0x00, 0x00, 0x00, 0xC4, 0x09, 0x00, 0x00, 0x18, 0x3F, 0xD4,
+    0x01, 0xB4, 0x00, 0x00, 0x00, 0x20, 0xCB, 0x00, 0x00, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3A, 0x09,
+};
+
+#define CAP_GGA_LEN     79
+#define CAP_PVT1_AT     (CAP_GGA_LEN + 10)      // after the GGA line and ACK-ACK
+
+struct Result {
+    GpsFix   fix;
+    UbxStats st;
+    uint32_t text;      // NMEA sentences seen between frames
+    uint8_t  source;
+    uint8_t  mask;
+};
+
+static Result feed(const uint8_t* data, size_t len, size_t split, bool byByte) {
+    UbxReader r;
+    Result    out;
+    out.mask = 0;
+    if (byByte) {
+        for (size_t i = 0; i < len; i++) out.mask |= r.consume(data + i, 1);
+    } else {
+        out.mask |= r.consume(data, split);
+        out.mask |= r.consume(data + split, len - split);
+    }
+    out.fix    = r.fix();
+    out.st     = r.stats();
+    out.text   = r.text().stats().sentences;
+    out.source = r.source();
+    return out;
+}
+
+static bool sameResult(const Result& a, const Result& b) {
+    return memcmp(&a.fix, &b.fix, sizeof(GpsFix)) == 0 && memcmp(&a.st, &b.st, sizeof(UbxStats)) == 0 &&
+           a.text == b.text && a.source == b.source && a.mask == b.mask;
+}
+
+static void captureCheck() {
+    printf("\n=== Canned capture (%zu bytes) ===\n", sizeof(CAPTURE));
+    Result r = feed(CAPTURE, sizeof(CAPTURE), sizeof(CAPTURE), false);
+    const GpsFix& f = r.fix;
+    printf("  frames %u  pvt %u  dop %u  acks %u  ignored %u  bad %u\n", (unsigned)r.st.frames,
+           (unsigned)r.st.pvt, (unsigned)r.st.dop, (unsigned)r.st.acks, (unsigned)r.st.ignored, (unsigned)r.st.bad);
+    printf("  %.7f, %.7f  alt %d cm  vel N %d E %d D %d cm/s  %u cm/s @ %.2f° ±%.2f°  %u SV  time %u\n",
+           f.lat_e7 / 1e7, f.lon_e7 / 1e7, (int)f.alt_cm, f.vel_n_cms, f.vel_e_cms, f.vel_d_cms, f.sog_cms,
+           f.cog_cdeg / 100.0, f.head_acc_cdeg / 100.0, f.sats, (unsigned)f.time_ms);
+
+    check(r.st.frames == 5 && r.st.pvt == 2 && r.st.dop == 1 && r.st.acks == 1 && r.st.ignored == 2 &&
+          r.st.bad == 0, "ACK, 2× NAV-PVT, NAV-DOP decoded; MON-VER and NAV-SAT ignored");
+    check(r.source == GPS_SRC_UBX && f.source == GPS_SRC_UBX, "source switched to UBX");
+    check(f.lat_e7 == 436543210 && f.lon_e7 == -793812340 && f.alt_cm == 8530 && f.h_acc_mm == 640,
+          "position exact (1e-7°), hMSL, hAcc");
+    check(f.vel_n_cms == 150 && f.vel_e_cms == -200 && f.vel_d_cms == 3 && f.sog_cms == 250 &&
+          f.cog_cdeg == 30687 && f.head_acc_cdeg == 52, "NED velocity, ground speed, heading of motion");
+    check(f.hdop_x100 == 80 && f.vdop_x100 == 105 && f.pdop_x100 == 132, "DOPs from NAV-DOP / NAV-PVT");
+    check(!f.valid && f.quality == 0 && f.sats == 3 && f.mode == 1 && f.time_ms == 45307995 && f.date == 170226,
+          "no-fix NAV-PVT: invalid, position kept, negative nano applied");
+    check(r.text == 1, "GGA before the switch went to the NMEA reader");
+
+    bool allSplits = true;
+    for (size_t i = 0; i <= sizeof(CAPTURE); i++) allSplits &= sameResult(feed(CAPTURE, sizeof(CAPTURE), i, false), r);
+    check(allSplits, "identical for a split at every byte position");
+    check(sameResult(feed(CAPTURE, sizeof(CAPTURE), 0, true), r), "identical fed one byte at a time");
+
+    uint8_t bad[sizeof(CAPTURE)];
+    memcpy(bad, CAPTURE, sizeof(bad));
+    bad[CAP_PVT1_AT + UBX_HEADER + 28] ^= 0x40;   // latitude
+    Result c = feed(bad, sizeof(bad), sizeof(bad), false);
+    check(c.st.bad == 1 && c.st.pvt == 1 && c.st.dop == 1 && c.st.acks == 1 && c.fix.lat_e7 == 0,
+          "corrupted NAV-PVT rejected by the checksum, later frames still decoded");
+}
+
+// ---------------------------------------------------------------------------
+// Generated traffic
+static void put2(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put4(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+
+static void appendPvt(std::vector<uint8_t>& out, uint32_t time_ms, int32_t lat_e7, int32_t lon_e7) {
+    uint8_t pl[UBX_NAV_PVT_LEN] = {};
+    put4(pl + 0, time_ms);
+    put2(pl + 4, 2026);
+    pl[6]  = 2;
+    pl[7]  = 17;
+    pl[8]  = (uint8_t)(time_ms / 3600000);
+    pl[9]  = (uint8_t)(time_ms / 60000 % 60);
+    pl[10] = (uint8_t)(time_ms / 1000 % 60);
+    pl[11] = 0x07;
+    put4(pl + 16, time_ms % 1000 * 1000000);
+    pl[20] = 3;
+    pl[21] = 0x01;
+    pl[23] = 14;
+    put4(pl + 24, (uint32_t)lon_e7);
+    put4(pl + 28, (uint32_t)lat_e7);
+    put4(pl + 36, 85300);
+    put4(pl + 40, 640);
+    put4(pl + 48, 1500);
+    put4(pl + 52, (uint32_t)-2000);
+    put4(pl + 60, 2500);
+    put4(pl + 64, 30687000);
+    put4(pl + 72, 52000);
+    put2(pl + 76, 132);
+    uint8_t f[UBX_NAV_PVT_LEN + UBX_OVERHEAD];
+    size_t  n = ubx_frame(f, sizeof(f), UBX_NAV_PVT, pl, sizeof(pl));
+    out.insert(out.end(), f, f + n);
+}
+
+static void appendAck(std::vector<uint8_t>& out, bool ack) {
+    uint8_t pl[2] = { UBX_CFG_VALSET >> 8, UBX_CFG_VALSET & 0xFF };
+    uint8_t f[2 + UBX_OVERHEAD];
+    size_t  n = ubx_frame(f, sizeof(f), ack ? UBX_ACK_ACK : UBX_ACK_NAK, pl, sizeof(pl));
+    out.insert(out.end(), f, f + n);
+}
+
+static void appendNmea(std::vector<uint8_t>& out, const char* body) {
+    char    line[128];
+    uint8_t sum = 0;
+    for (const char* p = body; *p; p++) sum ^= (uint8_t)*p;
+    int n = snprintf(line, sizeof(line), "$%s*%02X\r\n", body, sum);
+    out.insert(out.end(), line, line + n);
+}
+
+static void coord(char* out, size_t n, int32_t e7, bool lat) {
+    uint32_t a   = (uint32_t)(e7 < 0 ? -e7 : e7);
+    uint64_t min = (uint64_t)(a % 10000000u) * 60;
+    snprintf(out, n, lat ? "%02u%02u.%07u,%c" : "%03u%02u.%07u,%c", a / 10000000u, (unsigned)(min / 10000000u),
+             (unsigned)(min % 10000000u), lat ? (e7 < 0 ? 'S' : 'N') : (e7 < 0 ? 'W' : 'E'));
+}
+
+// GGA + RMC + VTG: the NMEA carrying what one NAV-PVT does
+static void appendNmeaEpoch(std::vector<uint8_t>& out, uint32_t ms, int32_t lat_e7, int32_t lon_e7) {
+    char hms[16], la[24], lo[24], body[128];
+    snprintf(hms, sizeof(hms), "%02u%02u%02u.%02u", ms / 3600000, ms / 60000 % 60, ms / 1000 % 60, ms % 1000 / 10);
+    coord(la, sizeof(la), lat_e7, true);
+    coord(lo, sizeof(lo), lon_e7, false);
+    snprintf(body, sizeof(body), "GNRMC,%s,A,%s,%s,4.860,306.87,170226,,,A,V", hms, la, lo);
+    appendNmea(out, body);
+    snprintf(body, sizeof(body), "GNGGA,%s,%s,%s,1,14,0.80,85.3,M,-34.0,M,,", hms, la, lo);
+    appendNmea(out, body);
+    appendNmea(out, "GNVTG,306.87,T,,M,4.860,N,9.000,K,A");
+}
+
+// The rest of the BE-880's default NMEA set per epoch
+static void appendNmeaDefaultExtras(std::vector<uint8_t>& out) {
+    appendNmea(out, "GNGSA,A,3,01,03,08,10,14,17,21,22,,,,,1.32,0.80,1.05,1");
+    appendNmea(out, "GNGSA,A,3,67,68,77,78,,,,,,,,,1.32,0.80,1.05,2");
+    appendNmea(out, "GNGSA,A,3,02,07,11,,,,,,,,,,1.32,0.80,1.05,3");
+    appendNmea(out, "GPGSV,3,1,11,01,45,123,42,03,12,045,35,08,67,301,44,10,23,201,38,1");
+    appendNmea(out, "GPGSV,3,2,11,14,55,088,45,17,31,250,40,21,08,318,29,22,40,160,41,1");
+    appendNmea(out, "GPGSV,3,3,11,27,05,020,,30,02,110,,32,14,280,31,1");
+    appendNmea(out, "GLGSV,2,1,06,67,44,050,39,68,61,140,43,77,25,290,36,78,30,345,37,1");
+    appendNmea(out, "GLGSV,2,2,06,84,09,100,,85,03,160,,1");
+    appendNmea(out, "GAGSV,2,1,05,02,50,070,41,07,35,210,39,11,20,330,35,12,06,010,,7");
+    appendNmea(out, "GAGSV,2,2,05,19,01,180,,7");
+    appendNmea(out, "GNGLL,4339.2592600,N,07922.8740400,W,123507.10,A,A");
+}
+
+// ---------------------------------------------------------------------------
+// Part 2 — mode switching
+struct Sim {
+    UbxReader r;
+    uint32_t  configsSent = 0;   // CFG-VALSET frames seen on the TX line
+    uint32_t  t_ms        = 0;
+
+    // One 25 Hz tick: what the module sends, then the reader's poll
+    void tick(bool ubx, bool nmea, bool ack = false, bool nak = false) {
+        std::vector<uint8_t> rx;
+        int32_t lat = 436543210 + (int32_t)t_ms, lon = -793812340 - (int32_t)t_ms;
+        if (ack || nak) appendAck(rx, ack);
+        if (ubx) appendPvt(rx, 45300000 + t_ms, lat, lon);
+        if (nmea && t_ms % 100 == 0) appendNmeaEpoch(rx, 45300000 + t_ms, lat, lon);
+        if (!rx.empty()) hal_host_uart_feed(HAL_GPS_UART, rx.data(), rx.size());
+        hal_host_advance_us(EPOCH_US);
+        t_ms += EPOCH_US / 1000;
+        r.poll();
+        uint8_t tx[HAL_HOST_UART_BUF];
+        size_t  n;
+        while ((n = hal_host_uart_drain(HAL_GPS_UART, tx, sizeof(tx))) > 0) configsSent += (uint32_t)(n / UBX_CONFIG_FRAME);
+    }
+};
+
+static void switchCheck() {
+    printf("\n=== Mode switching at 25 Hz (virtual clock) ===\n");
+    hal_host_reset();
+    Sim s;
+    s.r.begin(25);
+    uint8_t tx[HAL_HOST_UART_BUF], expect[UBX_CONFIG_FRAME];
+    size_t  n = hal_host_uart_drain(HAL_GPS_UART, tx, sizeof(tx));
+    check(n == UBX_CONFIG_FRAME && ubx_config_frame(expect, sizeof(expect), 25) == n && memcmp(tx, expect, n) == 0,
+          "begin() sends CFG-VALSET");
+    UbxReader echo;
+    echo.consume(tx, n);
+    check(echo.stats().frames == 1 && echo.stats().bad == 0, "config frame passes the Fletcher check");
+
+    for (int i = 0; i < 25; i++) s.tick(false, true);                     // 1 s NMEA only
+    bool nmeaOk = s.r.source() == GPS_SRC_NMEA && s.r.fix().valid && s.r.fix().source == GPS_SRC_NMEA;
+    s.tick(true, false, true);                                           // ACK + first NAV-PVT
+    bool switched = s.r.source() == GPS_SRC_UBX && s.r.fix().lat_e7 == 436543210 + (int32_t)(s.t_ms - 40);
+    for (int i = 0; i < 49; i++) s.tick(true, false);                    // 2 s UBX
+    UbxStats a = s.r.stats();
+    printf("  NMEA 1 s → UBX 2 s: source %s, %u NAV-PVT, ack %u\n", s.r.source() ? "UBX" : "NMEA",
+           (unsigned)a.pvt, (unsigned)a.acks);
+    check(nmeaOk, "NMEA fix used before the module switches");
+    check(switched && a.pvt == 50 && a.acks == 1, "switch to UBX on the first NAV-PVT");
+
+    uint32_t lastPvt = s.t_ms, fellBack = 0;
+    for (int i = 0; i < 150; i++) {                                      // 6 s: browned out, NMEA again
+        s.tick(false, true);
+        if (!fellBack && s.r.source() == GPS_SRC_NMEA) fellBack = s.t_ms;
+    }
+    UbxStats b = s.r.stats();
+    printf("  NAV-PVT stops: fell back after %u ms, %u config frame(s) re-sent\n", (unsigned)(fellBack - lastPvt),
+           (unsigned)s.configsSent);
+    check(fellBack && fellBack - lastPvt <= UBX_LOST_MIN_MS + EPOCH_US / 1000 && b.fallbacks == 1,
+          "falls back to NMEA within UBX_LOST_MIN_MS + one epoch");
+    check(s.r.fix().source == GPS_SRC_NMEA && s.r.fix().valid, "NMEA fix carries on after the fallback");
+    check(s.configsSent == 1, "config re-sent while on NMEA");
+
+    s.tick(true, false, true);
+    check(s.r.source() == GPS_SRC_UBX, "back on UBX after the re-sent config is taken");
+    for (int i = 0; i < 10; i++) s.tick(true, false);
+
+    uint32_t before = s.configsSent;
+    s.tick(false, true, false, true);                                    // module refuses CFG-VALSET
+    for (int i = 0; i < 400; i++) s.tick(false, true);                   // 16 s NMEA
+    printf("  NAK: %u config frame(s) sent in the following 16 s\n", (unsigned)(s.configsSent - before));
+    check(s.r.stats().naks == 1 && s.configsSent == before && s.r.source() == GPS_SRC_NMEA,
+          "NAK stops the retries; stays on NMEA");
+}
+
+// ---------------------------------------------------------------------------
+// Part 3 — parse cost
+static double timeUbx(const std::vector<uint8_t>& bytes, uint32_t* decoded) {
+    double best = 1e9;
+    for (int rep = 0; rep < COST_REPEAT; rep++) {
+        UbxReader r;
+        double    t0 = seconds();
+        for (size_t off = 0; off < bytes.size(); off += NMEA_RX_CHUNK)
+            r.consume(bytes.data() + off, bytes.size() - off < NMEA_RX_CHUNK ? bytes.size() - off : NMEA_RX_CHUNK);
+        double t = seconds() - t0;
+        if (t < best) best = t;
+        *decoded = r.stats().pvt;
+    }
+    return best;
+}
+
+static double timeNmea(const std::vector<uint8_t>& bytes, uint32_t* decoded) {
+    double best = 1e9;
+    for (int rep = 0; rep < COST_REPEAT; rep++) {
+        NmeaReader r(HAL_GPS_UART, NMEA_GGA | NMEA_RMC | NMEA_VTG);
+        double     t0 = seconds();
+        for (size_t off = 0; off < bytes.size(); off += NMEA_RX_CHUNK)
+            r.consume((const char*)bytes.data() + off,
+                      bytes.size() - off < NMEA_RX_CHUNK ? bytes.size() - off : NMEA_RX_CHUNK);
+        double t = seconds() - t0;
+        if (t < best) best = t;
+        *decoded = r.stats().decoded[0];
+    }
+    return best;
+}
+
+static void costCheck() {
+    printf("\n=== Parse cost per epoch (position + velocity + heading), best of %d ===\n", COST_REPEAT);
+    std::vector<uint8_t> ubx, nmea, full;
+    for (uint32_t e = 0; e < COST_EPOCHS; e++) {
+        uint32_t ms  = 45300000 + e * 100;
+        int32_t  lat = 436543210 + (int32_t)e * 37, lon = -793812340 - (int32_t)e * 51;
+        appendPvt(ubx, ms, lat, lon);
+        appendNmeaEpoch(nmea, ms, lat, lon);
+        appendNmeaEpoch(full, ms, lat, lon);
+        appendNmeaDefaultExtras(full);
+    }
+    uint32_t nUbx = 0, nNmea = 0, nFull = 0;
+    double   tUbx = timeUbx(ubx, &nUbx), tNmea = timeNmea(nmea, &nNmea), tFull = timeNmea(full, &nFull);
+
+    struct { const char* name; double t; size_t bytes; } rows[] = {
+        { "UBX NAV-PVT",               tUbx,  ubx.size() },
+        { "NMEA GGA+RMC+VTG",          tNmea, nmea.size() },
+        { "NMEA default set", tFull, full.size() },
+    };
+    printf("  %-26s %10s %10s %12s %14s\n", "stream", "ns/epoch", "B/epoch", "us/s @25Hz", "link max Hz");
+    for (auto& r : rows) {
+        double perEpoch = r.t * 1e9 / COST_EPOCHS;
+        double bytes    = (double)r.bytes / COST_EPOCHS;
+        printf("  %-26s %10.0f %10.0f %12.1f %14.0f\n", r.name, perEpoch, bytes, perEpoch * 25 / 1000,
+               LINK_BYTES_S / bytes);
+    }
+    check(nUbx == COST_EPOCHS && nNmea == COST_EPOCHS && nFull == COST_EPOCHS, "every epoch decoded on all streams");
+    check(tUbx < tNmea, "NAV-PVT cheaper to decode than GGA + RMC + VTG");
+    check(LINK_BYTES_S / ((double)ubx.size() / COST_EPOCHS) >= UBX_RATE_MAX_HZ * 2,
+          "NAV-PVT at 25 Hz uses under half the link");
+}
+
+int main() {
+    captureCheck();
+    switchCheck();
+    costCheck();
+    return check_summary();
+}
@@ -0,0 +1,161 @@
+// Non-blocking Ultrasonic Ranging — host (platform = native)
+//
+// Run:  pio run -e ultrasonic_async -t exec
+//
+// Replays the native_host collision-avoidance script through both ranging
+// paths on the virtual clock, with TRIG→ECHO linked in the host HAL so each
+// trigger plays back the scripted echo as real edges:
+//
+//   blocking — ultrasonic_scan(): pulseIn() on FWD, PORT, STBD in turn
+//   async    — UltrasonicAsync: timer-fired TRIG, ECHO edge interrupts,
+//              ULTRASONIC_SETTLE_US between sensors
+//
+// Per sweep: distances, zone, sweep time, and CPU time the caller loses to
+// ranging (blocking: the whole sweep; async: the TRIG pulses). A 1 kHz nav
+// loop runs alongside the async engine and records its worst gap. Async
+// sweeps are longer by the settle gaps and the modelled TRIG→ECHO delay
+// (HAL_HOST_ECHO_DELAY_US, which the pulseIn() stand-in does not charge).
+//
+// Pass criteria: async distances and zones match blocking within 1 cm;
+// sensors still fire one at a time; async CPU is < 1% of the sweep; the nav
+// loop never stalls for more than one tick.
+
+#include <stdio.h>
+#include "common/config.h"
+#include "firmware/common/hal/hal.h"
+#include "firmware/common/ultrasonic/ultrasonic.h"
+#include "firmware/common/ultrasonic/ultrasonic_async.h"
+#include "testing/check.h"
+
+#define NAV_TICK_US  1000
+
+// Echo width in µs for a target distance (inverse of ultrasonic_echo_to_cm)
+static uint32_t echoFor(uint16_t cm) {
+    return cm >= DIST_NONE_CM ? 0 : (uint32_t)((cm + 0.5f) * 2.0f / 0.034f);
+}
+
+// Boat closing on an obstacle dead ahead, with more room to port — then a
+// close pass where all three sensors see something.
+static const uint16_t script[][3] = {
+    // fwd   port  stbd
+    { 500,  500,  500 },
+    { 320,  410,  380 },
+    { 190,  300,  150 },
+    { 140,  120,  260 },
+    {  45,  200,  210 },
+    {  80,   60,   90 },
+    { 500,  500,  500 },
+};
+static const size_t SWEEPS = sizeof(script) / sizeof(script[0]);
+
+static const uint8_t TRIG[ULTRASONIC_SENSORS] = { ULTRASONIC_TRIG_FWD, ULTRASONIC_TRIG_PORT, ULTRASONIC_TRIG_STBD };
+static const uint8_t ECHO[ULTRASONIC_SENSORS] = { ULTRASONIC_ECHO_FWD, ULTRASONIC_ECHO_PORT, ULTRASONIC_ECHO_STBD };
+
+struct Sweep {
+    UltrasonicScan scan;
+    uint32_t       time_us;
+    uint32_t       cpu_us;
+};
+
+// Most ECHO lines seen high at one nav tick — more than one means cross-talk
+static uint8_t maxHigh = 0;
+
+// ---------------------------------------------------------------------------
+static void runBlocking(Sweep* out) {
+    hal_host_reset();
+    for (size_t i = 0; i < SWEEPS; i++) {
+        for (uint8_t s = 0; s < ULTRASONIC_SENSORS; s++) hal_host_queue_pulse(ECHO[s], echoFor(script[i][s]));
+        uint64_t start = hal_host_time_us();
+        out[i].scan    = ultrasonic_scan();
+        out[i].time_us = (uint32_t)(hal_host_time_us() - start);
+        out[i].cpu_us  = out[i].time_us;   // pulseIn() spins for all of it
+    }
+}
+
+// 1 kHz nav loop alongside the engine; samples the ECHO lines every tick
+static void runAsync(Sweep* out, uint32_t* navMaxGapUs) {
+    hal_host_reset();
+    for (uint8_t s = 0; s < ULTRASONIC_SENSORS; s++) {
+        hal_host_link_echo(TRIG[s], ECHO[s]);
+        for (size_t i = 0; i < SWEEPS; i++) hal_host_queue_pulse(ECHO[s], echoFor(script[i][s]));
+    }
+
+    UltrasonicAsync engine;
+    engine.begin();
+
+    size_t   n        = 0;
+    uint64_t lastNav  = hal_host_time_us();
+    uint32_t maxGap   = 0;
+    uint32_t prevBusy = 0;
+    while (n < SWEEPS && hal_host_time_us() < 5000000) {
+        // nav loop: never waits on ranging
+        hal_delay_us(NAV_TICK_US);
+        uint64_t now = hal_host_time_us();
+        if (now - lastNav > maxGap) maxGap = (uint32_t)(now - lastNav);
+        lastNav = now;
+
+        uint8_t high = 0;
+        for (uint8_t s = 0; s < ULTRASONIC_SENSORS; s++) high += hal_digital_read(ECHO[s]) == HAL_HIGH;
+        if (high > maxHigh) maxHigh = high;
+
+        UltrasonicScan scan;
+        if (engine.latest(&scan)) {
+            UltrasonicStats st = engine.stats();
+            out[n].scan    = scan;
+            out[n].time_us = st.last_cycle_us;
+            out[n].cpu_us  = st.busy_us - prevBusy;
+            prevBusy       = st.busy_us;
+            n++;
+        }
+    }
+    engine.stop();
+    *navMaxGapUs = maxGap;
+}
+
+// ---------------------------------------------------------------------------
+int main() {
+    Sweep blocking[SWEEPS];
+    Sweep async[SWEEPS];
+    uint32_t navGap = 0;
+    runBlocking(blocking);
+    runAsync(async, &navGap);
+
+    printf("Ultrasonic ranging — blocking pulseIn() vs timer + edge capture (settle %lu us)\n\n",
+           (unsigned long)ULTRASONIC_SETTLE_US);
+    printf("%-5s %-16s %-12s %9s %8s | %-16s %-12s %9s %8s\n",
+           "sweep", "blocking cm", "zone", "sweep ms", "cpu ms", "async cm", "zone", "sweep ms", "cpu ms");
+
+    bool     match = true;
+    uint64_t blockTime = 0, blockCpu = 0, asyncTime = 0, asyncCpu = 0;
+    for (size_t i = 0; i < SWEEPS; i++) {
+        const Sweep& b = blocking[i];
+        const Sweep& a = async[i];
+        ObstacleZone zb = ultrasonic_classify(b.scan);
+        ObstacleZone za = ultrasonic_classify(a.scan);
+        char bs[20], as[20];
+        snprintf(bs, sizeof(bs), "%u/%u/%u", b.scan.fwd_cm, b.scan.port_cm, b.scan.stbd_cm);
+        snprintf(as, sizeof(as), "%u/%u/%u", a.scan.fwd_cm, a.scan.port_cm, a.scan.stbd_cm);
+        printf("%-5zu %-16s %-12s %9.2f %8.3f | %-16s %-12s %9.2f %8.3f\n", i,
+               bs, ultrasonic_zone_name(zb), b.time_us / 1000.0, b.cpu_us / 1000.0,
+               as, ultrasonic_zone_name(za), a.time_us / 1000.0, a.cpu_us / 1000.0);
+
+        int d0 = (int)a.scan.fwd_cm - b.scan.fwd_cm;
+        int d1 = (int)a.scan.port_cm - b.scan.port_cm;
+        int d2 = (int)a.scan.stbd_cm - b.scan.stbd_cm;
+        if (zb != za || d0 < -1 || d0 > 1 || d1 < -1 || d1 > 1 || d2 < -1 || d2 > 1) match = false;
+        blockTime += b.time_us; blockCpu += b.cpu_us;
+        if (i > 0) { asyncTime += a.time_us; asyncCpu += a.cpu_us; }   // sweep 0 includes begin()
+    }
+
+    double asyncCpuPct = 100.0 * asyncCpu / (double)asyncTime;
+    printf("\nblocking: %.1f ms of %.1f ms in pulseIn (100%%)\n", blockCpu / 1000.0, blockTime / 1000.0);
+    printf("async:    %.3f ms of %.1f ms in TRIG pulses (%.3f%%), nav loop worst gap %.2f ms\n",
+           asyncCpu / 1000.0, asyncTime / 1000.0, asyncCpuPct, navGap / 1000.0);
+    printf("ECHO lines high at once: max %u\n\n", maxHigh);
+
+    check(match, "async distances and zones match blocking (±1 cm)");
+    check(maxHigh <= 1, "sensors fire sequentially (never two ECHO lines high)");
+    check(asyncCpuPct < 1.0, "async ranging costs < 1% CPU");
+    check(navGap <= NAV_TICK_US + 50, "nav loop never stalls on ranging");
+    return check_summary();
+}
@@ -3,6 +3,11 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include "common/config.h"
+#include "firmware/common/config/config_store.h"
+#include "firmware/common/telemetry/telemetry.h"
+#include "firmware/common/ultrasonic/ultrasonic.h"
+#include "firmware/common/ultrasonic/ultrasonic_async.h"
+#include "firmware/common/display/oled_flush.h"
 
 // ---------------------------------------------------------------------------
 // JSN-SR04T Waterproof Ultrasonic Collision Avoidance Test — Module 9
@@ -14,13 +19,18 @@
 //
 // Mode 1 (default — no R19 modification): manual TRIG/ECHO
 //   10 µs HIGH pulse on TRIG → sensor fires burst → ECHO HIGH for round-trip
-//   Distance (cm) = pulseIn(ECHO, HIGH, 30000) × 0.034 / 2
+//   Distance (cm) = ECHO high time (µs) × 0.034 / 2
 //
-// Sensors fire sequentially — eliminates acoustic cross-talk.
-// Total cycle ≈ 90 ms (padded to target if sensors return early).
+// Ranging runs in the background (UltrasonicAsync): a timer pulses TRIG,
+// ECHO edge interrupts time the echo, and the next sensor fires 5 ms after
+// the previous echo ends. Sensors still fire sequentially — no acoustic
+// cross-talk — and loop() never waits: it acts on each new sweep as it lands.
+// Sweep ≈ 30 ms with everything close, ~96 ms in open water.
 //
-// Status logic:
-//   STOP       — any sensor < 50 cm  (emergency stop)
+// Status logic (thresholds from the NVS config, defaults shown — change them
+// with "set dist_emergency <cm>" / "set dist_side_emergency <cm>" /
+// "set dist_avoidance <cm>" and "save"):
+//   STOP       — fwd < 50 cm or a side < 50 cm  (emergency stop)
 //   AVOID PORT — fwd < 200 cm AND port has more clearance than starboard
 //   AVOID STBD — fwd < 200 cm AND starboard has more clearance
 //   CLEAR      — all sensors ≥ 200 cm
@@ -30,45 +40,28 @@
 //   Green flash  = avoidance zone
 //   Red steady   = emergency stop
 //
-// Serial: CSV — time_ms, fwd_cm, port_cm, stbd_cm, status
+// Serial: TELEM_RANGE record — t_ms, fwd_cm, port_cm, stbd_cm, status, sweep_ms,
+//   oled_bytes, oled_us; tab-separated text, or COBS binary after
+//   "set telemetry 1" (telemetry.h)
 // ---------------------------------------------------------------------------
 
 #define SCREEN_WIDTH    128
 #define SCREEN_HEIGHT    64
 #define OLED_RESET       -1
 
-// Zone thresholds
-#define DIST_EMERGENCY_CM   50    // any sensor below → emergency stop
-#define DIST_AVOIDANCE_CM  200    // forward sensor below → avoidance zone
-#define DIST_NONE_CM       500    // pulseIn timeout — treat as no obstacle
-
-// pulseIn timeout: 30 ms → ~510 cm theoretical max (JSN-SR04T range ≤ 450 cm)
-#define ECHO_TIMEOUT_US  30000UL
+// Echo timeout and threshold defaults: firmware/common/ultrasonic/ultrasonic.h
 
 // LED flash period for avoidance zone
 #define FLASH_PERIOD_MS  250
 
-// Target loop period
-#define LOOP_PERIOD_MS    90
-
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+OledFlush oled;   // sends only changed columns, from its own task
 bool oledOk = false;
 
-// ---------------------------------------------------------------------------
-// Fire one JSN-SR04T sensor, return distance in cm.
-// Returns DIST_NONE_CM on timeout (no obstacle in range).
-// ---------------------------------------------------------------------------
-static uint16_t readSensor(uint8_t trigPin, uint8_t echoPin) {
-    digitalWrite(trigPin, LOW);
-    delayMicroseconds(2);
-    digitalWrite(trigPin, HIGH);
-    delayMicroseconds(10);
-    digitalWrite(trigPin, LOW);
-
-    unsigned long duration = pulseIn(echoPin, HIGH, ECHO_TIMEOUT_US);
-    if (duration == 0) return DIST_NONE_CM;
-    return (uint16_t)(duration * 0.034f / 2.0f);
-}
+UltrasonicAsync ranger;
+ConfigStore     cfg;   // zone thresholds, kept in NVS (config_store.h)
+char            cfgReply[320];
+Telemetry       tm;    // serial lines: text or COBS binary, "set telemetry 1" (telemetry.h)
 
 // ---------------------------------------------------------------------------
 static void printDist(uint16_t cm) {
@@ -83,7 +76,6 @@ void setup() {
     while (!Serial && millis() < 3000) delay(10);
 
     Serial.println("JSN-SR04T Collision Avoidance Test -- Module 9");
-    Serial.println("time_ms,fwd_cm,port_cm,stbd_cm,status");
 
     // Sensor trigger pins — output, start LOW
     pinMode(ULTRASONIC_TRIG_FWD,  OUTPUT); digitalWrite(ULTRASONIC_TRIG_FWD,  LOW);
@@ -111,35 +103,41 @@ void setup() {
         display.println("= ULTRASONIC M9 =");
         display.println("Initialising...");
         display.display();
+        oled.startTask();
     }
 
+    if (!cfg.load()) Serial.println("No stored config -- default thresholds.");
+
     delay(500);
+    if (!ranger.begin()) Serial.println("Ranging timer init failed!");
     Serial.println("Ready. Sweep hand in front of each sensor to verify TRIG/ECHO wiring.");
+
+    tm.setMode(cfg.get().telemetry_mode);
+    tm.header(TELEM_RANGE);
+    Serial.write(tm.data(), tm.size());
+    tm.clear();
 }
 
 // ---------------------------------------------------------------------------
 void loop() {
-    uint32_t cycleStart = millis();
+    while (Serial.available()) {
+        if (cfg.feed((char)Serial.read(), cfgReply, sizeof(cfgReply))) Serial.print(cfgReply);
+    }
+    tm.setMode(cfg.get().telemetry_mode);
 
-    // Fire all 3 sensors sequentially — prevents acoustic cross-talk
-    uint16_t fwd_cm  = readSensor(ULTRASONIC_TRIG_FWD,  ULTRASONIC_ECHO_FWD);
-    uint16_t port_cm = readSensor(ULTRASONIC_TRIG_PORT, ULTRASONIC_ECHO_PORT);
-    uint16_t stbd_cm = readSensor(ULTRASONIC_TRIG_STBD, ULTRASONIC_ECHO_STBD);
+    // Sweeps land in the background; nothing to do until a new one arrives
+    UltrasonicScan scan;
+    if (!ranger.latest(&scan)) return;
+    uint16_t fwd_cm  = scan.fwd_cm;
+    uint16_t port_cm = scan.port_cm;
+    uint16_t stbd_cm = scan.stbd_cm;
 
     // Determine status
-    const char* status;
-    bool emergencyStop = (fwd_cm  < DIST_EMERGENCY_CM ||
-                          port_cm < DIST_EMERGENCY_CM ||
-                          stbd_cm < DIST_EMERGENCY_CM);
-
-    if (emergencyStop) {
-        status = "STOP";
-    } else if (fwd_cm < DIST_AVOIDANCE_CM) {
-        // Turn toward the side with more clearance
-        status = (port_cm > stbd_cm) ? "AVOID PORT" : "AVOID STBD";
-    } else {
-        status = "CLEAR";
-    }
+    const BuoyConfig& c = cfg.get();
+    ObstacleZone zone   = ultrasonic_classify(scan, c.dist_emergency_cm, c.dist_avoidance_cm,
+                                              c.dist_side_emergency_cm);
+    const char*  status = ultrasonic_zone_name(zone);
+    bool emergencyStop  = (zone == ZONE_STOP);
 
     // LED control
     static uint32_t lastFlash = 0;
@@ -148,7 +146,7 @@ void loop() {
     if (emergencyStop) {
         digitalWrite(LED_GREEN_PIN, LOW);
         digitalWrite(LED_RED_PIN,   HIGH);
-    } else if (fwd_cm < DIST_AVOIDANCE_CM) {
+    } else if (fwd_cm < c.dist_avoidance_cm) {
         // Flashing green — avoidance zone
         digitalWrite(LED_RED_PIN, LOW);
         uint32_t now = millis();
@@ -163,12 +161,19 @@ void loop() {
         digitalWrite(LED_RED_PIN,   LOW);
     }
 
-    // Serial — one CSV line per cycle for logging
-    Serial.print(millis());   Serial.print(",");
-    Serial.print(fwd_cm);     Serial.print(",");
-    Serial.print(port_cm);    Serial.print(",");
-    Serial.print(stbd_cm);    Serial.print(",");
-    Serial.println(status);
+    // Serial — one record per cycle for logging, text or binary, one write
+    OledStats os = oled.stats();   // previous frame's flush
+    tm.begin(TELEM_RANGE, millis());
+    tm.add(fwd_cm);
+    tm.add(port_cm);
+    tm.add(stbd_cm);
+    tm.add(zone);
+    tm.add(ranger.stats().last_cycle_us / 1000.0f);
+    tm.add(os.last_bytes);
+    tm.add(os.last_flush_us);
+    tm.end();
+    Serial.write(tm.data(), tm.size());
+    tm.clear();
 
     // OLED
     if (oledOk) {
@@ -192,10 +197,6 @@ void loop() {
         display.print("> ");
         display.println(status);
 
-        display.display();
+        oled.submit(display.getBuffer());   // returns at once; no 25 ms stall per sweep
     }
-
-    // Pad to target cycle period (sensors may return faster when obstacle is near)
-    uint32_t elapsed = millis() - cycleStart;
-    if (elapsed < LOOP_PERIOD_MS) delay(LOOP_PERIOD_MS - elapsed);
 }
@@ -1,69 +1,73 @@
 #include <Arduino.h>
 #include <Wire.h>
-#include <QMC5883LCompass.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include "common/config.h"
+#include "firmware/common/compass/heading_filter.h"
+#include "firmware/common/compass/mag_cal.h"
+#include "firmware/common/compass/qmc5883l.h"
+#include "firmware/common/config/config_store.h"
+#include "firmware/common/display/oled_flush.h"
+#include "firmware/common/i2c/i2c_bus.h"
+#include "firmware/common/recorder/flight_recorder.h"
+#include "firmware/common/telemetry/telemetry.h"
+#include "firmware/common/wind/wind.h"
+#include "firmware/common/wind/anemometer.h"
+#include "firmware/common/wind/wind_window.h"
 
 // ---------------------------------------------------------------------------
-// VANE_OFFSET — set after calibration:
+// Vane offset — set after calibration, no reflash:
 //   Point the buoy bow directly into the wind, read vane_raw from serial,
-//   then set that value here and reflash.  After calibration, vane_relative
-//   reads 0° when the bow is pointing directly into the wind.
+//   then type "set vane_offset <vane_raw>" and "save" on the serial line
+//   (or send PKT_CONFIG_SET).  After calibration, vane_relative reads 0°
+//   when the bow is pointing directly into the wind.  Kept in the NVS
+//   config (config_store.h) with the wind-shift threshold.
 // ---------------------------------------------------------------------------
-#define VANE_OFFSET 0.0f
+ConfigStore cfg;
+char        cfgReply[320];
 
-// Compass calibration — replace after running compass_test in CALIBRATION_MODE 1
-#define CAL_X_MIN  -1500
-#define CAL_X_MAX   1500
-#define CAL_Y_MIN  -1500
-#define CAL_Y_MAX   1500
-#define CAL_Z_MIN  -1500
-#define CAL_Z_MAX   1500
-
-#define COMPASS_ADDR   0x0D
 #define SCREEN_WIDTH   128
 #define SCREEN_HEIGHT   64
 #define OLED_RESET      -1
 
-QMC5883LCompass  compass;
+I2cBus           bus;   // sole owner of Wire after setup(): compass HIGH, OLED LOW (i2c_bus.h)
+int              compassDev = -1;
+MagCalibrator    cal;   // hard/soft iron, learnt online and kept in NVS (mag_cal.h)
+HeadingFilter    hf;    // replaces the library's 5-reading smoothing (heading_filter.h)
+FlightRecorder   rec;   // binary log in the "rec" flash partition (flight_recorder.h)
+Telemetry        tm;    // serial lines: text or COBS binary, "set telemetry 1" (telemetry.h)
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+OledFlush        oled;  // changed columns only, from its own task (oled_flush.h)
 
 bool oledOk = false;
 
+// 60 s stability window over abs_wind_dir (WIND_CHANGE_DURATION_S, 5 Hz here)
+WindWindow windWindow;
+
 // ---------------------------------------------------------------------------
-// Wind speed — ISR + 1-second pulse integration (unchanged from .ino)
+// Wind speed — per-pulse period (firmware/common/wind/anemometer.h): the ISR
+// timestamps each pulse in µs, every pulse gives a fresh speed, 3 s gust/lull.
+// WIND_SPEED_COUNT_FALLBACK 1 reverts to pulses counted over 1 s.
 // ---------------------------------------------------------------------------
-volatile uint32_t windSpeedPulseCount = 0;
-volatile uint32_t lastWindSpeedPulse  = 0;
-uint32_t          lastWindSpeedCalc   = 0;
-float             windSpeed           = 0.0f;
+#define WIND_SPEED_COUNT_FALLBACK 0
 
-void IRAM_ATTR windSpeedISR() {
-    uint32_t now = millis();
-    if (now - lastWindSpeedPulse > 10) {   // 10 ms debounce
-        windSpeedPulseCount++;
-        lastWindSpeedPulse = now;
-    }
-}
+Anemometer anemometer(WIND_SPEED_PIN);
+uint32_t   lastWindSpeedCalc = 0;
+float      windSpeedCounted  = 0.0f;
 
 float updateWindSpeed() {
+    anemometer.poll();
+#if WIND_SPEED_COUNT_FALLBACK
     uint32_t now     = millis();
     uint32_t elapsed = now - lastWindSpeedCalc;
     if (elapsed >= 1000) {
-        float pps  = (float)windSpeedPulseCount / (elapsed / 1000.0f);
-        windSpeed  = pps * 1.609344f;   // Davis: 1 pulse/s = 1 mph → km/h
-        windSpeedPulseCount = 0;
-        lastWindSpeedCalc   = now;
+        windSpeedCounted  = wind_speed_kmh(anemometer.takePulseCount(), elapsed);
+        lastWindSpeedCalc = now;
     }
-    return windSpeed;
-}
-
-// ---------------------------------------------------------------------------
-// Wind vane — raw potentiometer reading mapped to 0–360°
-// ---------------------------------------------------------------------------
-float readVaneRaw() {
-    return (analogRead(WIND_DIR_PIN) / 4095.0f) * 360.0f;
+    return windSpeedCounted;
+#else
+    return anemometer.speedKmh();
+#endif
 }
 
 // ---------------------------------------------------------------------------
@@ -72,11 +76,10 @@ void setup() {
     while (!Serial && millis() < 3000) delay(10);
 
     Serial.println("Wind + Compass Sensor Fusion Test — Module 6");
-    Serial.println("vane_raw\tvane_rel\tcompass\tabs_wind\terror\tspeed_kmh");
 
     pinMode(WIND_SPEED_PIN, INPUT_PULLUP);
     pinMode(WIND_DIR_PIN,   INPUT);
-    attachInterrupt(digitalPinToInterrupt(WIND_SPEED_PIN), windSpeedISR, FALLING);
+    anemometer.begin();
     lastWindSpeedCalc = millis();
 
     Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
@@ -113,23 +116,51 @@ void setup() {
         display.display();
     }
 
-    compass.setADDR(COMPASS_ADDR);
-    compass.init();
-    compass.setSmoothing(5, true);
-    compass.setCalibration(CAL_X_MIN, CAL_X_MAX, CAL_Y_MIN, CAL_Y_MAX, CAL_Z_MIN, CAL_Z_MAX);
+    // From here on only the bus task drives Wire
+    compassDev = bus.addDevice("compass", COMPASS_ADDR, I2C_PRIO_HIGH);
+    if (oledOk) oled.attachBus(bus);
+    bus.startTask();
+    if (oledOk) oled.startTask();
+
+    if (!qmc5883l_init(bus, compassDev)) Serial.println("ERROR: QMC5883L init failed");
+    if (!cal.load()) Serial.println("Compass uncalibrated — turn the buoy through all headings.");
+
+    if (!cfg.load()) Serial.println("No stored config — defaults in use.");
+    Serial.print("vane_offset = "); Serial.println(cfg.get().vane_offset_deg, 1);
+    if (rec.begin()) { Serial.print("Recorder: page "); Serial.println(rec.nextSeq()); }
+    else             Serial.println("Recorder: no \"rec\" partition — not logging.");
+    rec.startTask();   // flash erase / program on core 0, never in loop()
 
     Serial.println("Ready.");
-    Serial.println("VANE_OFFSET calibration: point bow into wind, note vane_raw,");
-    Serial.println("  set #define VANE_OFFSET to that value, then reflash.");
+    Serial.println("Vane calibration: point bow into wind, note vane_raw,");
+    Serial.println("  then type: set vane_offset <vane_raw>  and  save");
+    Serial.println("Binary telemetry: set telemetry 1 (decode with testing/telemetry_decode)");
+
+    tm.setMode(cfg.get().telemetry_mode);
+    tm.header(TELEM_WIND);
+    Serial.write(tm.data(), tm.size());
+    tm.clear();
 }
 
 // ---------------------------------------------------------------------------
 void loop() {
+    while (Serial.available()) {
+        if (cfg.feed((char)Serial.read(), cfgReply, sizeof(cfgReply))) Serial.print(cfgReply);
+    }
+    tm.setMode(cfg.get().telemetry_mode);
+
     float speed = updateWindSpeed();
 
     // --- Compass ---
-    compass.read();
-    int compass_heading = compass.getAzimuth();   // 0–359°, magnetic north = 0°
+    // A failed read leaves the last counts; the filter coasts on its estimate
+    static int16_t mx = 0, my = 0, mz = 0;
+    if (qmc5883l_read(bus, compassDev, &mx, &my, &mz)) {
+        cal.add(mx, my, mz);
+        cal.service(millis());
+        hf.mag(cal.heading(mx, my, mz), micros());
+    }
+    float compass_heading = hf.heading(micros());                // 0–360°, magnetic north = 0°
+    int   compass_deg     = (int)lroundf(compass_heading) % 360;   // display / telemetry only
 
     // --- Sensor fusion ---
     //
@@ -139,19 +170,42 @@ void loop() {
     // heading_error : control signal — positive = wind from starboard (turn right)
     //                                  negative = wind from port     (turn left)
     //
-    float vane_raw      = readVaneRaw();
-    float vane_relative = fmod(vane_raw - VANE_OFFSET + 360.0f, 360.0f);
-    float abs_wind_dir  = fmod((float)compass_heading + vane_relative, 360.0f);
-    float heading_error = vane_relative;
-    if (heading_error > 180.0f) heading_error -= 360.0f;
-
-    // Serial — tab-separated, one line per sample
-    Serial.print(vane_raw, 1);      Serial.print("\t");
-    Serial.print(vane_relative, 1); Serial.print("\t");
-    Serial.print(compass_heading);  Serial.print("\t");
-    Serial.print(abs_wind_dir, 1);  Serial.print("\t");
-    Serial.print(heading_error, 1); Serial.print("\t");
-    Serial.println(speed, 2);
+    float      vane_raw      = wind_vane_read();   // raw potentiometer, 0–360°
+    WindFusion fusion        = wind_fuse(vane_raw, cfg.get().vane_offset_deg, compass_heading);
+    float      vane_relative = fusion.vane_relative;
+    float      abs_wind_dir  = fusion.abs_wind_dir;
+    float      heading_error = fusion.heading_error;
+
+    // --- Wind stability: mean, spread and largest shift over the last 60 s ---
+    windWindow.add(abs_wind_dir, millis());
+    bool windStable = windWindow.stable(cfg.get().wind_shift_deg);
+
+    // Flight recorder — integers only; the page reaches flash from service()
+    uint32_t now = millis();
+    rec.compass(now, (uint16_t)(lroundf(compass_heading * 100) % 36000), mx, my, mz);
+    rec.vane(now, (uint16_t)lroundf(vane_raw * 100), (uint16_t)lroundf(abs_wind_dir * 100),
+             (int16_t)lroundf(heading_error * 100));
+    rec.wind(now, (uint16_t)lroundf(speed * 100), (uint16_t)lroundf(anemometer.gustKmh() * 100),
+             (uint16_t)lroundf(anemometer.lullKmh() * 100));
+    rec.sync(now);
+
+    // Serial — one record per sample, text (tab-separated) or binary, one write
+    tm.begin(TELEM_WIND, now);
+    tm.add(vane_raw);
+    tm.add(vane_relative);
+    tm.add(compass_deg);
+    tm.add(abs_wind_dir);
+    tm.add(heading_error);
+    tm.add(speed);
+    tm.add(anemometer.gustKmh());
+    tm.add(anemometer.lullKmh());
+    tm.add(windWindow.mean_deg());
+    tm.add(windWindow.circular_variance());
+    tm.add(windWindow.range_deg());
+    tm.add(!windWindow.full() ? 0 : (windStable ? 1 : 2));   // FILL / STABLE / SHIFT
+    tm.end();
+    Serial.write(tm.data(), tm.size());
+    tm.clear();
 
     // OLED
     if (oledOk) {
@@ -171,22 +225,24 @@ void loop() {
 
         display.setCursor(0, 24);
         display.print("Cmpss:");
-        display.print(compass_heading);
+        display.print(compass_deg);
         display.print((char)247);
 
         display.setCursor(0, 36);
         display.print("Wind:");
         display.print(abs_wind_dir, 0);
         display.print((char)247);
-        display.print(" (abs)");
+        display.print(windWindow.full() ? (windStable ? " STBL" : " SHFT") : " ....");
+        display.print(windWindow.range_deg(), 0);
 
         display.setCursor(0, 50);
         display.print(speed, 1);
         display.print("km/h ");
-        display.print(speed / 1.852f, 1);
-        display.print("kt");
+        display.print(speed / KMH_PER_KNOT, 1);
+        display.print("kt G");
+        display.print(anemometer.gustKmh() / KMH_PER_KNOT, 0);
 
-        display.display();
+        oled.submit(display.getBuffer());
     }
 
     delay(200);